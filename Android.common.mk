@@ -53,6 +53,7 @@ LOCAL_SRC_FILES := \
 	src/cares_wrap.cc \
 	src/fs_event_wrap.cc \
 	src/handle_wrap.cc \
+	src/isolate_channel.cc \
 	src/pipe_wrap.cc \
 	src/process_wrap.cc \
 	src/stream_wrap.cc \
@@ -0,0 +1,36 @@
+// Measures Buffer encoding and decoding throughput.
+//
+//   node benchmark/buffer_codec.js [size] [iterations]
+
+var size = +process.argv[2] || 1024 * 1024;
+var iterations = +process.argv[3] || 50;
+
+var bytes = new Buffer(size);
+for (var i = 0; i < size; i++) bytes[i] = (i * 7919) & 0xff;
+
+var ascii = new Buffer(size);
+for (var i = 0; i < size; i++) ascii[i] = 0x20 + (i % 95);
+
+// Mostly ASCII with two and three byte sequences mixed in.
+var text = new Buffer(new Array(size / 16 + 1).join(
+    'héllo wörld 世界 text, '), 'utf8').slice(0, size);
+
+var base64 = bytes.toString('base64');
+var hex = bytes.toString('hex');
+var out = new Buffer(size);
+
+function bench(name, fn) {
+  fn();  // warm up
+  var start = Date.now();
+  for (var i = 0; i < iterations; i++) fn();
+  var elapsed = (Date.now() - start) / 1000;
+  var mb = size * iterations / (1024 * 1024);
+  console.log(name + ': ' + (mb / elapsed).toFixed(1) + ' MB/s');
+}
+
+bench('base64 encode', function() { bytes.toString('base64'); });
+bench('base64 decode', function() { out.write(base64, 0, 'base64'); });
+bench('hex encode', function() { bytes.toString('hex'); });
+bench('hex decode', function() { out.write(hex, 0, 'hex'); });
+bench('utf8 decode (ascii)', function() { ascii.toString('utf8'); });
+bench('utf8 decode (mixed)', function() { text.toString('utf8'); });
@@ -0,0 +1,36 @@
+var fork = require('child_process').fork,
+    starts = 100,
+    i = 0,
+    start;
+
+// Forked children keep their channel to the parent open, so they exit
+// explicitly.
+if (process.argv[2] === 'child') {
+  process.exit(0);
+}
+
+if (!process.features.isolates) {
+  console.error('This benchmark needs a build with isolates.');
+  process.exit(1);
+}
+
+function startIsolate() {
+  var child = fork(__filename, ['child']);
+  child.on('exit', function(exitCode) {
+    if (exitCode !== 0) {
+      throw new Error('Error during isolate startup');
+    }
+
+    i++;
+    if (i < starts) {
+      startIsolate();
+    } else {
+      var duration = +new Date - start;
+      console.log('Started %d isolates in %s ms. %d ms / start.',
+                  starts, duration, duration / starts);
+    }
+  });
+}
+
+start = +new Date;
+startIsolate();
@@ -1,4 +1,6 @@
 var http = require('http');
+var fs = require('fs');
+var path = require('path');
 
 var concurrency = 30;
 var port = 12346;
@@ -13,12 +15,30 @@ for (var i = 0; i < bytes; i++) {
   body += 'C';
 }
 
+// `node static_http_server.js sendfile` serves the body from a file with
+// res.sendFile() instead of from a string.
+var sendfile = process.argv[2] === 'sendfile';
+var file = path.join(__dirname, 'static_http_server.tmp');
+var fd;
+
+if (sendfile) {
+  fs.writeFileSync(file, body);
+  fd = fs.openSync(file, 'r');
+  process.on('exit', function() {
+    fs.unlinkSync(file);
+  });
+}
+
 var server = http.createServer(function(req, res) {
   res.writeHead(200, {
     'Content-Type': 'text/plain',
     'Content-Length': body.length
   });
-  res.end(body);
+  if (sendfile) {
+    res.sendFile(fd, 0, body.length);
+  } else {
+    res.end(body);
+  }
 })
 
 server.listen(port, function() {
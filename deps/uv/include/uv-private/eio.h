@@ -223,8 +223,11 @@ typedef struct {
   int size;
 } etp_reqq;
   
-typedef struct {
+typedef struct eio_channel {
   etp_reqq res_queue; /* queue of outstanding responses for this channel */
+  etp_reqq req_queue; /* requests waiting for a thread, private ETP */
+  struct eio_channel *next_ready; /* private ETP */
+  int ready;          /* private ETP */
   void *data;         /* use this for what you want */
 } eio_channel;
 
@@ -72,7 +72,11 @@ typedef void* uv_lib_t;
   uv_buf_t* bufs; \
   int bufcnt; \
   int error; \
-  uv_buf_t bufsml[UV_REQ_BUFSML_SIZE];
+  uv_buf_t bufsml[UV_REQ_BUFSML_SIZE]; \
+  /* uv_write_file(); file is -1 for regular writes */ \
+  int file; \
+  int64_t file_offset; \
+  size_t file_length;
 
 #define UV_SHUTDOWN_PRIVATE_FIELDS /* empty */
 
@@ -87,6 +91,8 @@ typedef void* uv_lib_t;
   int bufcnt;                       \
   ssize_t status;                   \
   uv_udp_send_cb send_cb;           \
+  int batch;                        \
+  int nsent;                        \
   uv_buf_t bufsml[UV_REQ_BUFSML_SIZE];  \
 
 #define UV_PRIVATE_REQ_TYPES /* empty */
@@ -120,6 +126,9 @@ typedef void* uv_lib_t;
 #define UV_UDP_PRIVATE_FIELDS         \
   uv_alloc_cb alloc_cb;               \
   uv_udp_recv_cb recv_cb;             \
+  uv_udp_recv_batch_cb recv_batch_cb; \
+  uv_udp_msg_t* recv_msgs;            \
+  int recv_nmsgs;                     \
   ev_io read_watcher;                 \
   ev_io write_watcher;                \
   ngx_queue_t write_queue;            \
@@ -302,6 +302,13 @@ UV_EXTERN uv_err_t uv_last_error(uv_loop_t*);
 UV_EXTERN const char* uv_strerror(uv_err_t err);
 UV_EXTERN const char* uv_err_name(uv_err_t err);
 
+/*
+ * Maps a system error number to its uv_err_code: an errno value on unix, a
+ * GetLastError() code on windows. For code that makes its own system calls
+ * from the thread pool, where uv_last_error() does not apply.
+ */
+UV_EXTERN uv_err_code uv_translate_sys_error(int sys_errno);
+
 
 #define UV_REQ_FIELDS \
   /* read-only */ \
@@ -465,6 +472,24 @@ UV_EXTERN int uv_write(uv_write_t* req, uv_stream_t* handle,
 UV_EXTERN int uv_write2(uv_write_t* req, uv_stream_t* handle, uv_buf_t bufs[],
     int bufcnt, uv_stream_t* send_handle, uv_write_cb cb);
 
+/*
+ * Queues `length` bytes of the file `fd`, starting at `offset`, behind the
+ * writes already pending on the stream. The data goes from the page cache
+ * to the socket with sendfile() without passing through user space, as fast
+ * as the socket takes it, and counts towards write_queue_size like any
+ * other write. `fd` must stay open until `cb` is called.
+ *
+ * `bufs` are written ahead of the file as part of the same request, and
+ * may be empty. On TCP they do not go out as a short segment of their own
+ * where the kernel allows it, which makes them the place for protocol
+ * headers.
+ *
+ * Not supported on windows (UV_ENOSYS).
+ */
+UV_EXTERN int uv_write_file(uv_write_t* req, uv_stream_t* handle,
+    uv_buf_t bufs[], int bufcnt, uv_file fd, int64_t offset, size_t length,
+    uv_write_cb cb);
+
 /* uv_write_t is a subclass of uv_req_t */
 struct uv_write_s {
   UV_REQ_FIELDS
@@ -489,6 +514,12 @@ struct uv_tcp_s {
 
 UV_EXTERN int uv_tcp_init(uv_loop_t*, uv_tcp_t* handle);
 
+/*
+ * Opens an existing file descriptor as a tcp handle, e.g. a socket that was
+ * handed over from another thread. The handle takes ownership of the fd.
+ */
+UV_EXTERN int uv_tcp_open(uv_tcp_t* handle, uv_file fd);
+
 /* Enable/disable Nagle's algorithm. */
 UV_EXTERN int uv_tcp_nodelay(uv_tcp_t* handle, int enable);
 
@@ -509,6 +540,14 @@ UV_EXTERN int uv_tcp_keepalive(uv_tcp_t* handle, int enable,
  */
 UV_EXTERN int uv_tcp_simultaneous_accepts(uv_tcp_t* handle, int enable);
 
+/*
+ * Enable/disable SO_REUSEPORT. Must be called before uv_tcp_bind(); several
+ * handles that all set it may then bind and listen on the same address and
+ * the kernel spreads incoming connections over them. Fails with UV_ENOTSUP
+ * where the option does not exist.
+ */
+UV_EXTERN int uv_tcp_reuseport(uv_tcp_t* handle, int enable);
+
 UV_EXTERN int uv_tcp_bind(uv_tcp_t* handle, struct sockaddr_in);
 UV_EXTERN int uv_tcp_bind6(uv_tcp_t* handle, struct sockaddr_in6);
 UV_EXTERN int uv_tcp_getsockname(uv_tcp_t* handle, struct sockaddr* name,
@@ -573,6 +612,32 @@ typedef void (*uv_udp_send_cb)(uv_udp_send_t* req, int status);
 typedef void (*uv_udp_recv_cb)(uv_udp_t* handle, ssize_t nread, uv_buf_t buf,
     struct sockaddr* addr, unsigned flags);
 
+/*
+ * A datagram in a batch. See uv_udp_recv_batch_start().
+ *
+ *  buf     Where to receive the datagram. Set by the user.
+ *  nread   Number of bytes that have been received.
+ *  flags   One or more OR'ed UV_UDP_* constants.
+ *  addr    The address of the sender.
+ */
+typedef struct uv_udp_msg_s {
+  uv_buf_t buf;
+  ssize_t nread;
+  unsigned flags;
+  struct sockaddr_storage addr;
+} uv_udp_msg_t;
+
+/*
+ * Callback that is invoked when a batch of UDP datagrams is received.
+ *
+ *  handle  UDP handle.
+ *  nmsgs   Number of datagrams that have been received, starting at msgs[0].
+ *          -1 if a transmission error was detected.
+ *  msgs    The array passed to uv_udp_recv_batch_start().
+ */
+typedef void (*uv_udp_recv_batch_cb)(uv_udp_t* handle, int nmsgs,
+    uv_udp_msg_t* msgs);
+
 /* uv_udp_t is a subclass of uv_handle_t */
 struct uv_udp_s {
   UV_HANDLE_FIELDS
@@ -695,6 +760,54 @@ UV_EXTERN int uv_udp_send6(uv_udp_send_t* req, uv_udp_t* handle,
 UV_EXTERN int uv_udp_recv_start(uv_udp_t* handle, uv_alloc_cb alloc_cb,
     uv_udp_recv_cb recv_cb);
 
+/*
+ * Send a batch of datagrams to the same peer, one datagram per buffer. Where
+ * the platform has it, the batch is handed to the kernel with sendmmsg(), so
+ * a whole batch can go out in a single system call. The callback runs once,
+ * after the last datagram has been sent or the first one has failed.
+ *
+ * Arguments:
+ *  req       UDP request handle. Need not be initialized.
+ *  handle    UDP handle. Should have been initialized with `uv_udp_init`.
+ *  bufs      List of datagrams to send.
+ *  bufcnt    Number of datagrams in `bufs`.
+ *  addr      Address of the remote peer. See `uv_ip4_addr`.
+ *  send_cb   Callback to invoke when the data has been sent out.
+ *
+ * Returns:
+ *  0 on success, -1 on error.
+ */
+UV_EXTERN int uv_udp_send_batch(uv_udp_send_t* req, uv_udp_t* handle,
+    uv_buf_t bufs[], int bufcnt, struct sockaddr_in addr,
+    uv_udp_send_cb send_cb);
+
+/*
+ * IPv6 version of `uv_udp_send_batch`. See `uv_ip6_addr`.
+ */
+UV_EXTERN int uv_udp_send_batch6(uv_udp_send_t* req, uv_udp_t* handle,
+    uv_buf_t bufs[], int bufcnt, struct sockaddr_in6 addr,
+    uv_udp_send_cb send_cb);
+
+/*
+ * Receive datagrams in batches. Works like `uv_udp_recv_start` except that
+ * datagrams are received straight into the buffers of `msgs`, with
+ * recvmmsg() where the platform has it, and the callback is invoked once
+ * per batch instead of once per datagram.
+ *
+ * Arguments:
+ *  handle    UDP handle. Should have been initialized with `uv_udp_init`.
+ *  msgs      Array of `nmsgs` datagram slots. It is owned by the caller and
+ *            must stay valid until `uv_udp_recv_stop` is called. The buffers
+ *            may be swapped out from within the callback.
+ *  nmsgs     Maximum number of datagrams per batch.
+ *  recv_cb   Callback to invoke with received data.
+ *
+ * Returns:
+ *  0 on success, -1 on error.
+ */
+UV_EXTERN int uv_udp_recv_batch_start(uv_udp_t* handle, uv_udp_msg_t* msgs,
+    int nmsgs, uv_udp_recv_batch_cb recv_cb);
+
 /*
  * Stop listening for incoming datagrams.
  *
@@ -982,6 +1095,12 @@ struct uv_process_options_s {
    */
   uv_thread_run thread_run;
 
+  /*
+   * thread_channel, an opaque in-process message channel handed over to the
+   * thread; ends up in uv_thread_shared_t.channel
+   */
+  void *thread_channel;
+
   /*
    * The user should supply pointers to initialized uv_pipe_t structs for
    * stdio. This is used to to send or receive input from the subprocess.
@@ -1030,6 +1149,7 @@ struct uv_thread_shared_s {
   char **env;                 /* the responsibility of the thread to delete when no longer needed */
   int exit_status;            /* set by the thread on exit before notifying any watcher */
   int term_signal;            /* set by the thread on exit before notifying any watcher */
+  void *channel;              /* as originally passed in options, owned by the thread */
   /* private after this point */
   pthread_mutex_t mtx;
   pthread_cond_t cond;
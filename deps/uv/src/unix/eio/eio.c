@@ -502,9 +502,16 @@ etp_nthreads (void)
   return retval;
 }
 
-static etp_reqq req_queue;
 static eio_channel default_channel;
 
+/*
+ * Every channel queues its own requests. The channels that have requests
+ * waiting are kept in a list that the threads serve round-robin, one
+ * request per turn, so one channel with a long queue cannot starve the
+ * others. Within a channel, requests are served by priority.
+ */
+static eio_channel *ready_first, *ready_last; /* reqlock */
+
 static void ecb_noinline ecb_cold
 reqq_init (etp_reqq *q)
 {
@@ -559,6 +566,57 @@ reqq_shift (etp_reqq *q)
   abort ();
 }
 
+/* must be called with reqlock held */
+static void
+etp_ready_append (eio_channel *channel)
+{
+  channel->ready = 1;
+  channel->next_ready = 0;
+
+  if (ready_last)
+    ready_last->next_ready = channel;
+  else
+    ready_first = channel;
+
+  ready_last = channel;
+}
+
+/* must be called with reqlock held */
+static void
+etp_reqq_push (ETP_REQ *req)
+{
+  eio_channel *channel = req->channel ? req->channel : &default_channel;
+
+  reqq_push (&channel->req_queue, req);
+
+  if (!channel->ready)
+    etp_ready_append (channel);
+}
+
+/* must be called with reqlock held */
+static ETP_REQ *
+etp_reqq_shift (void)
+{
+  eio_channel *channel = ready_first;
+  ETP_REQ *req;
+
+  if (!channel)
+    return 0;
+
+  req = reqq_shift (&channel->req_queue);
+
+  ready_first = channel->next_ready;
+  if (!ready_first)
+    ready_last = 0;
+  channel->ready = 0;
+
+  /* go to the back of the line if there is more */
+  if (channel->req_queue.size)
+    etp_ready_append (channel);
+
+  return req;
+}
+
 static int ecb_cold
 etp_init (void (*want_poll)(eio_channel *), void (*done_poll)(eio_channel *))
 {
@@ -567,7 +625,7 @@ etp_init (void (*want_poll)(eio_channel *), void (*done_poll)(eio_channel *))
   X_MUTEX_CREATE (reqlock);
   X_COND_CREATE  (reqwait);
 
-  reqq_init (&req_queue);
+  ready_first = ready_last = 0;
   eio_channel_init (&default_channel, 0);
 
   wrk_first.next =
@@ -633,7 +691,7 @@ etp_end_thread (void)
   req->pri  = ETP_PRI_MAX - ETP_PRI_MIN;
 
   X_LOCK (reqlock);
-  reqq_push (&req_queue, req);
+  etp_reqq_push (req);
   X_COND_SIGNAL (reqwait);
   X_UNLOCK (reqlock);
 
@@ -645,6 +703,9 @@ etp_end_thread (void)
 void
 eio_channel_init(eio_channel *channel, void *data) {
   reqq_init(&channel->res_queue);
+  reqq_init(&channel->req_queue);
+  channel->next_ready = 0;
+  channel->ready = 0;
   channel->data = data;
 }
 
@@ -659,6 +720,13 @@ etp_poll (eio_channel *channel)
   X_LOCK (reslock);
   maxreqs = max_poll_reqs;
   maxtime = max_poll_time;
+  /*
+   * Without a limit, handle the responses that are there now. The ones
+   * that arrive meanwhile are left for the next poll so that callbacks
+   * submitting new requests cannot keep us in here forever.
+   */
+  if (!maxreqs)
+    maxreqs = channel->res_queue.size ? channel->res_queue.size : 1;
   X_UNLOCK (reslock);
 
   if (maxtime)
@@ -755,7 +823,7 @@ etp_submit (ETP_REQ *req)
       X_LOCK (reqlock);
       ++nreqs;
       ++nready;
-      reqq_push (&req_queue, req);
+      etp_reqq_push (req);
       X_COND_SIGNAL (reqwait);
       X_UNLOCK (reqlock);
 
@@ -2040,7 +2108,7 @@ X_THREAD_PROC (etp_proc)
 
       for (;;)
         {
-          self->req = req = reqq_shift (&req_queue);
+          self->req = req = etp_reqq_shift ();
 
           if (req)
             break;
@@ -692,7 +692,11 @@ int uv_queue_work(uv_loop_t* loop, uv_work_t* req, uv_work_cb work_cb,
   req->work_cb = work_cb;
   req->after_work_cb = after_work_cb;
 
-  req->eio = eio_custom(uv__work, EIO_PRI_DEFAULT, uv__after_work, req,  &loop->uv_eio_channel);
+  /*
+   * Queued work is usually CPU bound and long running. Let the loop's file
+   * system requests, which are quick, go first.
+   */
+  req->eio = eio_custom(uv__work, EIO_PRI_MIN, uv__after_work, req,  &loop->uv_eio_channel);
 
   if (!req->eio) {
     uv__set_sys_error(loop, ENOMEM);
@@ -463,6 +463,7 @@ int uv_thread_create(uv_loop_t *loop, uv_thread_t *thread, uv_process_options_t
   hnd->thread_handle = thread;
   hnd->options = &options;
   hnd->thread_arg = options.thread_arg;
+  hnd->channel = options.thread_channel;
   hnd->stdin_fd = hnd->stdout_fd = hnd->stderr_fd = -1;
   /* FIXME: take ownership of args, but better way sought */
   hnd->args = options.args;
@@ -28,9 +28,20 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/uio.h>
+#include <limits.h> /* IOV_MAX */
+
+#if defined(__linux__)
+# include <sys/sendfile.h>
+#elif defined(__APPLE__) || defined(__FreeBSD__)
+# include <sys/socket.h>
+#endif
 
 #include <stdio.h>
 
+#ifndef IOV_MAX
+# define IOV_MAX 1024
+#endif
+
 
 static void uv__stream_connect(uv_stream_t*);
 static void uv__write(uv_stream_t* stream);
@@ -145,7 +156,7 @@ void uv__stream_destroy(uv_stream_t* stream) {
 
     req = ngx_queue_data(q, uv_write_t, queue);
     if (req->cb) {
-      uv__set_artificial_error(stream->loop, req->error);
+      uv__set_sys_error(stream->loop, req->error);
       req->cb(req, req->error ? -1 : 0);
     }
   }
@@ -308,6 +319,8 @@ static size_t uv__write_req_size(uv_write_t* req) {
 
   size = uv__buf_count(req->bufs + req->write_index,
                        req->bufcnt - req->write_index);
+  if (req->file >= 0)
+    size += req->file_length;
   assert(req->handle->write_queue_size >= size);
 
   return size;
@@ -332,6 +345,107 @@ static void uv__write_req_finish(uv_write_t* req) {
 }
 
 
+/* Sends up to `len` bytes of `in_fd` from `offset` to `out_fd`. Returns the
+ * number of bytes sent or -1 with errno set, ENOSYS where there is no
+ * sendfile().
+ */
+static ssize_t uv__sendfile(int out_fd, int in_fd, int64_t offset, size_t len) {
+#if defined(__linux__)
+  off_t off = offset;
+  return sendfile(out_fd, in_fd, &off, len);
+#elif defined(__APPLE__) || defined(__FreeBSD__)
+  off_t sent;
+  int r;
+# if defined(__APPLE__)
+  sent = len;
+  r = sendfile(in_fd, out_fd, offset, &sent, NULL, 0);
+# else
+  sent = 0;
+  r = sendfile(in_fd, out_fd, offset, len, NULL, &sent, 0);
+# endif
+  /* Both report a partial send as EAGAIN or EINTR with `sent` updated. */
+  if (r == 0 || ((errno == EAGAIN || errno == EINTR) && sent > 0))
+    return sent;
+  return -1;
+#else
+  errno = ENOSYS;
+  return -1;
+#endif
+}
+
+
+/* For descriptors that sendfile() does not handle: one pread() into a bounce
+ * buffer, one write(). Whatever the socket does not take is read again next
+ * time.
+ */
+static ssize_t uv__sendfile_emu(int out_fd, int in_fd, int64_t offset,
+    size_t len) {
+  char buf[64 * 1024];
+  ssize_t n;
+
+  if (len > sizeof(buf))
+    len = sizeof(buf);
+
+  do
+    n = pread(in_fd, buf, len, offset);
+  while (n == -1 && errno == EINTR);
+
+  if (n <= 0)
+    return n;
+
+  return write(out_fd, buf, n);
+}
+
+
+static void uv__write_file(uv_stream_t* stream, uv_write_t* req) {
+  ssize_t n;
+
+  while (req->file_length > 0) {
+    n = uv__sendfile(stream->fd,
+                     req->file,
+                     req->file_offset,
+                     req->file_length);
+
+    if (n == -1 &&
+        (errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP)) {
+      n = uv__sendfile_emu(stream->fd,
+                           req->file,
+                           req->file_offset,
+                           req->file_length);
+    }
+
+    if (n == -1 && errno == EINTR)
+      continue;
+
+    if (n == -1 && errno == EAGAIN && !stream->blocking)
+      break;
+
+    if (n <= 0) {
+      /* Zero means the file ended before the range did. */
+      req->error = n == 0 ? EINVAL : errno;
+      stream->write_queue_size -= uv__write_req_size(req);
+      uv__write_req_finish(req);
+      return;
+    }
+
+    req->file_offset += n;
+    req->file_length -= n;
+    stream->write_queue_size -= n;
+
+    /* Like writev(), one go per writable event; the socket buffer is full. */
+    if (req->file_length > 0 && !stream->blocking)
+      break;
+  }
+
+  if (req->file_length == 0) {
+    uv__write_req_finish(req);
+    return;
+  }
+
+  ev_io_start(stream->loop->ev, &stream->write_watcher);
+}
+
+
 /* On success returns NULL. On error returns a pointer to the write request
  * which had the error.
  */
@@ -354,6 +468,13 @@ start:
 
   assert(req->handle == stream);
 
+  /* A uv_write_file() request whose leading buffers are out. */
+  if (req->write_index == req->bufcnt) {
+    assert(req->file >= 0);
+    uv__write_file(stream, req);
+    return;
+  }
+
   /*
    * Cast to iovec. We had to have our own uv_buf_t instead of iovec
    * because Windows's WSABUF is not an iovec.
@@ -362,6 +483,10 @@ start:
   iov = (struct iovec*) &(req->bufs[req->write_index]);
   iovcnt = req->bufcnt - req->write_index;
 
+  /* Limit iov count to avoid EINVALs from writev() */
+  if (iovcnt > IOV_MAX)
+    iovcnt = IOV_MAX;
+
   /*
    * Now do the actual writev. Note that we've been updating the pointers
    * inside the iov each time we write. So there is no need to offset it.
@@ -394,6 +519,23 @@ start:
       n = sendmsg(stream->fd, &msg, 0);
     }
     while (n == -1 && errno == EINTR);
+#ifdef MSG_MORE
+  } else if (req->file >= 0 && stream->type == UV_TCP) {
+    /* The buffers lead a file. Tell the kernel that more is coming so that
+     * they do not go out as a short segment that the file then has to wait
+     * behind until it is acknowledged.
+     */
+    struct msghdr msg;
+
+    memset(&msg, 0, sizeof msg);
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+
+    do {
+      n = sendmsg(stream->fd, &msg, MSG_MORE);
+    }
+    while (n == -1 && errno == EINTR);
+#endif
   } else {
     do {
       if (iovcnt == 1) {
@@ -457,6 +599,11 @@ start:
         if (req->write_index == req->bufcnt) {
           /* Then we're done! */
           assert(n == 0);
+          if (req->file >= 0) {
+            /* Unless there is a file to follow. */
+            uv__write_file(stream, req);
+            return;
+          }
           uv__write_req_finish(req);
           /* TODO: start trying to write the next request. */
           return;
@@ -490,7 +637,7 @@ static void uv__write_callbacks(uv_stream_t* stream) {
 
     /* NOTE: call callback AFTER freeing the request data. */
     if (req->cb) {
-      uv__set_artificial_error(stream->loop, req->error);
+      uv__set_sys_error(stream->loop, req->error);
       req->cb(req, req->error ? -1 : 0);
     }
 
@@ -817,8 +964,9 @@ int uv__connect(uv_connect_t* req, uv_stream_t* stream, struct sockaddr* addr,
 }
 
 
-int uv_write2(uv_write_t* req, uv_stream_t* stream, uv_buf_t bufs[], int bufcnt,
-    uv_stream_t* send_handle, uv_write_cb cb) {
+static int uv__write_queue(uv_write_t* req, uv_stream_t* stream,
+    uv_buf_t bufs[], int bufcnt, uv_stream_t* send_handle, uv_file file,
+    int64_t file_offset, size_t file_length, uv_write_cb cb) {
   int empty_queue;
 
   assert((stream->type == UV_TCP || stream->type == UV_NAMED_PIPE ||
@@ -846,6 +994,9 @@ int uv_write2(uv_write_t* req, uv_stream_t* stream, uv_buf_t bufs[], int bufcnt,
   req->error = 0;
   req->send_handle = send_handle;
   req->type = UV_WRITE;
+  req->file = file;
+  req->file_offset = file_offset;
+  req->file_length = file_length;
   ngx_queue_init(&req->queue);
 
   if (bufcnt <= UV_REQ_BUFSML_SIZE) {
@@ -863,7 +1014,7 @@ int uv_write2(uv_write_t* req, uv_stream_t* stream, uv_buf_t bufs[], int bufcnt,
    */
 
   req->write_index = 0;
-  stream->write_queue_size += uv__buf_count(bufs, bufcnt);
+  stream->write_queue_size += uv__buf_count(bufs, bufcnt) + file_length;
 
   /* Append the request to write_queue. */
   ngx_queue_insert_tail(&stream->write_queue, &req->queue);
@@ -894,6 +1045,29 @@ int uv_write2(uv_write_t* req, uv_stream_t* stream, uv_buf_t bufs[], int bufcnt,
 }
 
 
+int uv_write2(uv_write_t* req, uv_stream_t* stream, uv_buf_t bufs[], int bufcnt,
+    uv_stream_t* send_handle, uv_write_cb cb) {
+  return uv__write_queue(req, stream, bufs, bufcnt, send_handle, -1, 0, 0, cb);
+}
+
+
+int uv_write_file(uv_write_t* req, uv_stream_t* stream, uv_buf_t bufs[],
+    int bufcnt, uv_file fd, int64_t offset, size_t length, uv_write_cb cb) {
+  if (fd < 0) {
+    uv__set_sys_error(stream->loop, EBADF);
+    return -1;
+  }
+
+  if (offset < 0) {
+    uv__set_sys_error(stream->loop, EINVAL);
+    return -1;
+  }
+
+  return uv__write_queue(req, stream, bufs, bufcnt, NULL, fd, offset, length,
+      cb);
+}
+
+
 /* The buffers to be written must remain valid until the callback is called.
  * This is not required for the uv_buf_t array.
  */
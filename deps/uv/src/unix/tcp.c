@@ -33,6 +33,11 @@ int uv_tcp_init(uv_loop_t* loop, uv_tcp_t* tcp) {
 }
 
 
+int uv_tcp_open(uv_tcp_t* tcp, uv_file fd) {
+  return uv__stream_open((uv_stream_t*)tcp, fd, UV_READABLE | UV_WRITABLE);
+}
+
+
 static int uv__bind(uv_tcp_t* tcp,
                     int domain,
                     struct sockaddr* addr,
@@ -59,6 +64,16 @@ static int uv__bind(uv_tcp_t* tcp,
 
   assert(tcp->fd >= 0);
 
+#ifdef SO_REUSEPORT
+  if (tcp->flags & UV_TCP_REUSEPORT) {
+    int on = 1;
+    if (setsockopt(tcp->fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof on)) {
+      uv__set_sys_error(tcp->loop, errno);
+      goto out;
+    }
+  }
+#endif
+
   tcp->delayed_error = 0;
   if (bind(tcp->fd, addr, addrsize) == -1) {
     if (errno == EADDRINUSE) {
@@ -324,3 +339,18 @@ int uv_tcp_keepalive(uv_tcp_t* handle, int enable, unsigned int delay) {
 int uv_tcp_simultaneous_accepts(uv_tcp_t* handle, int enable) {
   return 0;
 }
+
+
+int uv_tcp_reuseport(uv_tcp_t* handle, int enable) {
+#ifdef SO_REUSEPORT
+  if (enable)
+    handle->flags |= UV_TCP_REUSEPORT;
+  else
+    handle->flags &= ~UV_TCP_REUSEPORT;
+
+  return 0;
+#else
+  uv__set_artificial_error(handle->loop, UV_ENOTSUP);
+  return -1;
+#endif
+}
@@ -27,11 +27,23 @@
 #include <errno.h>
 #include <stdlib.h>
 
+#if defined(__linux__) && defined(__GLIBC__)
+# if __GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 14)
+#  define UV__HAVE_MMSG 1
+# endif
+#endif
+
+/* Upper bound on the number of datagrams per recvmmsg() or sendmmsg() call,
+ * it sizes the header arrays on the stack.
+ */
+#define UV__MMSG_MAX 64
+
 
 static void uv__udp_watcher_start(uv_udp_t* handle, ev_io* w);
 static void uv__udp_run_completed(uv_udp_t* handle);
 static void uv__udp_run_pending(uv_udp_t* handle);
 static void uv__udp_recvmsg(uv_udp_t* handle);
+static void uv__udp_recvmmsg(uv_udp_t* handle);
 static void uv__udp_sendmsg(uv_udp_t* handle);
 static void uv__udp_io(EV_P_ ev_io* w, int events);
 static int uv__udp_maybe_deferred_bind(uv_udp_t* handle, int domain);
@@ -91,6 +103,8 @@ void uv__udp_destroy(uv_udp_t* handle) {
   handle->flags = 0;
   handle->recv_cb = NULL;
   handle->alloc_cb = NULL;
+  handle->recv_batch_cb = NULL;
+  handle->recv_msgs = NULL;
   /* but _do not_ touch close_cb */
 
   if (handle->fd != -1) {
@@ -103,6 +117,63 @@ void uv__udp_destroy(uv_udp_t* handle) {
 }
 
 
+/* Sends the datagrams of a batch request that have not gone out yet.
+ * Returns the total number of bytes in the batch once all of them have been
+ * sent, or -1 with errno set. On EAGAIN, req->nsent records how far it got.
+ */
+static ssize_t uv__udp_send_datagrams(uv_udp_t* handle, uv_udp_send_t* req) {
+  ssize_t nbytes;
+  int i;
+  int n;
+
+  while (req->nsent < req->bufcnt) {
+#ifdef UV__HAVE_MMSG
+    struct mmsghdr hdrs[UV__MMSG_MAX];
+
+    n = req->bufcnt - req->nsent;
+    if (n > UV__MMSG_MAX)
+      n = UV__MMSG_MAX;
+
+    memset(hdrs, 0, n * sizeof hdrs[0]);
+    for (i = 0; i < n; i++) {
+      hdrs[i].msg_hdr.msg_name = &req->addr;
+      hdrs[i].msg_hdr.msg_namelen = req->addrlen;
+      hdrs[i].msg_hdr.msg_iov = (struct iovec*)&req->bufs[req->nsent + i];
+      hdrs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    do {
+      n = sendmmsg(handle->fd, hdrs, n, 0);
+    }
+    while (n == -1 && errno == EINTR);
+#else
+    struct msghdr h;
+
+    memset(&h, 0, sizeof h);
+    h.msg_name = &req->addr;
+    h.msg_namelen = req->addrlen;
+    h.msg_iov = (struct iovec*)&req->bufs[req->nsent];
+    h.msg_iovlen = 1;
+
+    do {
+      n = sendmsg(handle->fd, &h, 0) == -1 ? -1 : 1;
+    }
+    while (n == -1 && errno == EINTR);
+#endif
+
+    if (n == -1)
+      return -1;
+
+    req->nsent += n;
+  }
+
+  for (nbytes = i = 0; i < req->bufcnt; i++)
+    nbytes += req->bufs[i].len;
+
+  return nbytes;
+}
+
+
 static void uv__udp_run_pending(uv_udp_t* handle) {
   uv_udp_send_t* req;
   ngx_queue_t* q;
@@ -116,6 +187,17 @@ static void uv__udp_run_pending(uv_udp_t* handle) {
     req = ngx_queue_data(q, uv_udp_send_t, queue);
     assert(req != NULL);
 
+    if (req->batch) {
+      size = uv__udp_send_datagrams(handle, req);
+      if (size == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        break;
+
+      req->status = (size == -1 ? -errno : size);
+      ngx_queue_remove(&req->queue);
+      ngx_queue_insert_tail(&handle->write_completed_queue, &req->queue);
+      continue;
+    }
+
     memset(&h, 0, sizeof h);
     h.msg_name = &req->addr;
     h.msg_namelen = req->addrlen;
@@ -249,6 +331,118 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
 }
 
 
+/* Receives up to `n` datagrams into msgs[0..n-1]. Returns the number of
+ * datagrams received or -1 with errno set.
+ */
+static int uv__udp_recv_datagrams(uv_udp_t* handle, uv_udp_msg_t* msgs, int n) {
+  int i;
+
+#ifdef UV__HAVE_MMSG
+  struct mmsghdr hdrs[UV__MMSG_MAX];
+
+  if (n > UV__MMSG_MAX)
+    n = UV__MMSG_MAX;
+
+  memset(hdrs, 0, n * sizeof hdrs[0]);
+  for (i = 0; i < n; i++) {
+    hdrs[i].msg_hdr.msg_name = &msgs[i].addr;
+    hdrs[i].msg_hdr.msg_namelen = sizeof msgs[i].addr;
+    hdrs[i].msg_hdr.msg_iov = (struct iovec*)&msgs[i].buf;
+    hdrs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  do {
+    n = recvmmsg(handle->fd, hdrs, n, 0, NULL);
+  }
+  while (n == -1 && errno == EINTR);
+
+  for (i = 0; i < n; i++) {
+    msgs[i].nread = hdrs[i].msg_len;
+    msgs[i].flags = (hdrs[i].msg_hdr.msg_flags & MSG_TRUNC) ? UV_UDP_PARTIAL : 0;
+  }
+
+  return n;
+#else
+  struct msghdr h;
+  ssize_t nread;
+
+  for (i = 0; i < n; i++) {
+    memset(&h, 0, sizeof h);
+    h.msg_name = &msgs[i].addr;
+    h.msg_namelen = sizeof msgs[i].addr;
+    h.msg_iov = (struct iovec*)&msgs[i].buf;
+    h.msg_iovlen = 1;
+
+    do {
+      nread = recvmsg(handle->fd, &h, 0);
+    }
+    while (nread == -1 && errno == EINTR);
+
+    if (nread == -1)
+      return i > 0 ? i : -1;
+
+    msgs[i].nread = nread;
+    msgs[i].flags = (h.msg_flags & MSG_TRUNC) ? UV_UDP_PARTIAL : 0;
+  }
+
+  return n;
+#endif
+}
+
+
+static void uv__udp_recvmmsg(uv_udp_t* handle) {
+  uv_udp_msg_t* msgs;
+  int nmsgs;
+  int drained;
+  int count;
+  int n;
+
+  assert(handle->recv_batch_cb != NULL);
+  assert(handle->recv_msgs != NULL);
+
+  do {
+    msgs = handle->recv_msgs;
+    nmsgs = handle->recv_nmsgs;
+    drained = 0;
+
+    /* Fill the whole array before calling back, the per-call limit only
+     * exists to bound the stack usage.
+     */
+    for (count = 0; count < nmsgs; count += n) {
+      n = uv__udp_recv_datagrams(handle, msgs + count, nmsgs - count);
+
+      if (n == -1) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+          if (count > 0)
+            handle->recv_batch_cb(handle, count, msgs);
+
+          if (handle->recv_batch_cb != NULL) {
+            uv__set_sys_error(handle->loop, errno);
+            handle->recv_batch_cb(handle, -1, msgs);
+          }
+          return;
+        }
+        drained = 1;
+        break;
+      }
+
+      if (n < UV__MMSG_MAX && n < nmsgs - count) {
+        count += n;
+        drained = 1;
+        break;
+      }
+    }
+
+    if (count > 0)
+      handle->recv_batch_cb(handle, count, msgs);
+  }
+  /* recv_batch_cb callback may decide to pause or close the handle */
+  while (!drained
+      && handle->fd != -1
+      && handle->recv_batch_cb != NULL);
+}
+
+
 static void uv__udp_sendmsg(uv_udp_t* handle) {
   assert(!ngx_queue_empty(&handle->write_queue)
       || !ngx_queue_empty(&handle->write_completed_queue));
@@ -279,8 +473,12 @@ static void uv__udp_io(EV_P_ ev_io* w, int events) {
   assert(handle->fd >= 0);
   assert(!(events & ~(EV_READ|EV_WRITE)));
 
-  if (events & EV_READ)
-    uv__udp_recvmsg(handle);
+  if (events & EV_READ) {
+    if (handle->recv_batch_cb != NULL)
+      uv__udp_recvmmsg(handle);
+    else
+      uv__udp_recvmsg(handle);
+  }
 
   if (events & EV_WRITE)
     uv__udp_sendmsg(handle);
@@ -409,6 +607,8 @@ static int uv__udp_send(uv_udp_send_t* req,
   req->send_cb = send_cb;
   req->handle = handle;
   req->bufcnt = bufcnt;
+  req->batch = 0;
+  req->nsent = 0;
   req->type = UV_UDP_SEND;
 
   if (bufcnt <= UV_REQ_BUFSML_SIZE) {
@@ -558,6 +758,46 @@ int uv_udp_send6(uv_udp_send_t* req,
 }
 
 
+int uv_udp_send_batch(uv_udp_send_t* req,
+                      uv_udp_t* handle,
+                      uv_buf_t bufs[],
+                      int bufcnt,
+                      struct sockaddr_in addr,
+                      uv_udp_send_cb send_cb) {
+  if (uv__udp_send(req,
+                   handle,
+                   bufs,
+                   bufcnt,
+                   (struct sockaddr*)&addr,
+                   sizeof addr,
+                   send_cb))
+    return -1;
+
+  req->batch = 1;
+  return 0;
+}
+
+
+int uv_udp_send_batch6(uv_udp_send_t* req,
+                       uv_udp_t* handle,
+                       uv_buf_t bufs[],
+                       int bufcnt,
+                       struct sockaddr_in6 addr,
+                       uv_udp_send_cb send_cb) {
+  if (uv__udp_send(req,
+                   handle,
+                   bufs,
+                   bufcnt,
+                   (struct sockaddr*)&addr,
+                   sizeof addr,
+                   send_cb))
+    return -1;
+
+  req->batch = 1;
+  return 0;
+}
+
+
 int uv_udp_recv_start(uv_udp_t* handle,
                       uv_alloc_cb alloc_cb,
                       uv_udp_recv_cb recv_cb) {
@@ -582,9 +822,37 @@ int uv_udp_recv_start(uv_udp_t* handle,
 }
 
 
+int uv_udp_recv_batch_start(uv_udp_t* handle,
+                            uv_udp_msg_t* msgs,
+                            int nmsgs,
+                            uv_udp_recv_batch_cb recv_cb) {
+  if (msgs == NULL || nmsgs <= 0 || recv_cb == NULL) {
+    uv__set_artificial_error(handle->loop, UV_EINVAL);
+    return -1;
+  }
+
+  if (ev_is_active(&handle->read_watcher)) {
+    uv__set_artificial_error(handle->loop, UV_EALREADY);
+    return -1;
+  }
+
+  if (uv__udp_maybe_deferred_bind(handle, AF_INET))
+    return -1;
+
+  handle->recv_batch_cb = recv_cb;
+  handle->recv_msgs = msgs;
+  handle->recv_nmsgs = nmsgs;
+  uv__udp_watcher_start(handle, &handle->read_watcher);
+
+  return 0;
+}
+
+
 int uv_udp_recv_stop(uv_udp_t* handle) {
   uv__udp_watcher_stop(handle, &handle->read_watcher);
   handle->alloc_cb = NULL;
   handle->recv_cb = NULL;
+  handle->recv_batch_cb = NULL;
+  handle->recv_msgs = NULL;
   return 0;
 }
@@ -25,6 +25,7 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <pthread.h>
 
 static void uv_eio_do_poll(uv_idle_t* watcher, int status) {
@@ -97,12 +98,28 @@ static void uv_eio_done_poll(eio_channel *channel) {
 
 static pthread_once_t eio_initialised = PTHREAD_ONCE_INIT;
 void eio_init_once() {
+  const char* val;
+  int nthreads;
+
   eio_init(uv_eio_want_poll, uv_eio_done_poll);
+
   /*
-   * Don't handle more than 10 reqs on each eio_poll(). This is to avoid
-   * race conditions. See Node's test/simple/test-eio-race.js
+   * Each eio_poll() handles the batch of responses that is queued when it
+   * starts; see etp_poll(). That keeps Node's test/simple/test-eio-race.js
+   * happy without an arbitrary cap on the number of requests.
    */
-  eio_set_max_poll_reqs(10);
+  eio_set_max_poll_reqs(0);
+
+  /* The pool is shared by all loops in the process. */
+  val = getenv("UV_THREADPOOL_SIZE");
+  nthreads = val ? atoi(val) : 0;
+  if (nthreads > 0) {
+    if (nthreads > 128)
+      nthreads = 128;
+    eio_set_min_parallel(nthreads);
+    eio_set_max_parallel(nthreads);
+    eio_set_max_idle(nthreads);
+  }
 }
 
 void uv_eio_init(uv_loop_t* loop) {
@@ -160,6 +160,12 @@ int uv_tcp_init(uv_loop_t* loop, uv_tcp_t* handle) {
 }
 
 
+int uv_tcp_open(uv_tcp_t* handle, uv_file fd) {
+  uv__set_artificial_error(handle->loop, UV_ENOTSUP);
+  return -1;
+}
+
+
 void uv_tcp_endgame(uv_loop_t* loop, uv_tcp_t* handle) {
   int status;
   int sys_error;
@@ -1143,4 +1149,10 @@ int uv_tcp_simultaneous_accepts(uv_tcp_t* handle, int enable) {
   }
 
   return 0;
-}
\ No newline at end of file
+}
+
+int uv_tcp_reuseport(uv_tcp_t* handle, int enable) {
+  /* SO_REUSEADDR on Windows already lets sockets steal each other's port. */
+  uv__set_artificial_error(handle->loop, UV_ENOTSUP);
+  return -1;
+}
@@ -457,6 +457,31 @@ int uv_udp_send6(uv_udp_send_t* req, uv_udp_t* handle, uv_buf_t bufs[],
 }
 
 
+/*
+ * Batched sends and receives are not available on Windows. They fail with
+ * UV_ENOSYS and callers fall back to uv_udp_send and uv_udp_recv_start.
+ */
+int uv_udp_send_batch(uv_udp_send_t* req, uv_udp_t* handle, uv_buf_t bufs[],
+    int bufcnt, struct sockaddr_in addr, uv_udp_send_cb cb) {
+  uv__set_artificial_error(handle->loop, UV_ENOSYS);
+  return -1;
+}
+
+
+int uv_udp_send_batch6(uv_udp_send_t* req, uv_udp_t* handle, uv_buf_t bufs[],
+    int bufcnt, struct sockaddr_in6 addr, uv_udp_send_cb cb) {
+  uv__set_artificial_error(handle->loop, UV_ENOSYS);
+  return -1;
+}
+
+
+int uv_udp_recv_batch_start(uv_udp_t* handle, uv_udp_msg_t* msgs, int nmsgs,
+    uv_udp_recv_batch_cb recv_cb) {
+  uv__set_artificial_error(handle->loop, UV_ENOSYS);
+  return -1;
+}
+
+
 void uv_process_udp_recv_req(uv_loop_t* loop, uv_udp_t* handle,
     uv_req_t* req) {
   uv_buf_t buf;
@@ -111,12 +111,12 @@ function setupChannel(target, channel) {
     }
   };
 
-  target.send = function(message, sendHandle) {
+  function write(message, sendHandle) {
     if (!target._channel) throw new Error("channel closed");
 
     // For overflow protection don't write if channel queue is too deep.
     if (channel.writeQueueSize > 1024 * 1024) {
-      return false;
+      return null;
     }
 
     var buffer = Buffer(JSON.stringify(message) + '\n');
@@ -134,6 +134,28 @@ function setupChannel(target, channel) {
 
     writeReq.oncomplete = nop;
 
+    return writeReq;
+  }
+
+  target.send = function(message, sendHandle) {
+    return write(message, sendHandle) ? true : false;
+  };
+
+  // Internal: like send() but gives the handle away. An isolate channel
+  // duplicates the descriptor on write, a pipe needs it until the write
+  // has been done. Returns false, and keeps the handle, when the channel
+  // is backed up.
+  target._sendAndClose = function(message, sendHandle) {
+    var writeReq = write(message, sendHandle);
+    if (!writeReq) return false;
+
+    if (process.features.isolates) {
+      sendHandle.close();
+    } else {
+      writeReq.oncomplete = function() {
+        sendHandle.close();
+      };
+    }
     return true;
   };
 
@@ -168,12 +190,18 @@ exports.fork = function(modulePath, args, options) {
   if (!options.env) options.env = { };
   options.env.NODE_CHANNEL_FD = 42;
 
-  // stdin is the IPC channel.
-  options.stdinStream = createPipe(true);
+  // Isolates share our address space, so they get an in-process channel
+  // and a plain stdin. Otherwise stdin is the IPC channel.
+  var channel;
+  if (process.features.isolates) {
+    channel = options.channel = new (process.binding('isolate_channel').Channel);
+  } else {
+    channel = options.stdinStream = createPipe(true);
+  }
 
   var child = spawn(process.execPath, args, options);
 
-  setupChannel(child, options.stdinStream);
+  setupChannel(child, channel);
 
   child.on('exit', function() {
     if (child._channel) {
@@ -187,8 +215,12 @@ exports.fork = function(modulePath, args, options) {
 
 exports._forkChild = function() {
   // set process.send()
-  var p = createPipe(true);
-  p.open(process._stdio_fds[0]);
+  var p = process.features.isolates &&
+          process.binding('isolate_channel').parentChannel();
+  if (!p) {
+    p = createPipe(true);
+    p.open(process._stdio_fds[0]);
+  }
   setupChannel(process, p);
 };
 
@@ -347,7 +379,8 @@ var spawn = exports.spawn = function(file, args, options) {
     envPairs: envPairs,
     customFds: options ? options.customFds : null,
     stdinStream: options ? options.stdinStream : null,
-    fork: options ? options.fork : false
+    fork: options ? options.fork : false,
+    channel: options ? options.channel : null
   });
 
   return child;
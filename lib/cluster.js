@@ -51,10 +51,31 @@ var workerArgs;
 var workerId = 0;
 var queryIds = 0;
 var queryCallbacks = {};
+var distributedHandles = {};
 
 cluster.isWorker = 'NODE_WORKER_ID' in process.env;
 cluster.isMaster = ! cluster.isWorker;
 
+// How the master spreads the connections to a server over the workers.
+//
+// SCHED_SHARED
+// Every worker gets the same listening socket and accepts on it itself.
+//
+// SCHED_RR, SCHED_LEAST_LOADED
+// The master accepts and hands each connection to the next worker, or to
+// the worker with the fewest open connections from that server.
+//
+// SCHED_REUSEPORT
+// Every worker listens on a socket of its own with SO_REUSEPORT set and the
+// kernel balances between them.
+cluster.SCHED_SHARED = 'shared';
+cluster.SCHED_RR = 'rr';
+cluster.SCHED_LEAST_LOADED = 'leastloaded';
+cluster.SCHED_REUSEPORT = 'reuseport';
+
+cluster.schedulingPolicy = process.env.NODE_CLUSTER_SCHED_POLICY ||
+                           cluster.SCHED_SHARED;
+
 // Call this from the master process. It will start child workers.
 //
 // options.workerFilename
@@ -113,11 +134,40 @@ function handleWorkerMessage(worker, message) {
       if (key in servers == false) {
         // Create a new server.
         debug('create new server ' + key);
-        servers[key] = net._createServerHandle(message.address,
-                                               message.port,
-                                               message.addressType);
+        servers[key] = createServer(key, message);
+      }
+
+      var server = servers[key];
+      if (!server) {
+        // Binding failed, let the worker find out for itself.
+        worker.send(response);
+      } else if (server instanceof Distributor) {
+        server.add(worker);
+        response.distributed = true;
+        response.reportLoad = server.leastLoaded;
+        response.sockname = server.handle.getsockname();
+        worker.send(response);
+      } else if (server instanceof ReusePortServer) {
+        server.add(worker);
+        response.reusePort = true;
+        response.port = server.handle.getsockname().port;
+        worker.send(response);
+      } else {
+        worker.send(response, server);
+      }
+      break;
+
+    case 'connDone':
+      if (servers[message.key] instanceof Distributor) {
+        servers[message.key].done(worker, message.closed);
+      }
+      break;
+
+    case 'closeServer':
+      if (servers[message.key] instanceof Distributor ||
+          servers[message.key] instanceof ReusePortServer) {
+        servers[message.key].remove(worker);
       }
-      worker.send(response, servers[key]);
       break;
 
     default:
@@ -127,6 +177,197 @@ function handleWorkerMessage(worker, message) {
 }
 
 
+function createServer(key, message) {
+  var policy = cluster.schedulingPolicy;
+  var isTCP = !(message.port == -1 && message.addressType == -1);
+
+  if (policy == cluster.SCHED_REUSEPORT && isTCP) {
+    // This socket is bound but never listened on. It only reserves the
+    // port, so that the workers all end up in its group even when they
+    // asked for a random one.
+    var handle = net._createServerHandle(message.address,
+                                         message.port,
+                                         message.addressType,
+                                         true);
+    if (handle) return new ReusePortServer(key, handle);
+    debug('SO_REUSEPORT failed for ' + key + ', sharing the socket');
+  }
+
+  if (policy == cluster.SCHED_SHARED ||
+      policy == cluster.SCHED_REUSEPORT ||
+      !isTCP) {
+    return net._createServerHandle(message.address,
+                                   message.port,
+                                   message.addressType);
+  }
+
+  if (policy != cluster.SCHED_RR && policy != cluster.SCHED_LEAST_LOADED) {
+    throw new Error('Unknown cluster scheduling policy: ' + policy);
+  }
+
+  var handle = net._createServerHandle(message.address,
+                                       message.port,
+                                       message.addressType);
+  if (!handle) return null;
+
+  var distributor = new Distributor(key, handle, policy);
+  if (handle.listen(512)) {
+    handle.close();
+    return null;
+  }
+  return distributor;
+}
+
+
+// Accepts the connections to a server in the master and passes them on.
+function Distributor(key, handle, policy) {
+  var self = this;
+
+  this.key = key;
+  this.handle = handle;
+  this.leastLoaded = policy == cluster.SCHED_LEAST_LOADED;
+  this.workers = [];
+  this.next = 0;
+  // Connections that came in while no worker was listening.
+  this.pending = [];
+
+  handle.onconnection = function(clientHandle) {
+    if (!clientHandle) {
+      debug('accept error on ' + key + ': ' + errno);
+      return;
+    }
+    self.pending.push(clientHandle);
+    self.distribute();
+  };
+}
+
+
+Distributor.prototype.add = function(worker) {
+  if (this.workers.indexOf(worker) != -1) return;
+
+  if (!worker._servers) worker._servers = {};
+  worker._servers[this.key] = { sent: 0, closed: 0 };
+
+  this.workers.push(worker);
+  this.distribute();
+};
+
+
+Distributor.prototype.remove = function(worker) {
+  var i = this.workers.indexOf(worker);
+  if (i == -1) return;
+
+  this.workers.splice(i, 1);
+  delete worker._servers[this.key];
+
+  if (this.workers.length == 0) {
+    // Nobody left to serve it; let go of the port.
+    debug('close server ' + this.key);
+    this.pending.forEach(function(clientHandle) {
+      clientHandle.close();
+    });
+    this.pending = [];
+    this.handle.close();
+    delete servers[this.key];
+  }
+};
+
+
+Distributor.prototype.done = function(worker, closed) {
+  var stats = worker._servers && worker._servers[this.key];
+  if (stats) stats.closed = closed;
+};
+
+
+// A worker whose channel has closed is on its way out but stays on the
+// list until its 'exit'; it is passed over. Returns null when there is
+// nobody to send to.
+Distributor.prototype.pick = function() {
+  var n = this.workers.length;
+
+  if (!this.leastLoaded) {
+    for (var tries = 0; tries < n; tries++) {
+      this.next = this.next % n;
+      var next = this.workers[this.next++];
+      if (next._channel) return next;
+    }
+    return null;
+  }
+
+  // Start the scan where the last one left off so that ties are broken
+  // round-robin too.
+  var best = null;
+  var bestLoad = Infinity;
+  for (var i = 0; i < n; i++) {
+    var worker = this.workers[(this.next + i) % n];
+    if (!worker._channel) continue;
+    var stats = worker._servers[this.key];
+    var load = stats.sent - stats.closed;
+    if (load < bestLoad) {
+      best = worker;
+      bestLoad = load;
+    }
+  }
+  if (best) this.next = (this.workers.indexOf(best) + 1) % n;
+  return best;
+};
+
+
+Distributor.prototype.distribute = function() {
+  var message = { cmd: 'newConn', key: this.key };
+
+  while (this.pending.length > 0 && this.workers.length > 0) {
+    var worker = this.pick();
+    if (!worker) break;
+
+    var clientHandle = this.pending.shift();
+
+    if (worker._sendAndClose(message, clientHandle)) {
+      worker._servers[this.key].sent++;
+    } else {
+      // The worker is not keeping up with its channel. Shed the
+      // connection rather than buffering without bound.
+      debug('drop connection to ' + this.key);
+      clientHandle.close();
+    }
+  }
+};
+
+
+// Holds on to the port of a server whose workers each listen with
+// SO_REUSEPORT, until the last of them is gone.
+function ReusePortServer(key, handle) {
+  this.key = key;
+  this.handle = handle;
+  this.workers = [];
+}
+
+
+ReusePortServer.prototype.add = function(worker) {
+  if (this.workers.indexOf(worker) != -1) return;
+
+  if (!worker._servers) worker._servers = {};
+  worker._servers[this.key] = true;
+
+  this.workers.push(worker);
+};
+
+
+ReusePortServer.prototype.remove = function(worker) {
+  var i = this.workers.indexOf(worker);
+  if (i == -1) return;
+
+  this.workers.splice(i, 1);
+  delete worker._servers[this.key];
+
+  if (this.workers.length == 0) {
+    debug('close server ' + this.key);
+    this.handle.close();
+    delete servers[this.key];
+  }
+};
+
+
 function eachWorker(cb) {
   // This can only be called from the master.
   assert(cluster.isMaster);
@@ -166,6 +407,9 @@ cluster.fork = function() {
   worker.on('exit', function() {
     debug('worker id=' + id + ' died');
     delete workers[id];
+    for (var key in worker._servers) {
+      servers[key].remove(worker);
+    }
     cluster.emit('death', worker);
   });
 
@@ -183,7 +427,14 @@ cluster._startWorker = function() {
   // Make callbacks from queryMaster()
   process.on('message', function(msg, handle) {
     debug("recv " + JSON.stringify(msg));
-    if (msg._queryId && msg._queryId in queryCallbacks) {
+    if (msg.cmd == 'newConn') {
+      var server = distributedHandles[msg.key];
+      if (server) {
+        server.accept(handle);
+      } else {
+        handle.close();
+      }
+    } else if (msg._queryId && msg._queryId in queryCallbacks) {
       var cb = queryCallbacks[msg._queryId];
       if (typeof cb == 'function') {
         cb(msg, handle);
@@ -218,12 +469,104 @@ function queryMaster(msg, cb) {
 cluster._getServer = function(address, port, addressType, cb) {
   assert(cluster.isWorker);
 
+  var key = address + ":" + port + ":" + addressType;
+
   queryMaster({
     cmd: "queryServer",
     address: address,
     port: port,
     addressType: addressType
   }, function(msg, handle) {
+    if (msg.distributed) {
+      handle = distributedHandles[key] = new DistributedHandle(key,
+                                                               msg.sockname,
+                                                               msg.reportLoad);
+    } else if (msg.reusePort) {
+      handle = net._createServerHandle(address,
+                                       msg.port,
+                                       addressType,
+                                       true);
+      if (handle) {
+        reusePortHandle(handle, key);
+      } else {
+        queryMaster({ cmd: 'closeServer', key: key });
+      }
+    }
     cb(handle);
   });
 };
+
+
+// The master holds on to the port of a SO_REUSEPORT server until every
+// worker has closed its own socket, so tell it when this one is closed.
+function reusePortHandle(handle, key) {
+  var close = handle.close;
+  handle.close = function() {
+    queryMaster({ cmd: 'closeServer', key: key });
+    return close.apply(this, arguments);
+  };
+}
+
+
+// Stands in for the listening handle of a server in the worker when the
+// master does the accepting. Connections show up as 'newConn' messages.
+function DistributedHandle(key, sockname, reportLoad) {
+  this.key = key;
+  this.sockname = sockname;
+  this.reportLoad = reportLoad;
+  this.onconnection = null;
+  this.closed = 0;
+  this.reporting = false;
+}
+
+
+DistributedHandle.prototype.listen = function(backlog) {
+  return 0;
+};
+
+
+DistributedHandle.prototype.getsockname = function() {
+  return this.sockname;
+};
+
+
+DistributedHandle.prototype.close = function() {
+  if (distributedHandles[this.key] !== this) return;
+  delete distributedHandles[this.key];
+  queryMaster({ cmd: 'closeServer', key: this.key });
+};
+
+
+DistributedHandle.prototype.accept = function(clientHandle) {
+  var self = this;
+
+  this.onconnection(clientHandle);
+  if (!this.reportLoad) return;
+
+  // net.Server either wrapped the handle in a socket or closed it.
+  var socket = clientHandle.socket;
+  if (socket && !socket.destroyed) {
+    socket.once('close', function() {
+      self.connectionDone();
+    });
+  } else {
+    this.connectionDone();
+  }
+};
+
+
+// The master counts what it sent; tell it how many have finished. The
+// reports are cumulative, so the ones for a burst of closes can be folded
+// into one message.
+DistributedHandle.prototype.connectionDone = function() {
+  var self = this;
+
+  this.closed++;
+  if (this.reporting || distributedHandles[this.key] !== this) return;
+
+  this.reporting = true;
+  process.nextTick(function() {
+    self.reporting = false;
+    queryMaster({ cmd: 'connDone', key: self.key, closed: self.closed });
+  });
+};
@@ -29,6 +29,10 @@ var dns = null;
 var net = null;
 
 
+// the most datagrams recvmmsg() and sendmmsg() take at once
+var MAX_BATCH = 1024;
+
+
 // no-op callback
 function noop() {
 }
@@ -77,6 +81,7 @@ function newHandle(type) {
     handle.lookup = lookup6;
     handle.bind = handle.bind6;
     handle.send = handle.send6;
+    handle.sendBatch = handle.sendBatch6;
     return handle;
   }
 
@@ -96,6 +101,8 @@ function Socket(type, listener) {
   this._handle = handle;
   this._receiving = false;
   this._bound = false;
+  this._batchCount = 0;
+  this._batchSize = 0;
   this.type = type;
   this.fd = null; // compatibility hack
 
@@ -190,6 +197,96 @@ Socket.prototype.send = function(buffer,
 };
 
 
+// Sends every Buffer in `buffers` as a separate datagram. The datagrams go
+// out in as few system calls as the platform allows.
+Socket.prototype.sendBatch = function(buffers, port, address, callback) {
+  var self = this;
+
+  if (!Array.isArray(buffers) || buffers.length == 0)
+    throw new Error('sendBatch takes a non-empty array of buffers');
+
+  if (buffers.length > MAX_BATCH)
+    throw new Error('sendBatch takes at most ' + MAX_BATCH + ' buffers');
+
+  for (var i = 0; i < buffers.length; i++) {
+    if (!Buffer.isBuffer(buffers[i]))
+      throw new TypeError('sendBatch takes an array of buffers');
+  }
+
+  if (typeof address !== 'string')
+    throw new Error(this.type + ' sockets must send to port, address');
+
+  callback = callback || noop;
+
+  self._healthCheck();
+  self._startReceiving();
+
+  self._handle.lookup(address, function(err, ip) {
+    if (err) {
+      callback(err);
+      self.emit('error', err);
+    }
+    else {
+      var req = self._handle.sendBatch(buffers, port, ip);
+      if (req) {
+        req.oncomplete = afterSendBatch;
+        req.cb = callback;
+      }
+      else if (errno == 'ENOSYS') {
+        sendEach(self, buffers, port, ip, callback);
+      }
+      else {
+        callback(errnoException(errno, 'sendmmsg'));
+      }
+    }
+  });
+};
+
+
+// For platforms that cannot send a batch in one go: one send per datagram,
+// and a single callback once they have all gone out or one has failed.
+function sendEach(self, buffers, port, ip, callback) {
+  var pending = buffers.length;
+  var bytes = 0;
+  var failed = false;
+
+  function done(err, sent) {
+    if (failed) return;
+    if (err) {
+      failed = true;
+      callback(err);
+      return;
+    }
+    bytes += sent;
+    if (--pending == 0) callback(null, bytes);
+  }
+
+  for (var i = 0; i < buffers.length; i++) {
+    var req = self._handle.send(buffers[i], 0, buffers[i].length, port, ip);
+    if (!req) {
+      done(errnoException(errno, 'send'));
+      return;
+    }
+    req.oncomplete = afterSend;
+    req.cb = done;
+  }
+}
+
+
+function afterSendBatch(status, handle, req, buffers) {
+  if (status) {
+    req.cb(errnoException(errno, 'sendmmsg'));
+    return;
+  }
+
+  var bytes = 0;
+  for (var i = 0; i < buffers.length; i++)
+    bytes += buffers[i].length;
+
+  req.cb(null, bytes);
+}
+
+
 function afterSend(status, handle, req, buffer) {
   var self = handle.socket;
 
@@ -256,6 +353,33 @@ Socket.prototype.dropMembership = function(multicastAddress,
 };
 
 
+// Receive up to `count` datagrams of at most `size` bytes per read event and
+// emit them together as a 'messages' event. A count of 0 switches back to
+// one 'message' event per datagram.
+Socket.prototype.setRecvBatch = function(count, size) {
+  count = count >>> 0;
+  size = size === undefined ? 2048 : size >>> 0;
+
+  if (count > MAX_BATCH)
+    throw new Error('batch count must be at most ' + MAX_BATCH);
+
+  if (count && (size == 0 || size > 65536))
+    throw new Error('batch size must be between 1 and 65536');
+
+  this._healthCheck();
+
+  var receiving = this._receiving;
+  if (receiving)
+    this._stopReceiving();
+
+  this._batchCount = count;
+  this._batchSize = size;
+
+  if (receiving)
+    this._startReceiving();
+};
+
+
 Socket.prototype._healthCheck = function() {
   if (!this._handle)
     throw new Error('Not running'); // error message from dgram_legacy.js
@@ -274,8 +398,18 @@ Socket.prototype._startReceiving = function() {
       throw new Error('implicit bind failed');
   }
 
-  this._handle.onmessage = onMessage;
-  this._handle.recvStart();
+  if (this._batchCount) {
+    this._handle.onmessages = onMessages;
+    if (!this._handle.recvBatchStart(this._batchCount, this._batchSize) &&
+        errno == 'ENOSYS') {
+      // No batched receives here; fall back to one datagram at a time.
+      this._batchCount = 0;
+    }
+  }
+  if (!this._batchCount) {
+    this._handle.onmessage = onMessage;
+    this._handle.recvStart();
+  }
   this._receiving = true;
   this.fd = -42; // compatibility hack
 };
@@ -289,6 +423,7 @@ Socket.prototype._stopReceiving = function() {
   // this, but node applications (e.g. test/simple/test-dgram-pingpong) may
   // not expect it.
   this._handle.onmessage = noop;
+  this._handle.onmessages = noop;
 
   this._handle.recvStop();
   this._receiving = false;
@@ -309,6 +444,29 @@ function onMessage(handle, nread, buf, rinfo) {
 }
 
 
+function onMessages(handle, nmsgs, buf, info) {
+  var self = handle.socket;
+
+  if (nmsgs == -1) {
+    self.emit('error', errnoException(errno, 'recvmmsg'));
+    return;
+  }
+
+  self.emit('messages', buf, info);
+
+  // Listeners that want one event per datagram still get them.
+  if (self.listeners('message').length == 0)
+    return;
+
+  for (var i = 0; i < info.length; i += 4) {
+    var offset = info[i];
+    var length = info[i + 1];
+    var rinfo = { address: info[i + 2], port: info[i + 3], size: length };
+    self.emit('message', buf.slice(offset, offset + length), rinfo);
+  }
+}
+
+
 // TODO share with net_uv and others
 function errnoException(errorno, syscall) {
   var e = new Error(syscall + ' ' + errorno);
@@ -141,14 +141,12 @@ exports.lookup = function(domain, family, callback) {
     }
   }
 
-  var wrap = cares.getaddrinfo(domain, family);
+  var wrap = cares.getaddrinfo(domain, family, onanswer);
 
   if (!wrap) {
     throw errnoException(errno, 'getaddrinfo');
   }
 
-  wrap.oncomplete = onanswer;
-
   callback.immediately = true;
   return wrap;
 };
@@ -178,6 +176,13 @@ function resolver(bindingName) {
 }
 
 
+// The cache behind lookup(), resolve4() and resolve6(). It is shared by
+// all isolates in the process.
+exports.setCacheOptions = cares.setCacheOptions;
+exports.getCacheStats = cares.getCacheStats;
+exports.clearCache = cares.clearCache;
+
+
 var resolveMap = {};
 exports.resolve4 = resolveMap.A = resolver('queryA');
 exports.resolve6 = resolveMap.AAAA = resolver('queryAaaa');
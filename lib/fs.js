@@ -70,89 +70,34 @@ fs.Stats.prototype.isSocket = function() {
   return this._checkModeProperty(constants.S_IFSOCK);
 };
 
+// binding.readFile() reads the whole file in one go on the thread pool. It
+// decodes utf8 and ascii itself; for anything else it returns the data in a
+// SlowBuffer.
+function readFileResult(data, encoding) {
+  if (typeof data === 'string') return data;
+  var buffer = data.slice(0, data.length);
+  if (encoding) buffer = buffer.toString(encoding);
+  return buffer;
+}
+
 fs.readFile = function(path, encoding_) {
   var encoding = typeof(encoding_) === 'string' ? encoding_ : null;
   var callback = arguments[arguments.length - 1];
   if (typeof(callback) !== 'function') callback = noop;
-  var readStream = fs.createReadStream(path);
-  var buffers = [];
-  var nread = 0;
-
-  readStream.on('data', function(chunk) {
-    buffers.push(chunk);
-    nread += chunk.length;
-  });
-
-  readStream.on('error', function(er) {
-    callback(er);
-    readStream.destroy();
-  });
 
-  readStream.on('end', function() {
-    // copy all the buffers into one
-    var buffer;
-    switch (buffers.length) {
-      case 0: buffer = new Buffer(0); break;
-      case 1: buffer = buffers[0]; break;
-      default: // concat together
-        buffer = new Buffer(nread);
-        var n = 0;
-        buffers.forEach(function(b) {
-          var l = b.length;
-          b.copy(buffer, n, 0, l);
-          n += l;
-        });
-        break;
-    }
-    if (encoding) {
-      try {
-        buffer = buffer.toString(encoding);
-      } catch (er) {
-        return callback(er);
-      }
+  binding.readFile(path, encoding, function(er, data) {
+    if (er) return callback(er);
+    try {
+      data = readFileResult(data, encoding);
+    } catch (er) {
+      return callback(er);
     }
-    callback(null, buffer);
+    callback(null, data);
   });
 };
 
 fs.readFileSync = function(path, encoding) {
-  var fd = fs.openSync(path, constants.O_RDONLY, 438 /*=0666*/);
-  var buffer = new Buffer(4048);
-  var buffers = [];
-  var nread = 0;
-  var lastRead = 0;
-
-  do {
-    if (lastRead) {
-      buffer._bytesRead = lastRead;
-      nread += lastRead;
-      buffers.push(buffer);
-    }
-    var buffer = new Buffer(4048);
-    lastRead = fs.readSync(fd, buffer, 0, buffer.length, null);
-  } while (lastRead > 0);
-
-  fs.closeSync(fd);
-
-  if (buffers.length > 1) {
-    var offset = 0;
-    var i;
-    buffer = new Buffer(nread);
-    buffers.forEach(function(i) {
-      if (!i._bytesRead) return;
-      i.copy(buffer, offset, 0, i._bytesRead);
-      offset += i._bytesRead;
-    });
-  } else if (buffers.length) {
-    // buffers has exactly 1 (possibly zero length) buffer, so this should
-    // be a shortcut
-    buffer = buffers[0].slice(0, buffers[0]._bytesRead);
-  } else {
-    buffer = new Buffer(0);
-  }
-
-  if (encoding) buffer = buffer.toString(encoding);
-  return buffer;
+  return readFileResult(binding.readFile(path, encoding), encoding);
 };
 
 
@@ -277,6 +222,30 @@ fs.readSync = function(fd, buffer, offset, length, position) {
   return [str, r];
 };
 
+// Reads exactly `length` bytes from `position`. Used by the fallbacks of
+// socket.sendFile() and response.sendFile().
+fs._readRangeSync = function(fd, position, length) {
+  var buffer = new Buffer(length);
+  var nread = 0;
+
+  while (nread < length) {
+    var n = fs.readSync(fd, buffer, nread, length - nread, position + nread);
+    if (n == 0) {
+      var e = new Error('EINVAL, file is shorter than the range');
+      e.errno = e.code = 'EINVAL';
+      throw e;
+    }
+    nread += n;
+  }
+
+  return buffer;
+};
+
+fs.mmap = function(fd, offset, length, advice) {
+  var buffer = binding.mmap(fd, offset, length, advice);
+  return buffer.slice(0, buffer.length);
+};
+
 fs.write = function(fd, buffer, offset, length, position, callback) {
   if (!Buffer.isBuffer(buffer)) {
     // legacy string interface (fd, data, position, encoding, callback)
@@ -83,6 +83,10 @@ var parsers = new FreeList('parsers', 1000, function() {
       parser.incoming._addHeaderLine(k.toLowerCase(), v);
     }
 
+    if (info.rawHeaders) {
+      parser.incoming._setRawHeaders(info.rawHeaders, info.headerOffsets);
+    }
+
     if (info.method) {
       // server only
       parser.incoming.method = info.method;
@@ -268,8 +272,11 @@ IncomingMessage.prototype.resume = function() {
 // and drop the second. Extended header fields (those beginning with 'x-') are
 // always joined.
 IncomingMessage.prototype._addHeaderLine = function(field, value) {
-  var dest = this.complete ? this.trailers : this.headers;
+  addHeaderLine(this.complete ? this.trailers : this.headers, field, value);
+};
+
 
+function addHeaderLine(dest, field, value) {
   switch (field) {
     // Array headers:
     case 'set-cookie':
@@ -311,6 +318,82 @@ IncomingMessage.prototype._addHeaderLine = function(field, value) {
       }
       break;
   }
+}
+
+
+// With server.lazyHeaders the parser hands over the raw header bytes and a
+// table of offsets into them; the header strings are only created when
+// request.headers is first read. request.getHeader() looks a single header
+// up without creating the others.
+IncomingMessage.prototype._setRawHeaders = function(raw, offsets) {
+  this._rawHeaders = raw;
+  this._headerOffsets = offsets;
+  Object.defineProperty(this, 'headers', lazyHeaders);
+};
+
+
+var lazyHeaders = {
+  get: function() {
+    var raw = this._rawHeaders;
+    var offsets = this._headerOffsets;
+    var headers = {};
+
+    lazyHeaders.set.call(this, headers);
+
+    for (var i = 0; i < offsets.length; i += 4) {
+      var field = raw.toString('utf8', offsets[i], offsets[i + 1]);
+      var value = raw.toString('utf8', offsets[i + 2], offsets[i + 3]);
+      addHeaderLine(headers, field.toLowerCase(), value);
+    }
+
+    return headers;
+  },
+
+  set: function(headers) {
+    this._rawHeaders = null;
+    this._headerOffsets = null;
+    Object.defineProperty(this, 'headers', {
+      value: headers,
+      writable: true,
+      enumerable: true,
+      configurable: true
+    });
+  },
+
+  enumerable: true,
+  configurable: true
+};
+
+
+IncomingMessage.prototype.getHeader = function(name) {
+  if (arguments.length < 1) {
+    throw new Error('`name` is required for getHeader().');
+  }
+
+  var key = name.toLowerCase();
+  var raw = this._rawHeaders;
+  if (!raw) return this.headers[key];
+
+  var offsets = this._headerOffsets;
+  var dest = {};
+
+  for (var i = 0; i < offsets.length; i += 4) {
+    var start = offsets[i];
+    if (offsets[i + 1] - start !== key.length) continue;
+
+    for (var j = 0; j < key.length; j++) {
+      var c = raw[start + j];
+      if (c >= 65 && c <= 90) c += 32; // A-Z
+      if (c !== key.charCodeAt(j)) break;
+    }
+
+    if (j === key.length) {
+      var value = raw.toString('utf8', offsets[i + 2], offsets[i + 3]);
+      addHeaderLine(dest, key, value);
+    }
+  }
+
+  return dest[key];
 };
 
 
@@ -329,6 +412,7 @@ function OutgoingMessage() {
 
   this._hasBody = true;
   this._trailer = '';
+  this._corked = 0;
 
   this.finished = false;
 }
@@ -401,6 +485,28 @@ OutgoingMessage.prototype._writeRaw = function(data, encoding) {
 };
 
 
+// Holds back the writes that follow until the matching _uncork() so they
+// reach the socket as one request. Calls nest. Only the message that owns
+// the socket touches it, so a finished response cannot flush writes that a
+// later pipelined response is holding back; a socket left corked flushes
+// itself on the next tick anyway.
+OutgoingMessage.prototype._cork = function() {
+  var conn = this.connection;
+  if (this._corked++ == 0 && conn && conn._httpMessage === this && conn.cork) {
+    conn.cork();
+  }
+};
+
+
+OutgoingMessage.prototype._uncork = function() {
+  var conn = this.connection;
+  if (--this._corked == 0 && conn && conn._httpMessage === this &&
+      conn.uncork) {
+    conn.uncork();
+  }
+};
+
+
 OutgoingMessage.prototype._buffer = function(data, encoding) {
   if (data.length === 0) return;
 
@@ -613,9 +719,11 @@ OutgoingMessage.prototype.write = function(chunk, encoding) {
     } else {
       // buffer
       len = chunk.length;
+      this._cork();
       this._send(len.toString(16) + CRLF);
       this._send(chunk);
       ret = this._send(CRLF);
+      this._uncork();
     }
   } else {
     ret = this._send(chunk, encoding);
@@ -626,6 +734,69 @@ OutgoingMessage.prototype.write = function(chunk, encoding) {
 };
 
 
+// Sends `length` bytes of `fd` from `offset` as the rest of the body and
+// ends the message. Once the message owns its socket the range goes out
+// with socket.sendFile(); before that it is read into memory and queued.
+OutgoingMessage.prototype.sendFile = function(fd, offset, length, cb) {
+  if (!this._header && this.getHeader('content-length') === undefined) {
+    this.setHeader('Content-Length', length);
+  }
+
+  if (!this._header) {
+    this._implicitHeader();
+  }
+
+  var conn = this.connection;
+  var direct = this._hasBody &&
+               length > 0 &&
+               conn &&
+               conn.writable &&
+               conn._httpMessage === this &&
+               conn.sendFile;
+
+  if (!direct) {
+    var self = this;
+    var data;
+
+    if (this._hasBody && length > 0) {
+      try {
+        data = require('fs')._readRangeSync(fd, offset, length);
+      } catch (er) {
+        process.nextTick(function() {
+          if (cb) cb(er);
+          if (self.socket) self.destroy(er);
+        });
+        return false;
+      }
+    }
+
+    var ret = this.end(data);
+    if (cb) process.nextTick(cb);
+    return ret;
+  }
+
+  // Corked so that the header goes out together with the file.
+  this._cork();
+  if (this.chunkedEncoding) {
+    this._send(length.toString(16) + CRLF);
+  } else if (!this._headerSent) {
+    this._send('');
+  }
+  conn.sendFile(fd, offset, length, cb);
+  this._uncork();
+
+  if (!this.chunkedEncoding) {
+    return this.end();
+  }
+
+  this._cork();
+  this._send(CRLF);
+  var ret = this.end();
+  this._uncork();
+  return ret;
+};
+
+
 OutgoingMessage.prototype.addTrailers = function(headers) {
   this._trailer = '';
   var keys = Object.keys(headers);
@@ -662,6 +833,10 @@ OutgoingMessage.prototype.end = function(data, encoding) {
 
   var ret;
 
+  // The last body chunk, the terminating chunk and the trailers go out
+  // together.
+  this._cork();
+
   var hot = this._headerSent === false &&
             typeof(data) === 'string' &&
             data.length > 0 &&
@@ -700,6 +875,8 @@ OutgoingMessage.prototype.end = function(data, encoding) {
     }
   }
 
+  this._uncork();
+
   this.finished = true;
 
   // There is the first message on the outgoing queue, and we've sent
@@ -892,11 +1069,20 @@ function Agent(options) {
   self.options = options || {};
   self.requests = {};
   self.sockets = {};
+  self.freeSockets = {};
   self.maxSockets = self.options.maxSockets || Agent.defaultMaxSockets;
+  self.keepAlive = self.options.keepAlive || false;
+  self.maxFreeSockets = self.options.maxFreeSockets ||
+                        Agent.defaultMaxFreeSockets;
+  self.idleTimeout = self.options.idleTimeout || Agent.defaultIdleTimeout;
+  self._poolStats = { creates: 0, hits: 0, evictions: 0, stale: 0 };
   self.on('free', function(socket, host, port) {
     var name = host + ':' + port;
     if (self.requests[name] && self.requests[name].length) {
+      self._poolStats.hits++;
       self.requests[name].shift().onSocket(socket);
+    } else if (self.keepAlive) {
+      self.keepSocket(socket, name);
     } else {
       // If there are no pending requests just destroy the
       // socket and it will get removed from the pool. This
@@ -911,6 +1097,8 @@ util.inherits(Agent, EventEmitter);
 exports.Agent = Agent;
 
 Agent.defaultMaxSockets = 5;
+Agent.defaultMaxFreeSockets = 16;
+Agent.defaultIdleTimeout = 10000;
 
 Agent.prototype.defaultPort = 80;
 Agent.prototype.addRequest = function(req, host, port) {
@@ -918,7 +1106,11 @@ Agent.prototype.addRequest = function(req, host, port) {
   if (!this.sockets[name]) {
     this.sockets[name] = [];
   }
-  if (this.sockets[name].length < this.maxSockets) {
+  var socket = this.keepAlive && this.takeFreeSocket(name);
+  if (socket) {
+    this.sockets[name].push(socket);
+    req.onSocket(socket);
+  } else if (this.sockets[name].length < this.maxSockets) {
     // If we are under maxSockets create a new one.
     req.onSocket(this.createSocket(name, host, port));
   } else {
@@ -932,6 +1124,7 @@ Agent.prototype.addRequest = function(req, host, port) {
 Agent.prototype.createSocket = function(name, host, port) {
   var self = this;
   var s = self.createConnection(port, host, self.options);
+  self._poolStats.creates++;
   if (!self.sockets[name]) {
     self.sockets[name] = [];
   }
@@ -960,6 +1153,15 @@ Agent.prototype.createSocket = function(name, host, port) {
   return s;
 };
 Agent.prototype.removeSocket = function(s, name, host, port) {
+  if (this.freeSockets[name]) {
+    var index = this.freeSockets[name].indexOf(s);
+    if (index !== -1) {
+      this.freeSockets[name].splice(index, 1);
+      if (this.freeSockets[name].length === 0) {
+        delete this.freeSockets[name];
+      }
+    }
+  }
   if (this.sockets[name]) {
     var index = this.sockets[name].indexOf(s);
     if (index !== -1) {
@@ -976,6 +1178,108 @@ Agent.prototype.removeSocket = function(s, name, host, port) {
     this.createSocket(name, host, port).emit('free');
   }
 };
+// Parks a socket that finished its request in the idle list for its host.
+// The list is used as a stack, so that the sockets used most recently are
+// handed out first and the others are the ones left to time out.
+Agent.prototype.keepSocket = function(socket, name) {
+  var self = this;
+
+  if (!isHealthy(socket)) {
+    socket.destroy();
+    return;
+  }
+
+  var index = this.sockets[name] ? this.sockets[name].indexOf(socket) : -1;
+  if (index !== -1) {
+    this.sockets[name].splice(index, 1);
+  }
+
+  if (!this.freeSockets[name]) {
+    this.freeSockets[name] = [];
+  }
+  var free = this.freeSockets[name];
+  if (free.length >= this.maxFreeSockets) {
+    this._poolStats.evictions++;
+    free.shift().destroy();
+  }
+  free.push(socket);
+
+  // Nobody owns an idle socket. Let go of the last request and give its
+  // parser back, so that neither stays reachable from the pool.
+  var req = socket._httpMessage;
+  if (req && req.parser) {
+    var parser = req.parser;
+    parser.socket = null;
+    parser.incoming = null;
+    parser.onIncoming = null;
+    parsers.free(parser);
+    req.parser = null;
+  }
+  socket._httpMessage = null;
+  socket.ondata = null;
+  socket.onend = null;
+
+  var onIdle = socket._agentOnIdle = function(err) {
+    // Timed out, failed, or the server said something while nobody was
+    // asking. Either way the socket is of no more use.
+    if (!err) self._poolStats.evictions++;
+    socket.destroy();
+  };
+  socket.on('error', onIdle);
+  socket.on('data', onIdle);
+  socket.setTimeout(this.idleTimeout, onIdle);
+};
+// Pops the most recently used idle socket that still looks usable.
+Agent.prototype.takeFreeSocket = function(name) {
+  var free = this.freeSockets[name];
+  while (free && free.length) {
+    var socket = free.pop();
+    if (free.length === 0) {
+      delete this.freeSockets[name];
+    }
+
+    socket.setTimeout(0);
+    socket.removeListener('timeout', socket._agentOnIdle);
+    socket.removeListener('error', socket._agentOnIdle);
+    socket.removeListener('data', socket._agentOnIdle);
+    socket._agentOnIdle = null;
+
+    if (isHealthy(socket)) {
+      this._poolStats.hits++;
+      return socket;
+    }
+    this._poolStats.stale++;
+    socket.destroy();
+  }
+  return null;
+};
+Agent.prototype.getPoolStats = function() {
+  var idle = 0;
+  for (var name in this.freeSockets) {
+    idle += this.freeSockets[name].length;
+  }
+  return {
+    creates: this._poolStats.creates,
+    hits: this._poolStats.hits,
+    evictions: this._poolStats.evictions,
+    stale: this._poolStats.stale,
+    idle: idle
+  };
+};
+// Closes every idle socket. Sockets in use are left alone.
+Agent.prototype.destroy = function() {
+  for (var name in this.freeSockets) {
+    var free = this.freeSockets[name];
+    while (free.length) {
+      free.pop().destroy();
+    }
+    delete this.freeSockets[name];
+  }
+};
+
+function isHealthy(socket) {
+  return !socket.destroyed && socket.readable && socket.writable;
+}
 
 var globalAgent = new Agent();
 exports.globalAgent = globalAgent;
@@ -1326,6 +1630,9 @@ function Server(requestListener) {
   // http://wiki.squid-cache.org/SquidFaq/InnerWorkings#What_is_a_half-closed_filedescriptor.3F
   this.httpAllowHalfOpen = false;
 
+  // Leave the request headers as raw bytes until they are looked at.
+  this.lazyHeaders = false;
+
   this.addListener('connection', connectionListener);
 }
 util.inherits(Server, net.Server);
@@ -1364,6 +1671,7 @@ function connectionListener(socket) {
 
   var parser = parsers.alloc();
   parser.reinitialize(HTTPParser.REQUEST);
+  if (self.lazyHeaders) parser.setLazyHeaders(true);
   parser.socket = socket;
   parser.incoming = null;
 
@@ -1465,9 +1773,10 @@ function connectionListener(socket) {
       }
     });
 
-    if ('expect' in req.headers &&
+    var expect = req.getHeader('expect');
+    if (expect !== undefined &&
         (req.httpVersionMajor == 1 && req.httpVersionMinor == 1) &&
-        continueExpression.test(req.headers['expect'])) {
+        continueExpression.test(expect)) {
       res._expect_continue = true;
       if (self.listeners('checkContinue').length) {
         self.emit('checkContinue', req, res);
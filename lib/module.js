@@ -83,13 +83,10 @@ var debug = Module._debug;
 //   -> a.<ext>
 //   -> a/index.<ext>
 
-function statPath(path) {
-  var fs = NativeModule.require('fs');
-  try {
-    return fs.statSync(path);
-  } catch (ex) {}
-  return false;
-}
+// Answers from the directory listings cached by the native resolver, which
+// are shared by all isolates in the process. A name that is not in the
+// listing of its directory costs no stat() call.
+var resolver = process.binding('resolver');
 
 // check if the directory is a package.json dir
 var packageCache = {};
@@ -99,9 +96,13 @@ function readPackage(requestPath) {
     return packageCache[requestPath];
   }
 
+  var jsonPath = path.resolve(requestPath, 'package.json');
+  if (resolver.type(jsonPath) !== resolver.FILE) {
+    return false;
+  }
+
   var fs = NativeModule.require('fs');
   try {
-    var jsonPath = path.resolve(requestPath, 'package.json');
     var json = fs.readFileSync(jsonPath, 'utf8');
   } catch (e) {
     return false;
@@ -135,8 +136,7 @@ Module._realpathCache = {};
 // check if the file exists and is not a directory
 function tryFile(requestPath) {
   var fs = NativeModule.require('fs');
-  var stats = statPath(requestPath);
-  if (stats && !stats.isDirectory()) {
+  if (resolver.type(requestPath) === resolver.FILE) {
     return fs.realpathSync(requestPath, Module._realpathCache);
   }
   return false;
@@ -155,6 +155,27 @@ function tryExtensions(p, exts) {
 }
 
 
+// A resolution made elsewhere goes stale once a path searched before the
+// one it was found under gets its own copy of the module, like a closer
+// node_modules directory. Checks that none has an entry for the request,
+// which costs no stat() call for the ones that do not.
+function isClosest(request, paths, exts, resolved) {
+  if (paths.length < 2) return true;
+
+  var name = request.split(/[\/\\]/)[0];
+  for (var i = 0, PL = paths.length; i < PL; i++) {
+    var basePath = path.resolve(paths[i], name);
+    if (resolved.slice(0, basePath.length) === basePath) return true;
+    if (resolver.type(basePath) !== resolver.MISSING) return false;
+    for (var j = 0, EL = exts.length; j < EL; j++) {
+      if (resolver.type(basePath + exts[j]) !== resolver.MISSING) return false;
+    }
+  }
+  // Found through a symlink, say; just look it up again.
+  return false;
+}
+
+
 Module._findPath = function(request, paths) {
   var fs = NativeModule.require('fs');
   var exts = Object.keys(Module._extensions);
@@ -170,6 +191,17 @@ Module._findPath = function(request, paths) {
     return Module._pathCache[cacheKey];
   }
 
+  resolver.beginLookup();
+
+  // Another isolate, or a previous run that wrote the resolution manifest,
+  // may have resolved this already.
+  var resolved = resolver.getResolved(cacheKey);
+  if (resolved && resolver.type(resolved) === resolver.FILE &&
+      isClosest(request, paths, exts, resolved)) {
+    Module._pathCache[cacheKey] = resolved;
+    return resolved;
+  }
+
   // For each path
   for (var i = 0, PL = paths.length; i < PL; i++) {
     var basePath = path.resolve(paths[i], request);
@@ -196,6 +228,7 @@ Module._findPath = function(request, paths) {
 
     if (filename) {
       Module._pathCache[cacheKey] = filename;
+      resolver.setResolved(cacheKey, filename);
       return filename;
     }
   }
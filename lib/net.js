@@ -83,6 +83,8 @@ function initSocketHandle(self) {
 
   self._flags = 0;
   self._connectQueueSize = 0;
+  self._corkQueue = null;
+  self._corkQueueSize = 0;
   self.destroyed = false;
   self.bytesRead = 0;
   self.bytesWritten = 0;
@@ -188,7 +190,8 @@ Object.defineProperty(Socket.prototype, 'readyState', {
 
 Object.defineProperty(Socket.prototype, 'bufferSize', {
   get: function() {
-    return this._handle.writeQueueSize + this._connectQueueSize;
+    return this._handle.writeQueueSize + this._connectQueueSize +
+           this._corkQueueSize;
   }
 });
 
@@ -217,6 +220,7 @@ Socket.prototype.end = function(data, encoding) {
   this.writable = false;
 
   if (data) this.write(data, encoding);
+  this.uncork();
   DTRACE_NET_STREAM_END(this);
 
   if (!this.readable) {
@@ -256,6 +260,7 @@ function afterShutdown(status, handle, req) {
 
 
 Socket.prototype.destroySoon = function() {
+  this.uncork();
   this.writable = false;
   this._flags |= FLAG_DESTROY_SOON;
 
@@ -281,6 +286,9 @@ Socket.prototype.destroy = function(exception) {
 
   this.readable = this.writable = false;
 
+  this._corkQueue = null;
+  this._corkQueueSize = 0;
+
   timers.unenroll(this);
 
   if (this.server && !this.destroyed) {
@@ -403,8 +411,15 @@ Socket.prototype.write = function(data, arg1, arg2) {
     }
   }
 
-  // Change strings to buffers. SLOW
   if (typeof data == 'string') {
+    // If the handle can take the string as-is, skip the Buffer.
+    var method = stringWriters[encoding || 'utf8'];
+    if (method && this._handle && this._handle[method] &&
+        !this._connecting && !this._corkQueue) {
+      return this._writeString(data, method, cb);
+    }
+
+    // Change strings to buffers. SLOW
     data = new Buffer(data, encoding);
   }
 
@@ -428,6 +443,13 @@ Socket.prototype.write = function(data, arg1, arg2) {
 Socket.prototype._write = function(data, encoding, cb) {
   timers.active(this);
 
+  if (this._corkQueue) {
+    this._corkQueue.push(data);
+    if (cb) this._corkCallbacks.push(cb);
+    this._corkQueueSize += data.length;
+    return true;
+  }
+
   // `encoding` is unused right now, `data` is always a buffer.
   var writeReq = this._handle.write(data);
 
@@ -444,6 +466,154 @@ Socket.prototype._write = function(data, encoding, cb) {
 };
 
 
+/*
+ * Arguments fd, offset, length, [cb]
+ *
+ * Queues a range of a file behind the data already written. The handle
+ * sends it straight from the page cache; `fd` must stay open until `cb`.
+ */
+Socket.prototype.sendFile = function(fd, offset, length, cb) {
+  if (typeof fd !== 'number' || typeof offset !== 'number' ||
+      typeof length !== 'number') {
+    throw new TypeError('Bad arguments');
+  }
+
+  if (this._connecting || !this._handle || !this._handle.sendFile) {
+    this.uncork();
+    return this._sendFileCopy(fd, offset, length, cb);
+  }
+
+  timers.active(this);
+
+  // Corked writes lead the file in the same request. That keeps them from
+  // going out as a short packet of their own that the file has to wait for.
+  var head = this._corkQueue;
+  var callbacks = this._corkCallbacks;
+  this._corkQueue = this._corkCallbacks = null;
+  this._corkQueueSize = 0;
+
+  var writeReq = this._handle.sendFile(fd, offset, length, head);
+
+  if (!writeReq) {
+    this.destroy(errnoException(errno, 'sendfile'));
+    return false;
+  }
+
+  this.bytesWritten += length;
+
+  writeReq.oncomplete = afterSendFile;
+  writeReq.cb = cb;
+  writeReq.cbs = callbacks;
+  this._pendingWriteReqs++;
+
+  return this._handle.writeQueueSize == 0;
+};
+
+
+// For handles that cannot send files: read the range and write it. The read
+// is synchronous so that writes made after sendFile() cannot overtake it.
+Socket.prototype._sendFileCopy = function(fd, offset, length, cb) {
+  var buffer;
+
+  try {
+    buffer = require('fs')._readRangeSync(fd, offset, length);
+  } catch (er) {
+    var self = this;
+    process.nextTick(function() {
+      if (cb) cb(er);
+      self.destroy(er);
+    });
+    return false;
+  }
+
+  return this.write(buffer, cb);
+};
+
+
+function afterSendFile(status, handle, req) {
+  var self = handle.socket;
+
+  if (status && !self.destroyed) {
+    var er = errnoException(errno, 'sendfile');
+    if (req.cb) req.cb(er);
+    self.destroy(er);
+    return;
+  }
+
+  afterWrite(status, handle, req);
+}
+
+
+var stringWriters = {
+  'utf8': 'writeUtf8String',
+  'utf-8': 'writeUtf8String',
+  'ascii': 'writeAsciiString'
+};
+
+
+Socket.prototype._writeString = function(data, method, cb) {
+  timers.active(this);
+
+  var writeReq = this._handle[method](data);
+
+  if (!writeReq) {
+    this.destroy(errnoException(errno, 'write'));
+    return false;
+  }
+
+  this.bytesWritten += writeReq.bytes;
+
+  writeReq.oncomplete = afterWrite;
+  writeReq.cb = cb;
+  this._pendingWriteReqs++;
+
+  return this._handle.writeQueueSize == 0;
+};
+
+
+// While a socket is corked, writes are held back and then handed to the
+// handle all at once, as a single request. This saves a syscall and a
+// request object per chunk for things like HTTP headers, body and chunk
+// framing. A socket stays corked for at most one tick.
+Socket.prototype.cork = function() {
+  if (this._corkQueue || !this._handle || !this._handle.writev) return;
+
+  this._corkQueue = [];
+  this._corkCallbacks = [];
+
+  var self = this;
+  process.nextTick(function() {
+    self.uncork();
+  });
+};
+
+
+Socket.prototype.uncork = function() {
+  var queue = this._corkQueue;
+  if (!queue) return true;
+
+  var callbacks = this._corkCallbacks;
+  this._corkQueue = this._corkCallbacks = null;
+  this._corkQueueSize = 0;
+
+  if (queue.length == 0) return true;
+
+  var writeReq = queue.length == 1 ? this._handle.write(queue[0])
+                                   : this._handle.writev(queue);
+
+  if (!writeReq) {
+    this.destroy(errnoException(errno, 'write'));
+    return false;
+  }
+
+  writeReq.oncomplete = afterWrite;
+  writeReq.cbs = callbacks;
+  this._pendingWriteReqs++;
+
+  return this._handle.writeQueueSize == 0;
+};
+
+
 function afterWrite(status, handle, req, buffer) {
   var self = handle.socket;
 
@@ -464,6 +634,9 @@ function afterWrite(status, handle, req, buffer) {
   }
 
   if (req.cb) req.cb();
+  if (req.cbs) {
+    for (var i = 0; i < req.cbs.length; i++) req.cbs[i]();
+  }
 
   if (self._pendingWriteReqs == 0 && self._flags & FLAG_DESTROY_SOON) {
     self.destroy();
@@ -564,6 +737,19 @@ Socket.prototype.connect = function(port /* [host], [cb] */) {
 };
 
 
+// Puts `handle`, which is connected already, under a socket that has no
+// handle yet, as if connect() had just completed on it. tls uses this to
+// run the cleartext side of a connection on a native TLS handle.
+Socket.prototype._attachHandle = function(handle) {
+  assert.ok(!this._handle);
+  this._handle = handle;
+  handle.socket = this;
+  handle.onread = onread;
+  this._connecting = true;
+  afterConnect(0, handle, null);
+};
+
+
 function afterConnect(status, handle, req) {
   var self = handle.socket;
 
@@ -652,13 +838,18 @@ function toPort(x) { return (x = Number(x)) >= 0 ? x : false; }
 
 
 var createServerHandle = exports._createServerHandle =
-    function(address, port, addressType) {
+    function(address, port, addressType, reusePort) {
   var r = 0;
   // assign handle in listen, and clean up if bind or listen fails
   var handle =
       (port == -1 && addressType == -1) ? createPipe() : createTCP();
 
-  if (address || port) {
+  if (reusePort) {
+    debug('set SO_REUSEPORT');
+    r = handle.setReusePort(true);
+  }
+
+  if (!r && (address || port)) {
     debug('bind to ' + address);
     if (addressType == 6) {
       r = handle.bind6(address, port);
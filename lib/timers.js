@@ -20,7 +20,7 @@
 // USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 var Timer = process.binding('timer_wrap').Timer;
-var L = require('_linklist');
+var TimerWheel = process.binding('timer_wrap').TimerWheel;
 var assert = require('assert').ok;
 
 var debug;
@@ -34,91 +34,66 @@ if (process.env.NODE_DEBUG && /timer/.test(process.env.NODE_DEBUG)) {
 // IDLE TIMEOUTS
 //
 // Because often many sockets will have the same idle timeout we will not
-// use one timeout watcher per item. It is too much overhead.  Instead
-// we'll use a single watcher for all sockets with the same timeout value
-// and a linked list. This technique is described in the libev manual:
-// http://pod.tst.eu/http://cvs.schmorp.de/libev/ev.pod#Be_smart_about_timeouts
+// use one timeout watcher per item. It is too much overhead. Instead all
+// items go on a single hierarchical timing wheel (see src/timer_wrap.cc)
+// which arms, re-arms and cancels in constant time no matter how many
+// distinct timeout values there are, and reads the loop's cached time
+// rather than calling new Date().
+//
+// The wheel hands out an id for every armed item; `items` maps it back.
+var wheel = null;
+var items = [];
+
+
+function onWheelTimeout(id) {
+  var item = items[id];
+  items[id] = undefined;
+  if (!item) return;
 
-// Object containing all lists, timers
-// key = time in milliseconds
-// value = list
-var lists = {};
+  debug('timeout callback ' + item._idleTimeout);
+  item._wheelId = -1;
+  if (item._onTimeout) item._onTimeout();
+}
 
 
-// the main function - creates lists on demand and the watchers associated
-// with them.
 function insert(item, msecs) {
-  item._idleStart = new Date();
   item._idleTimeout = msecs;
 
   if (msecs < 0) return;
 
-  var list;
+  if (!wheel) {
+    wheel = new TimerWheel();
+    wheel.ontimeout = onWheelTimeout;
+  }
 
-  if (lists[msecs]) {
-    list = lists[msecs];
+  if (item._wheelId >= 0) {
+    wheel.again(item._wheelId, msecs);
   } else {
-    list = new Timer();
-    list.start(msecs, 0);
-
-    L.init(list);
-
-    lists[msecs] = list;
-
-    list.ontimeout = function() {
-      debug('timeout callback ' + msecs);
-
-      var now = new Date();
-      debug('now: ' + now);
-
-      var first;
-      while (first = L.peek(list)) {
-        var diff = now - first._idleStart;
-        if (diff + 1 < msecs) {
-          list.start(msecs - diff, 0);
-          debug(msecs + ' list wait because diff is ' + diff);
-          return;
-        } else {
-          L.remove(first);
-          assert(first !== L.peek(list));
-          if (first._onTimeout) first._onTimeout();
-        }
-      }
-
-      debug(msecs + ' list empty');
-      assert(L.isEmpty(list));
-      list.close();
-      delete lists[msecs];
-    };
+    var id = wheel.start(msecs);
+    assert(id >= 0);
+    item._wheelId = id;
+    items[id] = item;
   }
-
-  L.append(list, item);
-  assert(!L.isEmpty(list)); // list is not empty
 }
 
 
 var unenroll = exports.unenroll = function(item) {
-  L.remove(item);
-
-  var list = lists[item._idleTimeout];
-  // if empty then stop the watcher
   debug('unenroll');
-  if (list && L.isEmpty(list)) {
-    debug('unenroll: list empty');
-    list.close();
-    delete lists[item._idleTimeout];
+  if (item._wheelId >= 0) {
+    wheel.stop(item._wheelId);
+    items[item._wheelId] = undefined;
+    item._wheelId = -1;
   }
 };
 
 
 // Does not start the time, just sets up the members needed.
 exports.enroll = function(item, msecs) {
-  // if this item was already in a list somewhere
-  // then we should unenroll it from that
-  if (item._idleNext) unenroll(item);
+  // if this item was already armed then disarm it
+  if (item._wheelId >= 0) unenroll(item);
 
   item._idleTimeout = msecs;
-  L.init(item);
+  item._wheelId = -1;
 };
 
 
@@ -126,15 +101,7 @@ exports.enroll = function(item, msecs) {
 // it will reset its timeout.
 exports.active = function(item) {
   var msecs = item._idleTimeout;
-  if (msecs >= 0) {
-    var list = lists[msecs];
-    if (!list || L.isEmpty(list)) {
-      insert(item, msecs);
-    } else {
-      item._idleStart = new Date();
-      L.append(list, item);
-    }
-  }
+  if (msecs >= 0) insert(item, msecs);
 };
 
 
@@ -163,9 +130,7 @@ exports.setTimeout = function(callback, after) {
     timer.ontimeout = timer._onTimeout;
     timer.start(0, 0);
   } else {
-    timer = { _idleTimeout: after };
-    timer._idlePrev = timer;
-    timer._idleNext = timer;
+    timer = { _idleTimeout: after, _wheelId: -1 };
 
     if (arguments.length <= 2) {
       timer._onTimeout = callback;
@@ -35,13 +35,32 @@ if (process.env.NODE_DEBUG && /tls/.test(process.env.NODE_DEBUG)) {
 }
 
 
+var binding = null;
 var Connection = null;
 try {
-  Connection = process.binding('crypto').Connection;
+  binding = process.binding('crypto');
+  Connection = binding.Connection;
 } catch (e) {
   throw new Error('node.js not compiled with openssl crypto support.');
 }
 
+// TLS done natively on a stream handle. It is still experimental, so
+// connections only use it instead of a SecurePair if they ask for it with
+// the `nativeTLS` option, or if NODE_TLS_WRAP=1 makes that the default.
+var TLSWrap = null;
+try {
+  TLSWrap = process.binding('tls_wrap').TLSWrap;
+} catch (e) {
+}
+
+var nativeTLSDefault = (+process.env.NODE_TLS_WRAP > 0);
+
+function useTLSWrap(options) {
+  if (!TLSWrap) return false;
+  if (typeof options.nativeTLS == 'boolean') return options.nativeTLS;
+  return nativeTLSDefault;
+}
+
 // Convert protocols array into valid OpenSSL protocols list
 // ("\x06spdy/2\x08http/1.1\x08http/1.0")
 function convertNPNProtocols(NPNProtocols, out) {
@@ -752,6 +771,181 @@ SecurePair.prototype.error = function() {
   }
 };
 
+// The cleartext side of a connection that runs on a TLSWrap. It is a
+// net.Socket on that handle with the CleartextStream methods added; the
+// socket the connection came in on is left without a handle.
+function TLSSocket(socket) {
+  net.Socket.call(this, { allowHalfOpen: socket.allowHalfOpen });
+
+  this.socket = socket;
+  this.authorized = false;
+  this.npnProtocol = null;
+  this.servername = null;
+  this._secureEstablished = false;
+
+  // Writes are queued until startTLS() gives us a handle.
+  this._connecting = true;
+  this.readable = this.writable = true;
+}
+util.inherits(TLSSocket, net.Socket);
+
+
+TLSSocket.prototype.getPeerCertificate = function() {
+  if (this._handle) {
+    var c = this._handle.getPeerCertificate();
+
+    if (c) {
+      if (c.issuer) c.issuer = parseCertString(c.issuer);
+      if (c.subject) c.subject = parseCertString(c.subject);
+      return c;
+    }
+  }
+
+  return null;
+};
+
+TLSSocket.prototype.getSession = function() {
+  if (this._handle) {
+    return this._handle.getSession();
+  }
+
+  return null;
+};
+
+TLSSocket.prototype.isSessionReused = function() {
+  if (this._handle) {
+    return this._handle.isSessionReused();
+  }
+
+  return null;
+};
+
+// A write or shutdown that TLSWrap refused leaves OpenSSL's error on the
+// handle; net.Socket only knows the errno, so report the real one instead.
+TLSSocket.prototype.destroy = function(exception) {
+  if (exception && this._handle && this._handle.error) {
+    exception = this._handle.error;
+    this._handle.error = null;
+  }
+
+  net.Socket.prototype.destroy.call(this, exception);
+};
+
+TLSSocket.prototype.getCipher = function(err) {
+  if (this._handle) {
+    return this._handle.getCurrentCipher();
+  } else {
+    return null;
+  }
+};
+
+
+// Moves the connection of `cleartext.socket` onto a TLSWrap and starts the
+// handshake. 'secure' is emitted on `cleartext` once it is done.
+function startTLS(cleartext, credentials, isServer, requestCert,
+                  rejectUnauthorized, options) {
+  var socket = cleartext.socket;
+  var raw = socket._handle;
+
+  var handle = new TLSWrap(raw,
+                           credentials.context,
+                           isServer,
+                           isServer ? requestCert : options.servername,
+                           rejectUnauthorized);
+
+  // The raw socket stays around as `cleartext.socket` for its address
+  // and its 'end' and 'close' events, but all I/O goes through `handle`.
+  var peername = socket._getpeername();
+  socket._handle = null;
+  socket.readable = socket.writable = false;
+  if (socket.server) {
+    cleartext.server = socket.server;
+    socket.server = null;
+  }
+
+  socket.address = function() {
+    return raw.getsockname();
+  };
+  socket._getpeername = function() {
+    return peername;
+  };
+  socket.destroy = function(err) {
+    cleartext.destroy(err);
+  };
+  socket.destroySoon = function() {
+    cleartext.destroySoon();
+  };
+  cleartext.on('end', function() {
+    socket.emit('end');
+  });
+  cleartext.on('close', function(hadError) {
+    socket.destroyed = true;
+    socket.emit('close', hadError);
+  });
+
+  ['getpeername', 'getsockname', 'setNoDelay', 'setKeepAlive'].forEach(
+    function(name) {
+      if (raw[name]) {
+        handle[name] = function() {
+          return raw[name].apply(raw, arguments);
+        };
+      }
+    });
+
+  if (process.features.tls_sni && isServer && options.SNICallback) {
+    handle.setSNICallback(options.SNICallback);
+  }
+
+  if (process.features.tls_npn && options.NPNProtocols) {
+    handle.setNPNProtocols(options.NPNProtocols);
+  }
+
+  if (options.session) {
+    handle.setSession(options.session);
+  }
+
+  handle.onhandshakedone = function() {
+    if (process.features.tls_npn) {
+      cleartext.npnProtocol = handle.getNegotiatedProtocol();
+    }
+
+    if (process.features.tls_sni) {
+      cleartext.servername = handle.getServername();
+    }
+
+    cleartext._secureEstablished = true;
+    debug('secure established');
+    cleartext.emit('secure');
+  };
+
+  handle.onerror = function(err) {
+    if (!err) {
+      err = new Error(errno);
+      err.errno = err.code = errno;
+    }
+
+    // Same as SecurePair.prototype.error.
+    if (!cleartext._secureEstablished) {
+      cleartext.destroy();
+    } else if (isServer &&
+               rejectUnauthorized &&
+               /peer did not return a certificate/.test(err.message)) {
+      cleartext.destroy();
+    } else {
+      cleartext.destroy(err);
+    }
+  };
+
+  cleartext._attachHandle(handle);
+
+  if (!isServer && handle.start() < 0) {
+    var err = handle.error;
+    handle.error = null;
+    handle.onerror(err);
+  }
+}
+
+
 // TODO: support anonymous (nocert) and PSK
 
 
@@ -856,10 +1050,44 @@ function Server(/* [options], listener */) {
     sessionIdContext: self.sessionIdContext
   });
 
+  if (this.sharedSessionCache) {
+    sharedCreds.context.enableSessionCache(this.sharedTicketKeys);
+  }
+
   // constructor call
   net.Server.call(this, function(socket) {
     var creds = crypto.createCredentials(null, sharedCreds.context);
 
+    if (self.nativeTLS) {
+      var cleartext = new TLSSocket(socket);
+
+      cleartext.on('secure', function() {
+        if (self.requestCert) {
+          var verifyError = cleartext._handle.verifyError();
+          if (verifyError) {
+            cleartext.authorizationError = verifyError;
+
+            if (self.rejectUnauthorized) {
+              cleartext.destroy();
+              return;
+            }
+          } else {
+            cleartext.authorized = true;
+          }
+        }
+
+        self.emit('secureConnection', cleartext);
+      });
+
+      startTLS(cleartext, creds, true, self.requestCert,
+               self.rejectUnauthorized,
+               {
+                 NPNProtocols: self.NPNProtocols,
+                 SNICallback: self.SNICallback
+               });
+      return;
+    }
+
     var pair = new SecurePair(creds,
                               true,
                               self.requestCert,
@@ -913,6 +1141,64 @@ exports.createServer = function(options, listener) {
 };
 
 
+// The session cache that servers share with every other server in the
+// process, including those of other isolates.
+exports.setSessionCacheOptions = function(options) {
+  var current = binding.getSessionCacheStats();
+  var size = options.size, timeout = options.timeout;
+
+  binding.configureSessionCache(size === undefined ? current.size : size,
+                                timeout === undefined ? current.timeout :
+                                                        timeout);
+};
+
+exports.getSessionCacheStats = function() {
+  return binding.getSessionCacheStats();
+};
+
+exports.flushSessionCache = function() {
+  binding.flushSessionCache();
+};
+
+exports.rotateTicketKeys = function(key) {
+  if (!binding.rotateTicketKeys) {
+    throw new Error('node.js compiled without TLS session ticket support.');
+  }
+  binding.rotateTicketKeys(key);
+};
+
+
+// Identifies what a server's sessions vouch for, so that servers sharing
+// the session cache only resume each other's sessions if they would have
+// accepted the same clients in a full handshake.
+function sessionFingerprint(server) {
+  var hash = crypto.createHash('sha256');
+
+  function add(value) {
+    if (Array.isArray(value)) {
+      hash.update(value.length + ':');
+      value.forEach(add);
+      return;
+    }
+    if (!Buffer.isBuffer(value)) {
+      value = new Buffer(value == null ? '' : String(value));
+    }
+    hash.update(value.length + ':');
+    hash.update(value);
+  }
+
+  add(server.key);
+  add(server.cert);
+  add(server.ca);
+  add(server.crl);
+  add(server.requestCert);
+  add(server.rejectUnauthorized);
+
+  // The session id context holds at most 32 bytes.
+  return hash.digest('hex').slice(0, 32);
+}
+
+
 Server.prototype.setOptions = function(options) {
   if (typeof options.requestCert == 'boolean') {
     this.requestCert = options.requestCert;
@@ -926,6 +1212,20 @@ Server.prototype.setOptions = function(options) {
     this.rejectUnauthorized = false;
   }
 
+  this.nativeTLS = useTLSWrap(options);
+
+  if (typeof options.sharedSessionCache == 'boolean') {
+    this.sharedSessionCache = options.sharedSessionCache;
+  } else {
+    this.sharedSessionCache = false;
+  }
+
+  if (typeof options.sharedTicketKeys == 'boolean') {
+    this.sharedTicketKeys = options.sharedTicketKeys;
+  } else {
+    this.sharedTicketKeys = false;
+  }
+
   if (options.key) this.key = options.key;
   if (options.passphrase) this.passphrase = options.passphrase;
   if (options.cert) this.cert = options.cert;
@@ -943,6 +1243,8 @@ Server.prototype.setOptions = function(options) {
   }
   if (options.sessionIdContext) {
     this.sessionIdContext = options.sessionIdContext;
+  } else if (this.sharedSessionCache) {
+    this.sessionIdContext = sessionFingerprint(this);
   } else if (this.requestCert) {
     this.sessionIdContext = crypto.createHash('md5')
                                   .update(process.argv.join(' '))
@@ -1017,6 +1319,51 @@ exports.connect = function(port /* host, options, cb */) {
   var sslcontext = crypto.createCredentials(options);
 
   convertNPNProtocols(options.NPNProtocols, this);
+
+  if (useTLSWrap(options)) {
+    var NPNProtocols = this.NPNProtocols;
+    var cleartext = new TLSSocket(socket);
+
+    var onerror = function(e) {
+      cleartext.destroy(e);
+    };
+    socket.on('error', onerror);
+
+    socket.connect(port, host, function() {
+      socket.removeListener('error', onerror);
+
+      if (cleartext.destroyed) {
+        socket.destroy();
+        return;
+      }
+
+      startTLS(cleartext, sslcontext, false, true, false,
+               {
+                 NPNProtocols: NPNProtocols,
+                 servername: options.servername || host,
+                 session: options.session
+               });
+    });
+
+    cleartext.on('secure', function() {
+      var verifyError = cleartext._handle.verifyError();
+
+      if (verifyError) {
+        cleartext.authorized = false;
+        cleartext.authorizationError = verifyError;
+      } else {
+        cleartext.authorized = true;
+      }
+
+      cleartext.emit('secureConnect');
+    });
+
+    if (cb) {
+      cleartext.on('secureConnect', cb);
+    }
+
+    return cleartext;
+  }
   var pair = new SecurePair(sslcontext, false, true, false,
                             {
                               NPNProtocols: this.NPNProtocols,
@@ -259,16 +259,50 @@ function Zlib(opts, Binding) {
     }
   }
 
+  if (opts.dictionary) {
+    if (!Buffer.isBuffer(opts.dictionary)) {
+      throw new Error('Invalid dictionary: it should be a Buffer instance');
+    }
+    if (Binding === binding.Gzip || Binding === binding.Gunzip) {
+      throw new Error('Invalid dictionary: not supported by gzip');
+    }
+  }
+
   this._binding = new Binding();
-  this._binding.init(opts.windowBits || exports.Z_DEFAULT_WINDOWBITS,
-                     opts.level || exports.Z_DEFAULT_COMPRESSION,
-                     opts.memLevel || exports.Z_DEFAULT_MEMLEVEL,
-                     opts.strategy || exports.Z_DEFAULT_STRATEGY);
+  var err = this._binding.init(opts.windowBits || exports.Z_DEFAULT_WINDOWBITS,
+                               opts.level || exports.Z_DEFAULT_COMPRESSION,
+                               opts.memLevel || exports.Z_DEFAULT_MEMLEVEL,
+                               opts.strategy || exports.Z_DEFAULT_STRATEGY,
+                               opts.dictionary);
+  if (err !== binding.Z_OK) {
+    this._binding.close();
+    throw new Error('Failed to set dictionary');
+  }
 
   this._chunkSize = opts.chunkSize || exports.Z_DEFAULT_CHUNK;
   this._buffer = new Buffer(this._chunkSize);
   this._offset = 0;
   var self = this;
+
+  // Pipelined mode: the input is queued in the binding, which works through
+  // all of it in one trip to the thread pool and reports back in batches.
+  // See ZCtx::Push in src/node_zlib.cc.
+  if (opts.pipeline) {
+    if (opts.highWaterMark && opts.highWaterMark < this._chunkSize) {
+      throw new Error('Invalid highWaterMark: ' + opts.highWaterMark);
+    }
+
+    this._pipeline = true;
+    this._highWaterMark = opts.highWaterMark || 4 * this._chunkSize;
+    this._pushed = 0;
+    this._callbacks = [];
+    this._batch = null;
+
+    this._binding.setPipeline(this._chunkSize, this._highWaterMark);
+    this._binding.onbatch = function(buffers, consumed, queued, errno, msg) {
+      self._onBatch(buffers, consumed, queued, errno, msg);
+    };
+  }
 }
 
 util.inherits(Zlib, stream.Stream);
@@ -292,6 +326,11 @@ Zlib.prototype.write = function write(chunk, cb) {
   }
 
 
+  if (this._pipeline) {
+    var flush = this._ending ? binding.Z_FINISH : binding.Z_NO_FLUSH;
+    return this._push(flush, chunk, cb);
+  }
+
   var empty = this._queue.length === 0;
 
   this._queue.push([chunk, cb]);
@@ -303,6 +342,13 @@ Zlib.prototype.write = function write(chunk, cb) {
 };
 
 Zlib.prototype.flush = function flush(cb) {
+  if (this._pipeline) {
+    if (this._ended) {
+      return this.emit('error', new Error('Cannot write after end'));
+    }
+    return this._push(binding.Z_SYNC_FLUSH, null, cb);
+  }
+
   this._flush = binding.Z_SYNC_FLUSH;
   return this.write(cb);
 };
@@ -311,6 +357,8 @@ Zlib.prototype.end = function end(chunk, cb) {
   var self = this;
   this._ending = true;
   var ret = this.write(chunk, function() {
+    // Done with the zlib state, let somebody else have it.
+    self._binding.close();
     self.emit('end');
     if (cb) cb();
   });
@@ -402,13 +450,79 @@ Zlib.prototype._process = function() {
   }
 };
 
+Zlib.prototype._push = function(flush, chunk, cb) {
+  var queued = this._binding.push(flush, chunk);
+  this._pushed++;
+  if (cb) this._callbacks.push([this._pushed, cb]);
+
+  if (queued > this._highWaterMark) {
+    this._needDrain = true;
+    return false;
+  }
+  return true;
+};
+
+Zlib.prototype._onBatch = function(buffers, consumed, queued, errno, msg) {
+  this._batch = { buffers: buffers, index: 0, consumed: consumed,
+                  queued: queued, errno: errno, msg: msg };
+  this._deliver();
+};
+
+// Hands out what is left of the last batch. A batch may already be on its
+// way back when the stream is paused, so this stops there and resume()
+// picks up where it left off.
+Zlib.prototype._deliver = function() {
+  var batch = this._batch;
+  var buffers = batch.buffers;
+  while (batch.index < buffers.length) {
+    if (this._paused) return;
+    var buffer = buffers[batch.index++];
+    this.emit('data', buffer.slice(0, buffer.length));
+  }
+  this._batch = null;
+
+  var consumed = batch.consumed;
+  var queued = batch.queued;
+  var errno = batch.errno;
+
+  var callbacks = this._callbacks;
+  while (callbacks.length && callbacks[0][0] <= consumed) {
+    callbacks.shift()[1]();
+  }
+
+  if (errno) {
+    // The stream is dead. Whatever was waiting on it, end() included, is
+    // never going to complete, so let go of the zlib state here.
+    this._callbacks = [];
+    this._ended = true;
+    this.readable = this.writable = false;
+    this._binding.close();
+
+    var error = new Error(batch.msg);
+    error.errno = errno;
+    this.emit('error', error);
+    return;
+  }
+
+  if (this._needDrain && queued <= this._highWaterMark) {
+    this._needDrain = false;
+    this.emit('drain');
+  }
+};
+
 Zlib.prototype.pause = function() {
   this._paused = true;
+  if (this._pipeline) this._binding.pause();
   this.emit('pause');
 };
 
 Zlib.prototype.resume = function() {
   this._paused = false;
+  if (this._pipeline) {
+    if (this._batch) this._deliver();
+    if (!this._paused) this._binding.resume();
+    return;
+  }
   this._process();
 };
 
@@ -74,12 +74,17 @@
         'src/handle_wrap.cc',
         'src/node.cc',
         'src/node_buffer.cc',
+        'src/node_codec.cc',
         'src/node_constants.cc',
+        'src/node_dns_cache.cc',
         'src/node_extensions.cc',
         'src/node_file.cc',
         'src/node_http_parser.cc',
+        'src/node_idle_gc.cc',
         'src/node_javascript.cc',
+        'src/node_loop_stats.cc',
         'src/node_os.cc',
+        'src/node_resolver.cc',
         'src/node_script.cc',
         'src/node_string.cc',
         'src/node_zlib.cc',
@@ -95,14 +100,19 @@
         'src/handle_wrap.h',
         'src/node.h',
         'src/node_buffer.h',
+        'src/node_codec.h',
         'src/node_constants.h',
         'src/node_crypto.h',
+        'src/node_dns_cache.h',
         'src/node_extensions.h',
         'src/node_file.h',
         'src/node_http_parser.h',
+        'src/node_idle_gc.h',
         'src/node_javascript.h',
+        'src/node_loop_stats.h',
         'src/node_os.h',
         'src/node_root_certs.h',
+        'src/node_resolver.h',
         'src/node_script.h',
         'src/node_string.h',
         'src/node_version.h',
@@ -131,7 +141,11 @@
       'conditions': [
         [ 'node_use_openssl=="true"', {
           'defines': [ 'HAVE_OPENSSL=1' ],
-          'sources': [ 'src/node_crypto.cc' ],
+          'sources': [
+            'src/node_crypto.cc',
+            'src/tls_wrap.cc',
+            'src/tls_wrap.h',
+          ],
           'conditions': [
             [ 'node_use_system_openssl=="false"', {
               'dependencies': [ './deps/openssl/openssl.gyp:openssl' ],
@@ -141,6 +155,10 @@
         }],
         
         [ 'node_isolate=="true"', {
+          'sources': [
+            'src/isolate_channel.cc',
+            'src/isolate_channel.h',
+          ],
           'defines': [
             'NODE_FORK_ISOLATE',
             'NODE_LIBRARY'
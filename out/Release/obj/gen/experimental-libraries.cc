@@ -0,0 +1,66 @@
+// Copyright 2011 Google Inc. All Rights Reserved.
+
+// This file was generated from .js source files by SCons.  If you
+// want to make changes to this file you should either change the
+// javascript source files or the SConstruct script.
+
+#include "v8.h"
+#include "natives.h"
+#include "utils.h"
+
+namespace v8 {
+namespace internal {
+
+  static const byte sources[] = { 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 103, 108, 111, 98, 97, 108, 46, 80, 114, 111, 120, 121, 61, 110, 101, 119, 32, 36, 79, 98, 106, 101, 99, 116, 40, 41, 59, 10, 10, 118, 97, 114, 32, 36, 80, 114, 111, 120, 121, 61, 103, 108, 111, 98, 97, 108, 46, 80, 114, 111, 120, 121, 10, 10, 36, 80, 114, 111, 120, 121, 46, 99, 114, 101, 97, 116, 101, 61, 102, 117, 110, 99, 116, 105, 111, 110, 40, 97, 44, 98, 41, 123, 10, 105, 102, 40, 33, 40, 37, 95, 73, 115, 83, 112, 101, 99, 79, 98, 106, 101, 99, 116, 40, 97, 41, 41, 41, 10, 116, 104, 114, 111, 119, 32, 77, 97, 107, 101, 84, 121, 112, 101, 69, 114, 114, 111, 114, 40, 34, 104, 97, 110, 100, 108, 101, 114, 95, 110, 111, 110, 95, 111, 98, 106, 101, 99, 116, 34, 44, 91, 34, 99, 114, 101, 97, 116, 101, 34, 93, 41, 10, 105, 102, 40, 33, 40, 37, 95, 73, 115, 83, 112, 101, 99, 79, 98, 106, 101, 99, 116, 40, 98, 41, 41, 41, 98, 61, 110, 117, 108, 108, 10, 114, 101, 116, 117, 114, 110, 32, 37, 67, 114, 101, 97, 116, 101, 74, 83, 80, 114, 111, 120, 121, 40, 97, 44, 98, 41, 10, 125, 10, 10, 36, 80, 114, 111, 120, 121, 46, 99, 114, 101, 97, 116, 101, 70, 117, 110, 99, 116, 105, 111, 110, 61, 102, 117, 110, 99, 116, 105, 111, 110, 40, 97, 44, 98, 44, 99, 41, 123, 10, 105, 102, 40, 33, 40, 37, 95, 73, 115, 83, 112, 101, 99, 79, 98, 106, 101, 99, 116, 40, 97, 41, 41, 41, 10, 116, 104, 114, 111, 119, 32, 77, 97, 107, 101, 84, 121, 112, 101, 69, 114, 114, 111, 114, 40, 34, 104, 97, 110, 100, 108, 101, 114, 95, 110, 111, 110, 95, 111, 98, 106, 101, 99, 116, 34, 44, 91, 34, 99, 114, 101, 97, 116, 101, 34, 93, 41, 10, 105, 102, 40, 33, 40, 37, 95, 67, 108, 97, 115, 115, 79, 102, 40, 98, 41, 61, 61, 61, 39, 70, 117, 110, 99, 116, 105, 111, 110, 39, 41, 41, 10, 116, 104, 114, 111, 119, 32, 77, 97, 107, 101, 84, 121, 112, 101, 69, 114, 114, 111, 114, 40, 34, 116, 114, 97, 112, 95, 102, 117, 110, 99, 116, 105, 111, 110, 95, 101, 120, 112, 101, 99, 116, 101, 100, 34, 44, 91, 34, 99, 114, 101, 97, 116, 101, 70, 117, 110, 99, 116, 105, 111, 110, 34, 44, 34, 99, 97, 108, 108, 34, 93, 41, 10, 105, 102, 40, 40, 116, 121, 112, 101, 111, 102, 40, 99, 41, 61, 61, 61, 39, 117, 110, 100, 101, 102, 105, 110, 101, 100, 39, 41, 41, 123, 10, 99, 61, 98, 10, 125, 101, 108, 115, 101, 32, 105, 102, 40, 33, 40, 37, 95, 67, 108, 97, 115, 115, 79, 102, 40, 99, 41, 61, 61, 61, 39, 70, 117, 110, 99, 116, 105, 111, 110, 39, 41, 41, 123, 10, 116, 104, 114, 111, 119, 32, 77, 97, 107, 101, 84, 121, 112, 101, 69, 114, 114, 111, 114, 40, 34, 116, 114, 97, 112, 95, 102, 117, 110, 99, 116, 105, 111, 110, 95, 101, 120, 112, 101, 99, 116, 101, 100, 34, 44, 10, 91, 34, 99, 114, 101, 97, 116, 101, 70, 117, 110, 99, 116, 105, 111, 110, 34, 44, 34, 99, 111, 110, 115, 116, 114, 117, 99, 116, 34, 93, 41, 10, 125, 10, 114, 101, 116, 117, 114, 110, 32, 37, 67, 114, 101, 97, 116, 101, 74, 83, 70, 117, 110, 99, 116, 105, 111, 110, 80, 114, 111, 120, 121, 40, 10, 97, 44, 98, 44, 99, 44, 36, 70, 117, 110, 99, 116, 105, 111, 110, 46, 112, 114, 111, 116, 111, 116, 121, 112, 101, 41, 10, 125, 10, 10, 10, 10, 10, 10, 10, 10, 102, 117, 110, 99, 116, 105, 111, 110, 32, 68, 101, 108, 101, 103, 97, 116, 101, 67, 97, 108, 108, 65, 110, 100, 67, 111, 110, 115, 116, 114, 117, 99, 116, 40, 97, 44, 98, 41, 123, 10, 114, 101, 116, 117, 114, 110, 32, 102, 117, 110, 99, 116, 105, 111, 110, 40, 41, 123, 10, 114, 101, 116, 117, 114, 110, 32, 37, 65, 112, 112, 108, 121, 40, 37, 95, 73, 115, 67, 111, 110, 115, 116, 114, 117, 99, 116, 67, 97, 108, 108, 40, 41, 63, 98, 58, 97, 44, 10, 116, 104, 105, 115, 44, 97, 114, 103, 117, 109, 101, 110, 116, 115, 44, 48, 44, 37, 95, 65, 114, 103, 117, 109, 101, 110, 116, 115, 76, 101, 110, 103, 116, 104, 40, 41, 41, 10, 125, 10, 125, 10, 10, 102, 117, 110, 99, 116, 105, 111, 110, 32, 68, 101, 114, 105, 118, 101, 100, 71, 101, 116, 84, 114, 97, 112, 40, 97, 44, 98, 41, 123, 10, 118, 97, 114, 32, 99, 61, 116, 104, 105, 115, 46, 103, 101, 116, 80, 114, 111, 112, 101, 114, 116, 121, 68, 101, 115, 99, 114, 105, 112, 116, 111, 114, 40, 98, 41, 10, 105, 102, 40, 40, 116, 121, 112, 101, 111, 102, 40, 99, 41, 61, 61, 61, 39, 117, 110, 100, 101, 102, 105, 110, 101, 100, 39, 41, 41, 123, 114, 101, 116, 117, 114, 110, 32, 99, 125, 10, 105, 102, 40, 39, 118, 97, 108, 117, 101, 39, 105, 110, 32, 99, 41, 123, 10, 114, 101, 116, 117, 114, 110, 32, 99, 46, 118, 97, 108, 117, 101, 10, 125, 101, 108, 115, 101, 123, 10, 105, 102, 40, 40, 116, 121, 112, 101, 111, 102, 40, 99, 46, 103, 101, 116, 41, 61, 61, 61, 39, 117, 110, 100, 101, 102, 105, 110, 101, 100, 39, 41, 41, 123, 114, 101, 116, 117, 114, 110, 32, 99, 46, 103, 101, 116, 125, 10, 10, 114, 101, 116, 117, 114, 110, 32, 37, 95, 67, 97, 108, 108, 70, 117, 110, 99, 116, 105, 111, 110, 40, 97, 44, 99, 46, 103, 101, 116, 41, 10, 125, 10, 125, 10, 10, 102, 117, 110, 99, 116, 105, 111, 110, 32, 68, 101, 114, 105, 118, 101, 100, 83, 101, 116, 84, 114, 97, 112, 40, 97, 44, 98, 44, 99, 41, 123, 10, 118, 97, 114, 32, 100, 61, 116, 104, 105, 115, 46, 103, 101, 116, 79, 119, 110, 80, 114, 111, 112, 101, 114, 116, 121, 68, 101, 115, 99, 114, 105, 112, 116, 111, 114, 40, 98, 41, 10, 105, 102, 40, 100, 41, 123, 10, 105, 102, 40, 39, 119, 114, 105, 116, 97, 98, 108, 101, 39, 105, 110, 32, 100, 41, 123, 10, 105, 102, 40, 100, 46, 119, 114, 105, 116, 97, 98, 108, 101, 41, 123, 10, 100, 46, 118, 97, 108, 117, 101, 61, 99, 10, 116, 104, 105, 115, 46, 100, 101, 102, 105, 110, 101, 80, 114, 111, 112, 101, 114, 116, 121, 40, 98, 44, 100, 41, 10, 114, 101, 116, 117, 114, 110, 32, 116, 114, 117, 101, 10, 125, 101, 108, 115, 101, 123, 10, 114, 101, 116, 117, 114, 110, 32, 102, 97, 108, 115, 101, 10, 125, 10, 125, 101, 108, 115, 101, 123, 10, 105, 102, 40, 100, 46, 115, 101, 116, 41, 123, 10, 10, 37, 95, 67, 97, 108, 108, 70, 117, 110, 99, 116, 105, 111, 110, 40, 97, 44, 99, 44, 100, 46, 115, 101, 116, 41, 10, 114, 101, 116, 117, 114, 110, 32, 116, 114, 117, 101, 10, 125, 101, 108, 115, 101, 123, 10, 114, 101, 116, 117, 114, 110, 32, 102, 97, 108, 115, 101, 10, 125, 10, 125, 10, 125, 10, 100, 61, 116, 104, 105, 115, 46, 103, 101, 116, 80, 114, 111, 112, 101, 114, 116, 121, 68, 101, 115, 99, 114, 105, 112, 116, 111, 114, 40, 98, 41, 10, 105, 102, 40, 100, 41, 123, 10, 105, 102, 40, 39, 119, 114, 105, 116, 97, 98, 108, 101, 39, 105, 110, 32, 100, 41, 123, 10, 105, 102, 40, 100, 46, 119, 114, 105, 116, 97, 98, 108, 101, 41, 123, 10, 10, 125, 101, 108, 115, 101, 123, 10, 114, 101, 116, 117, 114, 110, 32, 102, 97, 108, 115, 101, 10, 125, 10, 125, 101, 108, 115, 101, 123, 10, 105, 102, 40, 100, 46, 115, 101, 116, 41, 123, 10, 10, 37, 95, 67, 97, 108, 108, 70, 117, 110, 99, 116, 105, 111, 110, 40, 97, 44, 99, 44, 100, 46, 115, 101, 116, 41, 10, 114, 101, 116, 117, 114, 110, 32, 116, 114, 117, 101, 10, 125, 101, 108, 115, 101, 123, 10, 114, 101, 116, 117, 114, 110, 32, 102, 97, 108, 115, 101, 10, 125, 10, 125, 10, 125, 10, 116, 104, 105, 115, 46, 100, 101, 102, 105, 110, 101, 80, 114, 111, 112, 101, 114, 116, 121, 40, 98, 44, 123, 10, 118, 97, 108, 117, 101, 58, 99, 44, 10, 119, 114, 105, 116, 97, 98, 108, 101, 58, 116, 114, 117, 101, 44, 10, 101, 110, 117, 109, 101, 114, 97, 98, 108, 101, 58, 116, 114, 117, 101, 44, 10, 99, 111, 110, 102, 105, 103, 117, 114, 97, 98, 108, 101, 58, 116, 114, 117, 101, 125, 41, 59, 10, 114, 101, 116, 117, 114, 110, 32, 116, 114, 117, 101, 59, 10, 125, 10, 10, 102, 117, 110, 99, 116, 105, 111, 110, 32, 68, 101, 114, 105, 118, 101, 100, 72, 97, 115, 84, 114, 97, 112, 40, 97, 41, 123, 10, 114, 101, 116, 117, 114, 110, 33, 33, 116, 104, 105, 115, 46, 103, 101, 116, 80, 114, 111, 112, 101, 114, 116, 121, 68, 101, 115, 99, 114, 105, 112, 116, 111, 114, 40, 97, 41, 10, 125, 10, 10, 102, 117, 110, 99, 116, 105, 111, 110, 32, 68, 101, 114, 105, 118, 101, 100, 72, 97, 115, 79, 119, 110, 84, 114, 97, 112, 40, 97, 41, 123, 10, 114, 101, 116, 117, 114, 110, 33, 33, 116, 104, 105, 115, 46, 103, 101, 116, 79, 119, 110, 80, 114, 111, 112, 101, 114, 116, 121, 68, 101, 115, 99, 114, 105, 112, 116, 111, 114, 40, 97, 41, 10, 125, 10, 10, 102, 117, 110, 99, 116, 105, 111, 110, 32, 68, 101, 114, 105, 118, 101, 100, 75, 101, 121, 115, 84, 114, 97, 112, 40, 41, 123, 10, 118, 97, 114, 32, 97, 61, 116, 104, 105, 115, 46, 103, 101, 116, 79, 119, 110, 80, 114, 111, 112, 101, 114, 116, 121, 78, 97, 109, 101, 115, 40, 41, 10, 118, 97, 114, 32, 98, 61, 91, 93, 10, 102, 111, 114, 40, 118, 97, 114, 32, 99, 61, 48, 44, 99, 111, 117, 110, 116, 61, 48, 59, 99, 60, 97, 46, 108, 101, 110, 103, 116, 104, 59, 43, 43, 99, 41, 123, 10, 118, 97, 114, 32, 100, 61, 97, 91, 99, 93, 10, 105, 102, 40, 116, 104, 105, 115, 46, 103, 101, 116, 79, 119, 110, 80, 114, 111, 112, 101, 114, 116, 121, 68, 101, 115, 99, 114, 105, 112, 116, 111, 114, 40, 40, 40, 116, 121, 112, 101, 111, 102, 40, 37, 73, 83, 95, 86, 65, 82, 40, 100, 41, 41, 61, 61, 61, 39, 115, 116, 114, 105, 110, 103, 39, 41, 63, 100, 58, 78, 111, 110, 83, 116, 114, 105, 110, 103, 84, 111, 83, 116, 114, 105, 110, 103, 40, 100, 41, 41, 41, 46, 101, 110, 117, 109, 101, 114, 97, 98, 108, 101, 41, 123, 10, 98, 91, 99, 111, 117, 110, 116, 43, 43, 93, 61, 97, 91, 99, 93, 10, 125, 10, 125, 10, 114, 101, 116, 117, 114, 110, 32, 98, 10, 125, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 99, 111, 110, 115, 116, 32, 36, 87, 101, 97, 107, 77, 97, 112, 61, 103, 108, 111, 98, 97, 108, 46, 87, 101, 97, 107, 77, 97, 112, 59, 10, 10, 10, 10, 102, 117, 110, 99, 116, 105, 111, 110, 32, 87, 101, 97, 107, 77, 97, 112, 67, 111, 110, 115, 116, 114, 117, 99, 116, 111, 114, 40, 41, 123, 10, 105, 102, 40, 37, 95, 73, 115, 67, 111, 110, 115, 116, 114, 117, 99, 116, 67, 97, 108, 108, 40, 41, 41, 123, 10, 37, 87, 101, 97, 107, 77, 97, 112, 73, 110, 105, 116, 105, 97, 108, 105, 122, 101, 40, 116, 104, 105, 115, 41, 59, 10, 125, 101, 108, 115, 101, 123, 10, 114, 101, 116, 117, 114, 110, 32, 110, 101, 119, 32, 36, 87, 101, 97, 107, 77, 97, 112, 40, 41, 59, 10, 125, 10, 125, 10, 10, 10, 102, 117, 110, 99, 116, 105, 111, 110, 32, 87, 101, 97, 107, 77, 97, 112, 71, 101, 116, 40, 97, 41, 123, 10, 105, 102, 40, 33, 40, 37, 95, 73, 115, 83, 112, 101, 99, 79, 98, 106, 101, 99, 116, 40, 97, 41, 41, 41, 123, 10, 116, 104, 114, 111, 119, 32, 37, 77, 97, 107, 101, 84, 121, 112, 101, 69, 114, 114, 111, 114, 40, 39, 105, 110, 118, 97, 108, 105, 100, 95, 119, 101, 97, 107, 109, 97, 112, 95, 107, 101, 121, 39, 44, 91, 116, 104, 105, 115, 44, 97, 93, 41, 59, 10, 125, 10, 114, 101, 116, 117, 114, 110, 32, 37, 87, 101, 97, 107, 77, 97, 112, 71, 101, 116, 40, 116, 104, 105, 115, 44, 97, 41, 59, 10, 125, 10, 10, 10, 102, 117, 110, 99, 116, 105, 111, 110, 32, 87, 101, 97, 107, 77, 97, 112, 83, 101, 116, 40, 97, 44, 98, 41, 123, 10, 105, 102, 40, 33, 40, 37, 95, 73, 115, 83, 112, 101, 99, 79, 98, 106, 101, 99, 116, 40, 97, 41, 41, 41, 123, 10, 116, 104, 114, 111, 119, 32, 37, 77, 97, 107, 101, 84, 121, 112, 101, 69, 114, 114, 111, 114, 40, 39, 105, 110, 118, 97, 108, 105, 100, 95, 119, 101, 97, 107, 109, 97, 112, 95, 107, 101, 121, 39, 44, 91, 116, 104, 105, 115, 44, 97, 93, 41, 59, 10, 125, 10, 114, 101, 116, 117, 114, 110, 32, 37, 87, 101, 97, 107, 77, 97, 112, 83, 101, 116, 40, 116, 104, 105, 115, 44, 97, 44, 98, 41, 59, 10, 125, 10, 10, 10, 102, 117, 110, 99, 116, 105, 111, 110, 32, 87, 101, 97, 107, 77, 97, 112, 72, 97, 115, 40, 97, 41, 123, 10, 105, 102, 40, 33, 40, 37, 95, 73, 115, 83, 112, 101, 99, 79, 98, 106, 101, 99, 116, 40, 97, 41, 41, 41, 123, 10, 116, 104, 114, 111, 119, 32, 37, 77, 97, 107, 101, 84, 121, 112, 101, 69, 114, 114, 111, 114, 40, 39, 105, 110, 118, 97, 108, 105, 100, 95, 119, 101, 97, 107, 109, 97, 112, 95, 107, 101, 121, 39, 44, 91, 116, 104, 105, 115, 44, 97, 93, 41, 59, 10, 125, 10, 114, 101, 116, 117, 114, 110, 33, 40, 116, 121, 112, 101, 111, 102, 40, 37, 87, 101, 97, 107, 77, 97, 112, 71, 101, 116, 40, 116, 104, 105, 115, 44, 97, 41, 41, 61, 61, 61, 39, 117, 110, 100, 101, 102, 105, 110, 101, 100, 39, 41, 59, 10, 125, 10, 10, 10, 102, 117, 110, 99, 116, 105, 111, 110, 32, 87, 101, 97, 107, 77, 97, 112, 68, 101, 108, 101, 116, 101, 40, 97, 41, 123, 10, 105, 102, 40, 33, 40, 37, 95, 73, 115, 83, 112, 101, 99, 79, 98, 106, 101, 99, 116, 40, 97, 41, 41, 41, 123, 10, 116, 104, 114, 111, 119, 32, 37, 77, 97, 107, 101, 84, 121, 112, 101, 69, 114, 114, 111, 114, 40, 39, 105, 110, 118, 97, 108, 105, 100, 95, 119, 101, 97, 107, 109, 97, 112, 95, 107, 101, 121, 39, 44, 91, 116, 104, 105, 115, 44, 97, 93, 41, 59, 10, 125, 10, 105, 102, 40, 33, 40, 116, 121, 112, 101, 111, 102, 40, 37, 87, 101, 97, 107, 77, 97, 112, 71, 101, 116, 40, 116, 104, 105, 115, 44, 97, 41, 41, 61, 61, 61, 39, 117, 110, 100, 101, 102, 105, 110, 101, 100, 39, 41, 41, 123, 10, 37, 87, 101, 97, 107, 77, 97, 112, 83, 101, 116, 40, 116, 104, 105, 115, 44, 97, 44, 118, 111, 105, 100, 32, 48, 41, 59, 10, 114, 101, 116, 117, 114, 110, 32, 116, 114, 117, 101, 59, 10, 125, 101, 108, 115, 101, 123, 10, 114, 101, 116, 117, 114, 110, 32, 102, 97, 108, 115, 101, 59, 10, 125, 10, 125, 10, 10, 10, 10, 40, 102, 117, 110, 99, 116, 105, 111, 110, 40, 41, 123, 10, 37, 67, 104, 101, 99, 107, 73, 115, 66, 111, 111, 116, 115, 116, 114, 97, 112, 112, 105, 110, 103, 40, 41, 59, 10, 10, 37, 83, 101, 116, 67, 111, 100, 101, 40, 36, 87, 101, 97, 107, 77, 97, 112, 44, 87, 101, 97, 107, 77, 97, 112, 67, 111, 110, 115, 116, 114, 117, 99, 116, 111, 114, 41, 59, 10, 10, 10, 37, 83, 101, 116, 80, 114, 111, 112, 101, 114, 116, 121, 40, 36, 87, 101, 97, 107, 77, 97, 112, 46, 112, 114, 111, 116, 111, 116, 121, 112, 101, 44, 34, 99, 111, 110, 115, 116, 114, 117, 99, 116, 111, 114, 34, 44, 36, 87, 101, 97, 107, 77, 97, 112, 44, 50, 41, 59, 10, 10, 10, 73, 110, 115, 116, 97, 108, 108, 70, 117, 110, 99, 116, 105, 111, 110, 115, 79, 110, 72, 105, 100, 100, 101, 110, 80, 114, 111, 116, 111, 116, 121, 112, 101, 40, 36, 87, 101, 97, 107, 77, 97, 112, 46, 112, 114, 111, 116, 111, 116, 121, 112, 101, 44, 50, 44, 36, 65, 114, 114, 97, 121, 40, 10, 34, 103, 101, 116, 34, 44, 87, 101, 97, 107, 77, 97, 112, 71, 101, 116, 44, 10, 34, 115, 101, 116, 34, 44, 87, 101, 97, 107, 77, 97, 112, 83, 101, 116, 44, 10, 34, 104, 97, 115, 34, 44, 87, 101, 97, 107, 77, 97, 112, 72, 97, 115, 44, 10, 34, 100, 101, 108, 101, 116, 101, 34, 44, 87, 101, 97, 107, 77, 97, 112, 68, 101, 108, 101, 116, 101, 10, 41, 41, 59, 10, 125, 41, 40, 41, 59, 10, 10 };
+
+  static const char* raw_sources = reinterpret_cast<const char*>(sources);
+
+  template <>
+  int NativesCollection<EXPERIMENTAL>::GetBuiltinsCount() {
+    return 2;
+  }
+
+  template <>
+  int NativesCollection<EXPERIMENTAL>::GetDebuggerCount() {
+    return 0;
+  }
+
+  template <>
+  int NativesCollection<EXPERIMENTAL>::GetIndex(const char* name) {
+    if (strcmp(name, "proxy") == 0) return 0;
+    if (strcmp(name, "weakmap") == 0) return 1;
+    return -1;
+  }
+
+  template <>
+  int NativesCollection<EXPERIMENTAL>::GetRawScriptsSize() {
+    return 3156;
+  }
+
+  template <>
+  Vector<const char> NativesCollection<EXPERIMENTAL>::GetRawScriptSource(int index) {
+    if (index == 0) return Vector<const char>(raw_sources + 0, 2011);
+    if (index == 1) return Vector<const char>(raw_sources + 2011, 1145);
+    return Vector<const char>("", 0);
+  }
+
+  template <>
+  Vector<const char> NativesCollection<EXPERIMENTAL>::GetScriptName(int index) {
+    if (index == 0) return Vector<const char>("native proxy.js", 15);
+    if (index == 1) return Vector<const char>("native weakmap.js", 17);
+    return Vector<const char>("", 0);
+  }
+
+  template <>
+  Vector<const byte> NativesCollection<EXPERIMENTAL>::GetScriptsSource() {
+    return Vector<const byte>(sources, 3156);
+  }
+
+  template <>
+  void NativesCollection<EXPERIMENTAL>::SetRawScriptsSource(Vector<const char> raw_source) {
+    ASSERT(3156 == raw_source.length());
+    raw_sources = raw_source.start();
+  }
+
+}  // internal
+}  // v8
@@ -0,0 +1,123 @@
+# This file is generated by gyp; do not edit.
+
+TOOLSET := target
+TARGET := preparser_lib
+DEFS_Debug := '-DV8_SHARED=1' \
+	'-DENABLE_DEBUGGER_SUPPORT' \
+	'-DV8_TARGET_ARCH_X64' \
+	'-DDEBUG' \
+	'-D_DEBUG' \
+	'-DENABLE_DISASSEMBLER' \
+	'-DV8_ENABLE_CHECKS' \
+	'-DOBJECT_PRINT'
+
+# Flags passed to all source files.
+CFLAGS_Debug := -Wall \
+	-pthread \
+	-ansi \
+	-fvisibility=hidden \
+	-g \
+	-O0 \
+	-Wall \
+	-Werror \
+	-W \
+	-Wno-unused-parameter \
+	-Wnon-virtual-dtor
+
+# Flags passed to only C files.
+CFLAGS_C_Debug := 
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Debug := -fno-rtti \
+	-fno-exceptions
+
+INCS_Debug := -I$(srcdir)/deps/v8/src
+
+DEFS_Release := '-DV8_SHARED=1' \
+	'-DENABLE_DEBUGGER_SUPPORT' \
+	'-DV8_TARGET_ARCH_X64' \
+	'-DNDEBUG'
+
+# Flags passed to all source files.
+CFLAGS_Release := -Wall \
+	-pthread \
+	-ansi \
+	-fvisibility=hidden \
+	-O3 \
+	-fomit-frame-pointer \
+	-fdata-sections \
+	-ffunction-sections \
+	-fdata-sections \
+	-ffunction-sections \
+	-fomit-frame-pointer \
+	-O3
+
+# Flags passed to only C files.
+CFLAGS_C_Release := 
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Release := -fno-rtti \
+	-fno-exceptions
+
+INCS_Release := -I$(srcdir)/deps/v8/src
+
+OBJS := $(obj).target/$(TARGET)/deps/v8/src/allocation.o \
+	$(obj).target/$(TARGET)/deps/v8/src/bignum.o \
+	$(obj).target/$(TARGET)/deps/v8/src/bignum-dtoa.o \
+	$(obj).target/$(TARGET)/deps/v8/src/cached-powers.o \
+	$(obj).target/$(TARGET)/deps/v8/src/conversions.o \
+	$(obj).target/$(TARGET)/deps/v8/src/diy-fp.o \
+	$(obj).target/$(TARGET)/deps/v8/src/dtoa.o \
+	$(obj).target/$(TARGET)/deps/v8/src/fast-dtoa.o \
+	$(obj).target/$(TARGET)/deps/v8/src/fixed-dtoa.o \
+	$(obj).target/$(TARGET)/deps/v8/src/hashmap.o \
+	$(obj).target/$(TARGET)/deps/v8/src/preparse-data.o \
+	$(obj).target/$(TARGET)/deps/v8/src/preparser.o \
+	$(obj).target/$(TARGET)/deps/v8/src/preparser-api.o \
+	$(obj).target/$(TARGET)/deps/v8/src/scanner.o \
+	$(obj).target/$(TARGET)/deps/v8/src/strtod.o \
+	$(obj).target/$(TARGET)/deps/v8/src/token.o \
+	$(obj).target/$(TARGET)/deps/v8/src/unicode.o \
+	$(obj).target/$(TARGET)/deps/v8/src/utils.o
+
+# Add to the list of files we specially track dependencies for.
+all_deps += $(OBJS)
+
+# CFLAGS et al overrides must be target-local.
+# See "Target-specific Variable Values" in the GNU Make manual.
+$(OBJS): TOOLSET := $(TOOLSET)
+$(OBJS): GYP_CFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE)) $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_C_$(BUILDTYPE))
+$(OBJS): GYP_CXXFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE)) $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_CC_$(BUILDTYPE))
+
+# Suffix rules, putting all outputs into $(obj).
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(srcdir)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# Try building from generated source, too.
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj).$(TOOLSET)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# End of this set of suffix rules
+### Rules for final target.
+LDFLAGS_Debug := -pthread
+
+LDFLAGS_Release := -pthread
+
+LIBS := -lz
+
+$(obj).target/deps/v8/tools/gyp/libpreparser_lib.a: GYP_LDFLAGS := $(LDFLAGS_$(BUILDTYPE))
+$(obj).target/deps/v8/tools/gyp/libpreparser_lib.a: LIBS := $(LIBS)
+$(obj).target/deps/v8/tools/gyp/libpreparser_lib.a: TOOLSET := $(TOOLSET)
+$(obj).target/deps/v8/tools/gyp/libpreparser_lib.a: $(OBJS) FORCE_DO_CMD
+	$(call do_cmd,alink)
+
+all_deps += $(obj).target/deps/v8/tools/gyp/libpreparser_lib.a
+# Add target alias
+.PHONY: preparser_lib
+preparser_lib: $(obj).target/deps/v8/tools/gyp/libpreparser_lib.a
+
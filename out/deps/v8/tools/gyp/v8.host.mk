@@ -0,0 +1,14 @@
+# This file is generated by gyp; do not edit.
+
+TOOLSET := host
+TARGET := v8
+### Rules for final target.
+$(obj).host/deps/v8/tools/gyp/v8.stamp: TOOLSET := $(TOOLSET)
+$(obj).host/deps/v8/tools/gyp/v8.stamp: $(obj).host/deps/v8/tools/gyp/libv8_nosnapshot.a FORCE_DO_CMD
+	$(call do_cmd,touch)
+
+all_deps += $(obj).host/deps/v8/tools/gyp/v8.stamp
+# Add target alias
+.PHONY: v8
+v8: $(obj).host/deps/v8/tools/gyp/v8.stamp
+
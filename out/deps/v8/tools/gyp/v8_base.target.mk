@@ -0,0 +1,229 @@
+# This file is generated by gyp; do not edit.
+
+TOOLSET := target
+TARGET := v8_base
+DEFS_Debug := '-DV8_SHARED=1' \
+	'-DENABLE_DEBUGGER_SUPPORT' \
+	'-DV8_TARGET_ARCH_X64' \
+	'-DDEBUG' \
+	'-D_DEBUG' \
+	'-DENABLE_DISASSEMBLER' \
+	'-DV8_ENABLE_CHECKS' \
+	'-DOBJECT_PRINT'
+
+# Flags passed to all source files.
+CFLAGS_Debug := -Wall \
+	-pthread \
+	-ansi \
+	-fvisibility=hidden \
+	-g \
+	-O0 \
+	-Wall \
+	-Werror \
+	-W \
+	-Wno-unused-parameter \
+	-Wnon-virtual-dtor
+
+# Flags passed to only C files.
+CFLAGS_C_Debug := 
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Debug := -fno-rtti \
+	-fno-exceptions
+
+INCS_Debug := -I$(srcdir)/deps/v8/src
+
+DEFS_Release := '-DV8_SHARED=1' \
+	'-DENABLE_DEBUGGER_SUPPORT' \
+	'-DV8_TARGET_ARCH_X64' \
+	'-DNDEBUG'
+
+# Flags passed to all source files.
+CFLAGS_Release := -Wall \
+	-pthread \
+	-ansi \
+	-fvisibility=hidden \
+	-O3 \
+	-fomit-frame-pointer \
+	-fdata-sections \
+	-ffunction-sections \
+	-fdata-sections \
+	-ffunction-sections \
+	-fomit-frame-pointer \
+	-O3
+
+# Flags passed to only C files.
+CFLAGS_C_Release := 
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Release := -fno-rtti \
+	-fno-exceptions
+
+INCS_Release := -I$(srcdir)/deps/v8/src
+
+OBJS := $(obj).target/$(TARGET)/deps/v8/src/accessors.o \
+	$(obj).target/$(TARGET)/deps/v8/src/allocation.o \
+	$(obj).target/$(TARGET)/deps/v8/src/api.o \
+	$(obj).target/$(TARGET)/deps/v8/src/assembler.o \
+	$(obj).target/$(TARGET)/deps/v8/src/ast.o \
+	$(obj).target/$(TARGET)/deps/v8/src/atomicops_internals_x86_gcc.o \
+	$(obj).target/$(TARGET)/deps/v8/src/bignum.o \
+	$(obj).target/$(TARGET)/deps/v8/src/bignum-dtoa.o \
+	$(obj).target/$(TARGET)/deps/v8/src/bootstrapper.o \
+	$(obj).target/$(TARGET)/deps/v8/src/builtins.o \
+	$(obj).target/$(TARGET)/deps/v8/src/cached-powers.o \
+	$(obj).target/$(TARGET)/deps/v8/src/checks.o \
+	$(obj).target/$(TARGET)/deps/v8/src/circular-queue.o \
+	$(obj).target/$(TARGET)/deps/v8/src/code-stubs.o \
+	$(obj).target/$(TARGET)/deps/v8/src/codegen.o \
+	$(obj).target/$(TARGET)/deps/v8/src/compilation-cache.o \
+	$(obj).target/$(TARGET)/deps/v8/src/compiler.o \
+	$(obj).target/$(TARGET)/deps/v8/src/contexts.o \
+	$(obj).target/$(TARGET)/deps/v8/src/conversions.o \
+	$(obj).target/$(TARGET)/deps/v8/src/counters.o \
+	$(obj).target/$(TARGET)/deps/v8/src/cpu-profiler.o \
+	$(obj).target/$(TARGET)/deps/v8/src/data-flow.o \
+	$(obj).target/$(TARGET)/deps/v8/src/dateparser.o \
+	$(obj).target/$(TARGET)/deps/v8/src/debug.o \
+	$(obj).target/$(TARGET)/deps/v8/src/debug-agent.o \
+	$(obj).target/$(TARGET)/deps/v8/src/deoptimizer.o \
+	$(obj).target/$(TARGET)/deps/v8/src/disassembler.o \
+	$(obj).target/$(TARGET)/deps/v8/src/diy-fp.o \
+	$(obj).target/$(TARGET)/deps/v8/src/dtoa.o \
+	$(obj).target/$(TARGET)/deps/v8/src/elements.o \
+	$(obj).target/$(TARGET)/deps/v8/src/execution.o \
+	$(obj).target/$(TARGET)/deps/v8/src/factory.o \
+	$(obj).target/$(TARGET)/deps/v8/src/fast-dtoa.o \
+	$(obj).target/$(TARGET)/deps/v8/src/fixed-dtoa.o \
+	$(obj).target/$(TARGET)/deps/v8/src/flags.o \
+	$(obj).target/$(TARGET)/deps/v8/src/frames.o \
+	$(obj).target/$(TARGET)/deps/v8/src/full-codegen.o \
+	$(obj).target/$(TARGET)/deps/v8/src/func-name-inferrer.o \
+	$(obj).target/$(TARGET)/deps/v8/src/global-handles.o \
+	$(obj).target/$(TARGET)/deps/v8/src/handles.o \
+	$(obj).target/$(TARGET)/deps/v8/src/hashmap.o \
+	$(obj).target/$(TARGET)/deps/v8/src/heap.o \
+	$(obj).target/$(TARGET)/deps/v8/src/heap-profiler.o \
+	$(obj).target/$(TARGET)/deps/v8/src/hydrogen.o \
+	$(obj).target/$(TARGET)/deps/v8/src/hydrogen-instructions.o \
+	$(obj).target/$(TARGET)/deps/v8/src/ic.o \
+	$(obj).target/$(TARGET)/deps/v8/src/inspector.o \
+	$(obj).target/$(TARGET)/deps/v8/src/interpreter-irregexp.o \
+	$(obj).target/$(TARGET)/deps/v8/src/jsregexp.o \
+	$(obj).target/$(TARGET)/deps/v8/src/isolate.o \
+	$(obj).target/$(TARGET)/deps/v8/src/lithium.o \
+	$(obj).target/$(TARGET)/deps/v8/src/lithium-allocator.o \
+	$(obj).target/$(TARGET)/deps/v8/src/liveedit.o \
+	$(obj).target/$(TARGET)/deps/v8/src/liveobjectlist.o \
+	$(obj).target/$(TARGET)/deps/v8/src/log-utils.o \
+	$(obj).target/$(TARGET)/deps/v8/src/log.o \
+	$(obj).target/$(TARGET)/deps/v8/src/mark-compact.o \
+	$(obj).target/$(TARGET)/deps/v8/src/messages.o \
+	$(obj).target/$(TARGET)/deps/v8/src/objects-debug.o \
+	$(obj).target/$(TARGET)/deps/v8/src/objects-printer.o \
+	$(obj).target/$(TARGET)/deps/v8/src/objects-visiting.o \
+	$(obj).target/$(TARGET)/deps/v8/src/objects.o \
+	$(obj).target/$(TARGET)/deps/v8/src/parser.o \
+	$(obj).target/$(TARGET)/deps/v8/src/preparse-data.o \
+	$(obj).target/$(TARGET)/deps/v8/src/preparser.o \
+	$(obj).target/$(TARGET)/deps/v8/src/prettyprinter.o \
+	$(obj).target/$(TARGET)/deps/v8/src/property.o \
+	$(obj).target/$(TARGET)/deps/v8/src/profile-generator.o \
+	$(obj).target/$(TARGET)/deps/v8/src/regexp-macro-assembler-irregexp.o \
+	$(obj).target/$(TARGET)/deps/v8/src/regexp-macro-assembler-tracer.o \
+	$(obj).target/$(TARGET)/deps/v8/src/regexp-macro-assembler.o \
+	$(obj).target/$(TARGET)/deps/v8/src/regexp-stack.o \
+	$(obj).target/$(TARGET)/deps/v8/src/rewriter.o \
+	$(obj).target/$(TARGET)/deps/v8/src/runtime.o \
+	$(obj).target/$(TARGET)/deps/v8/src/runtime-profiler.o \
+	$(obj).target/$(TARGET)/deps/v8/src/safepoint-table.o \
+	$(obj).target/$(TARGET)/deps/v8/src/scanner.o \
+	$(obj).target/$(TARGET)/deps/v8/src/scanner-character-streams.o \
+	$(obj).target/$(TARGET)/deps/v8/src/scopeinfo.o \
+	$(obj).target/$(TARGET)/deps/v8/src/scopes.o \
+	$(obj).target/$(TARGET)/deps/v8/src/serialize.o \
+	$(obj).target/$(TARGET)/deps/v8/src/snapshot-common.o \
+	$(obj).target/$(TARGET)/deps/v8/src/spaces.o \
+	$(obj).target/$(TARGET)/deps/v8/src/string-search.o \
+	$(obj).target/$(TARGET)/deps/v8/src/string-stream.o \
+	$(obj).target/$(TARGET)/deps/v8/src/strtod.o \
+	$(obj).target/$(TARGET)/deps/v8/src/stub-cache.o \
+	$(obj).target/$(TARGET)/deps/v8/src/token.o \
+	$(obj).target/$(TARGET)/deps/v8/src/type-info.o \
+	$(obj).target/$(TARGET)/deps/v8/src/unicode.o \
+	$(obj).target/$(TARGET)/deps/v8/src/utils.o \
+	$(obj).target/$(TARGET)/deps/v8/src/v8-counters.o \
+	$(obj).target/$(TARGET)/deps/v8/src/v8.o \
+	$(obj).target/$(TARGET)/deps/v8/src/v8conversions.o \
+	$(obj).target/$(TARGET)/deps/v8/src/v8threads.o \
+	$(obj).target/$(TARGET)/deps/v8/src/v8utils.o \
+	$(obj).target/$(TARGET)/deps/v8/src/variables.o \
+	$(obj).target/$(TARGET)/deps/v8/src/version.o \
+	$(obj).target/$(TARGET)/deps/v8/src/zone.o \
+	$(obj).target/$(TARGET)/deps/v8/src/extensions/externalize-string-extension.o \
+	$(obj).target/$(TARGET)/deps/v8/src/extensions/gc-extension.o \
+	$(obj).target/$(TARGET)/deps/v8/src/x64/assembler-x64.o \
+	$(obj).target/$(TARGET)/deps/v8/src/x64/builtins-x64.o \
+	$(obj).target/$(TARGET)/deps/v8/src/x64/code-stubs-x64.o \
+	$(obj).target/$(TARGET)/deps/v8/src/x64/codegen-x64.o \
+	$(obj).target/$(TARGET)/deps/v8/src/x64/cpu-x64.o \
+	$(obj).target/$(TARGET)/deps/v8/src/x64/debug-x64.o \
+	$(obj).target/$(TARGET)/deps/v8/src/x64/deoptimizer-x64.o \
+	$(obj).target/$(TARGET)/deps/v8/src/x64/disasm-x64.o \
+	$(obj).target/$(TARGET)/deps/v8/src/x64/frames-x64.o \
+	$(obj).target/$(TARGET)/deps/v8/src/x64/full-codegen-x64.o \
+	$(obj).target/$(TARGET)/deps/v8/src/x64/ic-x64.o \
+	$(obj).target/$(TARGET)/deps/v8/src/x64/lithium-codegen-x64.o \
+	$(obj).target/$(TARGET)/deps/v8/src/x64/lithium-gap-resolver-x64.o \
+	$(obj).target/$(TARGET)/deps/v8/src/x64/lithium-x64.o \
+	$(obj).target/$(TARGET)/deps/v8/src/x64/macro-assembler-x64.o \
+	$(obj).target/$(TARGET)/deps/v8/src/x64/regexp-macro-assembler-x64.o \
+	$(obj).target/$(TARGET)/deps/v8/src/x64/stub-cache-x64.o \
+	$(obj).target/$(TARGET)/deps/v8/src/platform-linux.o \
+	$(obj).target/$(TARGET)/deps/v8/src/platform-posix.o
+
+# Add to the list of files we specially track dependencies for.
+all_deps += $(OBJS)
+
+# CFLAGS et al overrides must be target-local.
+# See "Target-specific Variable Values" in the GNU Make manual.
+$(OBJS): TOOLSET := $(TOOLSET)
+$(OBJS): GYP_CFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE)) $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_C_$(BUILDTYPE))
+$(OBJS): GYP_CXXFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE)) $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_CC_$(BUILDTYPE))
+
+# Suffix rules, putting all outputs into $(obj).
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(srcdir)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# Try building from generated source, too.
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj).$(TOOLSET)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# End of this set of suffix rules
+### Rules for final target.
+LDFLAGS_Debug := -pthread
+
+LDFLAGS_Release := -pthread
+
+LIBS := -lz
+
+$(obj).target/deps/v8/tools/gyp/libv8_base.a: GYP_LDFLAGS := $(LDFLAGS_$(BUILDTYPE))
+$(obj).target/deps/v8/tools/gyp/libv8_base.a: LIBS := $(LIBS)
+$(obj).target/deps/v8/tools/gyp/libv8_base.a: TOOLSET := $(TOOLSET)
+$(obj).target/deps/v8/tools/gyp/libv8_base.a: $(OBJS) FORCE_DO_CMD
+	$(call do_cmd,alink)
+
+all_deps += $(obj).target/deps/v8/tools/gyp/libv8_base.a
+# Add target alias
+.PHONY: v8_base
+v8_base: $(obj).target/deps/v8/tools/gyp/libv8_base.a
+
+# Add target alias to "all" target.
+.PHONY: all
+all: v8_base
+
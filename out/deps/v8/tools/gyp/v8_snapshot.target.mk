@@ -0,0 +1,136 @@
+# This file is generated by gyp; do not edit.
+
+TOOLSET := target
+TARGET := v8_snapshot
+### Rules for action "run_mksnapshot":
+quiet_cmd_v8_snapshot_run_mksnapshot = ACTION v8_snapshot_run_mksnapshot $@
+cmd_v8_snapshot_run_mksnapshot = LD_LIBRARY_PATH=$(builddir)/lib.host:$(builddir)/lib.target:$$LD_LIBRARY_PATH; export LD_LIBRARY_PATH; cd $(srcdir)/deps/v8/tools/gyp; mkdir -p $(obj).$(TOOLSET)/geni; "$(builddir)/mksnapshot" --log-snapshot-positions --logfile "$(obj).$(TOOLSET)/geni/snapshot.log" "$(obj).$(TOOLSET)/geni/snapshot.cc"
+
+$(obj).$(TOOLSET)/geni/snapshot.cc: obj := $(abs_obj)
+
+$(obj).$(TOOLSET)/geni/snapshot.cc: builddir := $(abs_builddir)
+
+$(obj).$(TOOLSET)/geni/snapshot.cc: TOOLSET := $(TOOLSET)
+$(obj).$(TOOLSET)/geni/snapshot.cc: $(builddir)/mksnapshot FORCE_DO_CMD
+	$(call do_cmd,v8_snapshot_run_mksnapshot)
+
+all_deps += $(obj).$(TOOLSET)/geni/snapshot.cc
+action_v8_snapshot_run_mksnapshot_outputs := $(obj).$(TOOLSET)/geni/snapshot.cc
+
+
+DEFS_Debug := '-DV8_SHARED=1' \
+	'-DENABLE_DEBUGGER_SUPPORT' \
+	'-DV8_TARGET_ARCH_X64' \
+	'-DDEBUG' \
+	'-D_DEBUG' \
+	'-DENABLE_DISASSEMBLER' \
+	'-DV8_ENABLE_CHECKS' \
+	'-DOBJECT_PRINT'
+
+# Flags passed to all source files.
+CFLAGS_Debug := -Wall \
+	-pthread \
+	-ansi \
+	-fvisibility=hidden \
+	-g \
+	-O0 \
+	-Wall \
+	-Werror \
+	-W \
+	-Wno-unused-parameter \
+	-Wnon-virtual-dtor
+
+# Flags passed to only C files.
+CFLAGS_C_Debug := 
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Debug := -fno-rtti \
+	-fno-exceptions
+
+INCS_Debug := -I$(srcdir)/deps/v8/src
+
+DEFS_Release := '-DV8_SHARED=1' \
+	'-DENABLE_DEBUGGER_SUPPORT' \
+	'-DV8_TARGET_ARCH_X64' \
+	'-DNDEBUG'
+
+# Flags passed to all source files.
+CFLAGS_Release := -Wall \
+	-pthread \
+	-ansi \
+	-fvisibility=hidden \
+	-O3 \
+	-fomit-frame-pointer \
+	-fdata-sections \
+	-ffunction-sections \
+	-fdata-sections \
+	-ffunction-sections \
+	-fomit-frame-pointer \
+	-O3
+
+# Flags passed to only C files.
+CFLAGS_C_Release := 
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Release := -fno-rtti \
+	-fno-exceptions
+
+INCS_Release := -I$(srcdir)/deps/v8/src
+
+OBJS := $(obj).target/$(TARGET)/gen/libraries.o \
+	$(obj).target/$(TARGET)/gen/experimental-libraries.o \
+	$(obj).$(TOOLSET)/geni/snapshot.o
+
+# Add to the list of files we specially track dependencies for.
+all_deps += $(OBJS)
+
+# Make sure our dependencies are built before any of us.
+$(OBJS): | $(builddir)/mksnapshot $(obj).host/deps/v8/tools/gyp/js2c.stamp
+
+# Make sure our actions/rules run before any of us.
+$(OBJS): | $(action_v8_snapshot_run_mksnapshot_outputs)
+
+# CFLAGS et al overrides must be target-local.
+# See "Target-specific Variable Values" in the GNU Make manual.
+$(OBJS): TOOLSET := $(TOOLSET)
+$(OBJS): GYP_CFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE)) $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_C_$(BUILDTYPE))
+$(OBJS): GYP_CXXFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE)) $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_CC_$(BUILDTYPE))
+
+# Suffix rules, putting all outputs into $(obj).
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(srcdir)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# Try building from generated source, too.
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj).$(TOOLSET)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# End of this set of suffix rules
+### Rules for final target.
+# Build our special outputs first.
+$(obj).target/deps/v8/tools/gyp/libv8_snapshot.a: | $(action_v8_snapshot_run_mksnapshot_outputs)
+
+# Preserve order dependency of special output on deps.
+$(action_v8_snapshot_run_mksnapshot_outputs): | $(builddir)/mksnapshot $(obj).host/deps/v8/tools/gyp/js2c.stamp
+
+LDFLAGS_Debug := -pthread
+
+LDFLAGS_Release := -pthread
+
+LIBS := -lz
+
+$(obj).target/deps/v8/tools/gyp/libv8_snapshot.a: GYP_LDFLAGS := $(LDFLAGS_$(BUILDTYPE))
+$(obj).target/deps/v8/tools/gyp/libv8_snapshot.a: LIBS := $(LIBS)
+$(obj).target/deps/v8/tools/gyp/libv8_snapshot.a: TOOLSET := $(TOOLSET)
+$(obj).target/deps/v8/tools/gyp/libv8_snapshot.a: $(OBJS) FORCE_DO_CMD
+	$(call do_cmd,alink)
+
+all_deps += $(obj).target/deps/v8/tools/gyp/libv8_snapshot.a
+# Add target alias
+.PHONY: v8_snapshot
+v8_snapshot: $(obj).target/deps/v8/tools/gyp/libv8_snapshot.a
+
@@ -0,0 +1,108 @@
+# This file is generated by gyp; do not edit.
+
+TOOLSET := target
+TARGET := zlib
+DEFS_Debug := '-DV8_SHARED=1' \
+	'-DDEBUG' \
+	'-D_DEBUG'
+
+# Flags passed to all source files.
+CFLAGS_Debug := -Wall \
+	-pthread \
+	-fvisibility=hidden \
+	-g \
+	-O0
+
+# Flags passed to only C files.
+CFLAGS_C_Debug := 
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Debug := -fno-rtti \
+	-fno-exceptions
+
+INCS_Debug := -I$(srcdir)/deps/zlib \
+	-I$(srcdir)/deps/zlib/contrib/minizip
+
+DEFS_Release := '-DV8_SHARED=1' \
+	'-DNDEBUG'
+
+# Flags passed to all source files.
+CFLAGS_Release := -Wall \
+	-pthread \
+	-fvisibility=hidden \
+	-O3 \
+	-fomit-frame-pointer \
+	-fdata-sections \
+	-ffunction-sections
+
+# Flags passed to only C files.
+CFLAGS_C_Release := 
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Release := -fno-rtti \
+	-fno-exceptions
+
+INCS_Release := -I$(srcdir)/deps/zlib \
+	-I$(srcdir)/deps/zlib/contrib/minizip
+
+OBJS := $(obj).target/$(TARGET)/deps/zlib/contrib/minizip/ioapi.o \
+	$(obj).target/$(TARGET)/deps/zlib/contrib/minizip/unzip.o \
+	$(obj).target/$(TARGET)/deps/zlib/contrib/minizip/zip.o \
+	$(obj).target/$(TARGET)/deps/zlib/adler32.o \
+	$(obj).target/$(TARGET)/deps/zlib/compress.o \
+	$(obj).target/$(TARGET)/deps/zlib/crc32.o \
+	$(obj).target/$(TARGET)/deps/zlib/deflate.o \
+	$(obj).target/$(TARGET)/deps/zlib/gzio.o \
+	$(obj).target/$(TARGET)/deps/zlib/infback.o \
+	$(obj).target/$(TARGET)/deps/zlib/inffast.o \
+	$(obj).target/$(TARGET)/deps/zlib/inflate.o \
+	$(obj).target/$(TARGET)/deps/zlib/inftrees.o \
+	$(obj).target/$(TARGET)/deps/zlib/trees.o \
+	$(obj).target/$(TARGET)/deps/zlib/uncompr.o \
+	$(obj).target/$(TARGET)/deps/zlib/zutil.o
+
+# Add to the list of files we specially track dependencies for.
+all_deps += $(OBJS)
+
+# CFLAGS et al overrides must be target-local.
+# See "Target-specific Variable Values" in the GNU Make manual.
+$(OBJS): TOOLSET := $(TOOLSET)
+$(OBJS): GYP_CFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE)) $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_C_$(BUILDTYPE))
+$(OBJS): GYP_CXXFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE)) $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_CC_$(BUILDTYPE))
+
+# Suffix rules, putting all outputs into $(obj).
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(srcdir)/%.c FORCE_DO_CMD
+	@$(call do_cmd,cc,1)
+
+# Try building from generated source, too.
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj).$(TOOLSET)/%.c FORCE_DO_CMD
+	@$(call do_cmd,cc,1)
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj)/%.c FORCE_DO_CMD
+	@$(call do_cmd,cc,1)
+
+# End of this set of suffix rules
+### Rules for final target.
+LDFLAGS_Debug := -pthread
+
+LDFLAGS_Release := -pthread
+
+LIBS := -lz
+
+$(obj).target/deps/zlib/libchrome_zlib.a: GYP_LDFLAGS := $(LDFLAGS_$(BUILDTYPE))
+$(obj).target/deps/zlib/libchrome_zlib.a: LIBS := $(LIBS)
+$(obj).target/deps/zlib/libchrome_zlib.a: TOOLSET := $(TOOLSET)
+$(obj).target/deps/zlib/libchrome_zlib.a: $(OBJS) FORCE_DO_CMD
+	$(call do_cmd,alink)
+
+all_deps += $(obj).target/deps/zlib/libchrome_zlib.a
+# Add target alias
+.PHONY: zlib
+zlib: $(obj).target/deps/zlib/libchrome_zlib.a
+
+# Add target alias to "all" target.
+.PHONY: all
+all: zlib
+
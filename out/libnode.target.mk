@@ -0,0 +1,170 @@
+# This file is generated by gyp; do not edit.
+
+TOOLSET := target
+TARGET := libnode
+DEFS_Debug := '-DV8_SHARED=1' \
+	'-DARCH="x64"' \
+	'-DPLATFORM="linux"' \
+	'-D_LARGEFILE_SOURCE' \
+	'-D_FILE_OFFSET_BITS=64' \
+	'-DHAVE_OPENSSL=0' \
+	'-DNODE_FORK_ISOLATE' \
+	'-DNODE_LIBRARY' \
+	'-D__POSIX__' \
+	'-DDEBUG' \
+	'-D_DEBUG'
+
+# Flags passed to all source files.
+CFLAGS_Debug := -Wall \
+	-pthread \
+	-ansi \
+	-fvisibility=hidden \
+	-g \
+	-O0
+
+# Flags passed to only C files.
+CFLAGS_C_Debug := 
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Debug := -fno-rtti \
+	-fno-exceptions
+
+INCS_Debug := -I$(srcdir)/src \
+	-I$(srcdir)/deps/uv/src/ares \
+	-I$(obj)/gen \
+	-I$(srcdir)/deps/http_parser \
+	-I$(srcdir)/deps/v8/include \
+	-I$(srcdir)/deps/uv/include \
+	-I$(srcdir)/deps/zlib
+
+DEFS_Release := '-DV8_SHARED=1' \
+	'-DARCH="x64"' \
+	'-DPLATFORM="linux"' \
+	'-D_LARGEFILE_SOURCE' \
+	'-D_FILE_OFFSET_BITS=64' \
+	'-DHAVE_OPENSSL=0' \
+	'-DNODE_FORK_ISOLATE' \
+	'-DNODE_LIBRARY' \
+	'-D__POSIX__' \
+	'-DNDEBUG'
+
+# Flags passed to all source files.
+CFLAGS_Release := -Wall \
+	-pthread \
+	-ansi \
+	-fvisibility=hidden \
+	-O3 \
+	-fomit-frame-pointer \
+	-fdata-sections \
+	-ffunction-sections
+
+# Flags passed to only C files.
+CFLAGS_C_Release := 
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Release := -fno-rtti \
+	-fno-exceptions
+
+INCS_Release := -I$(srcdir)/src \
+	-I$(srcdir)/deps/uv/src/ares \
+	-I$(obj)/gen \
+	-I$(srcdir)/deps/http_parser \
+	-I$(srcdir)/deps/v8/include \
+	-I$(srcdir)/deps/uv/include \
+	-I$(srcdir)/deps/zlib
+
+OBJS := $(obj).target/$(TARGET)/src/fs_event_wrap.o \
+	$(obj).target/$(TARGET)/src/cares_wrap.o \
+	$(obj).target/$(TARGET)/src/handle_wrap.o \
+	$(obj).target/$(TARGET)/src/node.o \
+	$(obj).target/$(TARGET)/src/node_buffer.o \
+	$(obj).target/$(TARGET)/src/node_codec.o \
+	$(obj).target/$(TARGET)/src/node_constants.o \
+	$(obj).target/$(TARGET)/src/node_extensions.o \
+	$(obj).target/$(TARGET)/src/node_file.o \
+	$(obj).target/$(TARGET)/src/node_http_parser.o \
+	$(obj).target/$(TARGET)/src/node_dns_cache.o \
+	$(obj).target/$(TARGET)/src/node_idle_gc.o \
+	$(obj).target/$(TARGET)/src/node_javascript.o \
+	$(obj).target/$(TARGET)/src/node_loop_stats.o \
+	$(obj).target/$(TARGET)/src/node_os.o \
+	$(obj).target/$(TARGET)/src/node_resolver.o \
+	$(obj).target/$(TARGET)/src/node_script.o \
+	$(obj).target/$(TARGET)/src/node_string.o \
+	$(obj).target/$(TARGET)/src/node_zlib.o \
+	$(obj).target/$(TARGET)/src/pipe_wrap.o \
+	$(obj).target/$(TARGET)/src/stream_wrap.o \
+	$(obj).target/$(TARGET)/src/tcp_wrap.o \
+	$(obj).target/$(TARGET)/src/timer_wrap.o \
+	$(obj).target/$(TARGET)/src/tty_wrap.o \
+	$(obj).target/$(TARGET)/src/process_wrap.o \
+	$(obj).target/$(TARGET)/src/v8_typed_array.o \
+	$(obj).target/$(TARGET)/src/udp_wrap.o \
+	$(obj).target/$(TARGET)/src/isolate_channel.o \
+	$(obj).target/$(TARGET)/src/node_signal_watcher.o \
+	$(obj).target/$(TARGET)/src/node_stat_watcher.o \
+	$(obj).target/$(TARGET)/src/node_io_watcher.o \
+	$(obj).target/$(TARGET)/src/platform_linux.o
+
+# Add to the list of files we specially track dependencies for.
+all_deps += $(OBJS)
+
+# Make sure our dependencies are built before any of us.
+$(OBJS): | $(obj).target/deps/http_parser/libhttp_parser.a $(obj).target/deps/v8/tools/gyp/v8.stamp $(obj).target/deps/uv/libuv.a $(obj).target/deps/zlib/libchrome_zlib.a $(obj).host/node_js2c.stamp $(obj).target/deps/v8/tools/gyp/libv8_nosnapshot.a $(obj).target/deps/v8/tools/gyp/libv8_base.a $(obj).host/deps/v8/tools/gyp/js2c.stamp
+
+# CFLAGS et al overrides must be target-local.
+# See "Target-specific Variable Values" in the GNU Make manual.
+$(OBJS): TOOLSET := $(TOOLSET)
+$(OBJS): GYP_CFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE)) $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_C_$(BUILDTYPE))
+$(OBJS): GYP_CXXFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE)) $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_CC_$(BUILDTYPE))
+
+# Suffix rules, putting all outputs into $(obj).
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(srcdir)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# Try building from generated source, too.
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj).$(TOOLSET)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# End of this set of suffix rules
+### Rules for final target.
+LDFLAGS_Debug := -pthread
+
+LDFLAGS_Release := -pthread
+
+LIBS := -lz \
+	-ldl \
+	-lutil \
+	-lrt
+
+$(obj).target/libnode.so: GYP_LDFLAGS := $(LDFLAGS_$(BUILDTYPE))
+$(obj).target/libnode.so: LIBS := $(LIBS)
+$(obj).target/libnode.so: LD_INPUTS := $(OBJS) $(obj).target/deps/http_parser/libhttp_parser.a $(obj).target/deps/uv/libuv.a $(obj).target/deps/zlib/libchrome_zlib.a $(obj).target/deps/v8/tools/gyp/libv8_nosnapshot.a $(obj).target/deps/v8/tools/gyp/libv8_base.a
+$(obj).target/libnode.so: TOOLSET := $(TOOLSET)
+$(obj).target/libnode.so: $(OBJS) $(obj).target/deps/http_parser/libhttp_parser.a $(obj).target/deps/uv/libuv.a $(obj).target/deps/zlib/libchrome_zlib.a $(obj).target/deps/v8/tools/gyp/libv8_nosnapshot.a $(obj).target/deps/v8/tools/gyp/libv8_base.a FORCE_DO_CMD
+	$(call do_cmd,solink)
+
+all_deps += $(obj).target/libnode.so
+# Add target alias
+.PHONY: libnode
+libnode: $(builddir)/lib.target/libnode.so
+
+# Copy this to the shared library output path.
+$(builddir)/lib.target/libnode.so: TOOLSET := $(TOOLSET)
+$(builddir)/lib.target/libnode.so: $(obj).target/libnode.so FORCE_DO_CMD
+	$(call do_cmd,copy)
+
+all_deps += $(builddir)/lib.target/libnode.so
+# Short alias for building this shared library.
+.PHONY: libnode.so
+libnode.so: $(obj).target/libnode.so $(builddir)/lib.target/libnode.so
+
+# Add shared library to "all" target.
+.PHONY: all
+all: $(builddir)/lib.target/libnode.so
+
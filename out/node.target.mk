@@ -0,0 +1,112 @@
+# This file is generated by gyp; do not edit.
+
+TOOLSET := target
+TARGET := node
+DEFS_Debug := '-DV8_SHARED=1' \
+	'-DARCH="x64"' \
+	'-DPLATFORM="linux"' \
+	'-D_LARGEFILE_SOURCE' \
+	'-D_FILE_OFFSET_BITS=64' \
+	'-DDEBUG' \
+	'-D_DEBUG'
+
+# Flags passed to all source files.
+CFLAGS_Debug := -Wall \
+	-pthread \
+	-ansi \
+	-fvisibility=hidden \
+	-g \
+	-O0
+
+# Flags passed to only C files.
+CFLAGS_C_Debug := 
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Debug := -fno-rtti \
+	-fno-exceptions
+
+INCS_Debug := -I$(srcdir)/src \
+	-I$(srcdir)/deps/v8/include \
+	-I$(srcdir)/deps/uv/include
+
+DEFS_Release := '-DV8_SHARED=1' \
+	'-DARCH="x64"' \
+	'-DPLATFORM="linux"' \
+	'-D_LARGEFILE_SOURCE' \
+	'-D_FILE_OFFSET_BITS=64' \
+	'-DNDEBUG'
+
+# Flags passed to all source files.
+CFLAGS_Release := -Wall \
+	-pthread \
+	-ansi \
+	-fvisibility=hidden \
+	-O3 \
+	-fomit-frame-pointer \
+	-fdata-sections \
+	-ffunction-sections
+
+# Flags passed to only C files.
+CFLAGS_C_Release := 
+
+# Flags passed to only C++ files.
+CFLAGS_CC_Release := -fno-rtti \
+	-fno-exceptions
+
+INCS_Release := -I$(srcdir)/src \
+	-I$(srcdir)/deps/v8/include \
+	-I$(srcdir)/deps/uv/include
+
+OBJS := $(obj).target/$(TARGET)/src/node_main.o
+
+# Add to the list of files we specially track dependencies for.
+all_deps += $(OBJS)
+
+# Make sure our dependencies are built before any of us.
+$(OBJS): | $(builddir)/lib.target/libnode.so $(obj).target/libnode.so
+
+# CFLAGS et al overrides must be target-local.
+# See "Target-specific Variable Values" in the GNU Make manual.
+$(OBJS): TOOLSET := $(TOOLSET)
+$(OBJS): GYP_CFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE)) $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_C_$(BUILDTYPE))
+$(OBJS): GYP_CXXFLAGS := $(DEFS_$(BUILDTYPE)) $(INCS_$(BUILDTYPE)) $(CFLAGS_$(BUILDTYPE)) $(CFLAGS_CC_$(BUILDTYPE))
+
+# Suffix rules, putting all outputs into $(obj).
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(srcdir)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# Try building from generated source, too.
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj).$(TOOLSET)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+$(obj).$(TOOLSET)/$(TARGET)/%.o: $(obj)/%.cc FORCE_DO_CMD
+	@$(call do_cmd,cxx,1)
+
+# End of this set of suffix rules
+### Rules for final target.
+LDFLAGS_Debug := -pthread \
+	-Wl,-rpath=\$$ORIGIN/lib.target/
+
+LDFLAGS_Release := -pthread \
+	-Wl,-rpath=\$$ORIGIN/lib.target/
+
+LIBS := -lz
+
+$(builddir)/node: GYP_LDFLAGS := $(LDFLAGS_$(BUILDTYPE))
+$(builddir)/node: LIBS := $(LIBS)
+$(builddir)/node: LD_INPUTS := $(OBJS) $(obj).target/libnode.so
+$(builddir)/node: TOOLSET := $(TOOLSET)
+$(builddir)/node: $(OBJS) $(obj).target/libnode.so FORCE_DO_CMD
+	$(call do_cmd,link)
+
+all_deps += $(builddir)/node
+# Add target alias
+.PHONY: node
+node: $(builddir)/node
+
+# Add executable to "all" target.
+.PHONY: all
+all: $(builddir)/node
+
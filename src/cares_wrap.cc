@@ -21,10 +21,13 @@
 
 #include <assert.h>
 #include <node.h>
+#include <node_dns_cache.h>
 #include <node_statics.h>
 #include <req_wrap.h>
 #include <uv.h>
 
+#include <ctype.h>
+#include <stdlib.h>
 #include <string.h>
 
 #if defined(__OpenBSD__) || defined(__MINGW32__) || defined(_MSC_VER) || defined(ANDROID)
@@ -67,12 +70,32 @@ using v8::Persistent;
 using v8::String;
 using v8::Value;
 
+class QueryWrap;
+
+// Resolutions that coalesce with one already in flight for the same name
+// wait on it; the first one to start does the work and hands its answer to
+// the rest.
+struct Waiter {
+  Waiter* next;
+  Persistent<Object> object;
+  QueryWrap* query;  // deleted once the answer is delivered, if not NULL
+};
+
+struct InFlight {
+  InFlight* next;
+  DnsCache::Type type;
+  char* name;
+  Waiter* waiters;  // in reverse order of arrival
+};
+
 class CaresWrapStatics : public ModuleStatics {
 public:
     Persistent<String> oncomplete_sym;
     struct ares_channeldata *ares_channel;
+    InFlight* inflight;
     CaresWrapStatics() {
       ares_channel = 0;
+      inflight = NULL;
     }
 };
 
@@ -151,12 +174,147 @@ static void SetAresErrno(int errorno) {
 }
 
 
+static bool IsQuery(DnsCache::Type type) {
+  return type == DnsCache::QUERY_A || type == DnsCache::QUERY_AAAA;
+}
+
+
+// Calls `object`'s oncomplete the way lookups or queries of `type` do.
+static void Deliver(DnsCache::Type type,
+                    Handle<Object> object,
+                    const DnsCache::Answer* a) {
+  HandleScope scope;
+  Local<Value> argv[2];
+  int argc = 1;
+
+  if (a->error) {
+    if (IsQuery(type)) {
+      SetAresErrno(a->error);
+      argv[0] = Integer::New(-1);
+    } else {
+      uv_err_t err;
+      err.code = static_cast<uv_err_code>(a->error);
+      err.sys_errno_ = a->sys_error;
+      SetErrno(err);
+      argv[0] = Local<Value>::New(Null());
+    }
+  } else {
+    Local<Array> addresses = Array::New(a->count);
+    const char* address = const_cast<DnsCache::Answer*>(a)->Data();
+    for (int i = 0; i < a->count; i++) {
+      addresses->Set(i, String::New(address));
+      address += strlen(address) + 1;
+    }
+
+    if (IsQuery(type)) {
+      argv[0] = Integer::New(0);
+      argv[1] = addresses;
+      argc = 2;
+    } else {
+      argv[0] = addresses;
+    }
+  }
+
+  MakeCallback(object, "oncomplete", argc, argv);
+}
+
+
+// Host names are case insensitive.
+static bool SameName(const char* a, const char* b) {
+  while (*a && tolower(static_cast<unsigned char>(*a)) ==
+               tolower(static_cast<unsigned char>(*b))) {
+    a++;
+    b++;
+  }
+  return *a == *b;
+}
+
+
+static InFlight* FindInFlight(DnsCache::Type type, const char* name) {
+  CaresWrapStatics *statics = NODE_STATICS_GET(node_cares_wrap, CaresWrapStatics);
+  for (InFlight* f = statics->inflight; f; f = f->next) {
+    if (f->type == type && SameName(f->name, name)) return f;
+  }
+  return NULL;
+}
+
+
+static InFlight* BeginInFlight(DnsCache::Type type, const char* name) {
+  CaresWrapStatics *statics = NODE_STATICS_GET(node_cares_wrap, CaresWrapStatics);
+  InFlight* f = new InFlight;
+  f->type = type;
+  f->name = strdup(name);
+  f->waiters = NULL;
+  f->next = statics->inflight;
+  statics->inflight = f;
+  return f;
+}
+
+
+static void AddWaiter(InFlight* f, Handle<Object> object, QueryWrap* query) {
+  Waiter* w = new Waiter;
+  w->object = Persistent<Object>::New(object);
+  w->query = query;
+  w->next = f->waiters;
+  f->waiters = w;
+  DnsCache::CountCoalesced();
+}
+
+
+static void DeleteQueryWrap(QueryWrap* wrap);
+
+// Hands `a` to `leader`, the resolution that did the work, and if it was
+// started through the cache, caches `a` and hands it to everyone waiting on
+// `f` too. `f` is done with before any callback runs, so that resolutions
+// started from them do not wait on it.
+static void Finish(DnsCache::Type type,
+                   InFlight* f,
+                   Handle<Object> leader,
+                   const DnsCache::Answer* a,
+                   unsigned int ttl) {
+  if (f == NULL) {
+    Deliver(type, leader, a);
+    return;
+  }
+
+  CaresWrapStatics *statics = NODE_STATICS_GET(node_cares_wrap, CaresWrapStatics);
+  InFlight** link = &statics->inflight;
+  while (*link != f) link = &(*link)->next;
+  *link = f->next;
+
+  DnsCache::Put(f->type, f->name, a, ttl);
+  Deliver(type, leader, a);
+
+  // Reverse the list so that waiters get their answers in order.
+  Waiter* w = NULL;
+  while (f->waiters) {
+    Waiter* next = f->waiters->next;
+    f->waiters->next = w;
+    w = f->waiters;
+    f->waiters = next;
+  }
+
+  while (w) {
+    Waiter* next = w->next;
+    Deliver(type, w->object, a);
+    w->object.Dispose();
+    if (w->query) DeleteQueryWrap(w->query);
+    delete w;
+    w = next;
+  }
+
+  free(f->name);
+  delete f;
+}
+
+
 class QueryWrap {
  public:
   QueryWrap() {
     HandleScope scope;
 
     object_ = Persistent<Object>::New(Object::New());
+    inflight_ = NULL;
   }
 
   virtual ~QueryWrap() {
@@ -194,12 +352,51 @@ class QueryWrap {
     return static_cast<void*>(this);
   }
 
+  // Answers from the cache, or waits for a query for the same name that is
+  // already in flight. Returns false if the query has to be sent; this may
+  // be deleted otherwise.
+  bool Lookup(DnsCache::Type type, const char* name) {
+    if (!DnsCache::Enabled()) return false;
+
+    DnsCache::Answer* a = DnsCache::Get(type, name);
+    if (a) {
+      Deliver(type, object_, a);
+      DnsCache::FreeAnswer(a);
+      delete this;
+      return true;
+    }
+
+    InFlight* f = FindInFlight(type, name);
+    if (f) {
+      AddWaiter(f, object_, this);
+      return true;
+    }
+
+    inflight_ = BeginInFlight(type, name);
+    return false;
+  }
+
+  // Delivers the answer to a query sent after Lookup(), and takes
+  // ownership of it.
+  void Complete(DnsCache::Type type, DnsCache::Answer* a, unsigned int ttl) {
+    Finish(type, inflight_, object_, a, ttl);
+    inflight_ = NULL;
+    DnsCache::FreeAnswer(a);
+  }
+
   static void Callback(void *arg, int status, int timeouts,
       unsigned char* answer_buf, int answer_len) {
     QueryWrap* wrap = reinterpret_cast<QueryWrap*>(arg);
 
     if (status != ARES_SUCCESS) {
-      wrap->ParseError(status);
+      if (wrap->inflight_) {
+        InFlight* f = wrap->inflight_;
+        DnsCache::Answer* a = DnsCache::NewError(status, 0);
+        Finish(f->type, f, wrap->object_, a, 0);
+        DnsCache::FreeAnswer(a);
+      } else {
+        wrap->ParseError(status);
+      }
     } else {
       wrap->Parse(answer_buf, answer_len);
     }
@@ -252,12 +449,49 @@ class QueryWrap {
 
  private:
   Persistent<Object> object_;
+  InFlight* inflight_;
 };
 
 
+static void DeleteQueryWrap(QueryWrap* wrap) {
+  delete wrap;
+}
+
+
+// The smallest TTL in an A or AAAA reply, in seconds.
+template <typename T>
+static unsigned int MinTtl(const T* addrttls, int naddrttls) {
+  unsigned int ttl = 0;
+  for (int i = 0; i < naddrttls; i++) {
+    unsigned int t = addrttls[i].ttl > 0 ? addrttls[i].ttl : 0;
+    if (i == 0 || t < ttl) ttl = t;
+  }
+  return ttl;
+}
+
+
+static DnsCache::Answer* HostentToAnswer(struct hostent* host) {
+  DnsCache::Answer* a = DnsCache::NewAnswer();
+
+  char ip[INET6_ADDRSTRLEN];
+  for (int i = 0; host->h_addr_list[i]; ++i) {
+    uv_inet_ntop(host->h_addrtype, host->h_addr_list[i], ip, sizeof(ip));
+    a = DnsCache::AddAddress(a, ip);
+  }
+
+  return a;
+}
+
+
+// Addresses beyond this many still get answered, but their TTLs are not
+// looked at.
+static const int kMaxAddrTtls = 32;
+
+
 class QueryAWrap: public QueryWrap {
  public:
   int Send(const char* name) {
+    if (Lookup(DnsCache::QUERY_A, name)) return 0;
     CaresWrapStatics *statics = NODE_STATICS_GET(node_cares_wrap, CaresWrapStatics);
     ares_query(statics->ares_channel, name, ns_c_in, ns_t_a, Callback, GetQueryArg());
     return 0;
@@ -268,17 +502,19 @@ class QueryAWrap: public QueryWrap {
     HandleScope scope;
 
     struct hostent* host;
+    struct ares_addrttl addrttls[kMaxAddrTtls];
+    int naddrttls = kMaxAddrTtls;
 
-    int status = ares_parse_a_reply(buf, len, &host, NULL, NULL);
+    int status = ares_parse_a_reply(buf, len, &host, addrttls, &naddrttls);
     if (status != ARES_SUCCESS) {
-      this->ParseError(status);
+      this->Complete(DnsCache::QUERY_A, DnsCache::NewError(status, 0), 0);
       return;
     }
 
-    Local<Array> addresses = HostentToAddresses(host);
+    DnsCache::Answer* a = HostentToAnswer(host);
     ares_free_hostent(host);
 
-    this->CallOnComplete(addresses);
+    this->Complete(DnsCache::QUERY_A, a, MinTtl(addrttls, naddrttls));
   }
 };
 
@@ -286,6 +522,7 @@ class QueryAWrap: public QueryWrap {
 class QueryAaaaWrap: public QueryWrap {
  public:
   int Send(const char* name) {
+    if (Lookup(DnsCache::QUERY_AAAA, name)) return 0;
     CaresWrapStatics *statics = NODE_STATICS_GET(node_cares_wrap, CaresWrapStatics);
     ares_query(statics->ares_channel,
                name,
@@ -301,17 +538,19 @@ class QueryAaaaWrap: public QueryWrap {
     HandleScope scope;
 
     struct hostent* host;
+    struct ares_addr6ttl addrttls[kMaxAddrTtls];
+    int naddrttls = kMaxAddrTtls;
 
-    int status = ares_parse_aaaa_reply(buf, len, &host, NULL, NULL);
+    int status = ares_parse_aaaa_reply(buf, len, &host, addrttls, &naddrttls);
     if (status != ARES_SUCCESS) {
-      this->ParseError(status);
+      this->Complete(DnsCache::QUERY_AAAA, DnsCache::NewError(status, 0), 0);
       return;
     }
 
-    Local<Array> addresses = HostentToAddresses(host);
+    DnsCache::Answer* a = HostentToAnswer(host);
     ares_free_hostent(host);
 
-    this->CallOnComplete(addresses);
+    this->Complete(DnsCache::QUERY_AAAA, a, MinTtl(addrttls, naddrttls));
   }
 };
 
@@ -616,33 +855,23 @@ void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
   HandleScope scope;
 
   GetAddrInfoReqWrap* req_wrap = (GetAddrInfoReqWrap*) req->data;
+  InFlight* f = static_cast<InFlight*>(req_wrap->data_);
 
-  Local<Value> argv[1];
+  DnsCache::Answer* a;
 
   if (status) {
     // Error
-    SetLastErrno();
-    argv[0] = Local<Value>::New(Null());
+    uv_err_t err = uv_last_error(Isolate::GetCurrentLoop());
+    a = DnsCache::NewError(err.code, err.sys_errno_);
   } else {
     // Success
-    struct addrinfo *address;
-    int n = 0;
-
-    // Count the number of responses.
-    for (address = res; address; address = address->ai_next) {
-      n++;
-    }
-
-    // Create the response array.
-    Local<Array> results = Array::New(n);
+    a = DnsCache::NewAnswer();
 
     char ip[INET6_ADDRSTRLEN];
     const char *addr;
+    struct addrinfo *address;
 
-    n = 0;
-
-    // Iterate over the IPv4 responses again this time creating javascript
-    // strings for each IP and filling the results array.
+    // Iterate over the IPv4 responses first, then over the IPv6 ones.
     address = res;
     while (address) {
       assert(address->ai_socktype == SOCK_STREAM);
@@ -651,20 +880,14 @@ void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
       if (address->ai_family == AF_INET) {
         // Juggle pointers
         addr = (char*) &((struct sockaddr_in*) address->ai_addr)->sin_addr;
-        const char* c = uv_inet_ntop(address->ai_family, addr, ip,
-            INET6_ADDRSTRLEN);
-
-        // Create JavaScript string
-        Local<String> s = String::New(c);
-        results->Set(n, s);
-        n++;
+        a = DnsCache::AddAddress(a, uv_inet_ntop(address->ai_family, addr, ip,
+            INET6_ADDRSTRLEN));
       }
 
       // Increment
       address = address->ai_next;
     }
 
-    // Iterate over the IPv6 responses putting them in the array.
     address = res;
     while (address) {
       assert(address->ai_socktype == SOCK_STREAM);
@@ -673,51 +896,75 @@ void AfterGetAddrInfo(uv_getaddrinfo_t* req, int status, struct addrinfo* res) {
       if (address->ai_family == AF_INET6) {
         // Juggle pointers
         addr = (char*) &((struct sockaddr_in6*) address->ai_addr)->sin6_addr;
-        const char* c = uv_inet_ntop(address->ai_family, addr, ip,
-            INET6_ADDRSTRLEN);
-
-        // Create JavaScript string
-        Local<String> s = String::New(c);
-        results->Set(n, s);
-        n++;
+        a = DnsCache::AddAddress(a, uv_inet_ntop(address->ai_family, addr, ip,
+            INET6_ADDRSTRLEN));
       }
 
       // Increment
       address = address->ai_next;
     }
-
-
-    argv[0] = results;
   }
 
   uv_freeaddrinfo(res);
 
   // Make the callback into JavaScript
-  MakeCallback(req_wrap->object_, "oncomplete", 1, argv);
+  Finish(DnsCache::LOOKUP_ANY, f, req_wrap->object_, a, 0);
 
+  DnsCache::FreeAnswer(a);
   delete req_wrap;
 }
 
 
+// getaddrinfo(hostname, family, [oncomplete])
+//
+// Lookups that pass oncomplete may be answered from the cache before this
+// returns, or wait for a lookup of the same name already in flight.
 static Handle<Value> GetAddrInfo(const Arguments& args) {
   HandleScope scope;
 
   String::Utf8Value hostname(args[0]->ToString());
 
   int fam = AF_UNSPEC;
+  DnsCache::Type type = DnsCache::LOOKUP_ANY;
   if (args[1]->IsInt32()) {
     switch (args[1]->Int32Value()) {
       case 6:
         fam = AF_INET6;
+        type = DnsCache::LOOKUP_INET6;
         break;
 
       case 4:
         fam = AF_INET;
+        type = DnsCache::LOOKUP_INET;
         break;
     }
   }
 
+  bool cached = args[2]->IsFunction() && DnsCache::Enabled();
+
+  if (cached) {
+    CaresWrapStatics *statics = NODE_STATICS_GET(node_cares_wrap, CaresWrapStatics);
+    DnsCache::Answer* a = DnsCache::Get(type, *hostname);
+    InFlight* f = a ? NULL : FindInFlight(type, *hostname);
+
+    if (a || f) {
+      Local<Object> object = Object::New();
+      object->Set(statics->oncomplete_sym, args[2]);
+      if (a) {
+        Deliver(type, object, a);
+        DnsCache::FreeAnswer(a);
+      } else {
+        AddWaiter(f, object, NULL);
+      }
+      return scope.Close(object);
+    }
+  }
+
   GetAddrInfoReqWrap* req_wrap = new GetAddrInfoReqWrap();
+  if (args[2]->IsFunction()) {
+    CaresWrapStatics *statics = NODE_STATICS_GET(node_cares_wrap, CaresWrapStatics);
+    req_wrap->object_->Set(statics->oncomplete_sym, args[2]);
+  }
 
   struct addrinfo hints;
   memset(&hints, 0, sizeof(struct addrinfo));
@@ -737,6 +984,7 @@ static Handle<Value> GetAddrInfo(const Arguments& args) {
     delete req_wrap;
     return scope.Close(v8::Null());
   } else {
+    if (cached) req_wrap->data_ = BeginInFlight(type, *hostname);
     return scope.Close(req_wrap->object_);
   }
 }
@@ -766,6 +1014,10 @@ static void Initialize(Handle<Object> target) {
 
   NODE_SET_METHOD(target, "getaddrinfo", GetAddrInfo);
 
+  NODE_SET_METHOD(target, "setCacheOptions", DnsCache::SetOptions);
+  NODE_SET_METHOD(target, "getCacheStats", DnsCache::GetStats);
+  NODE_SET_METHOD(target, "clearCache", DnsCache::Clear);
+
   target->Set(String::NewSymbol("AF_INET"), Integer::New(AF_INET));
   target->Set(String::NewSymbol("AF_INET6"), Integer::New(AF_INET6));
   target->Set(String::NewSymbol("AF_UNSPEC"), Integer::New(AF_UNSPEC));
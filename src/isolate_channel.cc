@@ -0,0 +1,513 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <node.h>
+#include <node_buffer.h>
+#include <handle_wrap.h>
+#include <stream_wrap.h>
+#include <tcp_wrap.h>
+#include <isolate_channel.h>
+
+#include <stdlib.h> // malloc, free
+#include <string.h> // memcpy, memset
+#include <unistd.h> // dup, close
+
+#define UNWRAP \
+  assert(!args.Holder().IsEmpty()); \
+  assert(args.Holder()->InternalFieldCount() > 0); \
+  ChannelWrap* wrap =  \
+      static_cast<ChannelWrap*>(args.Holder()->GetPointerFromInternalField(0)); \
+  if (!wrap) { \
+    uv_err_t err; \
+    err.code = UV_EBADF; \
+    SetErrno(err); \
+    return scope.Close(Integer::New(-1)); \
+  }
+
+namespace node {
+
+using v8::Object;
+using v8::Handle;
+using v8::Local;
+using v8::Persistent;
+using v8::Value;
+using v8::HandleScope;
+using v8::FunctionTemplate;
+using v8::Function;
+using v8::String;
+using v8::External;
+using v8::Arguments;
+using v8::Integer;
+
+
+IsolateChannel::IsolateChannel() {
+  memset(rings_, 0, sizeof(rings_));
+  asyncs_[PARENT] = asyncs_[CHILD] = NULL;
+  closed_[PARENT] = closed_[CHILD] = false;
+  refs_ = 1;
+  uv_mutex_init(&mutex_);
+}
+
+
+IsolateChannel::~IsolateChannel() {
+  Message* m;
+  while ((m = Shift(PARENT)) != NULL) FreeMessage(m);
+  while ((m = Shift(CHILD)) != NULL) FreeMessage(m);
+  uv_mutex_destroy(&mutex_);
+}
+
+
+IsolateChannel* IsolateChannel::New() {
+  return new IsolateChannel();
+}
+
+
+IsolateChannel::Message* IsolateChannel::NewMessage(const char* data,
+                                                    size_t length) {
+  // The payload lives right behind the header so that one allocation
+  // covers the whole message.
+  Message* m = static_cast<Message*>(malloc(sizeof(Message) + length));
+  if (m == NULL) return NULL;
+  m->next = NULL;
+  m->length = length;
+  m->fd = -1;
+  memcpy(m->Data(), data, length);
+  return m;
+}
+
+
+void IsolateChannel::FreeMessage(Message* m) {
+  if (m->fd >= 0) close(m->fd);
+  free(m);
+}
+
+
+void IsolateChannel::Ref() {
+  __sync_add_and_fetch(&refs_, 1);
+}
+
+
+void IsolateChannel::Unref() {
+  if (__sync_sub_and_fetch(&refs_, 1) == 0) delete this;
+}
+
+
+void IsolateChannel::Attach(Side side, uv_async_t* async) {
+  uv_mutex_lock(&mutex_);
+  asyncs_[side] = async;
+  uv_mutex_unlock(&mutex_);
+}
+
+
+void IsolateChannel::Detach(Side side) {
+  uv_mutex_lock(&mutex_);
+  asyncs_[side] = NULL;
+  closed_[side] = true;
+  if (asyncs_[Peer(side)]) uv_async_send(asyncs_[Peer(side)]);
+  uv_mutex_unlock(&mutex_);
+}
+
+
+void IsolateChannel::Wake(Side side) {
+  // The lock only guards against the other end going away between the
+  // check and the send; the rings themselves never take it.
+  uv_mutex_lock(&mutex_);
+  if (asyncs_[side]) uv_async_send(asyncs_[side]);
+  uv_mutex_unlock(&mutex_);
+}
+
+
+bool IsolateChannel::Push(Side from, Message* m) {
+  Ring& ring = rings_[from];
+  unsigned int tail = ring.tail;
+
+  if (tail - ring.head == kRingSize) {
+    // Full. Flag it and look again, in case the consumer drained the ring
+    // before it could see the flag.
+    ring.blocked = true;
+    __sync_synchronize();
+    if (tail - ring.head == kRingSize) return false;
+  }
+
+  ring.slots[tail & (kRingSize - 1)] = m;
+  __sync_synchronize();
+  ring.tail = tail + 1;
+  return true;
+}
+
+
+IsolateChannel::Message* IsolateChannel::Shift(Side to) {
+  Ring& ring = rings_[Peer(to)];
+  unsigned int head = ring.head;
+
+  if (head == ring.tail) return NULL;
+  __sync_synchronize();
+
+  Message* m = ring.slots[head & (kRingSize - 1)];
+  __sync_synchronize();
+  ring.head = head + 1;
+  return m;
+}
+
+
+bool IsolateChannel::ClearBlocked(Side from) {
+  __sync_synchronize();
+  if (!rings_[from].blocked) return false;
+  rings_[from].blocked = false;
+  return true;
+}
+
+
+class ChannelStatics : public ModuleStatics {
+  Persistent<Function> constructor;
+  Persistent<String> write_queue_size_sym;
+  friend class ChannelWrap;
+};
+
+
+// The JavaScript side of one end of an IsolateChannel. It mimics the parts
+// of an IPC PipeWrap that child_process uses (readStart, write, onread and
+// writeQueueSize) so it can be dropped in as a fork() transport.
+class ChannelWrap : public HandleWrap {
+ public:
+  static void Initialize(Handle<Object> target) {
+    NODE_STATICS_NEW(node_isolate_channel, ChannelStatics, statics);
+    HandleScope scope;
+
+    HandleWrap::Initialize(target);
+
+    Local<FunctionTemplate> constructor = FunctionTemplate::New(New);
+    constructor->InstanceTemplate()->SetInternalFieldCount(1);
+    constructor->SetClassName(String::NewSymbol("Channel"));
+
+    NODE_SET_PROTOTYPE_METHOD(constructor, "close", HandleWrap::Close);
+    NODE_SET_PROTOTYPE_METHOD(constructor, "readStart", ReadStart);
+    NODE_SET_PROTOTYPE_METHOD(constructor, "readStop", ReadStop);
+    NODE_SET_PROTOTYPE_METHOD(constructor, "write", Write);
+
+    statics->constructor =
+        Persistent<Function>::New(constructor->GetFunction());
+    statics->write_queue_size_sym = NODE_PSYMBOL("writeQueueSize");
+
+    target->Set(String::NewSymbol("Channel"), statics->constructor);
+    NODE_SET_METHOD(target, "parentChannel", ParentChannel);
+  }
+
+  static ChannelWrap* Unwrap(Handle<Object> obj) {
+    assert(!obj.IsEmpty());
+    assert(obj->InternalFieldCount() > 0);
+    return static_cast<ChannelWrap*>(obj->GetPointerFromInternalField(0));
+  }
+
+  IsolateChannel* channel_;
+
+ private:
+  static Handle<Value> New(const Arguments& args) {
+    // This constructor should not be exposed to public javascript.
+    // Therefore we assert that we are not trying to call this as a
+    // normal function.
+    assert(args.IsConstructCall());
+
+    HandleScope scope;
+    ChannelWrap* wrap;
+
+    if (args[0]->IsExternal()) {
+      // The child's end of a channel made by its parent.
+      IsolateChannel* channel =
+          static_cast<IsolateChannel*>(External::Unwrap(args[0]));
+      wrap = new ChannelWrap(args.This(), channel, IsolateChannel::CHILD);
+    } else {
+      wrap = new ChannelWrap(args.This(), IsolateChannel::New(),
+                             IsolateChannel::PARENT);
+    }
+    assert(wrap);
+
+    return scope.Close(args.This());
+  }
+
+  ChannelWrap(Handle<Object> object, IsolateChannel* channel,
+              IsolateChannel::Side side)
+      : HandleWrap(object, (uv_handle_t*) &handle_),
+        channel_(channel),
+        side_(side),
+        reading_(false),
+        eof_(false),
+        backlog_head_(NULL),
+        backlog_tail_(NULL),
+        backlog_size_(0) {
+    int r = uv_async_init(Isolate::GetCurrentLoop(), &handle_, OnAsync);
+    assert(r == 0);
+    handle_.data = this;
+    channel_->Attach(side_, &handle_);
+    UpdateWriteQueueSize();
+  }
+
+  ~ChannelWrap() {
+    while (backlog_head_) {
+      IsolateChannel::Message* m = backlog_head_;
+      backlog_head_ = m->next;
+      IsolateChannel::FreeMessage(m);
+    }
+    // The parent owns its channel. The child's end borrows the reference
+    // that was handed to its thread, which is dropped when the isolate
+    // exits.
+    if (side_ == IsolateChannel::PARENT) channel_->Unref();
+  }
+
+  // Called from HandleWrap::Close.
+  void StateChange() {
+    reading_ = false;
+    channel_->Detach(side_);
+  }
+
+  void UpdateWriteQueueSize() {
+    HandleScope scope;
+    ChannelStatics* statics =
+        NODE_STATICS_GET(node_isolate_channel, ChannelStatics);
+    object_->Set(statics->write_queue_size_sym,
+                 Integer::NewFromUnsigned(backlog_size_));
+  }
+
+  // Moves as much of the backlog as fits into the ring.
+  void Flush() {
+    bool pushed = false;
+
+    while (backlog_head_ && channel_->Push(side_, backlog_head_)) {
+      IsolateChannel::Message* m = backlog_head_;
+      backlog_head_ = m->next;
+      if (backlog_head_ == NULL) backlog_tail_ = NULL;
+      backlog_size_ -= m->length;
+      pushed = true;
+    }
+
+    if (pushed) channel_->Wake(IsolateChannel::Peer(side_));
+  }
+
+  void Send(IsolateChannel::Message* m) {
+    if (channel_->IsClosed(IsolateChannel::Peer(side_))) {
+      // Nobody is listening anymore; drop it like a write into a pipe
+      // whose reader went away.
+      IsolateChannel::FreeMessage(m);
+      return;
+    }
+
+    if (backlog_tail_) {
+      backlog_tail_->next = m;
+    } else {
+      backlog_head_ = m;
+    }
+    backlog_tail_ = m;
+    backlog_size_ += m->length;
+
+    Flush();
+  }
+
+  void Deliver(IsolateChannel::Message* m) {
+    HandleScope scope;
+
+    // Hand the block over to the Buffer as-is; it is freed when the
+    // Buffer is collected.
+    Buffer* b = Buffer::New(m->Data(), m->length, OnBufferFree, m);
+
+    int argc = 3;
+    Local<Value> argv[4] = {
+      Local<Value>::New(b->handle_),
+      Integer::New(0),
+      Integer::NewFromUnsigned(m->length)
+    };
+
+    if (m->fd >= 0) {
+      // Instantiate the client javascript object and handle.
+      Local<Object> pending_obj = TCPWrap::Instantiate();
+
+      // Unwrap the client javascript object.
+      assert(pending_obj->InternalFieldCount() > 0);
+      TCPWrap* pending_wrap =
+          static_cast<TCPWrap*>(pending_obj->GetPointerFromInternalField(0));
+
+      int r = uv_tcp_open((uv_tcp_t*) pending_wrap->GetStream(), m->fd);
+      assert(r == 0);
+      m->fd = -1;
+
+      argv[3] = pending_obj;
+      argc++;
+    }
+
+    MakeCallback(object_, "onread", argc, argv);
+  }
+
+  static void OnBufferFree(char* data, void* hint) {
+    IsolateChannel::FreeMessage(static_cast<IsolateChannel::Message*>(hint));
+  }
+
+  static void OnAsync(uv_async_t* handle, int status) {
+    HandleScope scope;
+
+    ChannelWrap* wrap = static_cast<ChannelWrap*>(handle->data);
+    assert(wrap);
+    assert(wrap->object_.IsEmpty() == false);
+
+    IsolateChannel* channel = wrap->channel_;
+    IsolateChannel::Side peer = IsolateChannel::Peer(wrap->side_);
+
+    // We may have been woken because the peer made room for our backlog.
+    if (wrap->backlog_head_) {
+      wrap->Flush();
+      wrap->UpdateWriteQueueSize();
+    }
+
+    if (!wrap->reading_) return;
+
+    // Look at the flag before draining: whatever the peer pushed before
+    // closing is then guaranteed to be read first.
+    bool peer_closed = channel->IsClosed(peer);
+    bool drained = false;
+    IsolateChannel::Message* m;
+
+    while (wrap->reading_ && (m = channel->Shift(wrap->side_)) != NULL) {
+      drained = true;
+      wrap->Deliver(m);
+    }
+
+    if (drained && channel->ClearBlocked(peer)) channel->Wake(peer);
+
+    if (wrap->reading_ && peer_closed && !wrap->eof_) {
+      wrap->eof_ = true;
+      uv_err_t err;
+      err.code = UV_EOF;
+      SetErrno(err);
+      MakeCallback(wrap->object_, "onread", 0, NULL);
+    }
+  }
+
+  static Handle<Value> ReadStart(const Arguments& args) {
+    HandleScope scope;
+
+    UNWRAP
+
+    wrap->reading_ = true;
+    // Pick up whatever arrived before we started listening.
+    uv_async_send(&wrap->handle_);
+
+    return scope.Close(Integer::New(0));
+  }
+
+  static Handle<Value> ReadStop(const Arguments& args) {
+    HandleScope scope;
+
+    UNWRAP
+
+    wrap->reading_ = false;
+
+    return scope.Close(Integer::New(0));
+  }
+
+  static Handle<Value> Write(const Arguments& args) {
+    HandleScope scope;
+
+    UNWRAP
+
+    // The first argument is a buffer.
+    assert(Buffer::HasInstance(args[0]));
+    Local<Object> buffer_obj = args[0]->ToObject();
+    size_t offset = 0;
+    size_t length = Buffer::Length(buffer_obj);
+
+    if (args.Length() > 1) {
+      offset = args[1]->IntegerValue();
+    }
+
+    if (args.Length() > 2) {
+      length = args[2]->IntegerValue();
+    }
+
+    IsolateChannel::Message* m =
+        IsolateChannel::NewMessage(Buffer::Data(buffer_obj) + offset, length);
+    if (m == NULL) {
+      uv_err_t err;
+      err.code = UV_ENOMEM;
+      SetErrno(err);
+      return scope.Close(v8::Null());
+    }
+
+    if (args[3]->IsObject()) {
+      // Both ends share the process' descriptor table, so passing a handle
+      // only takes a descriptor of its own for the receiver.
+      Local<Object> send_stream_obj = args[3]->ToObject();
+      assert(send_stream_obj->InternalFieldCount() > 0);
+      StreamWrap* send_stream_wrap = static_cast<StreamWrap*>(
+          send_stream_obj->GetPointerFromInternalField(0));
+      m->fd = dup(send_stream_wrap->GetStream()->fd);
+      if (m->fd < 0) {
+        uv_err_t err;
+        err.code = UV_EMFILE;
+        SetErrno(err);
+        IsolateChannel::FreeMessage(m);
+        return scope.Close(v8::Null());
+      }
+    }
+
+    wrap->Send(m);
+    wrap->UpdateWriteQueueSize();
+
+    // The data has been copied out of the buffer, so as far as the caller
+    // is concerned the write is done. Return a request object anyway to
+    // keep the PipeWrap interface.
+    return scope.Close(Object::New());
+  }
+
+  static Handle<Value> ParentChannel(const Arguments& args) {
+    HandleScope scope;
+    ChannelStatics* statics =
+        NODE_STATICS_GET(node_isolate_channel, ChannelStatics);
+    Isolate* isolate = Isolate::GetCurrent();
+
+    if (isolate->parent_channel == NULL) {
+      return scope.Close(v8::Null());
+    }
+
+    Local<Value> argv[1] = { External::New(isolate->parent_channel) };
+    // There is only one end to hand out.
+    isolate->parent_channel = NULL;
+
+    return scope.Close(statics->constructor->NewInstance(1, argv));
+  }
+
+  uv_async_t handle_;
+  IsolateChannel::Side side_;
+  bool reading_;
+  bool eof_;
+  // Messages that did not fit into the ring yet.
+  IsolateChannel::Message* backlog_head_;
+  IsolateChannel::Message* backlog_tail_;
+  size_t backlog_size_;
+};
+
+
+IsolateChannel* IsolateChannel::Unwrap(Handle<Object> obj) {
+  ChannelWrap* wrap = ChannelWrap::Unwrap(obj);
+  return wrap ? wrap->channel_ : NULL;
+}
+
+
+}  // namespace node
+
+NODE_MODULE(node_isolate_channel, node::ChannelWrap::Initialize)
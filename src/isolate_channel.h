@@ -0,0 +1,105 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef ISOLATE_CHANNEL_H_
+#define ISOLATE_CHANNEL_H_
+
+#include <uv.h>
+#include <v8.h>
+#include <stddef.h>
+
+namespace node {
+
+// A message channel between an isolate and a child isolate that it forked
+// in-process. Both ends live in the same address space so there is no need
+// to go through a socket: every message is a single heap block that is
+// handed over through a lock-free single-producer/single-consumer ring, and
+// the receiving loop is woken up with a uv_async_t.
+//
+// The channel is created by the parent, carried to the child thread on
+// uv_thread_shared_t.channel and is reference counted; it goes away when
+// both ends have let go of it.
+class IsolateChannel {
+ public:
+  enum Side { PARENT = 0, CHILD = 1 };
+
+  struct Message {
+    Message* next;  // only used for the writer's backlog
+    size_t length;
+    int fd;         // a handle passed along with the message, or -1
+    char* Data() { return reinterpret_cast<char*>(this + 1); }
+  };
+
+  static IsolateChannel* New();
+  static Message* NewMessage(const char* data, size_t length);
+  static void FreeMessage(Message* m);
+
+  // Returns the channel behind a JavaScript Channel object.
+  static IsolateChannel* Unwrap(v8::Handle<v8::Object> obj);
+
+  static Side Peer(Side side) { return side == PARENT ? CHILD : PARENT; }
+
+  void Ref();
+  void Unref();
+
+  // Registers the handle to wake up when a message arrives for `side`, or
+  // when the peer made room in a full ring.
+  void Attach(Side side, uv_async_t* async);
+  // Closes `side`. The peer sees EOF once it has drained the ring.
+  void Detach(Side side);
+  void Wake(Side side);
+
+  // Called from the thread owning `from`. Returns false when full.
+  bool Push(Side from, Message* m);
+  // Called from the thread owning `to`. Returns NULL when empty.
+  Message* Shift(Side to);
+
+  bool IsClosed(Side side) { return closed_[side]; }
+  // Called by the consumer after draining; true if the producer on `from`
+  // ran into a full ring since the last call and needs a wakeup.
+  bool ClearBlocked(Side from);
+
+ private:
+  IsolateChannel();
+  ~IsolateChannel();
+
+  static const unsigned int kRingSize = 256;  // must be a power of two
+
+  struct Ring {
+    Message* slots[kRingSize];
+    volatile unsigned int head;  // advanced by the consumer
+    volatile unsigned int tail;  // advanced by the producer
+    volatile bool blocked;       // the producer found the ring full
+  };
+
+  // rings_[PARENT] carries messages from the parent to the child.
+  Ring rings_[2];
+  uv_async_t* asyncs_[2];
+  volatile bool closed_[2];
+  volatile int refs_;
+  uv_mutex_t mutex_;
+};
+
+
+}  // namespace node
+
+
+#endif  // ISOLATE_CHANNEL_H_
@@ -74,6 +74,10 @@ typedef int mode_t;
 # include <node_io_watcher.h>
 #endif
 #include <node_file.h>
+#include <node_resolver.h>
+#include <node_dns_cache.h>
+#include <node_loop_stats.h>
+#include <node_idle_gc.h>
 #include <node_http_parser.h>
 #ifdef __POSIX__
 # include <node_signal_watcher.h>
@@ -88,6 +92,7 @@ typedef int mode_t;
 #endif
 
 #include <node_script.h>
+#include <stream_wrap.h>
 #include <v8_typed_array.h>
 
 using namespace v8;
@@ -109,37 +114,6 @@ uv_loop_t *Isolate::GetCurrentLoop() {return GetCurrent()->Loop();}
 
 bool need_gc;
 
-#define FAST_TICK 700.
-#define GC_WAIT_TIME 5000.
-#define RPM_SAMPLES 100
-#define TICK_TIME(n) tick_times[(tick_time_head - (n)) % RPM_SAMPLES]
-static int64_t tick_times[RPM_SAMPLES];
-
-void Isolate::StartGCTimer () {
-  if (!uv_is_active((uv_handle_t*) &gc_timer)) {
-    uv_timer_start(&gc_timer, CheckStatus, 5000, 5000);
-  }
-}
-
-void Isolate::StopGCTimer () {
-  if (uv_is_active((uv_handle_t*) &gc_timer)) {
-    uv_timer_stop(&gc_timer);
-  }
-}
-
-void Isolate::Idle(uv_idle_t* watcher, int status) {
-    static_cast<Isolate *>(watcher->data)->__Idle(watcher, status);
-}
-
-void Isolate::__Idle(uv_idle_t* watcher, int status) {
-  assert((uv_idle_t*) watcher == &gc_idle);
-
-  if (V8::IdleNotification()) {
-    uv_idle_stop(&gc_idle);
-    StopGCTimer();
-  }
-}
-
 
 // Called directly after every call to select() (or epoll, or whatever)
 void Isolate::Check(uv_check_t* watcher, int status) {
@@ -149,26 +123,8 @@ void Isolate::Check(uv_check_t* watcher, int status) {
 void Isolate::__Check(uv_check_t* watcher, int status) {
   assert(watcher == &gc_check);
 
-  tick_times[tick_time_head] = uv_now(Loop());
-  tick_time_head = (tick_time_head + 1) % RPM_SAMPLES;
-
-  StartGCTimer();
-
-  for (int i = 0; i < (int)(GC_WAIT_TIME/FAST_TICK); i++) {
-    double d = TICK_TIME(i+1) - TICK_TIME(i+2);
-    //printf("d = %f\n", d);
-    // If in the last 5 ticks the difference between
-    // ticks was less than 0.7 seconds, then continue.
-    if (d < FAST_TICK) {
-      //printf("---\n");
-      return;
-    }
-  }
-
-  // Otherwise start the gc!
-
-  //fprintf(stderr, "start idle 2\n");
-  uv_idle_start(&gc_idle, Idle);
+  loop_stats->PollEnd();
+  idle_gc->AfterPoll();
 }
 
 void Isolate::Tick(void) {
@@ -182,6 +138,7 @@ void Isolate::Tick(void) {
   }
 
   HandleScope scope;
+  LoopStatsScope stats_scope(LoopStats::PHASE_TICK, "_tickCallback");
 
   if (tick_callback_sym.IsEmpty()) {
     // Lazily set the symbol
@@ -236,7 +193,10 @@ void Isolate::PrepareTick(uv_prepare_t* handle, int status) {
 void Isolate::__PrepareTick(uv_prepare_t* handle, int status) {
   assert(handle == &prepare_tick_watcher);
   assert(status == 0);
+  loop_stats->Prepare();
   Tick();
+  idle_gc->BeforePoll();
+  loop_stats->PollStart();
 }
 
 void Isolate::CheckTick(uv_check_t* handle, int status) {
@@ -246,6 +206,8 @@ void Isolate::CheckTick(uv_check_t* handle, int status) {
 void Isolate::__CheckTick(uv_check_t* handle, int status) {
   assert(handle == &check_tick_watcher);
   assert(status == 0);
+  loop_stats->PollEnd();
+  idle_gc->AfterPoll();
   Tick();
 }
 
@@ -831,6 +793,7 @@ void MakeCallback(Handle<Object> object,
                   int argc,
                   Handle<Value> argv[]) {
   HandleScope scope;
+  LoopStatsScope stats_scope(LoopStats::PHASE_IO, method);
 
   Local<Value> callback_v = object->Get(String::New(method));
   if (!callback_v->IsFunction()) {
@@ -1097,20 +1060,16 @@ static void ReportException(TryCatch &try_catch, bool show_line) {
   fflush(stderr);
 }
 
-static bool precompiled = false;
-static ScriptData *script_data;
 
 // Executes a str within the current v8 context.
 Local<Value> ExecuteString(Handle<String> source, Handle<Value> filename) {
   HandleScope scope;
   TryCatch try_catch;
   
-  if(!precompiled) {
-    script_data = ScriptData::PreCompile(source);
-    precompiled = true;
-  }
-
-  Local<v8::Script> script = v8::Script::Compile(source, new ScriptOrigin(filename), script_data);
+  ScriptData* pre_data = GetPreparseData(source);
+  ScriptOrigin origin(filename);
+  Local<v8::Script> script = v8::Script::Compile(source, &origin, pre_data);
+  delete pre_data;
   if (script.IsEmpty()) {
     ReportException(try_catch, true);
     EXIT(1);
@@ -1324,34 +1283,6 @@ v8::Handle<v8::Value> Isolate::Exit(const v8::Arguments& args) {
   return Undefined();
 }
 
-void Isolate::CheckStatus(uv_timer_t* watcher, int status) {
-    static_cast<Isolate *>(watcher->data)->__CheckStatus(watcher, status);
-}
-
-void Isolate::__CheckStatus(uv_timer_t* watcher, int status) {
-  assert(watcher == &gc_timer);
-
-  // check memory
-  if (!uv_is_active((uv_handle_t*) &gc_idle)) {
-    HeapStatistics stats;
-    V8::GetHeapStatistics(&stats);
-    if (stats.total_heap_size() > 1024 * 1024 * 128) {
-      // larger than 128 megs, just start the idle watcher
-      uv_idle_start(&gc_idle, Idle);
-      return;
-    }
-  }
-
-  double d = uv_now(Loop()) - TICK_TIME(3);
-
-  //printfb("timer d = %f\n", d);
-
-  if (d  >= GC_WAIT_TIME - 1.) {
-    //fprintf(stderr, "start idle\n");
-    uv_idle_start(&gc_idle, Idle);
-  }
-}
-
 static Handle<Value> Uptime(const Arguments& args) {
   HandleScope scope;
   assert(args.Length() == 0);
@@ -1430,6 +1361,20 @@ v8::Handle<v8::Value> Isolate::MemoryUsage(const v8::Arguments& args) {
   info->Set(isolate->heap_used_symbol,
             Integer::NewFromUnsigned(v8_heap_stats.used_heap_size()));
 
+  // Buffers that stream reads land in
+  SlabPoolStats slab_stats;
+  StreamWrap::GetSlabPoolStats(&slab_stats);
+  Local<Object> read_pool = Object::New();
+  read_pool->Set(String::NewSymbol("hits"),
+                 Integer::NewFromUnsigned(slab_stats.hits));
+  read_pool->Set(String::NewSymbol("misses"),
+                 Integer::NewFromUnsigned(slab_stats.misses));
+  read_pool->Set(String::NewSymbol("pinned"),
+                 Integer::NewFromUnsigned(slab_stats.pinned));
+  read_pool->Set(String::NewSymbol("pooled"),
+                 Integer::NewFromUnsigned(slab_stats.pooled));
+  info->Set(String::NewSymbol("readPool"), read_pool);
+
   return scope.Close(info);
 }
 
@@ -1855,6 +1800,13 @@ Handle<Object> Isolate::GetFeatures() {
   obj->Set(String::NewSymbol("tls_sni"), Boolean::New(use_sni));
   obj->Set(String::NewSymbol("tls"),
       Boolean::New(get_builtin_module("crypto") != NULL));
+  obj->Set(String::NewSymbol("isolates"),
+#if defined(NODE_FORK_ISOLATE)
+    True()
+#else
+    False()
+#endif
+  );
 
   return scope.Close(obj);
 }
@@ -2008,6 +1960,9 @@ Handle<Object> Isolate::SetupProcessObject(int argc, char *argv[]) {
   NODE_SET_METHOD(process, "uptime", Uptime);
   NODE_SET_METHOD(process, "memoryUsage", MemoryUsage);
   NODE_SET_METHOD(process, "uvCounters", UVCounters);
+  NODE_SET_METHOD(process, "loopStats", GetLoopStats);
+  NODE_SET_METHOD(process, "setIdleGC", IdleGC::SetOptions);
+  NODE_SET_METHOD(process, "idleGCStats", IdleGC::GetStats);
 
   NODE_SET_METHOD(process, "binding", Binding);
 
@@ -2084,6 +2039,9 @@ static void PrintHelp() {
          "  --v8-options         print v8 command line options\n"
          "  --vars               print various compiled-in variables\n"
          "  --max-stack-size=val set max v8 stack size (bytes)\n"
+         "  --resolution-manifest=file\n"
+         "                       load resolved module paths from file and\n"
+         "                       save them there on exit\n"
          "\n"
          "Enviromental variables:\n"
          "NODE_PATH              ':'-separated list of directories\n"
@@ -2091,6 +2049,10 @@ static void PrintHelp() {
          "NODE_MODULE_CONTEXTS   Set to 1 to load modules in their own\n"
          "                       global contexts.\n"
          "NODE_DISABLE_COLORS    Set to 1 to disable colors in the REPL\n"
+         "NODE_CODE_CACHE_DIR    Directory in which to keep the preparse\n"
+         "                       data of scripts across runs.\n"
+         "UV_THREADPOOL_SIZE     Number of threads for file system and\n"
+         "                       other blocking work (default 4).\n"
          "\n"
          "Documentation can be found at http://nodejs.org/\n");
 }
@@ -2102,6 +2064,7 @@ NodeOptions::NodeOptions() {
   debug_wait_connect = false;
   debug_port = 5858;
   max_stack_size = 0;
+  resolution_manifest = NULL;
 }
 
 NodeOptions::~NodeOptions() {}
@@ -2142,6 +2105,9 @@ void NodeOptions::ParseArgs(int argc, char **argv) {
       p = 1 + strchr(arg, '=');
       max_stack_size = atoi(p);
       argv[i] = const_cast<char*>("");
+    } else if (strstr(arg, "--resolution-manifest=") == arg) {
+      resolution_manifest = const_cast<char*>(1 + strchr(arg, '='));
+      argv[i] = const_cast<char*>("");
     } else if (strcmp(arg, "--eval") == 0 || strcmp(arg, "-e") == 0) {
       if (argc <= i + 1) {
         fprintf(stderr, "Error: --eval requires an argument\n");
@@ -2450,11 +2416,7 @@ int Isolate::Init(int argc, char *argv[]) {
   uv_check_start(&gc_check, Check);
   uv_unref(Loop());
 
-  uv_idle_init(Loop(), &gc_idle);
-  uv_unref(Loop());
-
-  uv_timer_init(Loop(), &gc_timer);
-  uv_unref(Loop());
+  idle_gc->Init(Loop());
 
   uv_async_init(Loop(), &stop_watcher, Break);
   uv_unref(Loop());
@@ -2521,6 +2483,7 @@ int Isolate::Start(uv_thread_shared_t *hnd) {
   if(hnd->stdin_fd >= 0) stdin_fd = hnd->stdin_fd;
   if(hnd->stdout_fd >= 0) stdout_fd = hnd->stdout_fd;
   if(hnd->stderr_fd >= 0) stderr_fd = hnd->stderr_fd;
+  parent_channel = static_cast<IsolateChannel*>(hnd->channel);
 
   // Get and enter v8::Isolate
   isolate = v8::Isolate::GetCurrent();
@@ -2580,8 +2543,8 @@ Isolate::Isolate() {
   prepare_tick_watcher.data = this;
   tick_spinner.data = this;
   gc_check.data = this;
-  gc_idle.data = this;
-  gc_timer.data = this;
+  loop_stats = new LoopStats();
+  idle_gc = new IdleGC();
     
 #ifdef OPENSSL_NPN_NEGOTIATED
   use_npn = true;
@@ -2596,15 +2559,23 @@ Isolate::Isolate() {
 #else
   use_sni = false;
 #endif
-  tick_time_head = 0;
+  memset(&statics_, 0, sizeof(statics_));
   uncaught_exception_counter = 0;
   exit_status = 0;
   term_signal = 0;
+  parent_channel = NULL;
   loop_ = (this == &defaultIsolate) ? uv_default_loop(): uv_loop_new();
   exitHandler = 0;
 }
 
 Isolate::~Isolate() {
+    // statics_ is nothing but ModuleStatics pointers, one per module.
+    ModuleStatics** statics = reinterpret_cast<ModuleStatics**>(&statics_);
+    for (size_t i = 0; i < sizeof(statics_) / sizeof(*statics); i++) {
+      delete statics[i];
+    }
+    delete loop_stats;
+    delete idle_gc;
     if(this != &defaultIsolate) uv_loop_delete(loop_);
 }
   
@@ -2655,6 +2626,13 @@ int Initialize(int argc, char *argv[]) {
   options.SetResourceConstraints();
   V8::SetFlagsFromCommandLine(&v8argc, v8argv, false);
   V8::Initialize();
+
+#if HAVE_OPENSSL
+  crypto::InitCryptoOnce();
+#endif
+  ModuleResolver::InitOnce(options.resolution_manifest);
+  DnsCache::InitOnce();
+  InitEvalsOnce();
   
   // overwrite the processed option arguments to avoid them being re-processed
   for(int i=1; i < options.args_start_index; i++) argv[i] = const_cast<char*>("");
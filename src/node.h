@@ -108,6 +108,10 @@
 
 namespace node {
 
+class IsolateChannel;
+class LoopStats;
+class IdleGC;
+
 class NodeOptions {
 public:
   // the index of the first non-option argument, after processing
@@ -120,6 +124,7 @@ public:
   bool use_debug_agent;
   bool debug_wait_connect;
   int debug_port;
+  char *resolution_manifest;
   void ParseArgs(int argc, char **argv);
   void ParseDebugOpt(const char* arg);
   void SetResourceConstraints();
@@ -151,27 +156,27 @@ public:
     ext_statics statics_;
     int exit_status;
     int term_signal;
+    // The child's end of the channel to the isolate that forked this one,
+    // until it is claimed by the isolate_channel binding.
+    IsolateChannel *parent_channel;
+    // Where the event loop spends its time, for process.loopStats().
+    LoopStats *loop_stats;
+    // Runs V8's idle-time GC between loop iterations.
+    IdleGC *idle_gc;
 
     Isolate();
     ~Isolate();
     
 private:
-    void StartGCTimer ();
-    void StopGCTimer ();
-
-    static void Idle(uv_idle_t* watcher, int status);
     static void Check(uv_check_t* watcher, int status);
     static void Spin(uv_idle_t* handle, int status);
     static void PrepareTick(uv_prepare_t* handle, int status);
     static void CheckTick(uv_check_t* handle, int status);
-    static void CheckStatus(uv_timer_t* watcher, int status);
 
-    void __Idle(uv_idle_t* watcher, int status);
     void __Check(uv_check_t* watcher, int status);
     void __Spin(uv_idle_t* handle, int status);
     void __PrepareTick(uv_prepare_t* handle, int status);
     void __CheckTick(uv_check_t* handle, int status);
-    void __CheckStatus(uv_timer_t* watcher, int status);
     void Tick(void);
 
     static v8::Handle<v8::Value> NeedTickCallback(const v8::Arguments& args);
@@ -233,20 +238,10 @@ private:
     // scoped at file-level rather than method-level to avoid excess stack usage.
     char getbuf[PATH_MAX + 1];
     
-    // We need to notify V8 when we're idle so that it can run the garbage
-    // collector. The interface to this is V8::IdleNotification(). It returns
-    // true if the heap hasn't be fully compacted, and needs to be run again.
-    // Returning false means that it doesn't have anymore work to do.
-    //
-    // A rather convoluted algorithm has been devised to determine when Node is
-    // idle. You'll have to figure it out for yourself.
+    // Tells idle_gc when the poll is over; see IdleGC.
     uv_check_t gc_check;
-    uv_idle_t gc_idle;
-    uv_timer_t gc_timer;
     uv_loop_t *loop_;
     
-    int tick_time_head;
-    
     v8::Persistent<v8::Object> binding_cache;
     v8::Persistent<v8::Array> module_load_list;
     void (*exitHandler)();
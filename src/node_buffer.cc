@@ -23,6 +23,7 @@
 #include <node.h>
 #include <node_statics.h>
 #include <node_buffer.h>
+#include <node_codec.h>
 
 #include <v8.h>
 
@@ -273,7 +274,24 @@ Handle<Value> Buffer::Utf8Slice(const Arguments &args) {
   Buffer *parent = ObjectWrap::Unwrap<Buffer>(args.This());
   SLICE_ARGS(args[0], args[1])
   char *data = parent->data_ + start;
-  Local<String> string = String::New(data, end - start);
+  size_t len = end - start;
+
+  // V8 decodes UTF-8 in two passes through a generic decoder. When the data
+  // is well-formed and has no characters outside the BMP we know exactly
+  // what it would produce and can hand it UTF-16 instead. Anything else,
+  // including plain ASCII which V8 copies directly, goes through V8.
+  if (len >= codec::kUtf8DecodeMin && codec::AsciiPrefix(data, len) < len) {
+    uint16_t *units = new uint16_t[len];
+    ptrdiff_t n = codec::Utf8DecodeBmp(data, len, units);
+    if (n >= 0) {
+      Local<String> string = String::New(units, n);
+      delete [] units;
+      return scope.Close(string);
+    }
+    delete [] units;
+  }
+
+  Local<String> string = String::New(data, len);
   return scope.Close(string);
 }
 
@@ -286,97 +304,34 @@ Handle<Value> Buffer::Ucs2Slice(const Arguments &args) {
   return scope.Close(string);
 }
 
-static const char *base64_table = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-                                  "abcdefghijklmnopqrstuvwxyz"
-                                  "0123456789+/";
-static const int unbase64_table[] =
-  {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-2,-1,-1,-2,-1,-1
-  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
-  ,-2,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,62,-1,-1,-1,63
-  ,52,53,54,55,56,57,58,59,60,61,-1,-1,-1,-1,-1,-1
-  ,-1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14
-  ,15,16,17,18,19,20,21,22,23,24,25,-1,-1,-1,-1,-1
-  ,-1,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40
-  ,41,42,43,44,45,46,47,48,49,50,51,-1,-1,-1,-1,-1
-  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
-  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
-  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
-  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
-  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
-  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
-  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
-  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
-  };
-#define unbase64(x) unbase64_table[(uint8_t)(x)]
-
-
 Handle<Value> Buffer::Base64Slice(const Arguments &args) {
   HandleScope scope;
   Buffer *parent = ObjectWrap::Unwrap<Buffer>(args.This());
   SLICE_ARGS(args[0], args[1])
 
-  int n = end - start;
-  int out_len = (n + 2 - ((n + 2) % 3)) / 3 * 4;
+  size_t n = end - start;
+  size_t out_len = (n + 2) / 3 * 4;
   char *out = new char[out_len];
 
-  uint8_t bitbuf[3];
-  int i = start; // data() index
-  int j = 0; // out index
-  char c;
-  bool b1_oob, b2_oob;
-
-  while (i < end) {
-    bitbuf[0] = parent->data_[i++];
-
-    if (i < end) {
-      bitbuf[1] = parent->data_[i];
-      b1_oob = false;
-    }  else {
-      bitbuf[1] = 0;
-      b1_oob = true;
-    }
-    i++;
-
-    if (i < end) {
-      bitbuf[2] = parent->data_[i];
-      b2_oob = false;
-    }  else {
-      bitbuf[2] = 0;
-      b2_oob = true;
-    }
-    i++;
+  size_t written = codec::Base64Encode(parent->data_ + start, n, out);
 
+  Local<String> string = String::New(out, written);
+  delete [] out;
+  return scope.Close(string);
+}
 
-    c = bitbuf[0] >> 2;
-    assert(c < 64);
-    out[j++] = base64_table[(int)c];
-    assert(j < out_len);
 
-    c = ((bitbuf[0] & 0x03) << 4) | (bitbuf[1] >> 4);
-    assert(c < 64);
-    out[j++] = base64_table[(int)c];
-    assert(j < out_len);
+Handle<Value> Buffer::HexSlice(const Arguments &args) {
+  HandleScope scope;
+  Buffer *parent = ObjectWrap::Unwrap<Buffer>(args.This());
+  SLICE_ARGS(args[0], args[1])
 
-    if (b1_oob) {
-      out[j++] = '=';
-    } else {
-      c = ((bitbuf[1] & 0x0F) << 2) | (bitbuf[2] >> 6);
-      assert(c < 64);
-      out[j++] = base64_table[(int)c];
-    }
-    assert(j < out_len);
+  size_t n = end - start;
+  char *out = new char[2 * n];
 
-    if (b2_oob) {
-      out[j++] = '=';
-    } else {
-      c = bitbuf[2] & 0x3F;
-      assert(c < 64);
-      out[j++]  = base64_table[(int)c];
-    }
-    assert(j <= out_len);
-  }
+  codec::HexEncode(parent->data_ + start, n, out);
 
-  Local<String> string = String::New(out, out_len);
+  Local<String> string = String::New(out, 2 * n);
   delete [] out;
   return scope.Close(string);
 }
@@ -595,17 +550,6 @@ Handle<Value> Buffer::Base64Write(const Arguments &args) {
   HandleScope scope;
   BufferStatics *statics = NODE_STATICS_GET(node_buffer, BufferStatics);
 
-  assert(unbase64('/') == 63);
-  assert(unbase64('+') == 62);
-  assert(unbase64('T') == 19);
-  assert(unbase64('Z') == 25);
-  assert(unbase64('t') == 45);
-  assert(unbase64('z') == 51);
-
-  assert(unbase64(' ') == -2);
-  assert(unbase64('\n') == -2);
-  assert(unbase64('\r') == -2);
-
   Buffer *buffer = ObjectWrap::Unwrap<Buffer>(args.This());
 
   if (!args[0]->IsString()) {
@@ -633,51 +577,65 @@ Handle<Value> Buffer::Base64Write(const Arguments &args) {
             "Buffer too small")));
   }
 
-  char a, b, c, d;
-  char* start = buffer->data_ + offset;
-  char* dst = start;
-  const char *src = *s;
-  const char *const srcEnd = src + s.length();
+  size_t written = codec::Base64Decode(*s, s.length(), buffer->data_ + offset);
+  assert(written <= size);
 
-  while (src < srcEnd) {
-    int remaining = srcEnd - src;
+  statics->constructor_template->GetFunction()->Set(statics->chars_written_sym,
+                                           Integer::New(s.length()));
 
-    while (unbase64(*src) < 0 && src < srcEnd) {
-      src++;
-      remaining--;
-    }
-    if (remaining == 0 || *src == '=') break;
-    a = unbase64(*src++);
+  return scope.Close(Integer::New(written));
+}
 
-    while (unbase64(*src) < 0 && src < srcEnd) {
-      src++;
-      remaining--;
-    }
-    if (remaining <= 1 || *src == '=') break;
-    b = unbase64(*src++);
-    *dst++ = (a << 2) | ((b & 0x30) >> 4);
 
-    while (unbase64(*src) < 0 && src < srcEnd) {
-      src++;
-      remaining--;
-    }
-    if (remaining <= 2 || *src == '=') break;
-    c = unbase64(*src++);
-    *dst++ = ((b & 0x0F) << 4) | ((c & 0x3C) >> 2);
+// var bytesWritten = buffer.hexWrite(string, offset, [maxLength]);
+Handle<Value> Buffer::HexWrite(const Arguments &args) {
+  HandleScope scope;
+  BufferStatics *statics = NODE_STATICS_GET(node_buffer, BufferStatics);
 
-    while (unbase64(*src) < 0 && src < srcEnd) {
-      src++;
-      remaining--;
-    }
-    if (remaining <= 3 || *src == '=') break;
-    d = unbase64(*src++);
-    *dst++ = ((c & 0x03) << 6) | (d & 0x3F);
+  Buffer *buffer = ObjectWrap::Unwrap<Buffer>(args.This());
+
+  if (!args[0]->IsString()) {
+    return ThrowException(Exception::TypeError(String::New(
+            "Argument must be a string")));
+  }
+
+  Local<String> s = args[0]->ToString();
+
+  // must be an even number of digits
+  size_t str_len = s->Length();
+  if (str_len % 2) {
+    return ThrowException(Exception::Error(String::New(
+            "Invalid hex string")));
+  }
+
+  size_t offset = args[1]->Uint32Value();
+  if (offset > buffer->length_) offset = buffer->length_;
+
+  size_t max_length = args[2]->IsUndefined() ? buffer->length_ - offset
+                                             : args[2]->Uint32Value();
+  max_length = MIN(str_len / 2, MIN(buffer->length_ - offset, max_length));
+
+  if (max_length == 0) {
+    statics->constructor_template->GetFunction()->Set(statics->chars_written_sym,
+                                             Integer::New(0));
+    return scope.Close(Integer::New(0));
+  }
+
+  uint16_t *units = new uint16_t[2 * max_length];
+  s->Write(units, 0, 2 * max_length, String::NO_NULL_TERMINATION);
+
+  size_t written = codec::HexDecode(units, max_length, buffer->data_ + offset);
+  delete [] units;
+
+  if (written < max_length) {
+    return ThrowException(Exception::Error(String::New(
+            "Invalid hex string")));
   }
 
   statics->constructor_template->GetFunction()->Set(statics->chars_written_sym,
-                                           Integer::New(s.length()));
+                                           Integer::New(written * 2));
 
-  return scope.Close(Integer::New(dst - start));
+  return scope.Close(Integer::New(written));
 }
 
 
@@ -785,6 +743,7 @@ void Buffer::Initialize(Handle<Object> target) {
   NODE_SET_PROTOTYPE_METHOD(statics->constructor_template, "binarySlice", Buffer::BinarySlice);
   NODE_SET_PROTOTYPE_METHOD(statics->constructor_template, "asciiSlice", Buffer::AsciiSlice);
   NODE_SET_PROTOTYPE_METHOD(statics->constructor_template, "base64Slice", Buffer::Base64Slice);
+  NODE_SET_PROTOTYPE_METHOD(statics->constructor_template, "hexSlice", Buffer::HexSlice);
   NODE_SET_PROTOTYPE_METHOD(statics->constructor_template, "ucs2Slice", Buffer::Ucs2Slice);
   // TODO NODE_SET_PROTOTYPE_METHOD(t, "utf16Slice", Utf16Slice);
   // copy
@@ -794,6 +753,7 @@ void Buffer::Initialize(Handle<Object> target) {
   NODE_SET_PROTOTYPE_METHOD(statics->constructor_template, "asciiWrite", Buffer::AsciiWrite);
   NODE_SET_PROTOTYPE_METHOD(statics->constructor_template, "binaryWrite", Buffer::BinaryWrite);
   NODE_SET_PROTOTYPE_METHOD(statics->constructor_template, "base64Write", Buffer::Base64Write);
+  NODE_SET_PROTOTYPE_METHOD(statics->constructor_template, "hexWrite", Buffer::HexWrite);
   NODE_SET_PROTOTYPE_METHOD(statics->constructor_template, "ucs2Write", Buffer::Ucs2Write);
   NODE_SET_PROTOTYPE_METHOD(statics->constructor_template, "fill", Buffer::Fill);
   NODE_SET_PROTOTYPE_METHOD(statics->constructor_template, "copy", Buffer::Copy);
@@ -0,0 +1,467 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <node_codec.h>
+
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) &&                          \
+    (defined(__clang__) ||                                                 \
+     __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+// The kernels are compiled with target attributes so that the rest of the
+// binary keeps running on CPUs without the extensions.
+# define NODE_CODEC_X86 1
+# include <cpuid.h>
+# include <emmintrin.h>
+# include <tmmintrin.h>
+# define SSE2_TARGET __attribute__((target("sse2")))
+# define SSSE3_TARGET __attribute__((target("ssse3")))
+#endif
+
+namespace node {
+namespace codec {
+
+
+static const char base64_table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                                   "abcdefghijklmnopqrstuvwxyz"
+                                   "0123456789+/";
+
+static const int8_t unbase64_table[] =
+  {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-2,-1,-1,-2,-1,-1
+  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+  ,-2,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,62,-1,-1,-1,63
+  ,52,53,54,55,56,57,58,59,60,61,-1,-1,-1,-1,-1,-1
+  ,-1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14
+  ,15,16,17,18,19,20,21,22,23,24,25,-1,-1,-1,-1,-1
+  ,-1,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40
+  ,41,42,43,44,45,46,47,48,49,50,51,-1,-1,-1,-1,-1
+  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+  ,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+  };
+#define unbase64(x) unbase64_table[(uint8_t)(x)]
+
+static const char hex_table[] = "0123456789abcdef";
+
+
+static inline int unhex(uint16_t c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  c |= 0x20;
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+
+
+static int features = -1;
+
+
+int GetFeatures() {
+  // Racing isolates all compute the same value, so there is no need to
+  // lock around the first call.
+  if (features == -1) {
+    int f = 0;
+#ifdef NODE_CODEC_X86
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+      if (edx & bit_SSE2) f |= SSE2;
+      if ((f & SSE2) && (ecx & bit_SSSE3)) f |= SSSE3;
+    }
+#endif
+    features = f;
+  }
+  return features;
+}
+
+
+#ifdef NODE_CODEC_X86
+
+// Each kernel consumes whole 16 byte blocks and leaves the tail, or the
+// first block it cannot handle, to the scalar loop.
+
+SSSE3_TARGET
+static size_t Base64EncodeSSSE3(const char* src, size_t len, char* dst) {
+  const __m128i shuf = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7,
+                                    4, 5, 3, 4, 1, 2, 0, 1);
+  const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52,
+                                        '0' - 52, '0' - 52, '0' - 52,
+                                        '0' - 52, '0' - 52, '0' - 52,
+                                        '0' - 52, '0' - 52, '+' - 62,
+                                        '/' - 63, 'A', 0, 0);
+  size_t i = 0;
+
+  // Loads 16 bytes but only uses 12 of them.
+  for (; i + 16 <= len; i += 12, dst += 16) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    in = _mm_shuffle_epi8(in, shuf);
+
+    // Spread the 24 bits of every triplet over four bytes.
+    __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    __m128i idx = _mm_or_si128(t1, t3);
+
+    // Map 0..63 onto the alphabet: pick the offset for the range the index
+    // falls into and add it.
+    __m128i r = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+    __m128i lt = _mm_cmpgt_epi8(_mm_set1_epi8(26), idx);
+    r = _mm_or_si128(r, _mm_and_si128(lt, _mm_set1_epi8(13)));
+    r = _mm_add_epi8(_mm_shuffle_epi8(offsets, r), idx);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), r);
+  }
+
+  return i;
+}
+
+
+SSSE3_TARGET
+static size_t Base64DecodeSSSE3(const char* src, size_t len, char* dst) {
+  size_t i = 0;
+
+  for (; i + 16 <= len; i += 16, dst += 12) {
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('A' - 1)),
+                                  _mm_cmplt_epi8(c, _mm_set1_epi8('Z' + 1)));
+    __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('a' - 1)),
+                                  _mm_cmplt_epi8(c, _mm_set1_epi8('z' + 1)));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+                                  _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+    __m128i plus = _mm_cmpeq_epi8(c, _mm_set1_epi8('+'));
+    __m128i slash = _mm_cmpeq_epi8(c, _mm_set1_epi8('/'));
+
+    __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower),
+                                 _mm_or_si128(_mm_or_si128(digit, plus),
+                                              slash));
+    // Padding, whitespace and garbage all take the scalar path.
+    if (_mm_movemask_epi8(valid) != 0xffff) break;
+
+    __m128i v = _mm_and_si128(upper, _mm_sub_epi8(c, _mm_set1_epi8('A')));
+    v = _mm_or_si128(v, _mm_and_si128(lower,
+                                      _mm_sub_epi8(c, _mm_set1_epi8('a' - 26))));
+    v = _mm_or_si128(v, _mm_and_si128(digit,
+                                      _mm_add_epi8(c, _mm_set1_epi8(52 - '0'))));
+    v = _mm_or_si128(v, _mm_and_si128(plus, _mm_set1_epi8(62)));
+    v = _mm_or_si128(v, _mm_and_si128(slash, _mm_set1_epi8(63)));
+
+    // Pack four 6 bit values into 24 bits and put them in big endian order.
+    __m128i ab = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+    __m128i abcd = _mm_madd_epi16(ab, _mm_set1_epi32(0x00011000));
+    __m128i out = _mm_shuffle_epi8(abcd, _mm_setr_epi8(2, 1, 0, 6, 5, 4,
+                                                       10, 9, 8, 14, 13, 12,
+                                                       -1, -1, -1, -1));
+    char tmp[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(tmp), out);
+    memcpy(dst, tmp, 12);
+  }
+
+  return i;
+}
+
+
+SSE2_TARGET
+static size_t HexEncodeSSE2(const char* src, size_t len, char* dst) {
+  const __m128i mask = _mm_set1_epi8(0x0f);
+  const __m128i nine = _mm_set1_epi8(9);
+  const __m128i zero = _mm_set1_epi8('0');
+  const __m128i alpha = _mm_set1_epi8('a' - '0' - 10);
+  size_t i = 0;
+
+  for (; i + 16 <= len; i += 16, dst += 32) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(in, 4), mask);
+    __m128i lo = _mm_and_si128(in, mask);
+
+    hi = _mm_add_epi8(_mm_add_epi8(hi, zero),
+                      _mm_and_si128(_mm_cmpgt_epi8(hi, nine), alpha));
+    lo = _mm_add_epi8(_mm_add_epi8(lo, zero),
+                      _mm_and_si128(_mm_cmpgt_epi8(lo, nine), alpha));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                     _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16),
+                     _mm_unpackhi_epi8(hi, lo));
+  }
+
+  return i;
+}
+
+
+// Turns 16 characters into nibbles. Characters above 0xff were saturated
+// to 0x00 or 0xff by the caller and are rejected like any other non-digit.
+SSE2_TARGET
+static inline bool HexNibblesSSE2(__m128i c, __m128i* out) {
+  __m128i d = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+  __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(d, _mm_set1_epi8(-1)),
+                                   _mm_cmplt_epi8(d, _mm_set1_epi8(10)));
+  __m128i l = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)),
+                           _mm_set1_epi8('a'));
+  __m128i is_alpha = _mm_and_si128(_mm_cmpgt_epi8(l, _mm_set1_epi8(-1)),
+                                   _mm_cmplt_epi8(l, _mm_set1_epi8(6)));
+
+  if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)) != 0xffff)
+    return false;
+
+  __m128i n = _mm_or_si128(
+      _mm_and_si128(is_digit, d),
+      _mm_and_si128(is_alpha, _mm_add_epi8(l, _mm_set1_epi8(10))));
+
+  // Even characters are the high nibbles, odd ones the low nibbles.
+  *out = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(n, _mm_set1_epi16(0xff)),
+                                     4),
+                      _mm_srli_epi16(n, 8));
+  return true;
+}
+
+
+SSE2_TARGET
+static size_t HexDecodeSSE2(const uint16_t* src, size_t len, char* dst) {
+  size_t i = 0;
+
+  for (; i + 16 <= len; i += 16, src += 32, dst += 16) {
+    const __m128i* p = reinterpret_cast<const __m128i*>(src);
+    __m128i a = _mm_packus_epi16(_mm_loadu_si128(p), _mm_loadu_si128(p + 1));
+    __m128i b = _mm_packus_epi16(_mm_loadu_si128(p + 2),
+                                 _mm_loadu_si128(p + 3));
+    __m128i x, y;
+    if (!HexNibblesSSE2(a, &x) || !HexNibblesSSE2(b, &y)) break;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(x, y));
+  }
+
+  return i;
+}
+
+
+SSE2_TARGET
+static size_t AsciiPrefixSSE2(const char* src, size_t len) {
+  size_t i = 0;
+
+  for (; i + 16 <= len; i += 16) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    int mask = _mm_movemask_epi8(in);
+    if (mask) return i + __builtin_ctz(mask);
+  }
+
+  return i;
+}
+
+
+// Widens a run of 7 bit characters into UTF-16.
+SSE2_TARGET
+static size_t AsciiWidenSSE2(const char* src, size_t len, uint16_t* dst) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+
+  for (; i + 16 <= len; i += 16) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    if (_mm_movemask_epi8(in)) break;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_unpacklo_epi8(in, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8),
+                     _mm_unpackhi_epi8(in, zero));
+  }
+
+  return i;
+}
+
+#endif  // NODE_CODEC_X86
+
+
+size_t Base64Encode(const char* src, size_t len, char* dst) {
+  const uint8_t* in = reinterpret_cast<const uint8_t*>(src);
+  char* const start = dst;
+  size_t i = 0;
+
+#ifdef NODE_CODEC_X86
+  if (GetFeatures() & SSSE3) {
+    i = Base64EncodeSSSE3(src, len, dst);
+    dst += i / 3 * 4;
+  }
+#endif
+
+  for (; i + 3 <= len; i += 3) {
+    unsigned a = in[i], b = in[i + 1], c = in[i + 2];
+    *dst++ = base64_table[a >> 2];
+    *dst++ = base64_table[((a & 0x03) << 4) | (b >> 4)];
+    *dst++ = base64_table[((b & 0x0f) << 2) | (c >> 6)];
+    *dst++ = base64_table[c & 0x3f];
+  }
+
+  if (i < len) {
+    unsigned a = in[i], b = i + 1 < len ? in[i + 1] : 0;
+    *dst++ = base64_table[a >> 2];
+    *dst++ = base64_table[((a & 0x03) << 4) | (b >> 4)];
+    *dst++ = i + 1 < len ? base64_table[(b & 0x0f) << 2] : '=';
+    *dst++ = '=';
+  }
+
+  return dst - start;
+}
+
+
+size_t Base64Decode(const char* src, size_t len, char* dst) {
+  const char* const end = src + len;
+  char* const start = dst;
+  int8_t a, b, c, d;
+
+  for (;;) {
+#ifdef NODE_CODEC_X86
+    // Runs again after every quad the scalar code had to deal with, so
+    // line breaks in MIME style input only cost a short detour.
+    if (GetFeatures() & SSSE3) {
+      size_t n = Base64DecodeSSSE3(src, end - src, dst);
+      src += n;
+      dst += n / 4 * 3;
+    }
+#endif
+
+    while (src < end && unbase64(*src) < 0) src++;
+    if (src == end || *src == '=') break;
+    a = unbase64(*src++);
+
+    while (src < end && unbase64(*src) < 0) src++;
+    if (src == end || *src == '=') break;
+    b = unbase64(*src++);
+    *dst++ = (a << 2) | ((b & 0x30) >> 4);
+
+    while (src < end && unbase64(*src) < 0) src++;
+    if (src == end || *src == '=') break;
+    c = unbase64(*src++);
+    *dst++ = ((b & 0x0F) << 4) | ((c & 0x3C) >> 2);
+
+    while (src < end && unbase64(*src) < 0) src++;
+    if (src == end || *src == '=') break;
+    d = unbase64(*src++);
+    *dst++ = ((c & 0x03) << 6) | (d & 0x3F);
+  }
+
+  return dst - start;
+}
+
+
+void HexEncode(const char* src, size_t len, char* dst) {
+  size_t i = 0;
+
+#ifdef NODE_CODEC_X86
+  if (GetFeatures() & SSE2) {
+    i = HexEncodeSSE2(src, len, dst);
+    dst += 2 * i;
+  }
+#endif
+
+  for (; i < len; i++) {
+    uint8_t c = src[i];
+    *dst++ = hex_table[c >> 4];
+    *dst++ = hex_table[c & 0x0f];
+  }
+}
+
+
+size_t HexDecode(const uint16_t* src, size_t len, char* dst) {
+  size_t i = 0;
+
+#ifdef NODE_CODEC_X86
+  if (GetFeatures() & SSE2) {
+    i = HexDecodeSSE2(src, len, dst);
+  }
+#endif
+
+  for (; i < len; i++) {
+    int hi = unhex(src[2 * i]);
+    int lo = unhex(src[2 * i + 1]);
+    if (hi < 0 || lo < 0) break;
+    dst[i] = (hi << 4) | lo;
+  }
+
+  return i;
+}
+
+
+size_t AsciiPrefix(const char* src, size_t len) {
+  size_t i = 0;
+
+#ifdef NODE_CODEC_X86
+  if (GetFeatures() & SSE2) {
+    i = AsciiPrefixSSE2(src, len);
+  }
+#endif
+
+  while (i < len && !(src[i] & 0x80)) i++;
+
+  return i;
+}
+
+
+ptrdiff_t Utf8DecodeBmp(const char* src, size_t len, uint16_t* dst) {
+  const uint8_t* in = reinterpret_cast<const uint8_t*>(src);
+  uint16_t* const start = dst;
+  bool simd = false;
+  size_t i = 0;
+
+#ifdef NODE_CODEC_X86
+  simd = (GetFeatures() & SSE2) != 0;
+#endif
+
+  while (i < len) {
+    unsigned c = in[i];
+
+    if (c < 0x80) {
+#ifdef NODE_CODEC_X86
+      if (simd) {
+        size_t n = AsciiWidenSSE2(src + i, len - i, dst);
+        i += n;
+        dst += n;
+      }
+#endif
+      while (i < len && in[i] < 0x80) *dst++ = in[i++];
+    } else if ((c & 0xe0) == 0xc0) {
+      if (c < 0xc2 || i + 1 >= len) return -1;  // overlong or truncated
+      unsigned c1 = in[i + 1];
+      if ((c1 & 0xc0) != 0x80) return -1;
+      *dst++ = ((c & 0x1f) << 6) | (c1 & 0x3f);
+      i += 2;
+    } else if ((c & 0xf0) == 0xe0) {
+      if (i + 2 >= len) return -1;
+      unsigned c1 = in[i + 1], c2 = in[i + 2];
+      if ((c1 & 0xc0) != 0x80 || (c2 & 0xc0) != 0x80) return -1;
+      unsigned cp = ((c & 0x0f) << 12) | ((c1 & 0x3f) << 6) | (c2 & 0x3f);
+      if (cp < 0x800 || (cp >= 0xd800 && cp <= 0xdfff)) return -1;
+      *dst++ = cp;
+      i += 3;
+    } else {
+      // Continuation bytes out of place, 4 byte sequences and 0xf8..0xff.
+      return -1;
+    }
+  }
+
+  (void) simd;
+  return dst - start;
+}
+
+
+}  // namespace codec
+}  // namespace node
@@ -0,0 +1,75 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SRC_NODE_CODEC_H_
+#define SRC_NODE_CODEC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace node {
+
+// Encoding kernels behind the Buffer string encodings. Every function has a
+// scalar implementation; on x86 the SSE2 and SSSE3 variants are picked at
+// runtime, once, based on what the CPU reports.
+namespace codec {
+
+enum Features {
+  SSE2  = 1 << 0,
+  SSSE3 = 1 << 1
+};
+
+// The subset of Features the kernels are using on this machine.
+int GetFeatures();
+
+// Writes ((len + 2) / 3) * 4 characters, padded with '='.
+size_t Base64Encode(const char* src, size_t len, char* dst);
+
+// Decodes `len` characters, skipping whitespace and other characters that
+// are not in the alphabet and stopping at the first '='. Returns the number
+// of bytes written, never more than base64_decoded_size() estimated.
+size_t Base64Decode(const char* src, size_t len, char* dst);
+
+// Writes 2 * len lower case hex digits.
+void HexEncode(const char* src, size_t len, char* dst);
+
+// Decodes `len` bytes from 2 * len UTF-16 code units. Returns the number of
+// bytes decoded before the first pair that is not a valid hex byte.
+size_t HexDecode(const uint16_t* src, size_t len, char* dst);
+
+// Returns the length of the leading run of 7 bit characters.
+size_t AsciiPrefix(const char* src, size_t len);
+
+// Decodes well-formed UTF-8 that only contains characters from the Basic
+// Multilingual Plane into `dst`, which must have room for `len` code units.
+// Returns the number of code units written, or -1 if the input has
+// malformed, overlong, surrogate or 4 byte sequences.
+ptrdiff_t Utf8DecodeBmp(const char* src, size_t len, uint16_t* dst);
+
+// Below this length callers leave UTF-8 decoding to V8; the extra
+// allocation Utf8DecodeBmp() needs does not pay off for short strings.
+const size_t kUtf8DecodeMin = 64;
+
+}  // namespace codec
+
+}  // namespace node
+
+#endif  // SRC_NODE_CODEC_H_
@@ -25,6 +25,7 @@
 #include <node.h>
 #include <node_statics.h>
 #include <node_buffer.h>
+#include <node_loop_stats.h>
 #include <node_root_certs.h>
 
 #include <string.h>
@@ -34,6 +35,7 @@
 #endif
 
 #include <stdlib.h>
+#include <time.h>
 
 #include <errno.h>
 
@@ -96,12 +98,16 @@ static unsigned long crypto_id_cb(void) {
 
 static uv_rwlock_t* locks;
 
+// The lock after OpenSSL's own guards the session cache.
+static int session_cache_lock;
+
 
 static void crypto_lock_init(void) {
   int i, n;
 
-  n = CRYPTO_num_locks();
+  n = CRYPTO_num_locks() + 1;
   locks = new uv_rwlock_t[n];
+  session_cache_lock = n - 1;
 
   for (i = 0; i < n; i++)
     if (uv_rwlock_init(locks + i))
@@ -127,6 +133,466 @@ static void crypto_lock_cb(int mode, int n, const char* file, int line) {
 }
 
 
+// Sessions of all SecureContexts that use it, in every isolate of the
+// process. They are kept serialized so that any SSL_CTX can resume them,
+// keyed by session id context and session id, in a hash table with an LRU
+// list through it. The least recently used entry goes when the cache is
+// full, and entries expire `ttl` seconds after they were stored. A context
+// only joins with a session id context that identifies its configuration,
+// so servers that verify clients differently never see each other's
+// sessions. Contexts that ask for it also share the session ticket keys;
+// the previous key keeps being accepted after a rotation so that tickets
+// out there stay good.
+//
+// Everything here is guarded by session_cache_lock, one of the locks of
+// crypto_lock_cb.
+#define SESSION_KEY_MAX (SSL_MAX_SID_CTX_LENGTH + SSL_MAX_SSL_SESSION_ID_LENGTH)
+#define SESSION_DER_MAX (16 * 1024)
+#define SESSION_CACHE_MAX_DEFAULT (20 * 1024)
+#define SESSION_CACHE_TTL_DEFAULT 300
+
+struct SessionCacheStats {
+  size_t hits;
+  size_t misses;
+  size_t stored;
+  size_t expired;
+  size_t evicted;
+  size_t entries;
+  size_t bytes;
+  size_t ticket_hits;
+  size_t ticket_misses;
+  size_t ticket_key_rotations;
+};
+
+struct SessionEntry {
+  SessionEntry* hash_next;
+  SessionEntry* lru_prev;  // more recently used
+  SessionEntry* lru_next;
+  unsigned int hash;
+  time_t expires;
+  unsigned int key_length;
+  unsigned char key[SESSION_KEY_MAX];
+  unsigned int der_length;
+  unsigned char* Der() { return reinterpret_cast<unsigned char*>(this + 1); }
+};
+
+struct TicketKey {
+  unsigned char name[16];
+  unsigned char hmac_secret[16];
+  unsigned char aes_key[16];
+};
+
+static SessionEntry** session_buckets;
+static unsigned int session_bucket_mask;
+static SessionEntry* session_lru_head;
+static SessionEntry* session_lru_tail;
+static size_t session_max = SESSION_CACHE_MAX_DEFAULT;
+static long session_ttl = SESSION_CACHE_TTL_DEFAULT;
+static SessionCacheStats session_stats;
+static TicketKey ticket_keys[2];  // current and previous
+static bool have_previous_ticket_key;
+
+
+static inline unsigned int SessionHash(const unsigned char* key,
+                                       unsigned int length) {
+  // FNV-1a
+  unsigned int h = 2166136261u;
+  for (unsigned int i = 0; i < length; i++) {
+    h ^= key[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+
+static unsigned int SessionKey(unsigned char* key,
+                               const unsigned char* sid_ctx,
+                               unsigned int sid_ctx_length,
+                               const unsigned char* id,
+                               unsigned int id_length) {
+  assert(sid_ctx_length <= SSL_MAX_SID_CTX_LENGTH);
+  assert(id_length <= SSL_MAX_SSL_SESSION_ID_LENGTH);
+  memcpy(key, sid_ctx, sid_ctx_length);
+  memcpy(key + sid_ctx_length, id, id_length);
+  return sid_ctx_length + id_length;
+}
+
+
+static SessionEntry** SessionFind(const unsigned char* key,
+                                  unsigned int length,
+                                  unsigned int hash) {
+  SessionEntry** e = &session_buckets[hash & session_bucket_mask];
+  while (*e) {
+    if ((*e)->hash == hash &&
+        (*e)->key_length == length &&
+        memcmp((*e)->key, key, length) == 0) {
+      break;
+    }
+    e = &(*e)->hash_next;
+  }
+  return e;
+}
+
+
+static void SessionLRUUnlink(SessionEntry* e) {
+  if (e->lru_prev) e->lru_prev->lru_next = e->lru_next;
+  else session_lru_head = e->lru_next;
+  if (e->lru_next) e->lru_next->lru_prev = e->lru_prev;
+  else session_lru_tail = e->lru_prev;
+}
+
+
+static void SessionLRUPush(SessionEntry* e) {
+  e->lru_prev = NULL;
+  e->lru_next = session_lru_head;
+  if (session_lru_head) session_lru_head->lru_prev = e;
+  session_lru_head = e;
+  if (session_lru_tail == NULL) session_lru_tail = e;
+}
+
+
+// Unlinks and frees the entry `slot` points to.
+static void SessionRemove(SessionEntry** slot) {
+  SessionEntry* e = *slot;
+  *slot = e->hash_next;
+  SessionLRUUnlink(e);
+  session_stats.entries--;
+  session_stats.bytes -= e->der_length;
+  free(e);
+}
+
+
+static void SessionRemoveTail(bool expired) {
+  SessionEntry* e = session_lru_tail;
+  SessionRemove(SessionFind(e->key, e->key_length, e->hash));
+  if (expired) {
+    session_stats.expired++;
+  } else {
+    session_stats.evicted++;
+  }
+}
+
+
+// Sizes the hash table for `max` entries, moving what is in it over.
+static void SessionRehash(size_t max) {
+  unsigned int size = 64;
+  while (size < max && size < (1u << 24)) size <<= 1;
+
+  SessionEntry** buckets = new SessionEntry*[size];
+  memset(buckets, 0, size * sizeof(*buckets));
+
+  for (SessionEntry* e = session_lru_head; e; e = e->lru_next) {
+    SessionEntry** slot = &buckets[e->hash & (size - 1)];
+    e->hash_next = *slot;
+    *slot = e;
+  }
+
+  delete[] session_buckets;
+  session_buckets = buckets;
+  session_bucket_mask = size - 1;
+}
+
+
+static void SessionCacheInit() {
+  memset(&session_stats, 0, sizeof(session_stats));
+  SessionRehash(session_max);
+
+#ifdef SSL_CTRL_SET_TLSEXT_TICKET_KEY_CB
+  if (RAND_bytes(reinterpret_cast<unsigned char*>(&ticket_keys[0]),
+                 sizeof(ticket_keys[0])) != 1) {
+    abort();
+  }
+  have_previous_ticket_key = false;
+#endif
+}
+
+
+static int NewSessionCallback(SSL* s, SSL_SESSION* sess) {
+  int der_length = i2d_SSL_SESSION(sess, NULL);
+  if (der_length <= 0 || der_length > SESSION_DER_MAX) return 0;
+
+  SessionEntry* e = static_cast<SessionEntry*>(
+      malloc(sizeof(SessionEntry) + der_length));
+  if (e == NULL) return 0;
+
+  unsigned char* p = e->Der();
+  e->der_length = i2d_SSL_SESSION(sess, &p);
+  e->key_length = SessionKey(e->key,
+                             sess->sid_ctx,
+                             sess->sid_ctx_length,
+                             sess->session_id,
+                             sess->session_id_length);
+  e->hash = SessionHash(e->key, e->key_length);
+
+  CRYPTO_w_lock(session_cache_lock);
+
+  time_t now = time(NULL);
+  e->expires = now + session_ttl;
+
+  SessionEntry** slot = SessionFind(e->key, e->key_length, e->hash);
+  if (*slot) SessionRemove(slot);
+
+  // Make room, dropping what has expired first.
+  while (session_lru_tail && session_lru_tail->expires <= now) {
+    SessionRemoveTail(true);
+  }
+  while (session_lru_tail && session_stats.entries >= session_max) {
+    SessionRemoveTail(false);
+  }
+
+  if (session_max > 0) {
+    slot = &session_buckets[e->hash & session_bucket_mask];
+    e->hash_next = *slot;
+    *slot = e;
+    SessionLRUPush(e);
+    session_stats.entries++;
+    session_stats.bytes += e->der_length;
+    session_stats.stored++;
+    e = NULL;
+  }
+
+  CRYPTO_w_unlock(session_cache_lock);
+
+  free(e);
+
+  // We did not keep a reference to `sess`.
+  return 0;
+}
+
+
+static SSL_SESSION* GetSessionCallback(SSL* s,
+                                       unsigned char* id,
+                                       int id_length,
+                                       int* copy) {
+  *copy = 0;
+
+  if (id_length <= 0 || id_length > SSL_MAX_SSL_SESSION_ID_LENGTH) {
+    return NULL;
+  }
+
+  unsigned char key[SESSION_KEY_MAX];
+  unsigned int key_length = SessionKey(key,
+                                       s->sid_ctx,
+                                       s->sid_ctx_length,
+                                       id,
+                                       id_length);
+  unsigned int hash = SessionHash(key, key_length);
+
+  unsigned char der[SESSION_DER_MAX];
+  unsigned int der_length = 0;
+
+  CRYPTO_w_lock(session_cache_lock);
+
+  SessionEntry** slot = SessionFind(key, key_length, hash);
+  if (*slot && (*slot)->expires <= time(NULL)) {
+    SessionRemove(slot);
+    session_stats.expired++;
+  }
+
+  if (*slot) {
+    SessionEntry* e = *slot;
+    SessionLRUUnlink(e);
+    SessionLRUPush(e);
+    der_length = e->der_length;
+    memcpy(der, e->Der(), der_length);
+    session_stats.hits++;
+  } else {
+    session_stats.misses++;
+  }
+
+  CRYPTO_w_unlock(session_cache_lock);
+
+  if (der_length == 0) return NULL;
+
+  // OpenSSL takes over this reference since *copy is 0.
+  const unsigned char* p = der;
+  return d2i_SSL_SESSION(NULL, &p, der_length);
+}
+
+
+static void RemoveSessionCallback(SSL_CTX* ctx, SSL_SESSION* sess) {
+  unsigned char key[SESSION_KEY_MAX];
+  unsigned int key_length = SessionKey(key,
+                                       sess->sid_ctx,
+                                       sess->sid_ctx_length,
+                                       sess->session_id,
+                                       sess->session_id_length);
+  unsigned int hash = SessionHash(key, key_length);
+
+  CRYPTO_w_lock(session_cache_lock);
+
+  SessionEntry** slot = SessionFind(key, key_length, hash);
+  if (*slot) SessionRemove(slot);
+
+  CRYPTO_w_unlock(session_cache_lock);
+}
+
+
+#ifdef SSL_CTRL_SET_TLSEXT_TICKET_KEY_CB
+// Replaces the current ticket key with `key`, or with a random one if it
+// is NULL. The current one becomes the previous one.
+static void RotateTicketKey(const unsigned char* key) {
+  TicketKey next;
+  if (key) {
+    memcpy(&next, key, sizeof(next));
+  } else if (RAND_bytes(reinterpret_cast<unsigned char*>(&next),
+                        sizeof(next)) != 1) {
+    abort();
+  }
+
+  CRYPTO_w_lock(session_cache_lock);
+  ticket_keys[1] = ticket_keys[0];
+  ticket_keys[0] = next;
+  have_previous_ticket_key = true;
+  session_stats.ticket_key_rotations++;
+  CRYPTO_w_unlock(session_cache_lock);
+}
+
+
+static int TicketKeyCallback(SSL* s,
+                             unsigned char* name,
+                             unsigned char* iv,
+                             EVP_CIPHER_CTX* ectx,
+                             HMAC_CTX* hctx,
+                             int enc) {
+  TicketKey key;
+  int r = 1;
+
+  if (enc) {
+    if (RAND_bytes(iv, EVP_MAX_IV_LENGTH) != 1) return -1;
+
+    CRYPTO_r_lock(session_cache_lock);
+    key = ticket_keys[0];
+    CRYPTO_r_unlock(session_cache_lock);
+
+    memcpy(name, key.name, sizeof(key.name));
+    EVP_EncryptInit_ex(ectx, EVP_aes_128_cbc(), NULL, key.aes_key, iv);
+    HMAC_Init_ex(hctx, key.hmac_secret, sizeof(key.hmac_secret),
+                 EVP_sha256(), NULL);
+    return 1;
+  }
+
+  CRYPTO_w_lock(session_cache_lock);
+  if (memcmp(name, ticket_keys[0].name, sizeof(key.name)) == 0) {
+    key = ticket_keys[0];
+    session_stats.ticket_hits++;
+  } else if (have_previous_ticket_key &&
+             memcmp(name, ticket_keys[1].name, sizeof(key.name)) == 0) {
+    // Accepted as is. Asking for a renewal (returning 2) would be nicer
+    // but the 0.9.8 client fails abbreviated handshakes that carry a new
+    // ticket, so the client gets a fresh one at its next full handshake.
+    key = ticket_keys[1];
+    session_stats.ticket_hits++;
+  } else {
+    session_stats.ticket_misses++;
+    r = 0;
+  }
+  CRYPTO_w_unlock(session_cache_lock);
+
+  if (r == 0) return 0;
+
+  HMAC_Init_ex(hctx, key.hmac_secret, sizeof(key.hmac_secret),
+               EVP_sha256(), NULL);
+  EVP_DecryptInit_ex(ectx, EVP_aes_128_cbc(), NULL, key.aes_key, iv);
+  return r;
+}
+#endif  // SSL_CTRL_SET_TLSEXT_TICKET_KEY_CB
+
+
+// configureSessionCache(maxEntries, ttl)
+static Handle<Value> ConfigureSessionCache(const Arguments& args) {
+  HandleScope scope;
+
+  if (!args[0]->IsUint32() || !args[1]->IsUint32()) {
+    return ThrowException(Exception::TypeError(
+          String::New("Bad arguments")));
+  }
+
+  CRYPTO_w_lock(session_cache_lock);
+
+  session_max = args[0]->Uint32Value();
+  session_ttl = args[1]->Uint32Value();
+  while (session_stats.entries > session_max) SessionRemoveTail(false);
+  SessionRehash(session_max);
+
+  CRYPTO_w_unlock(session_cache_lock);
+
+  return Undefined();
+}
+
+
+static Handle<Value> FlushSessionCache(const Arguments& args) {
+  HandleScope scope;
+
+  CRYPTO_w_lock(session_cache_lock);
+  while (session_lru_tail) {
+    SessionEntry* e = session_lru_tail;
+    SessionRemove(SessionFind(e->key, e->key_length, e->hash));
+  }
+  CRYPTO_w_unlock(session_cache_lock);
+
+  return Undefined();
+}
+
+
+static Handle<Value> GetSessionCacheStats(const Arguments& args) {
+  HandleScope scope;
+
+  SessionCacheStats stats;
+  size_t max;
+  long ttl;
+  CRYPTO_r_lock(session_cache_lock);
+  stats = session_stats;
+  max = session_max;
+  ttl = session_ttl;
+  CRYPTO_r_unlock(session_cache_lock);
+
+  Local<Object> info = Object::New();
+  info->Set(String::NewSymbol("size"), Number::New(max));
+  info->Set(String::NewSymbol("timeout"), Number::New(ttl));
+  info->Set(String::NewSymbol("hits"), Number::New(stats.hits));
+  info->Set(String::NewSymbol("misses"), Number::New(stats.misses));
+  info->Set(String::NewSymbol("stored"), Number::New(stats.stored));
+  info->Set(String::NewSymbol("expired"), Number::New(stats.expired));
+  info->Set(String::NewSymbol("evicted"), Number::New(stats.evicted));
+  info->Set(String::NewSymbol("entries"), Number::New(stats.entries));
+  info->Set(String::NewSymbol("bytes"), Number::New(stats.bytes));
+  info->Set(String::NewSymbol("ticketHits"), Number::New(stats.ticket_hits));
+  info->Set(String::NewSymbol("ticketMisses"),
+            Number::New(stats.ticket_misses));
+  info->Set(String::NewSymbol("ticketKeyRotations"),
+            Number::New(stats.ticket_key_rotations));
+
+  return scope.Close(info);
+}
+
+
+#ifdef SSL_CTRL_SET_TLSEXT_TICKET_KEY_CB
+// rotateTicketKeys([key])
+//
+// Rotates the keys of the contexts that share them. `key` is a 48 byte
+// Buffer: key name, HMAC secret and AES key, 16 bytes each. Processes that
+// are to accept each other's tickets rotate to the same key.
+static Handle<Value> RotateTicketKeys(const Arguments& args) {
+  HandleScope scope;
+
+  if (args.Length() < 1 || args[0]->IsUndefined()) {
+    RotateTicketKey(NULL);
+    return Undefined();
+  }
+
+  if (!Buffer::HasInstance(args[0]) ||
+      Buffer::Length(args[0]->ToObject()) != sizeof(TicketKey)) {
+    return ThrowException(Exception::TypeError(
+          String::New("Ticket keys must be a 48 byte Buffer")));
+  }
+
+  RotateTicketKey(reinterpret_cast<unsigned char*>(
+      Buffer::Data(args[0]->ToObject())));
+  return Undefined();
+}
+#endif  // SSL_CTRL_SET_TLSEXT_TICKET_KEY_CB
+
 
 
 void SecureContext::Initialize(Handle<Object> target) {
@@ -149,6 +615,8 @@ void SecureContext::Initialize(Handle<Object> target) {
   NODE_SET_PROTOTYPE_METHOD(t, "setOptions", SecureContext::SetOptions);
   NODE_SET_PROTOTYPE_METHOD(t, "setSessionIdContext",
                                SecureContext::SetSessionIdContext);
+  NODE_SET_PROTOTYPE_METHOD(t, "enableSessionCache",
+                               SecureContext::EnableSessionCache);
   NODE_SET_PROTOTYPE_METHOD(t, "close", SecureContext::Close);
 
   target->Set(String::NewSymbol("SecureContext"), t->GetFunction());
@@ -569,6 +1037,42 @@ Handle<Value> SecureContext::SetSessionIdContext(const Arguments& args) {
   return True();
 }
 
+// enableSessionCache([shareTicketKeys])
+//
+// Makes the context keep its sessions in the cache shared by the whole
+// process. Its session id context must be set first; it is part of the
+// cache key. Unless `shareTicketKeys` is true the context keeps the ticket
+// keys OpenSSL generated for it.
+Handle<Value> SecureContext::EnableSessionCache(const Arguments& args) {
+  HandleScope scope;
+
+  SecureContext *sc = ObjectWrap::Unwrap<SecureContext>(args.Holder());
+
+  if (sc->ctx_->sid_ctx_length == 0) {
+    return ThrowException(Exception::Error(
+          String::New("Session id context required for the shared cache")));
+  }
+
+  SSL_CTX_set_session_cache_mode(sc->ctx_,
+      SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+  SSL_CTX_sess_set_new_cb(sc->ctx_, NewSessionCallback);
+  SSL_CTX_sess_set_get_cb(sc->ctx_, GetSessionCallback);
+  SSL_CTX_sess_set_remove_cb(sc->ctx_, RemoveSessionCallback);
+
+  CRYPTO_r_lock(session_cache_lock);
+  SSL_CTX_set_timeout(sc->ctx_, session_ttl);
+  CRYPTO_r_unlock(session_cache_lock);
+
+#ifdef SSL_CTRL_SET_TLSEXT_TICKET_KEY_CB
+  if (args.Length() >= 1 && args[0]->BooleanValue()) {
+    SSL_CTX_set_tlsext_ticket_key_cb(sc->ctx_, TicketKeyCallback);
+  }
+#endif
+
+  return True();
+}
+
+
 Handle<Value> SecureContext::Close(const Arguments& args) {
   HandleScope scope;
   SecureContext *sc = ObjectWrap::Unwrap<SecureContext>(args.Holder());
@@ -900,15 +1404,25 @@ Handle<Value> Connection::New(const Arguments& args) {
       "First argument must be a crypto module Credentials")));
   }
 
-  SecureContext *sc = ObjectWrap::Unwrap<SecureContext>(args[0]->ToObject());
+  p->InitSSL(args, 0);
 
-  bool is_server = args[1]->BooleanValue();
+  return args.This();
+}
+
+
+void Connection::InitSSL(const Arguments& args, int argi) {
+  HandleScope scope;
+
+  SecureContext *sc =
+      ObjectWrap::Unwrap<SecureContext>(args[argi]->ToObject());
 
-  p->ssl_ = SSL_new(sc->ctx_);
-  p->bio_read_ = BIO_new(BIO_s_mem());
-  p->bio_write_ = BIO_new(BIO_s_mem());
+  bool is_server = args[argi + 1]->BooleanValue();
 
-  SSL_set_app_data(p->ssl_, p);
+  ssl_ = SSL_new(sc->ctx_);
+  bio_read_ = BIO_new(BIO_s_mem());
+  bio_write_ = BIO_new(BIO_s_mem());
+
+  SSL_set_app_data(ssl_, this);
 
 #ifdef OPENSSL_NPN_NEGOTIATED
   if (is_server) {
@@ -929,27 +1443,27 @@ Handle<Value> Connection::New(const Arguments& args) {
   if (is_server) {
     SSL_CTX_set_tlsext_servername_callback(sc->ctx_, SelectSNIContextCallback_);
   } else {
-    String::Utf8Value servername(args[2]->ToString());
-    SSL_set_tlsext_host_name(p->ssl_, *servername);
+    String::Utf8Value servername(args[argi + 2]->ToString());
+    SSL_set_tlsext_host_name(ssl_, *servername);
   }
 #endif
 
-  SSL_set_bio(p->ssl_, p->bio_read_, p->bio_write_);
+  SSL_set_bio(ssl_, bio_read_, bio_write_);
 
 #ifdef SSL_MODE_RELEASE_BUFFERS
-  long mode = SSL_get_mode(p->ssl_);
-  SSL_set_mode(p->ssl_, mode | SSL_MODE_RELEASE_BUFFERS);
+  long mode = SSL_get_mode(ssl_);
+  SSL_set_mode(ssl_, mode | SSL_MODE_RELEASE_BUFFERS);
 #endif
 
 
   int verify_mode;
   if (is_server) {
-    bool request_cert = args[2]->BooleanValue();
+    bool request_cert = args[argi + 2]->BooleanValue();
     if (!request_cert) {
       // Note reject_unauthorized ignored.
       verify_mode = SSL_VERIFY_NONE;
     } else {
-      bool reject_unauthorized = args[3]->BooleanValue();
+      bool reject_unauthorized = args[argi + 3]->BooleanValue();
       verify_mode = SSL_VERIFY_PEER;
       if (reject_unauthorized) verify_mode |= SSL_VERIFY_FAIL_IF_NO_PEER_CERT;
     }
@@ -960,15 +1474,13 @@ Handle<Value> Connection::New(const Arguments& args) {
 
 
   // Always allow a connection. We'll reject in javascript.
-  SSL_set_verify(p->ssl_, verify_mode, VerifyCallback);
+  SSL_set_verify(ssl_, verify_mode, VerifyCallback);
 
-  if ((p->is_server_ = is_server)) {
-    SSL_set_accept_state(p->ssl_);
+  if ((is_server_ = is_server)) {
+    SSL_set_accept_state(ssl_);
   } else {
-    SSL_set_connect_state(p->ssl_);
+    SSL_set_connect_state(ssl_);
   }
-
-  return args.This();
 }
 
 
@@ -4047,6 +4559,7 @@ EIO_PBKDF2After(uv_work_t* req) {
     argv[1] = Undefined();
   }
 
+  LoopStatsScope stats_scope(LoopStats::PHASE_EIO, "pbkdf2");
   TryCatch try_catch;
 
   request->callback->Call(Context::GetCurrent()->Global(), 2, argv);
@@ -4200,6 +4713,7 @@ void RandomBytesAfter(uv_work_t* work_req) {
   Handle<Value> argv[2];
   RandomBytesCheck(req, argv);
 
+  LoopStatsScope stats_scope(LoopStats::PHASE_EIO, "randomBytes");
   TryCatch tc;
   req->callback_->Call(Context::GetCurrent()->Global(), 2, argv);
 
@@ -4253,10 +4767,9 @@ Handle<Value> RandomBytes(const Arguments& args) {
 }
 
 
-void InitCrypto(Handle<Object> target) {
-  HandleScope scope;
-  NODE_STATICS_NEW(node_crypto, CryptoStatics, statics);
-
+// OpenSSL's state, its locks and the session cache are shared by all
+// isolates. This runs once, before any of them is started.
+void InitCryptoOnce() {
   SSL_library_init();
   OpenSSL_add_all_algorithms();
   OpenSSL_add_all_digests();
@@ -4280,6 +4793,14 @@ void InitCrypto(Handle<Object> target) {
   assert(sk_SSL_COMP_num(comp_methods) == 0);
 #endif
 
+  SessionCacheInit();
+}
+
+
+void InitCrypto(Handle<Object> target) {
+  HandleScope scope;
+  NODE_STATICS_NEW(node_crypto, CryptoStatics, statics);
+
   SecureContext::Initialize(target);
   Connection::Initialize(target);
   Cipher::Initialize(target);
@@ -4294,6 +4815,13 @@ void InitCrypto(Handle<Object> target) {
   NODE_SET_METHOD(target, "randomBytes", RandomBytes<RAND_bytes>);
   NODE_SET_METHOD(target, "pseudoRandomBytes", RandomBytes<RAND_pseudo_bytes>);
 
+  NODE_SET_METHOD(target, "configureSessionCache", ConfigureSessionCache);
+  NODE_SET_METHOD(target, "flushSessionCache", FlushSessionCache);
+  NODE_SET_METHOD(target, "getSessionCacheStats", GetSessionCacheStats);
+#ifdef SSL_CTRL_SET_TLSEXT_TICKET_KEY_CB
+  NODE_SET_METHOD(target, "rotateTicketKeys", RotateTicketKeys);
+#endif
+
   statics->subject_symbol    = NODE_PSYMBOL("subject");
   statics->issuer_symbol     = NODE_PSYMBOL("issuer");
   statics->valid_from_symbol = NODE_PSYMBOL("valid_from");
@@ -67,6 +67,7 @@ class SecureContext : ObjectWrap {
   static v8::Handle<v8::Value> SetCiphers(const v8::Arguments& args);
   static v8::Handle<v8::Value> SetOptions(const v8::Arguments& args);
   static v8::Handle<v8::Value> SetSessionIdContext(const v8::Arguments& args);
+  static v8::Handle<v8::Value> EnableSessionCache(const v8::Arguments& args);
   static v8::Handle<v8::Value> Close(const v8::Arguments& args);
 
   SecureContext() : ObjectWrap() {
@@ -98,7 +99,7 @@ class SecureContext : ObjectWrap {
  private:
 };
 
-class Connection : ObjectWrap {
+class Connection : public ObjectWrap {
  public:
   static void Initialize(v8::Handle<v8::Object> target);
 
@@ -154,6 +155,10 @@ class Connection : ObjectWrap {
   static int SelectSNIContextCallback_(SSL *s, int *ad, void* arg);
 #endif
 
+  // Sets up the SSL object and its memory BIOs. The arguments are those
+  // of the JavaScript constructor, starting at `argi`.
+  void InitSSL(const v8::Arguments& args, int argi);
+
   int HandleBIOError(BIO *bio, const char* func, int rv);
   int HandleSSLError(const char* func, int rv);
 
@@ -189,7 +194,6 @@ class Connection : ObjectWrap {
 #endif
   }
 
- private:
   BIO *bio_read_;
   BIO *bio_write_;
   SSL *ssl_;
@@ -197,6 +201,7 @@ class Connection : ObjectWrap {
   bool is_server_; /* coverity[member_decl] */
 };
 
+void InitCryptoOnce();
 void InitCrypto(v8::Handle<v8::Object> target);
 
 }  // namespace crypto
@@ -0,0 +1,424 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <node.h>
+#include <node_dns_cache.h>
+
+#include <assert.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace node {
+
+using v8::Arguments;
+using v8::Exception;
+using v8::Handle;
+using v8::HandleScope;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::String;
+using v8::ThrowException;
+using v8::Value;
+
+
+static const size_t kMaxName = 256;
+
+// Keys are the type followed by the lower-cased name.
+struct Entry {
+  Entry* next;        // hash chain
+  Entry* lru_prev;    // towards the most recently used entry
+  Entry* lru_next;
+  unsigned int hash;
+  size_t length;
+  uint64_t expires;   // uv_hrtime() / 1e6
+  DnsCache::Answer* answer;
+  char* Key() { return reinterpret_cast<char*>(this + 1); }
+};
+
+struct Stats {
+  double hits;
+  double negative_hits;
+  double misses;
+  double inserts;
+  double expired;
+  double evictions;
+  double coalesced;
+};
+
+static uv_mutex_t mutex;
+static Entry** buckets;
+static size_t mask;
+static size_t count;
+static Entry* lru_head;  // most recently used
+static Entry* lru_tail;
+static Stats stats;
+
+static bool enabled = true;
+static size_t max_entries = 1000;
+static uint64_t max_ttl = 300000;     // ms
+static uint64_t negative_ttl = 5000;  // ms
+static uint64_t lookup_ttl = 5000;    // ms
+
+
+static uint64_t Now() {
+  return uv_hrtime() / 1000000;
+}
+
+
+// FNV-1a.
+static unsigned int Hash(const char* key, size_t length) {
+  unsigned int h = 2166136261U;
+  for (size_t i = 0; i < length; i++) {
+    h = (h ^ static_cast<unsigned char>(key[i])) * 16777619U;
+  }
+  return h;
+}
+
+
+// Returns the key length, or 0 if the name is too long to be cached.
+static size_t MakeKey(DnsCache::Type type, const char* name, char* key) {
+  size_t length = strlen(name);
+  if (length == 0 || length >= kMaxName) return 0;
+  key[0] = static_cast<char>('0' + type);
+  for (size_t i = 0; i < length; i++) {
+    key[i + 1] = tolower(static_cast<unsigned char>(name[i]));
+  }
+  return length + 1;
+}
+
+
+static void Grow() {
+  size_t size = buckets ? (mask + 1) * 2 : 64;
+  Entry** b = new Entry*[size];
+  memset(b, 0, size * sizeof(*b));
+
+  for (size_t i = 0; buckets && i <= mask; i++) {
+    Entry* e = buckets[i];
+    while (e) {
+      Entry* next = e->next;
+      e->next = b[e->hash & (size - 1)];
+      b[e->hash & (size - 1)] = e;
+      e = next;
+    }
+  }
+
+  delete[] buckets;
+  buckets = b;
+  mask = size - 1;
+}
+
+
+static void LruUnlink(Entry* e) {
+  if (e->lru_prev) e->lru_prev->lru_next = e->lru_next;
+  else lru_head = e->lru_next;
+  if (e->lru_next) e->lru_next->lru_prev = e->lru_prev;
+  else lru_tail = e->lru_prev;
+}
+
+
+static void LruPush(Entry* e) {
+  e->lru_prev = NULL;
+  e->lru_next = lru_head;
+  if (lru_head) lru_head->lru_prev = e;
+  lru_head = e;
+  if (lru_tail == NULL) lru_tail = e;
+}
+
+
+static Entry* Find(const char* key, size_t length, unsigned int hash) {
+  if (buckets == NULL) return NULL;
+  for (Entry* e = buckets[hash & mask]; e; e = e->next) {
+    if (e->hash == hash && e->length == length &&
+        memcmp(e->Key(), key, length) == 0) {
+      return e;
+    }
+  }
+  return NULL;
+}
+
+
+static void Remove(Entry* e) {
+  Entry** slot = &buckets[e->hash & mask];
+  while (*slot != e) slot = &(*slot)->next;
+  *slot = e->next;
+  LruUnlink(e);
+  DnsCache::FreeAnswer(e->answer);
+  free(e);
+  count--;
+}
+
+
+static void RemoveAll() {
+  while (lru_head) Remove(lru_head);
+}
+
+
+DnsCache::Answer* DnsCache::NewAnswer() {
+  Answer* a = static_cast<Answer*>(malloc(sizeof(Answer)));
+  a->error = 0;
+  a->sys_error = 0;
+  a->count = 0;
+  a->size = 0;
+  return a;
+}
+
+
+DnsCache::Answer* DnsCache::AddAddress(Answer* a, const char* address) {
+  size_t length = strlen(address) + 1;
+  a = static_cast<Answer*>(realloc(a, sizeof(Answer) + a->size + length));
+  memcpy(a->Data() + a->size, address, length);
+  a->size += length;
+  a->count++;
+  return a;
+}
+
+
+DnsCache::Answer* DnsCache::NewError(int error, int sys_error) {
+  Answer* a = NewAnswer();
+  a->error = error;
+  a->sys_error = sys_error;
+  return a;
+}
+
+
+DnsCache::Answer* DnsCache::CopyAnswer(const Answer* a) {
+  Answer* copy = static_cast<Answer*>(malloc(sizeof(Answer) + a->size));
+  memcpy(copy, a, sizeof(Answer) + a->size);
+  return copy;
+}
+
+
+void DnsCache::FreeAnswer(Answer* a) {
+  free(a);
+}
+
+
+void DnsCache::InitOnce() {
+  uv_mutex_init(&mutex);
+  memset(&stats, 0, sizeof(stats));
+}
+
+
+bool DnsCache::Enabled() {
+  return enabled;
+}
+
+
+DnsCache::Answer* DnsCache::Get(Type type, const char* name) {
+  char key[kMaxName + 1];
+  size_t length = MakeKey(type, name, key);
+  if (length == 0 || !enabled) return NULL;
+  unsigned int hash = Hash(key, length);
+
+  Answer* a = NULL;
+  uv_mutex_lock(&mutex);
+
+  Entry* e = Find(key, length, hash);
+  if (e && e->expires <= Now()) {
+    Remove(e);
+    stats.expired++;
+    e = NULL;
+  }
+
+  if (e) {
+    LruUnlink(e);
+    LruPush(e);
+    a = CopyAnswer(e->answer);
+    if (a->error) stats.negative_hits++;
+    else stats.hits++;
+  } else {
+    stats.misses++;
+  }
+
+  uv_mutex_unlock(&mutex);
+  return a;
+}
+
+
+// Only "no such name" is worth remembering; timeouts and refusals are
+// likely to go away on their own.
+static bool IsNegative(DnsCache::Type type, int error) {
+  if (type == DnsCache::QUERY_A || type == DnsCache::QUERY_AAAA) {
+    return error == ARES_ENOTFOUND || error == ARES_ENODATA;
+  }
+  return error == UV_ENOENT;
+}
+
+
+void DnsCache::Put(Type type, const char* name, const Answer* a,
+                   unsigned int ttl) {
+  char key[kMaxName + 1];
+  size_t length = MakeKey(type, name, key);
+  if (length == 0 || !enabled || max_entries == 0) return;
+
+  uint64_t lifetime;
+  if (a->error) {
+    if (!IsNegative(type, a->error)) return;
+    lifetime = negative_ttl;
+  } else if (type == QUERY_A || type == QUERY_AAAA) {
+    lifetime = static_cast<uint64_t>(ttl) * 1000;
+    if (lifetime > max_ttl) lifetime = max_ttl;
+  } else {
+    lifetime = lookup_ttl;
+  }
+  if (lifetime == 0 || (a->error == 0 && a->count == 0)) return;
+
+  unsigned int hash = Hash(key, length);
+  uv_mutex_lock(&mutex);
+
+  Entry* e = Find(key, length, hash);
+  if (e) {
+    Remove(e);
+  } else {
+    while (count >= max_entries) {
+      Remove(lru_tail);
+      stats.evictions++;
+    }
+  }
+
+  if (count >= mask) Grow();
+
+  e = static_cast<Entry*>(malloc(sizeof(Entry) + length));
+  e->hash = hash;
+  e->length = length;
+  e->expires = Now() + lifetime;
+  e->answer = CopyAnswer(a);
+  memcpy(e->Key(), key, length);
+
+  Entry** slot = &buckets[hash & mask];
+  e->next = *slot;
+  *slot = e;
+  LruPush(e);
+  count++;
+  stats.inserts++;
+
+  uv_mutex_unlock(&mutex);
+}
+
+
+void DnsCache::CountCoalesced() {
+  uv_mutex_lock(&mutex);
+  stats.coalesced++;
+  uv_mutex_unlock(&mutex);
+}
+
+
+static bool GetMilliseconds(Local<Object> options, const char* name,
+                            uint64_t* value) {
+  Local<Value> v = options->Get(String::New(name));
+  if (v->IsUndefined()) return true;
+  if (!v->IsNumber() || v->NumberValue() < 0) return false;
+  *value = static_cast<uint64_t>(v->NumberValue());
+  return true;
+}
+
+
+// setCacheOptions({ enabled, maxEntries, maxTtl, negativeTtl, lookupTtl })
+Handle<Value> DnsCache::SetOptions(const Arguments& args) {
+  HandleScope scope;
+
+  if (!args[0]->IsObject()) {
+    return ThrowException(Exception::TypeError(
+        String::New("options must be an object")));
+  }
+
+  Local<Object> options = args[0]->ToObject();
+  uint64_t new_max_ttl = max_ttl;
+  uint64_t new_negative_ttl = negative_ttl;
+  uint64_t new_lookup_ttl = lookup_ttl;
+  uint64_t new_max_entries = max_entries;
+
+  if (!GetMilliseconds(options, "maxTtl", &new_max_ttl) ||
+      !GetMilliseconds(options, "negativeTtl", &new_negative_ttl) ||
+      !GetMilliseconds(options, "lookupTtl", &new_lookup_ttl)) {
+    return ThrowException(Exception::TypeError(
+        String::New("TTLs must be a number of milliseconds")));
+  }
+
+  if (!GetMilliseconds(options, "maxEntries", &new_max_entries)) {
+    return ThrowException(Exception::TypeError(
+        String::New("maxEntries must be a number")));
+  }
+
+  Local<Value> on = options->Get(String::New("enabled"));
+
+  uv_mutex_lock(&mutex);
+  max_ttl = new_max_ttl;
+  negative_ttl = new_negative_ttl;
+  lookup_ttl = new_lookup_ttl;
+  max_entries = static_cast<size_t>(new_max_entries);
+  if (!on->IsUndefined()) enabled = on->BooleanValue();
+  if (!enabled) {
+    RemoveAll();
+  } else {
+    while (count > max_entries) {
+      Remove(lru_tail);
+      stats.evictions++;
+    }
+  }
+  uv_mutex_unlock(&mutex);
+
+  return v8::Undefined();
+}
+
+
+// getCacheStats([reset])
+Handle<Value> DnsCache::GetStats(const Arguments& args) {
+  HandleScope scope;
+  Local<Object> obj = Object::New();
+
+  uv_mutex_lock(&mutex);
+  Stats s = stats;
+  size_t size = count;
+  if (args[0]->BooleanValue()) memset(&stats, 0, sizeof(stats));
+  obj->Set(String::New("enabled"), v8::Boolean::New(enabled));
+  obj->Set(String::New("maxEntries"), Number::New(max_entries));
+  obj->Set(String::New("maxTtl"), Number::New(max_ttl));
+  obj->Set(String::New("negativeTtl"), Number::New(negative_ttl));
+  obj->Set(String::New("lookupTtl"), Number::New(lookup_ttl));
+  uv_mutex_unlock(&mutex);
+
+  obj->Set(String::New("size"), Number::New(size));
+  obj->Set(String::New("hits"), Number::New(s.hits));
+  obj->Set(String::New("negativeHits"), Number::New(s.negative_hits));
+  obj->Set(String::New("misses"), Number::New(s.misses));
+  obj->Set(String::New("inserts"), Number::New(s.inserts));
+  obj->Set(String::New("expired"), Number::New(s.expired));
+  obj->Set(String::New("evictions"), Number::New(s.evictions));
+  obj->Set(String::New("coalesced"), Number::New(s.coalesced));
+
+  return scope.Close(obj);
+}
+
+
+// clearCache()
+Handle<Value> DnsCache::Clear(const Arguments& args) {
+  uv_mutex_lock(&mutex);
+  RemoveAll();
+  uv_mutex_unlock(&mutex);
+  return v8::Undefined();
+}
+
+
+}  // namespace node
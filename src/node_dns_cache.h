@@ -0,0 +1,91 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef NODE_DNS_CACHE_H_
+#define NODE_DNS_CACHE_H_
+
+#include <v8.h>
+#include <stddef.h>
+
+namespace node {
+
+// Answers to dns.lookup() and to A and AAAA queries, kept for every isolate
+// in the process so that connecting to the same few hosts over and over
+// does not cost a thread pool round trip or a DNS query each time.
+//
+// Query answers live as long as the smallest TTL in the reply, capped at
+// max_ttl. getaddrinfo() does not report TTLs, so lookups live for
+// lookup_ttl. A name that does not exist is remembered for negative_ttl;
+// other errors are not cached. When the cache holds max_entries names the
+// least recently used one is dropped.
+class DnsCache {
+ public:
+  enum Type {
+    LOOKUP_ANY = 0,
+    LOOKUP_INET,
+    LOOKUP_INET6,
+    QUERY_A,
+    QUERY_AAAA,
+    TYPE_COUNT
+  };
+
+  // A list of addresses, or the error the resolution failed with: a
+  // uv_err_code for lookups, an ares status for queries.
+  struct Answer {
+    int error;
+    int sys_error;   // the system error behind a lookup error
+    int count;
+    size_t size;
+    // `count` NUL-terminated addresses, back to back.
+    char* Data() { return reinterpret_cast<char*>(this + 1); }
+  };
+
+  // Returns an empty answer. AddAddress() may move it.
+  static Answer* NewAnswer();
+  static Answer* AddAddress(Answer* a, const char* address);
+  static Answer* NewError(int error, int sys_error);
+  static Answer* CopyAnswer(const Answer* a);
+  static void FreeAnswer(Answer* a);
+
+  // Called once per process, before any isolate starts.
+  static void InitOnce();
+
+  static bool Enabled();
+
+  // Returns a copy of the cached answer, or NULL.
+  static Answer* Get(Type type, const char* name);
+
+  // Caches `a`, which stays owned by the caller. `ttl` is in seconds and
+  // only used for query answers; the other lifetimes come from the options.
+  static void Put(Type type, const char* name, const Answer* a,
+                  unsigned int ttl);
+
+  // Counts a resolution that was folded into one already in flight.
+  static void CountCoalesced();
+
+  static v8::Handle<v8::Value> SetOptions(const v8::Arguments& args);
+  static v8::Handle<v8::Value> GetStats(const v8::Arguments& args);
+  static v8::Handle<v8::Value> Clear(const v8::Arguments& args);
+};
+
+}  // namespace node
+
+#endif  // NODE_DNS_CACHE_H_
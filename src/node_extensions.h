@@ -24,6 +24,7 @@ NODE_EXT_LIST_START
 NODE_EXT_LIST_ITEM(node_buffer)
 #if HAVE_OPENSSL
 NODE_EXT_LIST_ITEM(node_crypto)
+NODE_EXT_LIST_ITEM(node_tls_wrap)
 #endif
 NODE_EXT_LIST_ITEM(node_evals)
 NODE_EXT_LIST_ITEM(node_fs)
@@ -32,6 +33,7 @@ NODE_EXT_LIST_ITEM(node_http_parser)
 NODE_EXT_LIST_ITEM(node_signal_watcher)
 #endif
 NODE_EXT_LIST_ITEM(node_os)
+NODE_EXT_LIST_ITEM(node_resolver)
 NODE_EXT_LIST_ITEM(node_zlib)
 
 // libuv rewrite
@@ -43,6 +45,9 @@ NODE_EXT_LIST_ITEM(node_cares_wrap)
 NODE_EXT_LIST_ITEM(node_tty_wrap)
 NODE_EXT_LIST_ITEM(node_process_wrap)
 NODE_EXT_LIST_ITEM(node_fs_event_wrap)
+#ifdef NODE_FORK_ISOLATE
+NODE_EXT_LIST_ITEM(node_isolate_channel)
+#endif
 
 NODE_EXT_LIST_END
 
@@ -22,19 +22,27 @@
 #include "node.h"
 #include "node_file.h"
 #include "node_buffer.h"
+#include "node_codec.h"
 #ifdef __POSIX__
 # include "node_stat_watcher.h"
 #endif
 #include "req_wrap.h"
+#include "node_loop_stats.h"
 
 #include <fcntl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <assert.h>
+#include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <limits.h>
 
+#ifdef __POSIX__
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+
 #if defined(__MINGW32__) || defined(_MSC_VER)
 # include <io.h>
 # include <platform_win32.h>
@@ -182,6 +190,7 @@ static void After(uv_fs_t *req) {
     }
   }
 
+  LoopStatsScope stats_scope(LoopStats::PHASE_EIO, "oncomplete");
   TryCatch try_catch;
 
   callback->Call(req_wrap->object_, argc, argv);
@@ -1005,6 +1014,450 @@ static Handle<Value> FUTimes(const Arguments& args) {
 }
 
 
+// fs.readFile() in one trip to the thread pool: open, fstat, read and close
+// run back to back in a single work item and the file ends up in one block
+// sized from fstat. For utf8 and ascii the worker decodes the text as well,
+// so the main thread only has to hand the result to V8.
+class ReadFileReq : public ReqWrap<uv_work_t> {
+ public:
+  enum Result { RAW, ASCII_TEXT, UTF16_TEXT };
+
+  ReadFileReq(const char* path, enum encoding enc)
+      : encoding_(enc), buf_(NULL), length_(0), units_(NULL), nunits_(0),
+        result_(RAW), errorno_(0), syscall_(NULL) {
+    path_ = strdup(path);
+  }
+
+  ~ReadFileReq() {
+    free(path_);
+    free(buf_);
+    free(units_);
+  }
+
+  void Work();
+  Local<Value> BuildError();
+  Local<Value> BuildResult();
+
+  char* path_;
+  enum encoding encoding_;
+  char* buf_;
+  size_t length_;
+  uint16_t* units_;
+  size_t nunits_;
+  Result result_;
+  int errorno_;
+  const char* syscall_;
+};
+
+
+// Buffer lengths are small integers; nothing larger is read into memory.
+static const size_t kReadFileMax = 0x3fffffff;
+
+// Strings at least this long are handed to V8 as external strings that
+// point at the worker's output instead of being copied into the heap.
+static const size_t kExternalStringMin = 16 * 1024;
+
+
+class ExternalAsciiData : public String::ExternalAsciiStringResource {
+ public:
+  ExternalAsciiData(char* data, size_t length)
+      : data_(data), length_(length) {
+    V8::AdjustAmountOfExternalAllocatedMemory(length_);
+  }
+  ~ExternalAsciiData() {
+    free(data_);
+    V8::AdjustAmountOfExternalAllocatedMemory(-static_cast<int>(length_));
+  }
+  const char* data() const { return data_; }
+  size_t length() const { return length_; }
+
+ private:
+  char* data_;
+  size_t length_;
+};
+
+
+class ExternalTwoByteData : public String::ExternalStringResource {
+ public:
+  ExternalTwoByteData(uint16_t* data, size_t length)
+      : data_(data), length_(length) {
+    V8::AdjustAmountOfExternalAllocatedMemory(length_ * sizeof(*data_));
+  }
+  ~ExternalTwoByteData() {
+    free(data_);
+    V8::AdjustAmountOfExternalAllocatedMemory(
+        -static_cast<int>(length_ * sizeof(*data_)));
+  }
+  const uint16_t* data() const { return data_; }
+  size_t length() const { return length_; }
+
+ private:
+  uint16_t* data_;
+  size_t length_;
+};
+
+
+#ifndef O_BINARY
+# define O_BINARY 0
+#endif
+
+#ifdef _WIN32
+// The CRT keeps the operating system's error code in _doserrno, which is
+// what uv_translate_sys_error() expects on windows.
+# define READ_FILE_ERRNO _doserrno
+#else
+# define READ_FILE_ERRNO errno
+#endif
+
+
+// Runs on the thread pool, or inline for readFileSync(). No V8 in here.
+void ReadFileReq::Work() {
+  int fd;
+  do
+    fd = open(path_, O_RDONLY | O_BINARY);
+  while (fd == -1 && errno == EINTR);
+  if (fd == -1) {
+    errorno_ = READ_FILE_ERRNO;
+    syscall_ = "open";
+    return;
+  }
+
+  NODE_STAT_STRUCT s;
+  if (NODE_FSTAT(fd, &s)) {
+    errorno_ = READ_FILE_ERRNO;
+    syscall_ = "fstat";
+    close(fd);
+    return;
+  }
+
+  // Files in /proc and friends report a size of zero, pipes and character
+  // devices have no size at all. Those are read in growing steps until EOF.
+  size_t size = s.st_size > 0 ? static_cast<size_t>(s.st_size) : 0;
+  if (size > kReadFileMax) {
+    errorno_ = ENOMEM;
+    syscall_ = "read";
+    close(fd);
+    return;
+  }
+
+  // One byte more than fstat says so that EOF is seen by the first read
+  // instead of costing another one.
+  size_t capacity = size > 0 ? size + 1 : 8192;
+  buf_ = static_cast<char*>(malloc(capacity));
+  if (buf_ == NULL) {
+    errorno_ = ENOMEM;
+    syscall_ = "read";
+    close(fd);
+    return;
+  }
+
+  for (;;) {
+    if (length_ == capacity) {
+      if (capacity >= kReadFileMax) {
+        errorno_ = ENOMEM;
+        syscall_ = "read";
+        break;
+      }
+      capacity = MIN(capacity * 2, kReadFileMax);
+      char* p = static_cast<char*>(realloc(buf_, capacity));
+      if (p == NULL) {
+        errorno_ = ENOMEM;
+        syscall_ = "read";
+        break;
+      }
+      buf_ = p;
+    }
+
+    ssize_t n = read(fd, buf_ + length_, capacity - length_);
+    if (n == 0) break;
+    if (n == -1) {
+      if (errno == EINTR) continue;
+      errorno_ = READ_FILE_ERRNO;
+      syscall_ = "read";
+      break;
+    }
+    length_ += n;
+  }
+
+  close(fd);
+
+  if (syscall_ != NULL) return;
+
+  if (capacity - length_ > 4096) {
+    char* p = static_cast<char*>(realloc(buf_, length_ ? length_ : 1));
+    if (p != NULL) buf_ = p;
+  }
+
+  if (encoding_ == UTF8 || encoding_ == ASCII) {
+    if (codec::AsciiPrefix(buf_, length_) == length_) {
+      result_ = ASCII_TEXT;
+    } else if (length_ >= codec::kUtf8DecodeMin) {
+      // Same reasoning as Buffer::Utf8Slice: well-formed BMP text can be
+      // handed to V8 as UTF-16, everything else goes through its decoder.
+      units_ = static_cast<uint16_t*>(malloc(length_ * sizeof(*units_)));
+      ptrdiff_t n = units_ ? codec::Utf8DecodeBmp(buf_, length_, units_) : -1;
+      if (n >= 0) {
+        nunits_ = n;
+        result_ = UTF16_TEXT;
+        free(buf_);
+        buf_ = NULL;
+      } else {
+        free(units_);
+        units_ = NULL;
+      }
+    }
+  }
+}
+
+
+// Buffers with a free callback are not accounted for by Buffer itself; the
+// length travels in the hint so the release can be reported to V8 too.
+static void ReadFileFree(char* data, void* hint) {
+  free(data);
+  V8::AdjustAmountOfExternalAllocatedMemory(
+      -static_cast<int>(reinterpret_cast<intptr_t>(hint)));
+}
+
+
+Local<Value> ReadFileReq::BuildError() {
+  return FSError(uv_translate_sys_error(errorno_), syscall_, NULL, path_);
+}
+
+
+Local<Value> ReadFileReq::BuildResult() {
+  Local<String> string;
+
+  switch (result_) {
+    case ASCII_TEXT:
+      if (length_ >= kExternalStringMin) {
+        string = String::NewExternal(new ExternalAsciiData(buf_, length_));
+        buf_ = NULL;
+        return string;
+      }
+      return String::New(buf_, length_);
+
+    case UTF16_TEXT:
+      if (nunits_ >= kExternalStringMin) {
+        string = String::NewExternal(new ExternalTwoByteData(units_, nunits_));
+        units_ = NULL;
+        return string;
+      }
+      return String::New(units_, nunits_);
+
+    case RAW:
+      if (encoding_ == UTF8 || encoding_ == ASCII) {
+        return String::New(buf_, length_);
+      }
+      break;
+  }
+
+  // Hand the block over to a SlowBuffer. fs.js slices it into a Buffer.
+  Buffer* b = Buffer::New(buf_, length_, ReadFileFree,
+                          reinterpret_cast<void*>(length_));
+  Local<Object> buffer = Local<Object>::New(b->handle_);
+  V8::AdjustAmountOfExternalAllocatedMemory(length_);
+  buf_ = NULL;
+  return buffer;
+}
+
+
+static void ReadFileDoWork(uv_work_t* req) {
+  static_cast<ReadFileReq*>(req->data)->Work();
+}
+
+
+static void ReadFileAfter(uv_work_t* req) {
+  HandleScope scope;
+  FileStatics *statics = NODE_STATICS_GET(node_fs, FileStatics);
+
+  ReadFileReq* req_wrap = static_cast<ReadFileReq*>(req->data);
+  assert(&req_wrap->req_ == req);
+  Local<Value> callback_v = req_wrap->object_->Get(statics->oncomplete_sym);
+  assert(callback_v->IsFunction());
+  Local<Function> callback = Local<Function>::Cast(callback_v);
+
+  int argc = 1;
+  Local<Value> argv[2];
+
+  if (req_wrap->syscall_ != NULL) {
+    argv[0] = req_wrap->BuildError();
+  } else {
+    argv[0] = Local<Value>::New(Null());
+    argv[1] = req_wrap->BuildResult();
+    argc = 2;
+  }
+
+  LoopStatsScope stats_scope(LoopStats::PHASE_EIO, "oncomplete");
+  TryCatch try_catch;
+
+  callback->Call(req_wrap->object_, argc, argv);
+
+  if (try_catch.HasCaught()) {
+    FatalException(try_catch);
+  }
+
+  delete req_wrap;
+}
+
+
+// readFile(path, encoding, [callback])
+static Handle<Value> ReadFile(const Arguments& args) {
+  HandleScope scope;
+  FileStatics *statics = NODE_STATICS_GET(node_fs, FileStatics);
+
+  if (args.Length() < 1 || !args[0]->IsString()) {
+    return THROW_BAD_ARGS;
+  }
+
+  String::Utf8Value path(args[0]->ToString());
+  enum encoding enc = args[1]->IsString() ? ParseEncoding(args[1], BINARY)
+                                          : BINARY;
+
+  ReadFileReq* req_wrap = new ReadFileReq(*path, enc);
+  req_wrap->Dispatched();
+
+  if (args[2]->IsFunction()) {
+    req_wrap->object_->Set(statics->oncomplete_sym, args[2]);
+    int r = uv_queue_work(Isolate::GetCurrentLoop(),
+                          &req_wrap->req_,
+                          ReadFileDoWork,
+                          ReadFileAfter);
+    assert(r == 0);
+    return scope.Close(req_wrap->object_);
+  }
+
+  req_wrap->Work();
+
+  Local<Value> result;
+  if (req_wrap->syscall_ != NULL) {
+    result = req_wrap->BuildError();
+    delete req_wrap;
+    return ThrowException(result);
+  }
+
+  result = req_wrap->BuildResult();
+  delete req_wrap;
+  return scope.Close(result);
+}
+
+
+#ifdef __POSIX__
+// What MUnmap() needs to undo a mapping: mmap() wants a page aligned
+// offset, so the Buffer usually starts somewhere inside the first page.
+struct MappedRegion {
+  void* base;
+  size_t length;
+};
+
+
+static void MUnmap(char* data, void* hint) {
+  MappedRegion* region = static_cast<MappedRegion*>(hint);
+  munmap(region->base, region->length);
+  V8::AdjustAmountOfExternalAllocatedMemory(
+      -static_cast<int>(region->length));
+  delete region;
+}
+
+
+static int ParseAdvice(Handle<Value> advice_v) {
+  if (advice_v->IsUndefined() || advice_v->IsNull()) return MADV_NORMAL;
+
+  String::Utf8Value advice(advice_v->ToString());
+  if (strcasecmp(*advice, "normal") == 0) return MADV_NORMAL;
+  if (strcasecmp(*advice, "sequential") == 0) return MADV_SEQUENTIAL;
+  if (strcasecmp(*advice, "random") == 0) return MADV_RANDOM;
+  if (strcasecmp(*advice, "willneed") == 0) return MADV_WILLNEED;
+  return -1;
+}
+#endif
+
+
+// buffer = mmap(fd, offset, [length], [advice])
+//
+// The mapping is private: pages come straight from the page cache, and are
+// shared with every other process and isolate mapping the same file, until
+// they are written to. It goes away when the buffer is collected.
+static Handle<Value> MMap(const Arguments& args) {
+  HandleScope scope;
+
+  if (args.Length() < 1 || !args[0]->IsInt32()) {
+    return THROW_BAD_ARGS;
+  }
+
+#ifdef __POSIX__
+  int fd = args[0]->Int32Value();
+
+  ASSERT_OFFSET(args[1]);
+  int64_t offset = GET_OFFSET(args[1]);
+  if (offset < 0) offset = 0;
+
+  int advice = ParseAdvice(args[3]);
+  if (advice == -1) {
+    return ThrowException(Exception::TypeError(
+          String::New("Unknown advice")));
+  }
+
+  // Touching a page past the end of the file raises SIGBUS, so the mapping
+  // never goes beyond it, whatever length was asked for.
+  NODE_STAT_STRUCT s;
+  if (NODE_FSTAT(fd, &s)) {
+    return ThrowException(FSError(uv_translate_sys_error(errno), "fstat"));
+  }
+  int64_t length = s.st_size > offset ? s.st_size - offset : 0;
+
+  if (!args[2]->IsUndefined() && !args[2]->IsNull()) {
+    ASSERT_OFFSET(args[2]);
+    int64_t wanted = GET_OFFSET(args[2]);
+    if (wanted < 0) return THROW_BAD_ARGS;
+    if (wanted < length) length = wanted;
+  }
+
+  // Buffer lengths are small integers.
+  if (length > 0x3fffffff) {
+    return ThrowException(FSError(UV_ENOMEM, "mmap"));
+  }
+
+  if (length == 0) {
+    Buffer* b = Buffer::New(0);
+    return scope.Close(Local<Object>::New(b->handle_));
+  }
+
+  static const int64_t page_size = sysconf(_SC_PAGESIZE);
+  int64_t skip = offset % page_size;
+
+  MappedRegion* region = new MappedRegion;
+  region->length = length + skip;
+  region->base = mmap(NULL,
+                      region->length,
+                      PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE,
+                      fd,
+                      offset - skip);
+  if (region->base == MAP_FAILED) {
+    int err = errno;
+    delete region;
+    return ThrowException(FSError(uv_translate_sys_error(err), "mmap"));
+  }
+
+  // Only a hint; a failure does not make the mapping any less usable.
+  if (advice != MADV_NORMAL) {
+    madvise(region->base, region->length, advice);
+  }
+
+  // Lets the GC know what collecting the buffer would give back.
+  V8::AdjustAmountOfExternalAllocatedMemory(region->length);
+
+  Buffer* b = Buffer::New(static_cast<char*>(region->base) + skip,
+                          length,
+                          MUnmap,
+                          region);
+  return scope.Close(Local<Object>::New(b->handle_));
+#else  // !__POSIX__
+  return ThrowException(FSError(UV_ENOSYS, "mmap"));
+#endif
+}
+
+
 void File::Initialize(Handle<Object> target) {
   HandleScope scope;
   FileStatics *statics = NODE_STATICS_GET(node_fs, FileStatics);
@@ -1012,6 +1465,8 @@ void File::Initialize(Handle<Object> target) {
   NODE_SET_METHOD(target, "close", Close);
   NODE_SET_METHOD(target, "open", Open);
   NODE_SET_METHOD(target, "read", Read);
+  NODE_SET_METHOD(target, "readFile", ReadFile);
+  NODE_SET_METHOD(target, "mmap", MMap);
   NODE_SET_METHOD(target, "fdatasync", Fdatasync);
   NODE_SET_METHOD(target, "fsync", Fsync);
   NODE_SET_METHOD(target, "rename", Rename);
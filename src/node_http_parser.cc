@@ -91,6 +91,10 @@ public:
     Persistent<String> upgrade_sym;
     Persistent<String> headers_sym;
     Persistent<String> url_sym;
+    Persistent<String> raw_headers_sym;
+    Persistent<String> header_offsets_sym;
+    Persistent<String> header_syms[32];  // see kCommonHeaders
+    Persistent<String> header_lower_syms[32];
     struct http_parser_settings settings;
     // This is a hack to get the current_buffer to the callbacks with the least
     // amount of overhead. Nothing else will run while http_parser_execute()
@@ -171,51 +175,199 @@ method_to_str(unsigned short m) {
 }
 
 
-// helper class for the Parser
-struct StringPtr {
-  StringPtr() {
-    on_heap_ = false;
-    Reset();
+static inline char ToLower(char c) {
+  return c >= 'A' && c <= 'Z' ? c | 0x20 : c;
+}
+
+
+// Header names that get a pre-interned symbol instead of a fresh string on
+// every request. A name matches if it is spelled exactly like this or in
+// all lowercase, which covers what clients send in practice; anything else
+// gets a string of its own so that the original case is preserved.
+#define HEADER(name) { name, sizeof(name) - 1 }
+static const struct {
+  const char* name;
+  size_t length;
+} kCommonHeaders[] = {
+  HEADER("Accept"),
+  HEADER("Accept-Charset"),
+  HEADER("Accept-Encoding"),
+  HEADER("Accept-Language"),
+  HEADER("Accept-Ranges"),
+  HEADER("Authorization"),
+  HEADER("Cache-Control"),
+  HEADER("Connection"),
+  HEADER("Content-Encoding"),
+  HEADER("Content-Length"),
+  HEADER("Content-Type"),
+  HEADER("Cookie"),
+  HEADER("Date"),
+  HEADER("ETag"),
+  HEADER("Expect"),
+  HEADER("Host"),
+  HEADER("If-Modified-Since"),
+  HEADER("If-None-Match"),
+  HEADER("Keep-Alive"),
+  HEADER("Last-Modified"),
+  HEADER("Location"),
+  HEADER("Origin"),
+  HEADER("Pragma"),
+  HEADER("Referer"),
+  HEADER("Server"),
+  HEADER("Set-Cookie"),
+  HEADER("Transfer-Encoding"),
+  HEADER("Upgrade"),
+  HEADER("User-Agent"),
+  HEADER("Vary"),
+  HEADER("X-Forwarded-For"),
+  HEADER("X-Requested-With")
+};
+#undef HEADER
+
+
+// Returns the interned symbol for a common header name, or an empty handle.
+static inline Handle<String> CommonHeader(const char* str, size_t size) {
+  HttpStatics *statics = NODE_STATICS_GET(node_http_parser, HttpStatics);
+
+  for (size_t i = 0; i < ARRAY_SIZE(kCommonHeaders); i++) {
+    const char* name = kCommonHeaders[i].name;
+
+    // Cheap rejects first: the length and the first letter.
+    if (kCommonHeaders[i].length != size) continue;
+    if ((str[0] | 0x20) != (name[0] | 0x20)) continue;
+
+    if (memcmp(str, name, size) == 0)
+      return statics->header_syms[i];
+
+    size_t j = 0;
+    while (j < size && str[j] == ToLower(name[j])) j++;
+    if (j == size)
+      return statics->header_lower_syms[i];
   }
 
+  return Handle<String>();
+}
 
-  ~StringPtr() {
-    Reset();
+
+// Bump allocator for header data that arrives in several pieces. The memory
+// is released in one go once the strings have been handed to JS land; the
+// first block is kept around for the next message on the same parser.
+class HeaderArena {
+public:
+  HeaderArena() : head_(NULL) {
+  }
+
+
+  ~HeaderArena() {
+    while (head_) {
+      Block* next = head_->next;
+      delete[] reinterpret_cast<char*>(head_);
+      head_ = next;
+    }
+  }
+
+
+  char* Alloc(size_t size) {
+    if (head_ == NULL || head_->size - head_->used < size) {
+      size_t block_size = kBlockSize;
+      while (block_size < size) block_size *= 2;
+
+      Block* b = reinterpret_cast<Block*>(
+          new char[sizeof(Block) + block_size]);
+      b->next = head_;
+      b->size = block_size;
+      b->used = 0;
+      head_ = b;
+    }
+
+    char* p = head_->Data() + head_->used;
+    head_->used += size;
+    return p;
+  }
+
+
+  // Grows the last allocation in place if there is room for it.
+  bool Extend(const char* p, size_t size, size_t extra) {
+    if (head_ == NULL) return false;
+    if (p + size != head_->Data() + head_->used) return false;
+    if (head_->size - head_->used < extra) return false;
+    head_->used += extra;
+    return true;
   }
 
 
   void Reset() {
-    if (on_heap_) {
-      delete[] str_;
-      on_heap_ = false;
+    if (head_ == NULL) return;
+
+    // Keep only the oldest block, it is the one most likely to be needed.
+    while (head_->next) {
+      Block* next = head_->next;
+      delete[] reinterpret_cast<char*>(head_);
+      head_ = next;
     }
+    head_->used = 0;
+  }
+
+
+private:
+  static const size_t kBlockSize = 4096;
+
+  struct Block {
+    Block* next;
+    size_t size;
+    size_t used;
+    char* Data() { return reinterpret_cast<char*>(this + 1); }
+  };
+
+  Block* head_;
+};
+
+
+// helper class for the Parser
+struct StringPtr {
+  StringPtr() {
+    Reset();
+  }
 
+
+  // The arena owns the memory, nothing to free.
+  void Reset() {
     str_ = NULL;
+    on_arena_ = false;
     size_ = 0;
   }
 
 
-  void Update(const char* str, size_t size) {
-    if (str_ == NULL)
+  void Update(const char* str, size_t size, HeaderArena* arena) {
+    if (str_ == NULL) {
       str_ = str;
-    else if (on_heap_ || str_ + size != str) {
-      // Non-consecutive input, make a copy on the heap.
-      // TODO Use slab allocation, O(n) allocs is bad.
-      char* s = new char[size_ + size];
-      memcpy(s, str_, size_);
-      memcpy(s + size_, str, size);
-
-      if (on_heap_)
-        delete[] str_;
-      else
-        on_heap_ = true;
-
-      str_ = s;
+    } else if (on_arena_ || str_ + size_ != str) {
+      // Non-consecutive input, make a copy in the parser's arena.
+      if (on_arena_ && arena->Extend(str_, size_, size)) {
+        memcpy(const_cast<char*>(str_) + size_, str, size);
+      } else {
+        char* s = arena->Alloc(size_ + size);
+        memcpy(s, str_, size_);
+        memcpy(s + size_, str, size);
+        str_ = s;
+        on_arena_ = true;
+      }
     }
     size_ += size;
   }
 
 
+  // Copies the data into the arena if it still points into the input, which
+  // is not ours to keep once execute() returns.
+  void Save(HeaderArena* arena) {
+    if (str_ == NULL || on_arena_) return;
+    char* s = arena->Alloc(size_);
+    memcpy(s, str_, size_);
+    str_ = s;
+    on_arena_ = true;
+  }
+
+
   Handle<String> ToString() const {
     if (str_)
       return String::New(str_, size_);
@@ -224,8 +376,20 @@ struct StringPtr {
   }
 
 
+  Handle<String> ToHeaderName() const {
+    if (str_ == NULL || size_ == 0)
+      return String::Empty();
+
+    Handle<String> sym = CommonHeader(str_, size_);
+    if (!sym.IsEmpty())
+      return sym;
+
+    return String::New(str_, size_);
+  }
+
+
   const char* str_;
-  bool on_heap_;
+  bool on_arena_;
   size_t size_;
 };
 
@@ -244,12 +408,13 @@ public:
   HTTP_CB(on_message_begin) {
     num_fields_ = num_values_ = -1;
     url_.Reset();
+    arena_.Reset();
     return 0;
   }
 
 
   HTTP_DATA_CB(on_url) {
-    url_.Update(at, length);
+    url_.Update(at, length, &arena_);
     return 0;
   }
 
@@ -268,7 +433,7 @@ public:
     assert(num_fields_ < (int)ARRAY_SIZE(fields_));
     assert(num_fields_ == num_values_ + 1);
 
-    fields_[num_fields_].Update(at, length);
+    fields_[num_fields_].Update(at, length, &arena_);
 
     return 0;
   }
@@ -283,7 +448,7 @@ public:
     assert(num_values_ < (int)ARRAY_SIZE(values_));
     assert(num_values_ == num_fields_);
 
-    values_[num_values_].Update(at, length);
+    values_[num_values_].Update(at, length, &arena_);
 
     return 0;
   }
@@ -304,9 +469,14 @@ public:
     }
     else {
       // Fast case, pass headers and URL to JS land.
-      message_info->Set(statics->headers_sym, CreateHeaders());
+      if (lazy_headers_)
+        SetRawHeaders(message_info);
+      else
+        message_info->Set(statics->headers_sym, CreateHeaders());
       if (parser_.type == HTTP_REQUEST)
         message_info->Set(statics->url_sym, url_.ToString());
+      url_.Reset();
+      arena_.Reset();
     }
     num_fields_ = num_values_ = -1;
 
@@ -464,6 +634,8 @@ public:
     // If there was an exception in one of the callbacks
     if (parser->got_exception_) return Local<Value>();
 
+    parser->Save();
+
     Local<Integer> nparsed_obj = Integer::New(nparsed);
     // If there was a parse error in one of the callbacks
     // TODO What if there is an error on EOF?
@@ -502,6 +674,22 @@ public:
   }
 
 
+  // parser.setLazyHeaders(true) makes onHeadersComplete hand over the raw
+  // header bytes (info.rawHeaders) and a table of [name start, name end,
+  // value start, value end, ...] offsets into them (info.headerOffsets)
+  // instead of info.headers. The strings are left for JS land to create
+  // when it needs them. Only the fast case is affected: headers that had to
+  // be flushed early still go through onHeaders. Reset by reinitialize().
+  static Handle<Value> SetLazyHeaders(const Arguments& args) {
+    HandleScope scope;
+
+    Parser* parser = ObjectWrap::Unwrap<Parser>(args.This());
+    parser->lazy_headers_ = args[0]->IsTrue();
+
+    return Undefined();
+  }
+
+
   static Handle<Value> Reinitialize(const Arguments& args) {
     HandleScope scope;
 
@@ -528,7 +716,7 @@ private:
     Local<Array> headers = Array::New(2 * (num_values_ + 1));
 
     for (int i = 0; i < num_values_ + 1; ++i) {
-      headers->Set(2 * i, fields_[i].ToString());
+      headers->Set(2 * i, fields_[i].ToHeaderName());
       headers->Set(2 * i + 1, values_[i].ToString());
     }
 
@@ -536,6 +724,41 @@ private:
   }
 
 
+  void SetRawHeaders(Local<Object> message_info) {
+    HttpStatics *statics = NODE_STATICS_GET(node_http_parser, HttpStatics);
+    int n = num_values_ + 1;
+
+    // The header bytes are copied into a buffer of their own even when they
+    // all came in the buffer being parsed: the message lives on after that
+    // and would otherwise keep the whole read slab it came from alive.
+    size_t total = 0;
+    for (int i = 0; i < n; ++i) {
+      total += fields_[i].size_ + values_[i].size_;
+    }
+
+    Buffer* b = Buffer::New(total);
+    char* copy = Buffer::Data(b);
+
+    Local<Array> offsets = Array::New(4 * n);
+    size_t pos = 0;
+
+    for (int i = 0; i < n; ++i) {
+      const StringPtr* ptrs[2] = { &fields_[i], &values_[i] };
+      for (int j = 0; j < 2; ++j) {
+        const StringPtr* p = ptrs[j];
+        if (p->size_ > 0) memcpy(copy + pos, p->str_, p->size_);
+        offsets->Set(4 * i + 2 * j, Integer::New(pos));
+        pos += p->size_;
+        offsets->Set(4 * i + 2 * j + 1, Integer::New(pos));
+      }
+    }
+
+    message_info->Set(statics->raw_headers_sym,
+                      Local<Object>::New(b->handle_));
+    message_info->Set(statics->header_offsets_sym, offsets);
+  }
+
+
   // spill headers and request path to JS land
   void Flush() {
     HandleScope scope;
@@ -557,17 +780,33 @@ private:
       got_exception_ = true;
 
     url_.Reset();
+    arena_.Reset();
     have_flushed_ = true;
   }
 
 
+  // Called when execute() is done with its buffer; anything that is still
+  // being collected must not point into it anymore.
+  void Save() {
+    url_.Save(&arena_);
+
+    for (int i = 0; i < num_fields_ + 1; ++i)
+      fields_[i].Save(&arena_);
+
+    for (int i = 0; i < num_values_ + 1; ++i)
+      values_[i].Save(&arena_);
+  }
+
+
   void Init(enum http_parser_type type) {
     http_parser_init(&parser_, type);
     url_.Reset();
+    arena_.Reset();
     num_fields_ = -1;
     num_values_ = -1;
     have_flushed_ = false;
     got_exception_ = false;
+    lazy_headers_ = false;
   }
 
 
@@ -575,10 +814,12 @@ private:
   StringPtr fields_[32];  // header fields
   StringPtr values_[32];  // header values
   StringPtr url_;
+  HeaderArena arena_;
   int num_fields_;
   int num_values_;
   bool have_flushed_;
   bool got_exception_;
+  bool lazy_headers_;
 };
 
 
@@ -597,6 +838,7 @@ void InitHttpParser(Handle<Object> target) {
   NODE_SET_PROTOTYPE_METHOD(t, "execute", Parser::Execute);
   NODE_SET_PROTOTYPE_METHOD(t, "finish", Parser::Finish);
   NODE_SET_PROTOTYPE_METHOD(t, "reinitialize", Parser::Reinitialize);
+  NODE_SET_PROTOTYPE_METHOD(t, "setLazyHeaders", Parser::SetLazyHeaders);
 
   target->Set(String::NewSymbol("HTTPParser"), t->GetFunction());
 
@@ -640,6 +882,21 @@ void InitHttpParser(Handle<Object> target) {
   statics->upgrade_sym = NODE_PSYMBOL("upgrade");
   statics->headers_sym = NODE_PSYMBOL("headers");
   statics->url_sym = NODE_PSYMBOL("url");
+  statics->raw_headers_sym = NODE_PSYMBOL("rawHeaders");
+  statics->header_offsets_sym = NODE_PSYMBOL("headerOffsets");
+
+  assert(ARRAY_SIZE(kCommonHeaders) == ARRAY_SIZE(statics->header_syms));
+  for (size_t i = 0; i < ARRAY_SIZE(kCommonHeaders); i++) {
+    char lower[32];
+    size_t length = kCommonHeaders[i].length;
+    assert(length < sizeof(lower));
+    for (size_t j = 0; j < length; j++)
+      lower[j] = ToLower(kCommonHeaders[i].name[j]);
+    lower[length] = '\0';
+
+    statics->header_syms[i] = NODE_PSYMBOL(kCommonHeaders[i].name);
+    statics->header_lower_syms[i] = NODE_PSYMBOL(lower);
+  }
 
   statics->settings.on_message_begin    = Parser::on_message_begin;
   statics->settings.on_url              = Parser::on_url;
@@ -0,0 +1,309 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <node.h>
+#include <node_idle_gc.h>
+
+#include <assert.h>
+#include <string.h>
+
+namespace node {
+
+using v8::Arguments;
+using v8::Boolean;
+using v8::Exception;
+using v8::GCCallbackFlags;
+using v8::GCType;
+using v8::Handle;
+using v8::HandleScope;
+using v8::HeapStatistics;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::String;
+using v8::ThrowException;
+using v8::V8;
+using v8::Value;
+
+// V8 starts another round of idle cleanup after this many collections.
+static const int kGCsBeforeRearm = 4;
+
+// Above the heap limit another round also starts after this long, like
+// the 5 second gc_timer used to do, even if nothing else collects.
+static const uint64_t kOverLimitBackoff = 5 * 1000 * 1000;  // microseconds
+
+
+static inline uint64_t NowMicros() {
+  return uv_hrtime() / 1000;
+}
+
+
+IdleGC::IdleGC() {
+  loop_ = NULL;
+  mode_ = MODE_LATENCY;
+  min_idle_ = 10 * 1000;
+  heap_limit_ = 128 * 1024 * 1024;
+
+  poll_start_ = 0;
+  forced_ = false;
+  predicted_ = 0;
+  step_cost_ = 0;
+  done_ = false;
+  done_at_ = 0;
+  gcs_since_done_ = 0;
+  over_limit_ = false;
+
+  in_step_ = false;
+  gc_start_ = 0;
+
+  ResetStats();
+}
+
+
+void IdleGC::Init(uv_loop_t* loop) {
+  loop_ = loop;
+
+  uv_idle_init(loop_, &idle_watcher_);
+  idle_watcher_.data = this;
+  uv_unref(loop_);
+
+  uv_timer_init(loop_, &timer_);
+  timer_.data = this;
+  uv_unref(loop_);
+
+  V8::AddGCPrologueCallback(OnGCStart);
+  V8::AddGCEpilogueCallback(OnGCEnd);
+}
+
+
+void IdleGC::ResetStats() {
+  memset(&idle_, 0, sizeof(idle_));
+  memset(&critical_, 0, sizeof(critical_));
+  steps_ = 0;
+  step_time_ = 0;
+  deferred_ = 0;
+}
+
+
+void IdleGC::BeforePoll() {
+  forced_ = false;
+
+  if (done_ && (gcs_since_done_ >= kGCsBeforeRearm ||
+                (over_limit_ &&
+                 NowMicros() - done_at_ >= kOverLimitBackoff))) {
+    done_ = false;
+  }
+
+  if (!done_) {
+    uint64_t needed = min_idle_;
+    if (mode_ == MODE_LATENCY && 2 * step_cost_ > needed) {
+      needed = 2 * step_cost_;
+    }
+
+    if (over_limit_ || predicted_ >= needed) {
+      // The poll won't block now; the step runs if it finds nothing to do.
+      uv_idle_start(&idle_watcher_, OnIdle);
+      forced_ = true;
+    } else {
+      if (predicted_ >= min_idle_) deferred_++;
+      // Make sure a wait long enough is noticed even if nothing ends it.
+      if (!uv_is_active(reinterpret_cast<uv_handle_t*>(&timer_))) {
+        uv_timer_start(&timer_, OnTimer, needed / 1000 + 1, 0);
+      }
+    }
+  }
+
+  poll_start_ = NowMicros();
+}
+
+
+void IdleGC::AfterPoll() {
+  if (poll_start_ == 0) return;
+
+  uint64_t waited = NowMicros() - poll_start_;
+  poll_start_ = 0;
+
+  // A poll that was told not to block says nothing about the next window.
+  if (forced_) return;
+
+  if (waited >= predicted_) {
+    predicted_ = waited;
+  } else {
+    predicted_ = (predicted_ + waited) / 2;
+  }
+}
+
+
+void IdleGC::Step() {
+  uv_idle_stop(&idle_watcher_);
+
+  uint64_t start = NowMicros();
+  in_step_ = true;
+  bool finished = V8::IdleNotification();
+  in_step_ = false;
+  uint64_t elapsed = NowMicros() - start;
+
+  steps_++;
+  step_time_ += elapsed;
+
+  // Most steps do little; remember the expensive ones for a while.
+  step_cost_ -= step_cost_ / 8;
+  if (elapsed > step_cost_) step_cost_ = elapsed;
+
+  if (finished) {
+    done_ = true;
+    done_at_ = NowMicros();
+    gcs_since_done_ = 0;
+    uv_timer_stop(&timer_);
+    // Wake up to look again once the back-off is over.
+    if (over_limit_) {
+      uv_timer_start(&timer_, OnTimer, kOverLimitBackoff / 1000, 0);
+    }
+  }
+}
+
+
+void IdleGC::OnIdle(uv_idle_t* handle, int status) {
+  static_cast<IdleGC*>(handle->data)->Step();
+}
+
+
+void IdleGC::OnTimer(uv_timer_t* handle, int status) {
+  // Nothing to do: the timer only ends a poll that would otherwise block
+  // for good, so that its length is measured or the over limit back-off
+  // is noticed.
+}
+
+
+void IdleGC::OnGCStart(GCType type, GCCallbackFlags flags) {
+  Isolate::GetCurrent()->idle_gc->gc_start_ = NowMicros();
+}
+
+
+void IdleGC::OnGCEnd(GCType type, GCCallbackFlags flags) {
+  IdleGC* gc = Isolate::GetCurrent()->idle_gc;
+
+  Counter& c = gc->in_step_ ? gc->idle_ : gc->critical_;
+  if (type == v8::kGCTypeScavenge) {
+    c.scavenges++;
+  } else {
+    c.mark_sweeps++;
+  }
+  c.time += NowMicros() - gc->gc_start_;
+
+  if (!gc->in_step_) gc->gcs_since_done_++;
+
+  HeapStatistics stats;
+  V8::GetHeapStatistics(&stats);
+  gc->over_limit_ = stats.total_heap_size() > gc->heap_limit_;
+}
+
+
+static Local<Object> CounterObject(uint64_t scavenges,
+                                   uint64_t mark_sweeps,
+                                   uint64_t time) {
+  Local<Object> obj = Object::New();
+  obj->Set(String::New("scavenges"), Number::New(scavenges));
+  obj->Set(String::New("markSweeps"), Number::New(mark_sweeps));
+  obj->Set(String::New("time"), Number::New(time));
+  return obj;
+}
+
+
+// process.setIdleGC({ mode, minIdle, heapLimit })
+Handle<Value> IdleGC::SetOptions(const Arguments& args) {
+  HandleScope scope;
+
+  if (!args[0]->IsObject()) {
+    return ThrowException(Exception::TypeError(
+        String::New("options must be an object")));
+  }
+
+  IdleGC* gc = Isolate::GetCurrent()->idle_gc;
+  Local<Object> options = args[0]->ToObject();
+
+  Local<Value> mode = options->Get(String::New("mode"));
+  if (!mode->IsUndefined()) {
+    String::AsciiValue name(mode);
+    if (*name && strcmp(*name, "latency") == 0) {
+      gc->mode_ = MODE_LATENCY;
+    } else if (*name && strcmp(*name, "batch") == 0) {
+      gc->mode_ = MODE_BATCH;
+    } else {
+      return ThrowException(Exception::TypeError(
+          String::New("mode must be 'latency' or 'batch'")));
+    }
+  }
+
+  Local<Value> min_idle = options->Get(String::New("minIdle"));
+  if (!min_idle->IsUndefined()) {
+    if (!min_idle->IsNumber() || min_idle->NumberValue() < 0) {
+      return ThrowException(Exception::TypeError(
+          String::New("minIdle must be a number of milliseconds")));
+    }
+    gc->min_idle_ = static_cast<uint64_t>(min_idle->NumberValue() * 1000);
+  }
+
+  Local<Value> heap_limit = options->Get(String::New("heapLimit"));
+  if (!heap_limit->IsUndefined()) {
+    if (!heap_limit->IsNumber() || heap_limit->NumberValue() < 0) {
+      return ThrowException(Exception::TypeError(
+          String::New("heapLimit must be a number of bytes")));
+    }
+    gc->heap_limit_ = static_cast<size_t>(heap_limit->NumberValue());
+  }
+
+  return v8::Undefined();
+}
+
+
+// process.idleGCStats([reset])
+Handle<Value> IdleGC::GetStats(const Arguments& args) {
+  HandleScope scope;
+
+  IdleGC* gc = Isolate::GetCurrent()->idle_gc;
+  Local<Object> obj = Object::New();
+
+  obj->Set(String::New("mode"),
+           String::New(gc->mode_ == MODE_BATCH ? "batch" : "latency"));
+  obj->Set(String::New("minIdle"), Number::New(gc->min_idle_ / 1000.0));
+  obj->Set(String::New("heapLimit"), Number::New(gc->heap_limit_));
+
+  obj->Set(String::New("idle"), CounterObject(gc->idle_.scavenges,
+                                              gc->idle_.mark_sweeps,
+                                              gc->idle_.time));
+  obj->Set(String::New("critical"), CounterObject(gc->critical_.scavenges,
+                                                  gc->critical_.mark_sweeps,
+                                                  gc->critical_.time));
+  obj->Set(String::New("steps"), Number::New(gc->steps_));
+  obj->Set(String::New("stepTime"), Number::New(gc->step_time_));
+  obj->Set(String::New("deferred"), Number::New(gc->deferred_));
+
+  obj->Set(String::New("predictedIdle"), Number::New(gc->predicted_));
+  obj->Set(String::New("stepCost"), Number::New(gc->step_cost_));
+  obj->Set(String::New("done"), Boolean::New(gc->done_));
+
+  if (args[0]->BooleanValue()) gc->ResetStats();
+
+  return scope.Close(obj);
+}
+
+}  // namespace node
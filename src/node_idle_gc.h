@@ -0,0 +1,104 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef NODE_IDLE_GC_H_
+#define NODE_IDLE_GC_H_
+
+#include <uv.h>
+#include <v8.h>
+#include <stdint.h>
+
+namespace node {
+
+// Hands V8 the gaps between event loop iterations of one isolate to
+// collect garbage in, through V8::IdleNotification().
+//
+// Every poll wait is measured and the next one is predicted from them: a
+// long wait raises the prediction at once, short ones halve it. Before
+// polling, a GC step is scheduled if the predicted window is at least
+// min_idle long and, in MODE_LATENCY, twice what a step is expected to
+// cost. The step runs from an idle watcher, so it only happens if the poll
+// turns up nothing to do. Once V8 reports it has nothing left to clean up
+// the scheduler rests until V8 has collected a few times on its own.
+//
+// Above heap_limit bytes of heap, steps run whenever the loop is idle,
+// regardless of the prediction. Once V8 has nothing left to clean up they
+// rest too, until V8 has collected a few times or for five seconds.
+class IdleGC {
+ public:
+  enum Mode { MODE_LATENCY, MODE_BATCH };
+
+  IdleGC();
+
+  // Called once the isolate and its loop exist.
+  void Init(uv_loop_t* loop);
+
+  void BeforePoll();
+  void AfterPoll();
+
+  static v8::Handle<v8::Value> SetOptions(const v8::Arguments& args);
+  static v8::Handle<v8::Value> GetStats(const v8::Arguments& args);
+
+ private:
+  struct Counter {
+    uint64_t scavenges;
+    uint64_t mark_sweeps;
+    uint64_t time;  // microseconds
+  };
+
+  static void OnIdle(uv_idle_t* handle, int status);
+  static void OnTimer(uv_timer_t* handle, int status);
+  static void OnGCStart(v8::GCType type, v8::GCCallbackFlags flags);
+  static void OnGCEnd(v8::GCType type, v8::GCCallbackFlags flags);
+
+  void Step();
+  void ResetStats();
+
+  uv_loop_t* loop_;
+  uv_idle_t idle_watcher_;
+  uv_timer_t timer_;
+
+  Mode mode_;
+  uint64_t min_idle_;    // microseconds
+  size_t heap_limit_;
+
+  uint64_t poll_start_;
+  bool forced_;          // this iteration's poll was made not to block
+  uint64_t predicted_;   // microseconds
+  uint64_t step_cost_;   // microseconds, a decaying maximum
+  bool done_;
+  uint64_t done_at_;     // microseconds
+  int gcs_since_done_;
+  bool over_limit_;
+
+  bool in_step_;
+  uint64_t gc_start_;
+
+  Counter idle_;
+  Counter critical_;
+  uint64_t steps_;
+  uint64_t step_time_;
+  uint64_t deferred_;
+};
+
+}  // namespace node
+
+#endif  // NODE_IDLE_GC_H_
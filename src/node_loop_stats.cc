@@ -0,0 +1,258 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <node.h>
+#include <node_loop_stats.h>
+
+#include <assert.h>
+#include <string.h>
+#include <math.h>
+
+namespace node {
+
+using v8::Array;
+using v8::Arguments;
+using v8::Handle;
+using v8::HandleScope;
+using v8::Local;
+using v8::Null;
+using v8::Number;
+using v8::Object;
+using v8::String;
+using v8::Value;
+
+static const char* phase_names[LoopStats::PHASE_COUNT] = {
+  "poll", "io", "tick", "timers", "eio"
+};
+
+
+static inline uint64_t NowMicros() {
+  return uv_hrtime() / 1000;
+}
+
+
+void LoopHistogram::Reset() {
+  count_ = 0;
+  total_ = 0;
+  min_ = 0;
+  max_ = 0;
+  memset(buckets_, 0, sizeof(buckets_));
+}
+
+
+int LoopHistogram::BucketFor(uint64_t value) {
+  if (value < static_cast<uint64_t>(kSubBuckets)) return value;
+
+  int msb = 63;
+  while (!(value & (static_cast<uint64_t>(1) << msb))) msb--;
+
+  int shift = msb - kSubBucketBits;
+  return (shift + 1) * kSubBuckets + (value >> shift) - kSubBuckets;
+}
+
+
+uint64_t LoopHistogram::HighestIn(int bucket) {
+  if (bucket < kSubBuckets) return bucket;
+
+  int shift = bucket / kSubBuckets - 1;
+  uint64_t low =
+      static_cast<uint64_t>(bucket % kSubBuckets + kSubBuckets) << shift;
+  return low + (static_cast<uint64_t>(1) << shift) - 1;
+}
+
+
+void LoopHistogram::Record(uint64_t value) {
+  if (count_ == 0 || value < min_) min_ = value;
+  if (value > max_) max_ = value;
+  count_++;
+  total_ += value;
+  buckets_[BucketFor(value)]++;
+}
+
+
+uint64_t LoopHistogram::Percentile(double p) const {
+  if (count_ == 0) return 0;
+
+  uint64_t wanted = static_cast<uint64_t>(ceil(p / 100 * count_));
+  if (wanted == 0) wanted = 1;
+
+  uint64_t seen = 0;
+  for (int i = 0; i < kBuckets; i++) {
+    seen += buckets_[i];
+    if (seen >= wanted) {
+      uint64_t v = HighestIn(i);
+      return v < max_ ? v : max_;
+    }
+  }
+  return max_;
+}
+
+
+Local<Object> LoopHistogram::ToObject() const {
+  HandleScope scope;
+
+  Local<Object> obj = Object::New();
+  obj->Set(String::New("count"), Number::New(count_));
+  obj->Set(String::New("total"), Number::New(total_));
+  obj->Set(String::New("min"), Number::New(min_));
+  obj->Set(String::New("max"), Number::New(max_));
+  obj->Set(String::New("mean"),
+           Number::New(count_ ? static_cast<double>(total_) / count_ : 0));
+  obj->Set(String::New("p50"), Number::New(Percentile(50)));
+  obj->Set(String::New("p90"), Number::New(Percentile(90)));
+  obj->Set(String::New("p99"), Number::New(Percentile(99)));
+  obj->Set(String::New("p999"), Number::New(Percentile(99.9)));
+
+  // Only the buckets that were hit, as [highest value, count] pairs.
+  Local<Array> buckets = Array::New();
+  int n = 0;
+  for (int i = 0; i < kBuckets; i++) {
+    if (buckets_[i] == 0) continue;
+    Local<Array> bucket = Array::New(2);
+    bucket->Set(0, Number::New(HighestIn(i)));
+    bucket->Set(1, Number::New(buckets_[i]));
+    buckets->Set(n++, bucket);
+  }
+  obj->Set(String::New("buckets"), buckets);
+
+  return scope.Close(obj);
+}
+
+
+LoopStats::LoopStats() {
+  depth_ = 0;
+  enter_time_ = 0;
+  Reset();
+}
+
+
+void LoopStats::Reset() {
+  // A callback may be running; it still gets timed when it returns.
+  for (int i = 0; i < PHASE_COUNT; i++) phases_[i].Reset();
+  events_per_iteration_.Reset();
+  iterations_ = 0;
+  events_ = 0;
+  reset_time_ = NowMicros();
+  poll_start_ = 0;
+  longest_ = 0;
+  longest_phase_ = PHASE_IO;
+  has_longest_ = false;
+  longest_name_[0] = '\0';
+}
+
+
+void LoopStats::Prepare() {
+  if (iterations_ > 0) events_per_iteration_.Record(events_);
+  iterations_++;
+  events_ = 0;
+}
+
+
+void LoopStats::PollStart() {
+  poll_start_ = NowMicros();
+}
+
+
+void LoopStats::PollEnd() {
+  if (poll_start_ == 0) return;
+  phases_[PHASE_POLL].Record(NowMicros() - poll_start_);
+  poll_start_ = 0;
+}
+
+
+void LoopStats::Enter() {
+  if (depth_++ == 0) enter_time_ = NowMicros();
+}
+
+
+void LoopStats::Leave(Phase phase, const char* name) {
+  assert(depth_ > 0);
+  if (--depth_ > 0) return;
+
+  uint64_t elapsed = NowMicros() - enter_time_;
+  phases_[phase].Record(elapsed);
+  if (phase != PHASE_TICK) events_++;
+
+  if (elapsed > longest_ || !has_longest_) {
+    longest_ = elapsed;
+    longest_phase_ = phase;
+    has_longest_ = true;
+    strncpy(longest_name_, name, kMaxNameLength);
+    longest_name_[kMaxNameLength] = '\0';
+  }
+}
+
+
+Local<Object> LoopStats::ToObject() const {
+  HandleScope scope;
+
+  Local<Object> obj = Object::New();
+  obj->Set(String::New("iterations"), Number::New(iterations_));
+  obj->Set(String::New("duration"), Number::New(NowMicros() - reset_time_));
+
+  Local<Object> phases = Object::New();
+  for (int i = 0; i < PHASE_COUNT; i++) {
+    phases->Set(String::New(phase_names[i]), phases_[i].ToObject());
+  }
+  obj->Set(String::New("phases"), phases);
+  obj->Set(String::New("eventsPerIteration"),
+           events_per_iteration_.ToObject());
+
+  if (!has_longest_) {
+    obj->Set(String::New("longest"), Null());
+  } else {
+    Local<Object> longest = Object::New();
+    longest->Set(String::New("phase"),
+                 String::New(phase_names[longest_phase_]));
+    longest->Set(String::New("callback"), String::New(longest_name_));
+    longest->Set(String::New("duration"), Number::New(longest_));
+    obj->Set(String::New("longest"), longest);
+  }
+
+  return scope.Close(obj);
+}
+
+
+LoopStatsScope::LoopStatsScope(LoopStats::Phase phase, const char* name)
+    : stats_(Isolate::GetCurrent()->loop_stats),
+      phase_(phase),
+      name_(name) {
+  stats_->Enter();
+}
+
+
+LoopStatsScope::~LoopStatsScope() {
+  stats_->Leave(phase_, name_);
+}
+
+
+Handle<Value> GetLoopStats(const Arguments& args) {
+  HandleScope scope;
+
+  LoopStats* stats = Isolate::GetCurrent()->loop_stats;
+  Local<Object> obj = stats->ToObject();
+
+  if (args[0]->BooleanValue()) stats->Reset();
+
+  return scope.Close(obj);
+}
+
+}  // namespace node
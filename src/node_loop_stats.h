@@ -0,0 +1,120 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef NODE_LOOP_STATS_H_
+#define NODE_LOOP_STATS_H_
+
+#include <v8.h>
+#include <stdint.h>
+
+namespace node {
+
+// A log-linear histogram in the style of HdrHistogram. Values are grouped
+// by power of two, and each power of two is split into kSubBuckets linear
+// steps, so a bucket never spans more than 1/kSubBuckets of its values.
+class LoopHistogram {
+ public:
+  void Reset();
+  void Record(uint64_t value);
+  v8::Local<v8::Object> ToObject() const;
+
+ private:
+  static const int kSubBucketBits = 3;
+  static const int kSubBuckets = 1 << kSubBucketBits;
+  static const int kBuckets = (65 - kSubBucketBits) * kSubBuckets;
+
+  static int BucketFor(uint64_t value);
+  static uint64_t HighestIn(int bucket);
+  uint64_t Percentile(double p) const;
+
+  uint64_t count_;
+  uint64_t total_;
+  uint64_t min_;
+  uint64_t max_;
+  uint64_t buckets_[kBuckets];
+};
+
+
+// Where an isolate's event loop spends its time. Times are microseconds.
+//
+// One iteration runs from one prepare callback to the next. The time
+// between the prepare and the first check callback is spent waiting in
+// poll; everything else is spent in callbacks, which are timed by
+// LoopStatsScope according to what made them.
+class LoopStats {
+ public:
+  enum Phase {
+    PHASE_POLL, PHASE_IO, PHASE_TICK, PHASE_TIMERS, PHASE_EIO, PHASE_COUNT
+  };
+
+  LoopStats();
+  void Reset();
+
+  void Prepare();  // top of an iteration, before the tick callback
+  void PollStart();
+  void PollEnd();
+
+  void Enter();
+  void Leave(Phase phase, const char* name);
+
+  v8::Local<v8::Object> ToObject() const;
+
+ private:
+  LoopHistogram phases_[PHASE_COUNT];
+  LoopHistogram events_per_iteration_;
+  uint64_t iterations_;
+  uint64_t events_;
+  uint64_t reset_time_;
+  uint64_t poll_start_;
+  uint64_t enter_time_;
+  int depth_;
+
+  // The name is copied: MakeCallback() is public and its caller's string
+  // need not outlive the call.
+  static const size_t kMaxNameLength = 63;
+
+  uint64_t longest_;
+  Phase longest_phase_;
+  bool has_longest_;
+  char longest_name_[kMaxNameLength + 1];
+};
+
+
+// process.loopStats([reset])
+v8::Handle<v8::Value> GetLoopStats(const v8::Arguments& args);
+
+
+// Times a callback made off the event loop. Callbacks made while another
+// one is running are part of the outer one and not counted again.
+class LoopStatsScope {
+ public:
+  LoopStatsScope(LoopStats::Phase phase, const char* name);
+  ~LoopStatsScope();
+
+ private:
+  LoopStats* stats_;
+  LoopStats::Phase phase_;
+  const char* name_;
+};
+
+}  // namespace node
+
+#endif  // NODE_LOOP_STATS_H_
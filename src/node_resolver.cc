@@ -0,0 +1,511 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <node.h>
+#include <node_resolver.h>
+
+#include <assert.h>
+#include <stdio.h>
+#if defined(_MSC_VER)
+#define snprintf _snprintf
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+namespace node {
+
+using v8::Arguments;
+using v8::Handle;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Object;
+using v8::String;
+using v8::Undefined;
+using v8::Value;
+
+
+// Types returned by type(). kUnknown marks a listed entry that has not been
+// stat()ed yet.
+enum EntryType { kUnknown = 0, kFile = 1, kDirectory = 2, kMissing = 3 };
+
+static const char kManifestHeader[] = "node resolution manifest 1\n";
+
+
+// A chained hash table with string keys and untyped values.
+class StringTable {
+ public:
+  struct Entry {
+    Entry* next;
+    unsigned int hash;
+    size_t length;
+    void* value;
+    char* Key() { return reinterpret_cast<char*>(this + 1); }
+  };
+
+  StringTable() : buckets_(NULL), mask_(0), count_(0) {}
+
+  ~StringTable() {
+    Clear();
+    delete[] buckets_;
+  }
+
+  Entry* Find(const char* key, size_t length) {
+    if (buckets_ == NULL) return NULL;
+    unsigned int hash = Hash(key, length);
+    for (Entry* e = buckets_[hash & mask_]; e; e = e->next) {
+      if (e->hash == hash && e->length == length &&
+          memcmp(e->Key(), key, length) == 0) {
+        return e;
+      }
+    }
+    return NULL;
+  }
+
+  // Returns the entry for `key`, adding one with a NULL value if needed.
+  Entry* Insert(const char* key, size_t length) {
+    Entry* e = Find(key, length);
+    if (e) return e;
+
+    if (count_ >= mask_) Grow();
+
+    e = static_cast<Entry*>(malloc(sizeof(Entry) + length + 1));
+    e->hash = Hash(key, length);
+    e->length = length;
+    e->value = NULL;
+    memcpy(e->Key(), key, length);
+    e->Key()[length] = '\0';
+
+    Entry** slot = &buckets_[e->hash & mask_];
+    e->next = *slot;
+    *slot = e;
+    count_++;
+    return e;
+  }
+
+  // Frees the entries but not their values.
+  void Clear() {
+    for (size_t i = 0; buckets_ && i <= mask_; i++) {
+      Entry* e = buckets_[i];
+      while (e) {
+        Entry* next = e->next;
+        free(e);
+        e = next;
+      }
+      buckets_[i] = NULL;
+    }
+    count_ = 0;
+  }
+
+  void Each(void (*cb)(Entry* e, void* arg), void* arg) {
+    for (size_t i = 0; buckets_ && i <= mask_; i++) {
+      for (Entry* e = buckets_[i]; e; e = e->next) cb(e, arg);
+    }
+  }
+
+ private:
+  // FNV-1a.
+  static unsigned int Hash(const char* key, size_t length) {
+    unsigned int h = 2166136261U;
+    for (size_t i = 0; i < length; i++) {
+      h = (h ^ static_cast<unsigned char>(key[i])) * 16777619U;
+    }
+    return h;
+  }
+
+  void Grow() {
+    size_t size = buckets_ ? (mask_ + 1) * 2 : 16;
+    Entry** buckets = new Entry*[size];
+    memset(buckets, 0, size * sizeof(*buckets));
+
+    for (size_t i = 0; buckets_ && i <= mask_; i++) {
+      Entry* e = buckets_[i];
+      while (e) {
+        Entry* next = e->next;
+        e->next = buckets[e->hash & (size - 1)];
+        buckets[e->hash & (size - 1)] = e;
+        e = next;
+      }
+    }
+
+    delete[] buckets_;
+    buckets_ = buckets;
+    mask_ = size - 1;
+  }
+
+  Entry** buckets_;
+  size_t mask_;
+  size_t count_;
+};
+
+
+struct Directory {
+  bool loaded;
+  bool exists;
+  // The listing was read in the same second the directory was last
+  // changed, so a change right after the read may not show in its mtime.
+  bool racy;
+  unsigned int checked;  // the lookup during which it was last validated
+  long mtime;
+  long mtime_nsec;
+  StringTable entries;   // name -> EntryType
+  StringTable folded;    // lower cased ASCII names, see Type()
+};
+
+
+static uv_mutex_t mutex;
+static StringTable* directories;  // path -> Directory
+static StringTable* resolved;     // lookup key -> malloc()ed path
+static unsigned int lookup;
+static char* manifest_path;
+
+
+static EntryType StatType(const char* path) {
+  uv_fs_t req;
+  EntryType type = kMissing;
+  if (uv_fs_stat(Isolate::GetCurrentLoop(), &req, path, NULL) == 0) {
+    NODE_STAT_STRUCT* s = static_cast<NODE_STAT_STRUCT*>(req.ptr);
+    type = (s->st_mode & S_IFMT) == S_IFDIR ? kDirectory : kFile;
+  }
+  uv_fs_req_cleanup(&req);
+  return type;
+}
+
+
+// Lower cases `name` in place. Returns false if it is not all ASCII.
+static bool FoldCase(char* name, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    unsigned char c = static_cast<unsigned char>(name[i]);
+    if (c >= 0x80) return false;
+    if (c >= 'A' && c <= 'Z') name[i] = c - 'A' + 'a';
+  }
+  return true;
+}
+
+
+static void ModificationTime(NODE_STAT_STRUCT* s, long* sec, long* nsec) {
+  *sec = static_cast<long>(s->st_mtime);
+#if defined(__linux__)
+  *nsec = s->st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+  *nsec = s->st_mtimespec.tv_nsec;
+#else
+  *nsec = 0;
+#endif
+}
+
+
+// Makes sure the listing of `dir` is current as of this lookup. Called
+// with the mutex held.
+static void Validate(Directory* dir, const char* path) {
+  if (dir->loaded && dir->checked == lookup) return;
+  dir->checked = lookup;
+
+  uv_loop_t* loop = Isolate::GetCurrentLoop();
+  uv_fs_t req;
+  long mtime = 0, mtime_nsec = 0;
+  bool exists = false;
+
+  if (uv_fs_stat(loop, &req, path, NULL) == 0) {
+    NODE_STAT_STRUCT* s = static_cast<NODE_STAT_STRUCT*>(req.ptr);
+    exists = (s->st_mode & S_IFMT) == S_IFDIR;
+    ModificationTime(s, &mtime, &mtime_nsec);
+  }
+  uv_fs_req_cleanup(&req);
+
+  if (dir->loaded && dir->exists == exists &&
+      (!exists || (!dir->racy &&
+                   dir->mtime == mtime &&
+                   dir->mtime_nsec == mtime_nsec))) {
+    return;
+  }
+
+  dir->entries.Clear();
+  dir->folded.Clear();
+  dir->loaded = true;
+  dir->exists = exists;
+  dir->mtime = mtime;
+  dir->mtime_nsec = mtime_nsec;
+  dir->racy = exists && time(NULL) <= mtime + 1;
+
+  if (!exists) return;
+
+  int r = uv_fs_readdir(loop, &req, path, 0, NULL);
+  if (r >= 0) {
+    char* name = static_cast<char*>(req.ptr);
+    for (int i = 0; i < r; i++) {
+      size_t length = strlen(name);
+      dir->entries.Insert(name, length);
+      if (FoldCase(name, length)) dir->folded.Insert(name, length);
+      name += length + 1;
+    }
+  } else {
+    // Unreadable. Fall back to stat()ing whatever is asked for.
+    dir->loaded = false;
+  }
+  uv_fs_req_cleanup(&req);
+}
+
+
+// Whether a name that is not in the listing is really missing. On case
+// insensitive file systems it may be listed under another case, so that
+// is left to stat(), as are names that are not all ASCII, whose case
+// folding and normalization depend on the file system.
+static EntryType MissingType(Directory* dir, const char* name, size_t length) {
+  char* folded = static_cast<char*>(malloc(length));
+  memcpy(folded, name, length);
+  bool missing = FoldCase(folded, length) &&
+                 dir->folded.Find(folded, length) == NULL;
+  free(folded);
+  return missing ? kMissing : kUnknown;
+}
+
+
+static EntryType Type(const char* path, size_t length) {
+  // Split off the last path component.
+  size_t base = length;
+  while (base > 0 && path[base - 1] != '/' && path[base - 1] != '\\') base--;
+  size_t dir_length = base > 0 ? base - 1 : 0;
+
+  // The root, relative paths and trailing slashes go straight to stat().
+  if (base == length || dir_length == 0 || path[dir_length - 1] == ':') {
+    return StatType(path);
+  }
+
+  uv_mutex_lock(&mutex);
+
+  StringTable::Entry* d = directories->Insert(path, dir_length);
+  Directory* dir = static_cast<Directory*>(d->value);
+  if (dir == NULL) {
+    dir = new Directory();
+    dir->loaded = dir->exists = dir->racy = false;
+    dir->checked = 0;
+    dir->mtime = dir->mtime_nsec = 0;
+    d->value = dir;
+  }
+
+  // The key is NUL terminated where `path` is not.
+  Validate(dir, d->Key());
+
+  EntryType type;
+  if (!dir->loaded) {
+    type = kUnknown;
+  } else if (!dir->exists) {
+    type = kMissing;
+  } else {
+    StringTable::Entry* e = dir->entries.Find(path + base, length - base);
+    if (e == NULL) {
+      type = MissingType(dir, path + base, length - base);
+    } else {
+      type = static_cast<EntryType>(reinterpret_cast<intptr_t>(e->value));
+      if (type == kUnknown) {
+        type = StatType(path);
+        e->value = reinterpret_cast<void*>(static_cast<intptr_t>(type));
+      }
+    }
+  }
+
+  uv_mutex_unlock(&mutex);
+
+  return type == kUnknown ? StatType(path) : type;
+}
+
+
+static void SetResolved(const char* key, size_t key_length,
+                        const char* path, size_t path_length) {
+  char* value = static_cast<char*>(malloc(path_length + 1));
+  memcpy(value, path, path_length);
+  value[path_length] = '\0';
+
+  uv_mutex_lock(&mutex);
+  StringTable::Entry* e = resolved->Insert(key, key_length);
+  free(e->value);
+  e->value = value;
+  uv_mutex_unlock(&mutex);
+}
+
+
+// The manifest is a header line followed by NUL terminated pairs of lookup
+// keys and paths.
+static void LoadManifest(const char* path) {
+  FILE* fp = fopen(path, "rb");
+  if (fp == NULL) return;
+
+  char* buf = NULL;
+  size_t size = 0, capacity = 0;
+  for (;;) {
+    if (size == capacity) {
+      capacity = capacity ? capacity * 2 : 65536;
+      buf = static_cast<char*>(realloc(buf, capacity));
+    }
+    size_t n = fread(buf + size, 1, capacity - size, fp);
+    if (n == 0) break;
+    size += n;
+  }
+  fclose(fp);
+
+  size_t header_length = sizeof(kManifestHeader) - 1;
+  if (size >= header_length &&
+      memcmp(buf, kManifestHeader, header_length) == 0) {
+    const char* p = buf + header_length;
+    const char* end = buf + size;
+    for (;;) {
+      const char* key_end = static_cast<const char*>(memchr(p, 0, end - p));
+      if (key_end == NULL) break;
+      const char* value = key_end + 1;
+      const char* value_end =
+          static_cast<const char*>(memchr(value, 0, end - value));
+      if (value_end == NULL) break;
+      SetResolved(p, key_end - p, value, value_end - value);
+      p = value_end + 1;
+    }
+  }
+
+  free(buf);
+}
+
+
+static void WriteManifestEntry(StringTable::Entry* e, void* arg) {
+  FILE* fp = static_cast<FILE*>(arg);
+  const char* value = static_cast<const char*>(e->value);
+  fwrite(e->Key(), 1, e->length + 1, fp);
+  fwrite(value, 1, strlen(value) + 1, fp);
+}
+
+
+// Runs at exit. Writes to a temporary file first so that a process that
+// starts meanwhile never loads half a manifest.
+static void SaveManifest() {
+  char tmp[1024];
+  int r = snprintf(tmp, sizeof(tmp), "%s.%llx.tmp", manifest_path,
+                   static_cast<unsigned long long>(uv_hrtime()));
+  if (r < 0 || r >= static_cast<int>(sizeof(tmp))) return;
+
+  FILE* fp = fopen(tmp, "wb");
+  if (fp == NULL) return;
+
+  uv_mutex_lock(&mutex);
+  fwrite(kManifestHeader, 1, sizeof(kManifestHeader) - 1, fp);
+  resolved->Each(WriteManifestEntry, fp);
+  uv_mutex_unlock(&mutex);
+
+  bool ok = !ferror(fp);
+  ok = fclose(fp) == 0 && ok;
+
+  if (!ok || rename(tmp, manifest_path) != 0) {
+#if defined(_MSC_VER) || defined(__MINGW32__)
+    // rename() does not replace files on Windows.
+    if (ok && remove(manifest_path) == 0 &&
+        rename(tmp, manifest_path) == 0) {
+      return;
+    }
+#endif
+    remove(tmp);
+  }
+}
+
+
+void ModuleResolver::InitOnce(const char* manifest) {
+  uv_mutex_init(&mutex);
+  directories = new StringTable();
+  resolved = new StringTable();
+
+  if (manifest) {
+    manifest_path = strdup(manifest);
+    LoadManifest(manifest_path);
+    atexit(SaveManifest);
+  }
+}
+
+
+// beginLookup()
+//
+// Directory listings are checked against the directory's mtime at most
+// once per lookup.
+static Handle<Value> BeginLookup(const Arguments& args) {
+  uv_mutex_lock(&mutex);
+  lookup++;
+  uv_mutex_unlock(&mutex);
+  return Undefined();
+}
+
+
+// type(path)
+//
+// Returns 1 for a file, 2 for a directory and 3 if there is nothing at
+// `path`.
+static Handle<Value> GetType(const Arguments& args) {
+  HandleScope scope;
+
+  String::Utf8Value path(args[0]);
+  EntryType type = Type(*path, path.length());
+
+  return scope.Close(Integer::New(type));
+}
+
+
+// getResolved(key)
+static Handle<Value> GetResolved(const Arguments& args) {
+  HandleScope scope;
+
+  String::Utf8Value key(args[0]);
+  Handle<Value> result = Undefined();
+
+  uv_mutex_lock(&mutex);
+  StringTable::Entry* e = resolved->Find(*key, key.length());
+  if (e) result = String::New(static_cast<const char*>(e->value));
+  uv_mutex_unlock(&mutex);
+
+  return scope.Close(result);
+}
+
+
+// setResolved(key, path)
+static Handle<Value> SetResolved(const Arguments& args) {
+  HandleScope scope;
+
+  String::Utf8Value key(args[0]);
+  String::Utf8Value path(args[1]);
+  SetResolved(*key, key.length(), *path, path.length());
+
+  return Undefined();
+}
+
+
+void ModuleResolver::Initialize(Handle<Object> target) {
+  HandleScope scope;
+
+  NODE_SET_METHOD(target, "beginLookup", BeginLookup);
+  NODE_SET_METHOD(target, "type", GetType);
+  NODE_SET_METHOD(target, "getResolved", GetResolved);
+  NODE_SET_METHOD(target, "setResolved", SetResolved);
+
+  target->Set(String::NewSymbol("FILE"), Integer::New(kFile));
+  target->Set(String::NewSymbol("DIRECTORY"), Integer::New(kDirectory));
+  target->Set(String::NewSymbol("MISSING"), Integer::New(kMissing));
+}
+
+
+}  // namespace node
+
+NODE_MODULE(node_resolver, node::ModuleResolver::Initialize)
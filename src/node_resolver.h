@@ -0,0 +1,47 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef NODE_RESOLVER_H_
+#define NODE_RESOLVER_H_
+
+#include <node.h>
+#include <v8.h>
+
+namespace node {
+
+// What lib/module.js learns about the file system while it resolves
+// require() calls, kept for every isolate in the process: the listings of
+// the directories it looks in, so that a candidate file that does not exist
+// costs no stat() call, and the module paths it resolved.
+//
+// With --resolution-manifest=file the resolved paths are written to `file`
+// when the process exits and loaded from it at the next start.
+class ModuleResolver {
+ public:
+  // Called once per process, before any isolate starts. `manifest` may be
+  // NULL.
+  static void InitOnce(const char* manifest);
+  static void Initialize(v8::Handle<v8::Object> target);
+};
+
+}  // namespace node
+
+#endif  // NODE_RESOLVER_H_
@@ -22,11 +22,19 @@
 #include <node.h>
 #include <node_script.h>
 #include <assert.h>
+#include <stdio.h>
+#if defined(_MSC_VER)
+#define snprintf _snprintf
+#endif
+#include <stdlib.h>
+#include <string.h>
 
 namespace node {
 
 using v8::Context;
 using v8::Script;
+using v8::ScriptData;
+using v8::ScriptOrigin;
 using v8::Value;
 using v8::Handle;
 using v8::HandleScope;
@@ -128,6 +136,292 @@ void CloneObject(Handle<Object> recv,
 }
 
 
+// Preparse data cache.
+//
+// V8 preparses every script of 1K or more before compiling it, to find the
+// function boundaries it can skip until the functions are first called.
+// The preparse data of every such script is kept in memory, where every
+// isolate in the process finds it: an isolate started after the first one
+// does not preparse node.js and the core modules again. When
+// NODE_CODE_CACHE_DIR is set, the data is also kept in that directory for
+// later processes. Entries are found by a hash of the source and carry
+// the source itself, which must match before their data is used: an edited
+// file simply misses, and so does a script whose hash collides with
+// another's. The ones on disk also carry the V8 version they were made by.
+
+static const int kCodeCacheMinLength = 1024;  // V8's --min_preparse_length
+static const uint32_t kCodeCacheMagic = 0x4e505232;  // "NPR2"
+static const size_t kPreparseCacheMax = 32 * 1024 * 1024;
+
+struct CodeCacheHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t source_length;
+  uint32_t data_length;
+  uint64_t source_hash;
+  uint32_t data_hash;
+  uint32_t padding;  // keeps the data that follows aligned
+};
+
+// The data is followed by the source.
+struct PreparseEntry {
+  PreparseEntry* next;
+  uint64_t source_hash;
+  uint32_t source_length;
+  uint32_t data_length;
+  char* Data() { return reinterpret_cast<char*>(this + 1); }
+  uint16_t* Source() {
+    return reinterpret_cast<uint16_t*>(Data() + data_length);
+  }
+};
+
+static uv_mutex_t preparse_mutex;
+// Entries are never removed, so their data can be used without the lock.
+static PreparseEntry* preparse_entries[256];
+static size_t preparse_bytes;
+static char* code_cache_dir;
+
+
+// FNV-1a.
+static uint64_t CodeCacheHash(const uint16_t* data, size_t length) {
+  uint64_t h = 14695981039346656037ULL;
+  for (size_t i = 0; i < length; i++) {
+    h = (h ^ data[i]) * 1099511628211ULL;
+  }
+  return h;
+}
+
+
+static uint32_t CodeCacheHash(const char* data, size_t length) {
+  uint32_t h = 2166136261U;
+  for (size_t i = 0; i < length; i++) {
+    h = (h ^ static_cast<unsigned char>(data[i])) * 16777619U;
+  }
+  return h;
+}
+
+
+// Preparse data only fits the V8 build that made it.
+static uint32_t CodeCacheVersion() {
+  const char* version = v8::V8::GetVersion();
+  return CodeCacheHash(version, strlen(version)) ^
+         static_cast<uint32_t>(sizeof(void*));
+}
+
+
+static bool IsPreparseEntryFor(PreparseEntry* e,
+                               const CodeCacheHeader& header,
+                               const uint16_t* source) {
+  return e->source_hash == header.source_hash &&
+         e->source_length == header.source_length &&
+         memcmp(e->Source(), source, header.source_length * 2) == 0;
+}
+
+
+static PreparseEntry* FindPreparseEntry(const CodeCacheHeader& header,
+                                        const uint16_t* source) {
+  uv_mutex_lock(&preparse_mutex);
+  PreparseEntry* e = preparse_entries[header.source_hash & 255];
+  while (e && !IsPreparseEntryFor(e, header, source)) e = e->next;
+  uv_mutex_unlock(&preparse_mutex);
+  return e;
+}
+
+
+// Returns NULL once the cache is full.
+static PreparseEntry* AddPreparseEntry(const CodeCacheHeader& header,
+                                       const uint16_t* source,
+                                       const char* data,
+                                       uint32_t length) {
+  PreparseEntry* e = NULL;
+  size_t size = length + header.source_length * 2;
+
+  uv_mutex_lock(&preparse_mutex);
+
+  PreparseEntry** slot = &preparse_entries[header.source_hash & 255];
+  for (e = *slot; e; e = e->next) {
+    if (IsPreparseEntryFor(e, header, source)) {
+      break;  // another isolate got here first
+    }
+  }
+
+  if (e == NULL && preparse_bytes + size <= kPreparseCacheMax) {
+    e = static_cast<PreparseEntry*>(malloc(sizeof(*e) + size));
+    if (e) {
+      e->source_hash = header.source_hash;
+      e->source_length = header.source_length;
+      e->data_length = length;
+      memcpy(e->Data(), data, length);
+      memcpy(e->Source(), source, header.source_length * 2);
+      e->next = *slot;
+      *slot = e;
+      preparse_bytes += size;
+    }
+  }
+
+  uv_mutex_unlock(&preparse_mutex);
+
+  return e;
+}
+
+
+// Returns the data of the entry at `path`, in a malloc()ed buffer, if it is
+// the one for `expected` and `source`.
+static char* ReadCodeCache(const char* path,
+                           const CodeCacheHeader& expected,
+                           const uint16_t* source,
+                           uint32_t* length) {
+  FILE* fp = fopen(path, "rb");
+  if (fp == NULL) return NULL;
+
+  CodeCacheHeader header;
+  char* buf = NULL;
+
+  if (fread(&header, sizeof(header), 1, fp) != 1 ||
+      header.magic != expected.magic ||
+      header.version != expected.version ||
+      header.source_length != expected.source_length ||
+      header.source_hash != expected.source_hash ||
+      header.data_length == 0 ||
+      header.data_length % sizeof(unsigned) != 0) {
+    fclose(fp);
+    return NULL;
+  }
+
+  buf = static_cast<char*>(malloc(header.data_length));
+  if (buf == NULL ||
+      fread(buf, 1, header.data_length, fp) != header.data_length ||
+      CodeCacheHash(buf, header.data_length) != header.data_hash) {
+    free(buf);
+    fclose(fp);
+    return NULL;
+  }
+
+  // The source follows the data; compare it a block at a time.
+  uint16_t block[4096];
+  size_t done = 0;
+  while (done < header.source_length) {
+    size_t n = header.source_length - done;
+    if (n > sizeof(block) / sizeof(*block)) n = sizeof(block) / sizeof(*block);
+    if (fread(block, sizeof(*block), n, fp) != n ||
+        memcmp(block, source + done, n * sizeof(*block)) != 0) {
+      free(buf);
+      fclose(fp);
+      return NULL;
+    }
+    done += n;
+  }
+
+  fclose(fp);
+
+  ScriptData* data = ScriptData::New(buf, header.data_length);
+  bool ok = !data->HasError();
+  delete data;
+  if (!ok) {
+    free(buf);
+    return NULL;
+  }
+
+  *length = header.data_length;
+  return buf;
+}
+
+
+// Writes the entry to a temporary file first and renames it into place,
+// so that concurrent readers never see half of it.
+static void WriteCodeCache(const char* path,
+                           CodeCacheHeader& header,
+                           const uint16_t* source,
+                           ScriptData* data) {
+  char tmp[1024];
+  snprintf(tmp, sizeof(tmp), "%s.%llx.tmp", path,
+           static_cast<unsigned long long>(uv_hrtime()));
+
+  FILE* fp = fopen(tmp, "wb");
+  if (fp == NULL) return;
+
+  header.data_length = data->Length();
+  header.data_hash = CodeCacheHash(data->Data(), data->Length());
+
+  bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+            fwrite(data->Data(), 1, data->Length(), fp) ==
+                static_cast<size_t>(data->Length()) &&
+            fwrite(source, sizeof(*source), header.source_length, fp) ==
+                header.source_length;
+  ok = fclose(fp) == 0 && ok;
+
+  uv_fs_t req;
+  if (ok) {
+    ok = uv_fs_rename(Isolate::GetCurrentLoop(), &req, tmp, path, NULL) == 0;
+    uv_fs_req_cleanup(&req);
+  }
+  if (!ok) {
+    remove(tmp);
+  }
+}
+
+
+ScriptData* GetPreparseData(Handle<String> source) {
+  if (source->Length() < kCodeCacheMinLength) return NULL;
+
+  String::Value value(source);
+
+  CodeCacheHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = kCodeCacheMagic;
+  header.version = CodeCacheVersion();
+  header.source_length = value.length();
+  header.source_hash = CodeCacheHash(*value, value.length());
+
+  PreparseEntry* e = FindPreparseEntry(header, *value);
+  if (e) return ScriptData::New(e->Data(), e->data_length);
+
+  char path[1024];
+  if (code_cache_dir) {
+    int r = snprintf(path, sizeof(path), "%s/%016llx", code_cache_dir,
+                     static_cast<unsigned long long>(header.source_hash));
+    if (r < 0 || r >= static_cast<int>(sizeof(path)) - 32) path[0] = '\0';
+
+    uint32_t length;
+    char* buf = path[0] ? ReadCodeCache(path, header, *value, &length) : NULL;
+    if (buf) {
+      e = AddPreparseEntry(header, *value, buf, length);
+      free(buf);
+      if (e) return ScriptData::New(e->Data(), e->data_length);
+    }
+  }
+
+  ScriptData* data = ScriptData::PreCompile(source);
+  if (data->HasError()) {
+    // Let the compiler report the syntax error.
+    delete data;
+    return NULL;
+  }
+
+  if (code_cache_dir && path[0]) WriteCodeCache(path, header, *value, data);
+
+  e = AddPreparseEntry(header, *value, data->Data(), data->Length());
+  if (e == NULL) return data;
+
+  delete data;
+  return ScriptData::New(e->Data(), e->data_length);
+}
+
+
+void InitEvalsOnce() {
+  uv_mutex_init(&preparse_mutex);
+
+  const char* dir = getenv("NODE_CODE_CACHE_DIR");
+  if (dir && *dir) {
+    code_cache_dir = strdup(dir);
+
+    uv_fs_t req;
+    uv_fs_mkdir(uv_default_loop(), &req, dir, 0777, NULL);
+    uv_fs_req_cleanup(&req);
+  }
+}
+
+
 void WrappedContext::Initialize(Handle<Object> target) {
   HandleScope scope;
   NODE_STATICS_NEW(node_evals, ScriptStatics, statics);
@@ -377,10 +671,17 @@ Handle<Value> WrappedScript::EvalMachine(const Arguments& args) {
   Handle<Script> script;
 
   if (input_flag == compileCode) {
+    ScriptData* pre_data = GetPreparseData(code);
+
     // well, here WrappedScript::New would suffice in all cases, but maybe
     // Compile has a little better performance where possible
-    script = output_flag == returnResult ? Script::Compile(code, filename)
-                                         : Script::New(code, filename);
+    ScriptOrigin origin(filename);
+    script = output_flag == returnResult
+        ? Script::Compile(code, &origin, pre_data)
+        : Script::New(code, &origin, pre_data);
+
+    delete pre_data;
+
     if (script.IsEmpty()) {
       // FIXME UGLY HACK TO DISPLAY SYNTAX ERRORS.
       if (display_error) DisplayExceptionLine(try_catch);
@@ -32,5 +32,12 @@ namespace node {
 
 void InitEvals(v8::Handle<v8::Object> target);
 
+// Called once per process, before any isolate starts.
+void InitEvalsOnce();
+
+// Returns the preparse data for `source`, shared by all isolates, or NULL
+// for scripts too small to need any. Delete it once `source` is compiled.
+v8::ScriptData* GetPreparseData(v8::Handle<v8::String> source);
+
 } // namespace node
 #endif //  node_script_h
@@ -30,6 +30,7 @@
 #include <node.h>
 #include <node_buffer.h>
 #include <req_wrap.h>
+#include <node_loop_stats.h>
 
 
 
@@ -39,11 +40,105 @@ using namespace v8;
 // write() returns one of these, and then calls the cb() when it's done.
 typedef ReqWrap<uv_work_t> WorkReqWrap;
     
+// A deflate state that has been deflateReset() and is waiting to be reused
+// by a stream with the same parameters.
+struct PooledDeflate {
+  PooledDeflate* next;
+  z_stream* strm;
+  int level;
+  int windowBits;
+  int memLevel;
+  int strategy;
+};
+
+// Each deflate state is around 256 KB with the default settings; this many
+// are kept around at most.
+static const int kDeflatePoolMax = 16;
+
 class ZlibStatics : public ModuleStatics {
 public:
+  ZlibStatics() {
+    deflate_pool = NULL;
+    deflate_pool_size = 0;
+    deflate_pool_hits = 0;
+    deflate_pool_misses = 0;
+  }
+
+  ~ZlibStatics() {
+    while (PooledDeflate* p = deflate_pool) {
+      deflate_pool = p->next;
+      (void)deflateEnd(p->strm);
+      delete p->strm;
+      delete p;
+    }
+  }
+
   Persistent<String> callback_sym;
+  Persistent<String> onbatch_sym;
+
+  PooledDeflate* deflate_pool;
+  int deflate_pool_size;
+  double deflate_pool_hits;
+  double deflate_pool_misses;
 };
 
+
+// Returns a reset deflate state with these parameters from the pool, or
+// NULL if there is none.
+static z_stream* TakePooledDeflate(int level,
+                                   int windowBits,
+                                   int memLevel,
+                                   int strategy) {
+  ZlibStatics *statics = NODE_STATICS_GET(node_zlib, ZlibStatics);
+
+  PooledDeflate** pp = &statics->deflate_pool;
+  while (PooledDeflate* p = *pp) {
+    if (p->level == level &&
+        p->windowBits == windowBits &&
+        p->memLevel == memLevel &&
+        p->strategy == strategy) {
+      z_stream* strm = p->strm;
+      *pp = p->next;
+      delete p;
+      statics->deflate_pool_size--;
+      statics->deflate_pool_hits++;
+      return strm;
+    }
+    pp = &p->next;
+  }
+
+  statics->deflate_pool_misses++;
+  return NULL;
+}
+
+
+// Takes ownership of a deflate state that is done with. It goes back to the
+// pool if there is room, otherwise it is freed.
+static void PoolDeflate(z_stream* strm,
+                        int level,
+                        int windowBits,
+                        int memLevel,
+                        int strategy) {
+  ZlibStatics *statics = NODE_STATICS_GET(node_zlib, ZlibStatics);
+
+  if (statics->deflate_pool_size >= kDeflatePoolMax ||
+      deflateReset(strm) != Z_OK) {
+    (void)deflateEnd(strm);
+    delete strm;
+    return;
+  }
+
+  PooledDeflate* p = new PooledDeflate;
+  p->strm = strm;
+  p->level = level;
+  p->windowBits = windowBits;
+  p->memLevel = memLevel;
+  p->strategy = strategy;
+  p->next = statics->deflate_pool;
+  statics->deflate_pool = p;
+  statics->deflate_pool_size++;
+}
+
 enum node_zlib_mode {
   DEFLATE = 1,
   INFLATE,
@@ -67,14 +162,100 @@ template <node_zlib_mode mode> class ZCtx : public ObjectWrap {
  public:
 
   ZCtx() : ObjectWrap() {
+    init_done_ = false;
+    strm_ = NULL;
+    dictionary_data_ = NULL;
+    dictionary_len_ = 0;
+    pending_head_ = pending_tail_ = NULL;
+    work_head_ = work_tail_ = NULL;
+    done_head_ = done_tail_ = NULL;
+    out_head_ = out_tail_ = NULL;
+    queued_bytes_ = 0;
+    consumed_ = 0;
+    busy_ = false;
+    paused_ = false;
+    error_ = Z_OK;
+    block_size_ = 16 * 1024;
+    high_water_ = 64 * 1024;
   }
 
   ~ZCtx() {
-    if (mode == DEFLATE || mode == GZIP || mode == DEFLATERAW) {
-      (void)deflateEnd(&strm_);
-    } else if (mode == INFLATE || mode == GUNZIP || mode == INFLATERAW) {
-      (void)inflateEnd(&strm_);
+    assert(!busy_);
+    FreeChunks(pending_head_);
+    FreeChunks(work_head_);
+    FreeChunks(done_head_);
+    FreeBlocks();
+    Release();
+    if (!dictionary_.IsEmpty()) dictionary_.Dispose();
+  }
+
+  // Lets go of the zlib state: deflate states go back to the pool for the
+  // next stream with the same settings.
+  void
+  Release() {
+    if (strm_ == NULL) return;
+
+    switch (mode) {
+      case DEFLATE:
+      case GZIP:
+      case DEFLATERAW:
+        if (error_ == Z_OK) {
+          PoolDeflate(strm_, level_, windowBits_, memLevel_, strategy_);
+        } else {
+          (void)deflateEnd(strm_);
+          delete strm_;
+        }
+        break;
+      default:
+        (void)inflateEnd(strm_);
+        delete strm_;
+        break;
+    }
+
+    strm_ = NULL;
+  }
+
+  // close() is called once the stream has ended, so that the zlib state
+  // can be reused or freed without waiting for the GC.
+  static Handle<Value>
+  Close(const Arguments& args) {
+    HandleScope scope;
+
+    ZCtx<mode> *ctx = ObjectWrap::Unwrap< ZCtx<mode> >(args.This());
+    assert(!ctx->busy_ && "close while busy");
+    ctx->Release();
+
+    return Undefined();
+  }
+
+  // Runs deflate() or inflate() once, handing the preset dictionary to
+  // inflate() when the stream asks for it. Called on the thread pool.
+  int
+  Step(int flush) {
+    int err;
+    switch (mode) {
+      case DEFLATE:
+      case GZIP:
+      case DEFLATERAW:
+        err = deflate(strm_, flush);
+        break;
+      case UNZIP:
+      case INFLATE:
+      case GUNZIP:
+      case INFLATERAW:
+        err = inflate(strm_, flush);
+        if (err == Z_NEED_DICT && dictionary_data_ != NULL) {
+          err = inflateSetDictionary(strm_,
+                                     dictionary_data_,
+                                     dictionary_len_);
+          // Z_DATA_ERROR here means the dictionary does not match.
+          if (err == Z_OK) err = inflate(strm_, flush);
+        }
+        break;
+      default:
+        assert(0 && "wtf?");
     }
+    return err;
   }
 
   // write(flush, in, in_off, in_len, out, out_off, out_len)
@@ -85,6 +266,7 @@ template <node_zlib_mode mode> class ZCtx : public ObjectWrap {
 
     ZCtx<mode> *ctx = ObjectWrap::Unwrap< ZCtx<mode> >(args.This());
     assert(ctx->init_done_ && "write before init");
+    assert(ctx->strm_ && "write after close");
 
     unsigned int flush = args[0]->Uint32Value();
     Bytef *in;
@@ -118,10 +300,10 @@ template <node_zlib_mode mode> class ZCtx : public ObjectWrap {
     WorkReqWrap *req_wrap = new WorkReqWrap();
 
     req_wrap->data_ = ctx;
-    ctx->strm_.avail_in = in_len;
-    ctx->strm_.next_in = &(*in);
-    ctx->strm_.avail_out = out_len;
-    ctx->strm_.next_out = out;
+    ctx->strm_->avail_in = in_len;
+    ctx->strm_->next_in = &(*in);
+    ctx->strm_->avail_out = out_len;
+    ctx->strm_->next_out = out;
     ctx->flush_ = flush;
 
     // set this so that later on, I can easily tell how much was written.
@@ -154,22 +336,7 @@ template <node_zlib_mode mode> class ZCtx : public ObjectWrap {
     // If the avail_out is left at 0, then it means that it ran out
     // of room.  If there was avail_out left over, then it means
     // that all of the input was consumed.
-    int err;
-    switch (mode) {
-      case DEFLATE:
-      case GZIP:
-      case DEFLATERAW:
-        err = deflate(&(ctx->strm_), ctx->flush_);
-        break;
-      case UNZIP:
-      case INFLATE:
-      case GUNZIP:
-      case INFLATERAW:
-        err = inflate(&(ctx->strm_), ctx->flush_);
-        break;
-      default:
-        assert(0 && "wtf?");
-    }
+    int err = ctx->Step(ctx->flush_);
     assert(err != Z_STREAM_ERROR);
 
     // now After will emit the output, and
@@ -181,11 +348,12 @@ template <node_zlib_mode mode> class ZCtx : public ObjectWrap {
   static void
   After(uv_work_t* work_req) {
     HandleScope scope;
+    LoopStatsScope stats_scope(LoopStats::PHASE_EIO, "callback");
     ZlibStatics *statics = NODE_STATICS_GET(node_zlib, ZlibStatics);
     WorkReqWrap *req_wrap = reinterpret_cast<WorkReqWrap *>(work_req->data);
     ZCtx<mode> *ctx = (ZCtx<mode> *)req_wrap->data_;
-    Local<Integer> avail_out = Integer::New(ctx->strm_.avail_out);
-    Local<Integer> avail_in = Integer::New(ctx->strm_.avail_in);
+    Local<Integer> avail_out = Integer::New(ctx->strm_->avail_out);
+    Local<Integer> avail_in = Integer::New(ctx->strm_->avail_in);
 
     // call the write() cb
     assert(req_wrap->object_->Get(statics->callback_sym)->IsFunction() &&
@@ -197,6 +365,254 @@ template <node_zlib_mode mode> class ZCtx : public ObjectWrap {
     delete req_wrap;
   }
 
+  // Pipelined mode.
+  //
+  // write() above does one trip through the thread pool per call and needs
+  // JS land to hand it the next output buffer every time. In pipelined mode
+  // the input buffers are queued here instead, and a single work request at
+  // a time drains the whole queue into blocks of output which are handed to
+  // onbatch(buffers, consumed, queued, errno, message) in one go. A batch
+  // stops early once it has produced highWaterMark bytes so that a large
+  // stream does not pile up output that JS land has not asked for yet.
+
+  // setPipeline(blockSize, highWaterMark)
+  static Handle<Value>
+  SetPipeline(const Arguments& args) {
+    HandleScope scope;
+
+    ZCtx<mode> *ctx = ObjectWrap::Unwrap< ZCtx<mode> >(args.This());
+    ctx->block_size_ = args[0]->Uint32Value();
+    ctx->high_water_ = args[1]->Uint32Value();
+    assert(ctx->block_size_ > 0);
+
+    return Undefined();
+  }
+
+  // push(flush, in) queues a buffer, or a bare flush if in is null, and
+  // returns the number of input bytes queued but not processed yet.
+  static Handle<Value>
+  Push(const Arguments& args) {
+    HandleScope scope;
+
+    ZCtx<mode> *ctx = ObjectWrap::Unwrap< ZCtx<mode> >(args.This());
+    assert(ctx->init_done_ && "push before init");
+    assert(ctx->strm_ && "push after close");
+
+    Chunk* c = new Chunk;
+    c->next = NULL;
+    c->flush = args[0]->Uint32Value();
+    c->data = NULL;
+    c->length = 0;
+    c->offset = 0;
+
+    if (!args[1]->IsNull()) {
+      assert(Buffer::HasInstance(args[1]));
+      Local<Object> in_buf = args[1]->ToObject();
+      c->buffer = Persistent<Object>::New(in_buf);
+      c->data = Buffer::Data(in_buf);
+      c->length = Buffer::Length(in_buf);
+    }
+
+    if (ctx->pending_tail_) {
+      ctx->pending_tail_->next = c;
+    } else {
+      ctx->pending_head_ = c;
+    }
+    ctx->pending_tail_ = c;
+    ctx->queued_bytes_ += c->length;
+
+    ctx->Dispatch();
+
+    return scope.Close(Number::New(ctx->queued_bytes_));
+  }
+
+  static Handle<Value>
+  Pause(const Arguments& args) {
+    HandleScope scope;
+    ZCtx<mode> *ctx = ObjectWrap::Unwrap< ZCtx<mode> >(args.This());
+    ctx->paused_ = true;
+    return Undefined();
+  }
+
+  static Handle<Value>
+  Resume(const Arguments& args) {
+    HandleScope scope;
+    ZCtx<mode> *ctx = ObjectWrap::Unwrap< ZCtx<mode> >(args.This());
+    ctx->paused_ = false;
+    ctx->Dispatch();
+    return Undefined();
+  }
+
+  void
+  Dispatch() {
+    if (busy_ || paused_ || error_ != Z_OK || strm_ == NULL) return;
+
+    // Whatever the last batch left over goes first.
+    if (pending_head_) {
+      if (work_tail_) {
+        work_tail_->next = pending_head_;
+      } else {
+        work_head_ = pending_head_;
+      }
+      work_tail_ = pending_tail_;
+      pending_head_ = pending_tail_ = NULL;
+    }
+
+    if (work_head_ == NULL) return;
+
+    busy_ = true;
+    Ref();
+
+    work_req_.data = this;
+    uv_queue_work(Isolate::GetCurrentLoop(),
+                  &work_req_,
+                  ZCtx<mode>::PipelineProcess,
+                  ZCtx<mode>::PipelineAfter);
+  }
+
+  // thread pool! Only touches the work, done and output lists, which
+  // the main thread leaves alone while busy_ is set.
+  static void
+  PipelineProcess(uv_work_t* work_req) {
+    ZCtx<mode> *ctx = static_cast<ZCtx<mode> *>(work_req->data);
+    ctx->Drain();
+  }
+
+  void
+  Drain() {
+    size_t produced = 0;
+
+    while (Chunk* c = work_head_) {
+      strm_->next_in = reinterpret_cast<Bytef *>(c->data + c->offset);
+      strm_->avail_in = c->length - c->offset;
+
+      for (;;) {
+        Block* b = out_tail_;
+        if (b == NULL || b->used == b->size) {
+          b = NewBlock();
+          if (b == NULL) {
+            error_ = Z_MEM_ERROR;
+            return;
+          }
+        }
+
+        strm_->next_out = reinterpret_cast<Bytef *>(b->data + b->used);
+        strm_->avail_out = b->size - b->used;
+
+        int err = Step(c->flush);
+        assert(err != Z_STREAM_ERROR);
+
+        size_t have = (b->size - b->used) - strm_->avail_out;
+        b->used += have;
+        produced += have;
+        c->offset = c->length - strm_->avail_in;
+
+        // Z_BUF_ERROR only means that no progress was possible, unless
+        // all of the input is in, there is room for more output and the
+        // stream still has not ended: then the input was cut short.
+        if (err == Z_BUF_ERROR && c->flush == Z_FINISH &&
+            strm_->avail_in == 0 && strm_->avail_out != 0) {
+          error_ = err;
+          return;
+        }
+        if (err != Z_OK && err != Z_STREAM_END && err != Z_BUF_ERROR) {
+          error_ = err;
+          return;
+        }
+
+        // Room left over means all of the input went in, and the output
+        // asked for by the flush mode came out.
+        if (strm_->avail_out != 0) break;
+
+        // Otherwise pick this chunk up again in the next batch.
+        if (produced >= high_water_) return;
+      }
+
+      work_head_ = c->next;
+      if (work_head_ == NULL) work_tail_ = NULL;
+
+      c->next = NULL;
+      if (done_tail_) {
+        done_tail_->next = c;
+      } else {
+        done_head_ = c;
+      }
+      done_tail_ = c;
+
+      if (produced >= high_water_) return;
+    }
+  }
+
+  // v8 land!
+  static void
+  PipelineAfter(uv_work_t* work_req) {
+    HandleScope scope;
+    LoopStatsScope stats_scope(LoopStats::PHASE_EIO, "onbatch");
+    ZlibStatics *statics = NODE_STATICS_GET(node_zlib, ZlibStatics);
+    ZCtx<mode> *ctx = static_cast<ZCtx<mode> *>(work_req->data);
+
+    ctx->busy_ = false;
+
+    int n = 0;
+    for (Block* b = ctx->out_head_; b; b = b->next) {
+      if (b->used > 0) n++;
+    }
+
+    // The output blocks are given away to the buffers, trimmed to size.
+    Local<Array> buffers = Array::New(n);
+    int i = 0;
+    while (Block* b = ctx->out_head_) {
+      ctx->out_head_ = b->next;
+
+      if (b->used > 0) {
+        char* data = b->data;
+        if (b->used < b->size) {
+          char* trimmed = static_cast<char*>(realloc(data, b->used));
+          if (trimmed) data = trimmed;
+        }
+        Buffer* buf = Buffer::New(data, b->used, FreeBlockData, NULL);
+        buffers->Set(i++, Local<Object>::New(buf->handle_));
+      } else {
+        free(b->data);
+      }
+
+      delete b;
+    }
+    ctx->out_tail_ = NULL;
+
+    while (Chunk* c = ctx->done_head_) {
+      ctx->done_head_ = c->next;
+      ctx->queued_bytes_ -= c->length;
+      ctx->consumed_++;
+      if (!c->buffer.IsEmpty()) c->buffer.Dispose();
+      delete c;
+    }
+    ctx->done_tail_ = NULL;
+
+    Local<Value> message = Local<Value>::New(Undefined());
+    if (ctx->error_ == Z_BUF_ERROR) {
+      message = String::New("unexpected end of file");
+    } else if (ctx->error_ != Z_OK) {
+      message = String::New(ctx->strm_->msg ? ctx->strm_->msg
+                                           : zError(ctx->error_));
+    }
+
+    Local<Value> argv[5] = {
+      buffers,
+      Integer::NewFromUnsigned(ctx->consumed_),
+      Number::New(ctx->queued_bytes_),
+      Integer::New(ctx->error_),
+      message
+    };
+
+    assert(ctx->handle_->Get(statics->onbatch_sym)->IsFunction() &&
+           "Invalid onbatch");
+    MakeCallback(ctx->handle_, "onbatch", 5, argv);
+
+    ctx->Dispatch();
+    ctx->Unref();
+  }
+
   static Handle<Value>
   New(const Arguments& args) {
     HandleScope scope;
@@ -210,8 +626,8 @@ template <node_zlib_mode mode> class ZCtx : public ObjectWrap {
   Init(const Arguments& args) {
     HandleScope scope;
 
-    assert(args.Length() == 4 &&
-           "init(windowBits, level, memLevel, strategy)");
+    assert((args.Length() == 4 || args.Length() == 5) &&
+           "init(windowBits, level, memLevel, strategy, [dictionary])");
 
     ZCtx<mode> *ctx = ObjectWrap::Unwrap< ZCtx<mode> >(args.This());
 
@@ -231,11 +647,20 @@ template <node_zlib_mode mode> class ZCtx : public ObjectWrap {
             strategy == Z_FIXED ||
             strategy == Z_DEFAULT_STRATEGY) && "invalid strategy");
 
-    Init(ctx, level, windowBits, memLevel, strategy);
-    return Undefined();
+    if (args.Length() == 5 && !args[4]->IsUndefined()) {
+      assert(Buffer::HasInstance(args[4]));
+      Local<Object> dictionary = args[4]->ToObject();
+      ctx->dictionary_ = Persistent<Object>::New(dictionary);
+      ctx->dictionary_data_ = reinterpret_cast<Bytef *>(
+          Buffer::Data(dictionary));
+      ctx->dictionary_len_ = Buffer::Length(dictionary);
+    }
+
+    int err = Init(ctx, level, windowBits, memLevel, strategy);
+    return scope.Close(Integer::New(err));
   }
 
-  static void
+  static int
   Init(ZCtx *ctx,
        int level,
        int windowBits,
@@ -246,10 +671,6 @@ template <node_zlib_mode mode> class ZCtx : public ObjectWrap {
     ctx->memLevel_ = memLevel;
     ctx->strategy_ = strategy;
 
-    ctx->strm_.zalloc = Z_NULL;
-    ctx->strm_.zfree = Z_NULL;
-    ctx->strm_.opaque = Z_NULL;
-
     ctx->flush_ = Z_NO_FLUSH;
 
     if (mode == GZIP || mode == GUNZIP) {
@@ -264,23 +685,31 @@ template <node_zlib_mode mode> class ZCtx : public ObjectWrap {
       ctx->windowBits_ *= -1;
     }
 
-    int err;
+    int err = Z_OK;
     switch (mode) {
       case DEFLATE:
       case GZIP:
       case DEFLATERAW:
-        err = deflateInit2(&(ctx->strm_),
-                           ctx->level_,
-                           Z_DEFLATED,
-                           ctx->windowBits_,
-                           ctx->memLevel_,
-                           ctx->strategy_);
+        ctx->strm_ = TakePooledDeflate(ctx->level_,
+                                       ctx->windowBits_,
+                                       ctx->memLevel_,
+                                       ctx->strategy_);
+        if (ctx->strm_ == NULL) {
+          ctx->strm_ = NewStream();
+          err = deflateInit2(ctx->strm_,
+                             ctx->level_,
+                             Z_DEFLATED,
+                             ctx->windowBits_,
+                             ctx->memLevel_,
+                             ctx->strategy_);
+        }
         break;
       case INFLATE:
       case GUNZIP:
       case INFLATERAW:
       case UNZIP:
-        err = inflateInit2(&(ctx->strm_), ctx->windowBits_);
+        ctx->strm_ = NewStream();
+        err = inflateInit2(ctx->strm_, ctx->windowBits_);
         break;
       default:
         assert(0 && "wtf?");
@@ -288,13 +717,108 @@ template <node_zlib_mode mode> class ZCtx : public ObjectWrap {
 
     ctx->init_done_ = true;
     assert(err == Z_OK);
+
+    // A preset dictionary goes in up front when compressing, and for raw
+    // inflate which has no header to ask for it. Otherwise inflate() asks
+    // for it with Z_NEED_DICT, see Step().
+    if (ctx->dictionary_data_ != NULL) {
+      switch (mode) {
+        case DEFLATE:
+        case DEFLATERAW:
+          err = deflateSetDictionary(ctx->strm_,
+                                     ctx->dictionary_data_,
+                                     ctx->dictionary_len_);
+          break;
+        case INFLATERAW:
+          err = inflateSetDictionary(ctx->strm_,
+                                     ctx->dictionary_data_,
+                                     ctx->dictionary_len_);
+          break;
+        default:
+          break;
+      }
+    }
+
+    return err;
+  }
+
+  static z_stream*
+  NewStream() {
+    z_stream* strm = new z_stream;
+    memset(strm, 0, sizeof(*strm));
+    strm->zalloc = Z_NULL;
+    strm->zfree = Z_NULL;
+    strm->opaque = Z_NULL;
+    return strm;
   }
 
  private:
 
+  struct Chunk {
+    Chunk* next;
+    Persistent<Object> buffer;  // keeps the input alive; empty for a flush
+    char* data;
+    size_t length;
+    size_t offset;  // how much of it zlib has taken in
+    int flush;
+  };
+
+  struct Block {
+    Block* next;
+    char* data;
+    size_t size;
+    size_t used;
+  };
+
+  Block*
+  NewBlock() {
+    Block* b = new Block;
+    b->data = static_cast<char*>(malloc(block_size_));
+    if (b->data == NULL) {
+      delete b;
+      return NULL;
+    }
+    b->next = NULL;
+    b->size = block_size_;
+    b->used = 0;
+
+    if (out_tail_) {
+      out_tail_->next = b;
+    } else {
+      out_head_ = b;
+    }
+    out_tail_ = b;
+    return b;
+  }
+
+  static void
+  FreeBlockData(char* data, void* hint) {
+    free(data);
+  }
+
+  void
+  FreeBlocks() {
+    while (Block* b = out_head_) {
+      out_head_ = b->next;
+      free(b->data);
+      delete b;
+    }
+    out_tail_ = NULL;
+  }
+
+  static void
+  FreeChunks(Chunk* c) {
+    while (c) {
+      Chunk* next = c->next;
+      if (!c->buffer.IsEmpty()) c->buffer.Dispose();
+      delete c;
+      c = next;
+    }
+  }
+
   bool init_done_;
 
-  z_stream strm_;
+  z_stream* strm_;
   int level_;
   int windowBits_;
   int memLevel_;
@@ -303,6 +827,27 @@ template <node_zlib_mode mode> class ZCtx : public ObjectWrap {
   int flush_;
 
   int chunk_size_;
+
+  Persistent<Object> dictionary_;
+  Bytef* dictionary_data_;
+  uInt dictionary_len_;
+
+  uv_work_t work_req_;
+  Chunk* pending_head_;  // pushed since the last batch was dispatched
+  Chunk* pending_tail_;
+  Chunk* work_head_;  // being worked on
+  Chunk* work_tail_;
+  Chunk* done_head_;  // fully consumed, to be reported
+  Chunk* done_tail_;
+  Block* out_head_;
+  Block* out_tail_;
+  size_t queued_bytes_;
+  unsigned int consumed_;  // number of chunks fully consumed so far
+  bool busy_;
+  bool paused_;
+  int error_;
+  size_t block_size_;
+  size_t high_water_;
 };
 
 
@@ -312,10 +857,30 @@ template <node_zlib_mode mode> class ZCtx : public ObjectWrap {
     z->InstanceTemplate()->SetInternalFieldCount(1); \
     NODE_SET_PROTOTYPE_METHOD(z, "write", ZCtx<mode>::Write); \
     NODE_SET_PROTOTYPE_METHOD(z, "init", ZCtx<mode>::Init); \
+    NODE_SET_PROTOTYPE_METHOD(z, "close", ZCtx<mode>::Close); \
+    NODE_SET_PROTOTYPE_METHOD(z, "setPipeline", ZCtx<mode>::SetPipeline); \
+    NODE_SET_PROTOTYPE_METHOD(z, "push", ZCtx<mode>::Push); \
+    NODE_SET_PROTOTYPE_METHOD(z, "pause", ZCtx<mode>::Pause); \
+    NODE_SET_PROTOTYPE_METHOD(z, "resume", ZCtx<mode>::Resume); \
     z->SetClassName(String::NewSymbol(name)); \
     target->Set(String::NewSymbol(name), z->GetFunction()); \
   }
 
+static Handle<Value> DeflatePoolStats(const Arguments& args) {
+  HandleScope scope;
+  ZlibStatics *statics = NODE_STATICS_GET(node_zlib, ZlibStatics);
+
+  Local<Object> info = Object::New();
+  info->Set(String::NewSymbol("pooled"),
+            Integer::New(statics->deflate_pool_size));
+  info->Set(String::NewSymbol("hits"),
+            Number::New(statics->deflate_pool_hits));
+  info->Set(String::NewSymbol("misses"),
+            Number::New(statics->deflate_pool_misses));
+
+  return scope.Close(info);
+}
+
 void InitZlib(Handle<Object> target) {
   HandleScope scope;
   NODE_STATICS_NEW(node_zlib, ZlibStatics, statics);
@@ -329,6 +894,9 @@ void InitZlib(Handle<Object> target) {
   NODE_ZLIB_CLASS(UNZIP, "Unzip")
 
   statics->callback_sym = NODE_PSYMBOL("callback");
+  statics->onbatch_sym = NODE_PSYMBOL("onbatch");
+
+  NODE_SET_METHOD(target, "deflatePoolStats", DeflatePoolStats);
 
   NODE_DEFINE_CONSTANT(target, Z_NO_FLUSH);
   NODE_DEFINE_CONSTANT(target, Z_PARTIAL_FLUSH);
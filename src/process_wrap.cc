@@ -22,6 +22,9 @@
 #include <node.h>
 #include <handle_wrap.h>
 #include <pipe_wrap.h>
+#if defined(NODE_FORK_ISOLATE)
+# include <isolate_channel.h>
+#endif
 #include <string.h>
 #include <stdlib.h>
 
@@ -97,6 +100,14 @@ class ProcessWrap : public HandleWrap {
   static void *IsolateMain(uv_thread_shared_t *hnd, void *thread_arg) {
     node::Isolate *isolate = static_cast<node::Isolate *>(thread_arg);
     isolate->Start(hnd);
+    if (hnd->channel) {
+      // Close our end in case the child never did; this is the reference
+      // that was taken for the thread in Spawn().
+      IsolateChannel* channel = static_cast<IsolateChannel*>(hnd->channel);
+      channel->Detach(IsolateChannel::CHILD);
+      channel->Unref();
+      hnd->channel = NULL;
+    }
     hnd->exit_status = isolate->exit_status;
     hnd->term_signal = isolate->term_signal;
     isolate->Dispose();
@@ -205,7 +216,18 @@ class ProcessWrap : public HandleWrap {
       } else {
         options.thread_arg = isolate;
         options.thread_run = IsolateMain;
+
+        // options.channel
+        IsolateChannel* channel = NULL;
+        Local<Value> channel_v = js_options->Get(String::New("channel"));
+        if (channel_v->IsObject()) {
+          channel = IsolateChannel::Unwrap(channel_v->ToObject());
+          if (channel) channel->Ref();
+        }
+        options.thread_channel = channel;
+
         r = uv_thread_create(Isolate::GetCurrentLoop(), &wrap->thread_, options);
+        if (r && channel) channel->Unref();
         wrap->SetHandle((uv_handle_t*)&wrap->thread_);
         assert(wrap->thread_.data == wrap);
         wrap->is_isolate_ = true;
@@ -30,6 +30,7 @@ class ReqWrap {
   ReqWrap() {
     v8::HandleScope scope;
     object_ = v8::Persistent<v8::Object>::New(v8::Object::New());
+    data_ = NULL;
   }
 
   ~ReqWrap() {
@@ -26,13 +26,41 @@
 #include <tcp_wrap.h>
 #include <req_wrap.h>
 
+#include <stdlib.h> // malloc, free
+#include <string.h> // memset
+
 
 namespace node {
 
 
-#define SLAB_SIZE (1024 * 1024)
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 
+// Reads are carved out of slabs of a few fixed sizes. A connection reads
+// into the smallest class that fits its current read size, so a slow
+// consumer that holds on to one small read only pins a small slab.
+#define SLAB_CLASSES 3
+#define SLAB_FREE_MAX 4       // free slabs kept around per class
+#define READ_SIZE_MIN (4 * 1024)
+#define READ_SIZE_MAX (64 * 1024)
+#define READ_SIZE_INITIAL (16 * 1024)
+
+static const size_t slab_sizes[SLAB_CLASSES] = {
+  64 * 1024,    // reads up to 4 kB
+  256 * 1024,   // reads up to 16 kB
+  1024 * 1024   // reads up to 64 kB
+};
+
+// Strings written from JavaScript are encoded into blocks of this size.
+// Larger ones get a block of their own.
+#define STRING_BLOCK_SIZE (64 * 1024)
+#define STRING_SMALL_MAX (8 * 1024)
+
+static inline int SlabClass(size_t read_size) {
+  if (read_size <= 4 * 1024) return 0;
+  if (read_size <= 16 * 1024) return 1;
+  return 2;
+}
+
 
 using v8::Object;
 using v8::Handle;
@@ -47,6 +75,8 @@ using v8::TryCatch;
 using v8::Context;
 using v8::Arguments;
 using v8::Integer;
+using v8::Array;
+using v8::V8;
 
 
 #define UNWRAP \
@@ -65,24 +95,80 @@ using v8::Integer;
 typedef class ReqWrap<uv_shutdown_t> ShutdownWrap;
 typedef class ReqWrap<uv_write_t> WriteWrap;
 
+class StreamStatics;
+
+// Header of a slab's memory. The data follows right behind it.
+struct Slab {
+  Slab* prev;  // on the list of slabs in use
+  Slab* next;  // on the free list or on the list of slabs in use
+  StreamStatics* statics;
+  int klass;
+  char* Data() { return reinterpret_cast<char*>(this + 1); }
+};
+
+// Backing store for strings that are written out. Small strings share a
+// block and are stacked on top of each other; once every write using the
+// block has completed it is rewound. A string that is too large gets a
+// block to itself, which is freed after its write.
+struct StringBlock {
+  size_t size;
+  size_t used;
+  unsigned int refs;
+  char* Data() { return reinterpret_cast<char*>(this + 1); }
+};
+
 class StreamStatics : public ModuleStatics {
-    size_t slab_used;
-    uv_stream_t* handle_that_last_alloced;
+    // Per size class: the slab currently being carved up and how much of
+    // it is handed out, and the slabs whose Buffer has been collected.
+    Persistent<Object> slab[SLAB_CLASSES];
+    size_t slab_used[SLAB_CLASSES];
+    uv_stream_t* handle_that_last_alloced[SLAB_CLASSES];
+    Slab* free_slabs[SLAB_CLASSES];
+    unsigned int free_count[SLAB_CLASSES];
+    Slab* used_slabs;  // handed to a Buffer that has not been collected
+    SlabPoolStats stats;
+    StringBlock* string_block;  // the one small strings go into
     Persistent<String> slab_sym;
     Persistent<String> buffer_sym;
     Persistent<String> write_queue_size_sym;
-    bool initialized;
+    Persistent<String> bytes_sym;
     friend class StreamWrap;
-    StreamStatics() {slab_used = 0; initialized = false;}
+    StreamStatics() {
+      memset(slab_used, 0, sizeof(slab_used));
+      memset(handle_that_last_alloced, 0, sizeof(handle_that_last_alloced));
+      memset(free_slabs, 0, sizeof(free_slabs));
+      memset(free_count, 0, sizeof(free_count));
+      memset(&stats, 0, sizeof(stats));
+      used_slabs = NULL;
+      string_block = NULL;
+    }
+    // Runs once the isolate's heap is gone, so only plain memory is let go
+    // of here. The heap goes without collecting its Buffers, so the slabs
+    // they still held are freed here too.
+    ~StreamStatics() {
+      while (Slab* slab = used_slabs) {
+        used_slabs = slab->next;
+        free(slab);
+      }
+      for (int i = 0; i < SLAB_CLASSES; i++) {
+        while (Slab* slab = free_slabs[i]) {
+          free_slabs[i] = slab->next;
+          free(slab);
+        }
+        free_count[i] = 0;
+      }
+      if (string_block && string_block->refs == 0) free(string_block);
+      string_block = NULL;
+    }
 };
 
 void StreamWrap::Initialize(Handle<Object> target) {
-  NODE_STATICS_NEW(node_stream_wrap, StreamStatics, statics);
-  if (statics->initialized) {
+  // Called by every stream binding; the first one sets things up. The
+  // statics must stay put after that since live slabs point back to them.
+  if (NODE_STATICS_GET(node_stream_wrap, StreamStatics) != NULL) {
     return;
-  } else {
-    statics->initialized = true;
   }
+  NODE_STATICS_NEW(node_stream_wrap, StreamStatics, statics);
 
   HandleScope scope;
 
@@ -92,12 +178,27 @@ void StreamWrap::Initialize(Handle<Object> target) {
   statics->buffer_sym = Persistent<String>::New(String::NewSymbol("buffer"));
   statics->write_queue_size_sym =
     Persistent<String>::New(String::NewSymbol("writeQueueSize"));
+  statics->bytes_sym = Persistent<String>::New(String::NewSymbol("bytes"));
+}
+
+
+void StreamWrap::GetSlabPoolStats(SlabPoolStats* stats) {
+  StreamStatics *statics = NODE_STATICS_GET(node_stream_wrap, StreamStatics);
+  if (statics) {
+    *stats = statics->stats;
+  } else {
+    memset(stats, 0, sizeof(*stats));
+  }
 }
 
 
 StreamWrap::StreamWrap(Handle<Object> object, uv_stream_t* stream)
     : HandleWrap(object, (uv_handle_t*)stream) {
   stream_ = stream;
+  slab_offset_ = 0;
+  slab_class_ = 0;
+  read_size_ = READ_SIZE_INITIAL;
+  consumer_ = NULL;
   if (stream) {
     stream->data = this;
   }
@@ -118,19 +219,28 @@ void StreamWrap::UpdateWriteQueueSize() {
 }
 
 
+int StreamWrap::StartReading() {
+  bool ipc_pipe = stream_->type == UV_NAMED_PIPE &&
+                  ((uv_pipe_t*)stream_)->ipc;
+  if (ipc_pipe) {
+    return uv_read2_start(stream_, OnAlloc, OnRead2);
+  } else {
+    return uv_read_start(stream_, OnAlloc, OnRead);
+  }
+}
+
+
+int StreamWrap::StopReading() {
+  return uv_read_stop(stream_);
+}
+
+
 Handle<Value> StreamWrap::ReadStart(const Arguments& args) {
   HandleScope scope;
 
   UNWRAP
 
-  bool ipc_pipe = wrap->stream_->type == UV_NAMED_PIPE &&
-                  ((uv_pipe_t*)wrap->stream_)->ipc;
-  int r;
-  if (ipc_pipe) {
-    r = uv_read2_start(wrap->stream_, OnAlloc, OnRead2);
-  } else {
-    r = uv_read_start(wrap->stream_, OnAlloc, OnRead);
-  }
+  int r = wrap->StartReading();
 
   // Error starting the tcp.
   if (r) SetLastErrno();
@@ -144,7 +254,7 @@ Handle<Value> StreamWrap::ReadStop(const Arguments& args) {
 
   UNWRAP
 
-  int r = uv_read_stop(wrap->stream_);
+  int r = wrap->StopReading();
 
   // Error starting the tcp.
   if (r) SetLastErrno();
@@ -153,15 +263,69 @@ Handle<Value> StreamWrap::ReadStop(const Arguments& args) {
 }
 
 
-inline char* StreamWrap::NewSlab(Handle<Object> global,
-                                        Handle<Object> wrap_obj) {
+// Called when the last Buffer referencing a retired slab is collected.
+void StreamWrap::FreeSlab(char* data, void* hint) {
+  Slab* slab = static_cast<Slab*>(hint);
+  StreamStatics* statics = slab->statics;
+  int klass = slab->klass;
+
+  statics->stats.pinned -= slab_sizes[klass];
+
+  if (slab->prev) {
+    slab->prev->next = slab->next;
+  } else {
+    statics->used_slabs = slab->next;
+  }
+  if (slab->next) slab->next->prev = slab->prev;
+
+  if (statics->free_count[klass] < SLAB_FREE_MAX) {
+    slab->next = statics->free_slabs[klass];
+    statics->free_slabs[klass] = slab;
+    statics->free_count[klass]++;
+    statics->stats.pooled += slab_sizes[klass];
+  } else {
+    free(slab);
+    V8::AdjustAmountOfExternalAllocatedMemory(-static_cast<int>(
+        sizeof(Slab) + slab_sizes[klass]));
+  }
+}
+
+
+inline char* StreamWrap::NewSlab(int klass, Handle<Object> wrap_obj) {
   StreamStatics *statics = NODE_STATICS_GET(node_stream_wrap, StreamStatics);
-  Buffer* b = Buffer::New(SLAB_SIZE);
-  global->SetHiddenValue(statics->slab_sym, b->handle_);
-  assert(Buffer::Length(b) == SLAB_SIZE);
-  statics->slab_used = 0;
+  size_t size = slab_sizes[klass];
+  Slab* slab = statics->free_slabs[klass];
+
+  if (slab) {
+    statics->free_slabs[klass] = slab->next;
+    statics->free_count[klass]--;
+    statics->stats.pooled -= size;
+    statics->stats.hits++;
+  } else {
+    slab = static_cast<Slab*>(malloc(sizeof(Slab) + size));
+    if (slab == NULL) return NULL;
+    slab->statics = statics;
+    slab->klass = klass;
+    V8::AdjustAmountOfExternalAllocatedMemory(sizeof(Slab) + size);
+    statics->stats.misses++;
+  }
+  slab->prev = NULL;
+  slab->next = statics->used_slabs;
+  if (slab->next) slab->next->prev = slab;
+  statics->used_slabs = slab;
+
+  // The previous slab stays alive for as long as slices of it are in use.
+  if (!statics->slab[klass].IsEmpty()) {
+    statics->slab[klass].Dispose();
+    statics->stats.pinned += size;
+  }
+
+  Buffer* b = Buffer::New(slab->Data(), size, FreeSlab, slab);
+  assert(Buffer::Length(b) == size);
+  statics->slab[klass] = Persistent<Object>::New(b->handle_);
+  statics->slab_used[klass] = 0;
   wrap_obj->SetHiddenValue(statics->slab_sym, b->handle_);
-  return Buffer::Data(b);
+  return slab->Data();
 }
 
 
@@ -172,37 +336,38 @@ uv_buf_t StreamWrap::OnAlloc(uv_handle_t* handle, size_t suggested_size) {
   StreamWrap* wrap = static_cast<StreamWrap*>(handle->data);
   assert(wrap->stream_ == reinterpret_cast<uv_stream_t*>(handle));
 
-  char* slab = NULL;
+  if (wrap->consumer_) {
+    return wrap->consumer_->OnAlloc(suggested_size);
+  }
 
-  Handle<Object> global = Context::GetCurrent()->Global();
-  Local<Value> slab_v = global->GetHiddenValue(statics->slab_sym);
+  size_t read_size = MIN(wrap->read_size_, suggested_size);
+  int klass = SlabClass(read_size);
+  size_t slab_size = slab_sizes[klass];
+  char* slab = NULL;
 
-  if (slab_v.IsEmpty()) {
-    // No slab currently. Create a new one.
-    slab = NewSlab(global, wrap->object_);
+  if (statics->slab[klass].IsEmpty() ||
+      slab_size - statics->slab_used[klass] < read_size) {
+    // No slab currently, or not enough left on it. Get a new one.
+    slab = NewSlab(klass, wrap->object_);
+    if (slab == NULL) {
+      return uv_buf_init(NULL, 0);
+    }
   } else {
     // Use existing slab.
-    Local<Object> slab_obj = slab_v->ToObject();
-    slab = Buffer::Data(slab_obj);
-    assert(Buffer::Length(slab_obj) == SLAB_SIZE);
-    assert(SLAB_SIZE >= statics->slab_used);
-
-    // If less than 64kb is remaining on the slab allocate a new one.
-    if (SLAB_SIZE - statics->slab_used < 64 * 1024) {
-      slab = NewSlab(global, wrap->object_);
-    } else {
-      wrap->object_->SetHiddenValue(statics->slab_sym, slab_obj);
-    }
+    slab = Buffer::Data(statics->slab[klass]);
+    wrap->object_->SetHiddenValue(statics->slab_sym, statics->slab[klass]);
   }
 
   uv_buf_t buf;
-  buf.base = slab + statics->slab_used;
-  buf.len = MIN(SLAB_SIZE - statics->slab_used, suggested_size);
+  buf.base = slab + statics->slab_used[klass];
+  buf.len = read_size;
 
-  wrap->slab_offset_ = statics->slab_used;
-  statics->slab_used += buf.len;
+  wrap->slab_offset_ = statics->slab_used[klass];
+  wrap->slab_class_ = klass;
+  statics->slab_used[klass] += buf.len;
 
-  statics->handle_that_last_alloced = reinterpret_cast<uv_stream_t*>(handle);
+  statics->handle_that_last_alloced[klass] =
+      reinterpret_cast<uv_stream_t*>(handle);
 
   return buf;
 }
@@ -219,14 +384,22 @@ void StreamWrap::OnReadCommon(uv_stream_t* handle, ssize_t nread,
   // uv_close() on the handle.
   assert(wrap->object_.IsEmpty() == false);
 
+  if (wrap->consumer_) {
+    assert(pending == UV_UNKNOWN_HANDLE);
+    wrap->consumer_->OnRead(nread, buf);
+    return;
+  }
+
   // Remove the reference to the slab to avoid memory leaks;
   Local<Value> slab_v = wrap->object_->GetHiddenValue(statics->slab_sym);
   wrap->object_->SetHiddenValue(statics->slab_sym, v8::Null());
 
+  int klass = wrap->slab_class_;
+
   if (nread < 0)  {
     // EOF or Error
-    if (statics->handle_that_last_alloced == handle) {
-      statics->slab_used -= buf.len;
+    if (statics->handle_that_last_alloced[klass] == handle) {
+      statics->slab_used[klass] -= buf.len;
     }
 
     SetLastErrno();
@@ -236,8 +409,17 @@ void StreamWrap::OnReadCommon(uv_stream_t* handle, ssize_t nread,
 
   assert(nread <= buf.len);
 
-  if (statics->handle_that_last_alloced == handle) {
-    statics->slab_used -= (buf.len - nread);
+  if (statics->handle_that_last_alloced[klass] == handle) {
+    statics->slab_used[klass] -= (buf.len - nread);
+  }
+
+  // Follow what the connection actually delivers: grow the next read when
+  // this one filled the buffer, shrink it when it used little of it.
+  if ((size_t) nread == buf.len && wrap->read_size_ < READ_SIZE_MAX) {
+    wrap->read_size_ *= 2;
+  } else if ((size_t) nread <= wrap->read_size_ / 4 &&
+             wrap->read_size_ > READ_SIZE_MIN) {
+    wrap->read_size_ /= 2;
   }
 
   if (nread > 0) {
@@ -352,6 +534,278 @@ Handle<Value> StreamWrap::Write(const Arguments& args) {
 }
 
 
+// Writes an array of buffers with a single request. The buffers go out
+// with as few writev() calls as the kernel lets us get away with.
+Handle<Value> StreamWrap::Writev(const Arguments& args) {
+  HandleScope scope;
+  StreamStatics *statics = NODE_STATICS_GET(node_stream_wrap, StreamStatics);
+
+  UNWRAP
+
+  assert(args[0]->IsArray());
+  Local<Array> buffers = Local<Array>::Cast(args[0]);
+  uint32_t count = buffers->Length();
+
+  if (count == 0) {
+    uv_err_t err;
+    err.code = UV_EINVAL;
+    SetErrno(err);
+    return scope.Close(v8::Null());
+  }
+
+  uv_buf_t bufs_stack[16];
+  uv_buf_t* bufs = bufs_stack;
+
+  if (count > ARRAY_SIZE(bufs_stack)) {
+    bufs = new uv_buf_t[count];
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    Local<Value> buffer_v = buffers->Get(i);
+    assert(Buffer::HasInstance(buffer_v));
+    Local<Object> buffer_obj = buffer_v->ToObject();
+    bufs[i] = uv_buf_init(Buffer::Data(buffer_obj),
+                          Buffer::Length(buffer_obj));
+  }
+
+  WriteWrap* req_wrap = new WriteWrap();
+
+  // Keeps all of the buffers alive until the write completes.
+  req_wrap->object_->SetHiddenValue(statics->buffer_sym, buffers);
+
+  // libuv takes a copy of the uv_buf_t array.
+  int r = uv_write(&req_wrap->req_, wrap->stream_, bufs, count,
+                   StreamWrap::AfterWrite);
+
+  if (bufs != bufs_stack) {
+    delete [] bufs;
+  }
+
+  req_wrap->Dispatched();
+
+  wrap->UpdateWriteQueueSize();
+
+  if (r) {
+    SetLastErrno();
+    delete req_wrap;
+    return scope.Close(v8::Null());
+  } else {
+    return scope.Close(req_wrap->object_);
+  }
+}
+
+
+// sendFile(fd, offset, length, [buffers]) queues a range of a file behind
+// the pending writes. It goes out with sendfile() once everything before it
+// has. The buffers, typically protocol headers, lead the file in the same
+// request.
+Handle<Value> StreamWrap::SendFile(const Arguments& args) {
+  HandleScope scope;
+  StreamStatics *statics = NODE_STATICS_GET(node_stream_wrap, StreamStatics);
+
+  UNWRAP
+
+  assert(args[0]->IsInt32());
+  int fd = args[0]->Int32Value();
+  int64_t offset = args[1]->IntegerValue();
+  size_t length = args[2]->IntegerValue();
+
+  uv_buf_t bufs_stack[16];
+  uv_buf_t* bufs = bufs_stack;
+  uint32_t count = 0;
+
+  WriteWrap* req_wrap = new WriteWrap();
+
+  if (args[3]->IsArray()) {
+    Local<Array> buffers = Local<Array>::Cast(args[3]);
+    count = buffers->Length();
+
+    if (count > ARRAY_SIZE(bufs_stack)) {
+      bufs = new uv_buf_t[count];
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+      Local<Value> buffer_v = buffers->Get(i);
+      assert(Buffer::HasInstance(buffer_v));
+      Local<Object> buffer_obj = buffer_v->ToObject();
+      bufs[i] = uv_buf_init(Buffer::Data(buffer_obj),
+                            Buffer::Length(buffer_obj));
+    }
+
+    req_wrap->object_->SetHiddenValue(statics->buffer_sym, buffers);
+  } else {
+    // AfterWrite() hands this to oncomplete in place of the buffer.
+    req_wrap->object_->SetHiddenValue(statics->buffer_sym, args[0]);
+  }
+
+  int r = uv_write_file(&req_wrap->req_, wrap->stream_, bufs, count,
+                        fd, offset, length, StreamWrap::AfterWrite);
+
+  if (bufs != bufs_stack) {
+    delete [] bufs;
+  }
+
+  req_wrap->Dispatched();
+
+  wrap->UpdateWriteQueueSize();
+
+  if (r) {
+    SetLastErrno();
+    delete req_wrap;
+    return scope.Close(v8::Null());
+  } else {
+    return scope.Close(req_wrap->object_);
+  }
+}
+
+
+char* StreamWrap::AllocString(size_t size, StringBlock** block) {
+  StreamStatics *statics = NODE_STATICS_GET(node_stream_wrap, StreamStatics);
+  StringBlock* b;
+
+  if (size > STRING_SMALL_MAX) {
+    b = static_cast<StringBlock*>(malloc(sizeof(StringBlock) + size));
+    if (b == NULL) return NULL;
+    b->size = b->used = size;
+    b->refs = 1;
+    *block = b;
+    return b->Data();
+  }
+
+  b = statics->string_block;
+
+  if (b == NULL || b->size - b->used < size) {
+    // Writes are still using the current block. Leave it to them; it is
+    // freed when the last one completes.
+    b = static_cast<StringBlock*>(malloc(sizeof(StringBlock) +
+                                         STRING_BLOCK_SIZE));
+    if (b == NULL) return NULL;
+    b->size = STRING_BLOCK_SIZE;
+    b->used = 0;
+    b->refs = 0;
+    statics->string_block = b;
+  }
+
+  char* data = b->Data() + b->used;
+  b->used += size;
+  b->refs++;
+  *block = b;
+  return data;
+}
+
+
+// Gives back the end of the most recent allocation from the block.
+void StreamWrap::TrimString(StringBlock* block, size_t unused) {
+  assert(block->used >= unused);
+  block->used -= unused;
+}
+
+
+void StreamWrap::ReleaseString(StringBlock* block) {
+  StreamStatics *statics = NODE_STATICS_GET(node_stream_wrap, StreamStatics);
+
+  assert(block->refs > 0);
+  if (--block->refs > 0) return;
+
+  if (block == statics->string_block) {
+    block->used = 0;
+  } else {
+    free(block);
+  }
+}
+
+
+// Encodes a string straight into memory that stays with the write request,
+// without going through a Buffer.
+template <enum encoding encoding>
+Handle<Value> StreamWrap::WriteStringImpl(const Arguments& args) {
+  HandleScope scope;
+  StreamStatics *statics = NODE_STATICS_GET(node_stream_wrap, StreamStatics);
+
+  UNWRAP
+
+  assert(args[0]->IsString());
+  Local<String> string = args[0]->ToString();
+
+  WriteWrap* req_wrap = new WriteWrap();
+  StringBlock* block = NULL;
+  uv_buf_t buf;
+
+  req_wrap->object_->SetHiddenValue(statics->buffer_sym, string);
+
+  if (encoding == ASCII && string->IsExternalAscii()) {
+    // The characters are already out of the V8 heap. Write them from where
+    // they are; the hidden value keeps them alive.
+    const String::ExternalAsciiStringResource* resource =
+        string->GetExternalAsciiStringResource();
+    buf = uv_buf_init(const_cast<char*>(resource->data()),
+                      resource->length());
+  } else {
+    size_t length = string->Length();
+    size_t size;
+
+    if (encoding == ASCII) {
+      size = length;
+    } else if (length * 3 <= STRING_SMALL_MAX) {
+      // Worst case; the unused part is handed back below.
+      size = length * 3;
+    } else {
+      size = string->Utf8Length();
+    }
+
+    char* data = AllocString(size, &block);
+    if (data == NULL) {
+      delete req_wrap;
+      uv_err_t err;
+      err.code = UV_ENOMEM;
+      SetErrno(err);
+      return scope.Close(v8::Null());
+    }
+
+    int written;
+    if (encoding == ASCII) {
+      written = string->WriteAscii(data, 0, length,
+                                   String::NO_NULL_TERMINATION);
+    } else {
+      written = string->WriteUtf8(data, size, NULL,
+                                  String::NO_NULL_TERMINATION);
+    }
+    assert(static_cast<size_t>(written) <= size);
+    TrimString(block, size - written);
+
+    buf = uv_buf_init(data, written);
+    req_wrap->data_ = block;
+  }
+
+  int r = uv_write(&req_wrap->req_, wrap->stream_, &buf, 1,
+                   StreamWrap::AfterWrite);
+
+  req_wrap->Dispatched();
+  req_wrap->object_->Set(statics->bytes_sym, Integer::NewFromUnsigned(buf.len));
+
+  wrap->UpdateWriteQueueSize();
+
+  if (r) {
+    SetLastErrno();
+    if (block) ReleaseString(block);
+    delete req_wrap;
+    return scope.Close(v8::Null());
+  } else {
+    return scope.Close(req_wrap->object_);
+  }
+}
+
+
+Handle<Value> StreamWrap::WriteAsciiString(const Arguments& args) {
+  return WriteStringImpl<ASCII>(args);
+}
+
+
+Handle<Value> StreamWrap::WriteUtf8String(const Arguments& args) {
+  return WriteStringImpl<UTF8>(args);
+}
+
+
 void StreamWrap::AfterWrite(uv_write_t* req, int status) {
   WriteWrap* req_wrap = (WriteWrap*) req->data;
   StreamWrap* wrap = (StreamWrap*) req->handle->data;
@@ -376,6 +830,10 @@ void StreamWrap::AfterWrite(uv_write_t* req, int status) {
     req_wrap->object_->GetHiddenValue(statics->buffer_sym),
   };
 
+  if (req_wrap->data_) {
+    ReleaseString(static_cast<StringBlock*>(req_wrap->data_));
+  }
+
   MakeCallback(req_wrap->object_, "oncomplete", 4, argv);
 
   delete req_wrap;
@@ -28,18 +28,48 @@
 
 namespace node {
 
+// Counters of the pool that read buffers come from.
+struct SlabPoolStats {
+  size_t hits;    // slabs reused from the free list
+  size_t misses;  // slabs that had to be allocated
+  size_t pinned;  // bytes in retired slabs that are still referenced
+  size_t pooled;  // bytes in slabs on the free list
+};
+
+struct StringBlock;
+
+// Takes over what is read from a stream before it gets to JavaScript.
+// TLSWrap is one: it deciphers the data and passes cleartext on itself.
+class StreamConsumer {
+ public:
+  virtual ~StreamConsumer() { }
+  virtual uv_buf_t OnAlloc(size_t suggested_size) = 0;
+  virtual void OnRead(ssize_t nread, uv_buf_t buf) = 0;
+};
+
 class StreamWrap : public HandleWrap {
  public:
   uv_stream_t* GetStream() { return stream_; }
 
+  // While a consumer is set, reads go to it instead of to onread.
+  void SetConsumer(StreamConsumer* consumer) { consumer_ = consumer; }
+  int StartReading();
+  int StopReading();
+
   static void Initialize(v8::Handle<v8::Object> target);
 
   // JavaScript functions
   static v8::Handle<v8::Value> Write(const v8::Arguments& args);
+  static v8::Handle<v8::Value> Writev(const v8::Arguments& args);
+  static v8::Handle<v8::Value> SendFile(const v8::Arguments& args);
+  static v8::Handle<v8::Value> WriteAsciiString(const v8::Arguments& args);
+  static v8::Handle<v8::Value> WriteUtf8String(const v8::Arguments& args);
   static v8::Handle<v8::Value> ReadStart(const v8::Arguments& args);
   static v8::Handle<v8::Value> ReadStop(const v8::Arguments& args);
   static v8::Handle<v8::Value> Shutdown(const v8::Arguments& args);
 
+  static void GetSlabPoolStats(SlabPoolStats* stats);
+
  protected:
   StreamWrap(v8::Handle<v8::Object> object, uv_stream_t* stream);
   virtual ~StreamWrap() { }
@@ -48,7 +78,14 @@ class StreamWrap : public HandleWrap {
   void UpdateWriteQueueSize();
 
  private:
-  static inline char* NewSlab(v8::Handle<v8::Object> global, v8::Handle<v8::Object> wrap_obj);
+  static inline char* NewSlab(int klass, v8::Handle<v8::Object> wrap_obj);
+  static void FreeSlab(char* data, void* hint);
+
+  template <enum encoding encoding>
+  static v8::Handle<v8::Value> WriteStringImpl(const v8::Arguments& args);
+  static char* AllocString(size_t size, StringBlock** block);
+  static void TrimString(StringBlock* block, size_t unused);
+  static void ReleaseString(StringBlock* block);
 
   // Callbacks for libuv
   static void AfterWrite(uv_write_t* req, int status);
@@ -62,7 +99,10 @@ class StreamWrap : public HandleWrap {
       uv_buf_t buf, uv_handle_type pending);
 
   size_t slab_offset_;
+  int slab_class_;
+  size_t read_size_;  // size of the next read, adapted to past reads
   uv_stream_t* stream_;
+  StreamConsumer* consumer_;
 };
 
 
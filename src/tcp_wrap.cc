@@ -112,6 +112,12 @@ void TCPWrap::Initialize(Handle<Object> target) {
   NODE_SET_PROTOTYPE_METHOD(t, "readStart", StreamWrap::ReadStart);
   NODE_SET_PROTOTYPE_METHOD(t, "readStop", StreamWrap::ReadStop);
   NODE_SET_PROTOTYPE_METHOD(t, "write", StreamWrap::Write);
+  NODE_SET_PROTOTYPE_METHOD(t, "writev", StreamWrap::Writev);
+#ifdef __POSIX__
+  NODE_SET_PROTOTYPE_METHOD(t, "sendFile", StreamWrap::SendFile);
+#endif
+  NODE_SET_PROTOTYPE_METHOD(t, "writeAsciiString", StreamWrap::WriteAsciiString);
+  NODE_SET_PROTOTYPE_METHOD(t, "writeUtf8String", StreamWrap::WriteUtf8String);
   NODE_SET_PROTOTYPE_METHOD(t, "shutdown", StreamWrap::Shutdown);
 
   NODE_SET_PROTOTYPE_METHOD(t, "bind", Bind);
@@ -123,6 +129,7 @@ void TCPWrap::Initialize(Handle<Object> target) {
   NODE_SET_PROTOTYPE_METHOD(t, "getpeername", GetPeerName);
   NODE_SET_PROTOTYPE_METHOD(t, "setNoDelay", SetNoDelay);
   NODE_SET_PROTOTYPE_METHOD(t, "setKeepAlive", SetKeepAlive);
+  NODE_SET_PROTOTYPE_METHOD(t, "setReusePort", SetReusePort);
 
 #ifdef _WIN32
   NODE_SET_PROTOTYPE_METHOD(t, "setSimultaneousAccepts", SetSimultaneousAccepts);
@@ -281,6 +288,21 @@ Handle<Value> TCPWrap::SetKeepAlive(const Arguments& args) {
 }
 
 
+Handle<Value> TCPWrap::SetReusePort(const Arguments& args) {
+  HandleScope scope;
+
+  UNWRAP
+
+  bool enable = args[0]->BooleanValue();
+
+  int r = uv_tcp_reuseport(&wrap->handle_, enable ? 1 : 0);
+  if (r)
+    SetLastErrno();
+
+  return scope.Close(Integer::New(r));
+}
+
+
 #ifdef _WIN32
 Handle<Value> TCPWrap::SetSimultaneousAccepts(const Arguments& args) {
   HandleScope scope;
@@ -21,6 +21,8 @@
 
 #include <node.h>
 #include <handle_wrap.h>
+#include <node_loop_stats.h>
+#include <stdlib.h>
 
 #define UNWRAP \
   assert(!args.Holder().IsEmpty()); \
@@ -34,6 +36,18 @@
     return scope.Close(Integer::New(-1)); \
   }
 
+#define UNWRAP_WHEEL \
+  assert(!args.Holder().IsEmpty()); \
+  assert(args.Holder()->InternalFieldCount() > 0); \
+  TimerWheel* wheel =  \
+      static_cast<TimerWheel*>(args.Holder()->GetPointerFromInternalField(0)); \
+  if (!wheel) { \
+    uv_err_t err; \
+    err.code = UV_EBADF; \
+    SetErrno(err); \
+    return scope.Close(Integer::New(-1)); \
+  }
+
 namespace node {
 
 using v8::Object;
@@ -51,6 +65,421 @@ using v8::Arguments;
 using v8::Integer;
 
 
+// Returns the distance from `from` to the first set bit of the 64 slot
+// bitmap `bits`, going around the wheel, or -1 when no slot is occupied.
+static inline int NextOccupied(uint64_t bits, int from) {
+  uint64_t rot = from ? (bits >> from) | (bits << (64 - from)) : bits;
+  if (rot == 0) return -1;
+#if defined(__GNUC__)
+  return __builtin_ctzll(rot);
+#else
+  int n = 0;
+  while (!(rot & 1)) {
+    rot >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+
+// A hierarchical timing wheel for the idle timeouts in lib/timers.js.
+//
+// Four levels of 64 slots with a 1 ms tick cover about 4.6 hours; entries
+// further out are parked in the top level and placed again when it comes
+// around. Every entry sits on a doubly linked slot list so start, again and
+// stop are O(1), whatever the number of distinct timeout values. Entries
+// move down a level when the slot they are in comes up (cascading). All of
+// it runs off one uv_timer_t that is set for the next occupied slot, and
+// the clock is the loop's cached uv_now(), so arming a timeout costs no
+// system call.
+//
+// Entries are identified by small integers that are only valid while the
+// entry is armed. JavaScript gets the id back from start() and passed to
+// ontimeout(id) when it expires; the id is free for reuse at that point.
+class TimerWheel : public HandleWrap {
+ public:
+  static void Initialize(Handle<Object> target) {
+    HandleScope scope;
+
+    Local<FunctionTemplate> constructor = FunctionTemplate::New(New);
+    constructor->InstanceTemplate()->SetInternalFieldCount(1);
+    constructor->SetClassName(String::NewSymbol("TimerWheel"));
+
+    NODE_SET_PROTOTYPE_METHOD(constructor, "close", HandleWrap::Close);
+
+    NODE_SET_PROTOTYPE_METHOD(constructor, "start", Start);
+    NODE_SET_PROTOTYPE_METHOD(constructor, "again", Again);
+    NODE_SET_PROTOTYPE_METHOD(constructor, "stop", Stop);
+
+    target->Set(String::NewSymbol("TimerWheel"), constructor->GetFunction());
+  }
+
+ private:
+  static const int kBits = 6;
+  static const int kSlots = 1 << kBits;
+  static const int kMask = kSlots - 1;
+  static const int kLevels = 4;
+  static const int kMaxDelta = (1 << (kBits * kLevels)) - 1;
+  static const int kNil = -1;
+
+  struct Entry {
+    int64_t expiry;
+    int prev;
+    int next;
+    int slot;  // level * kSlots + index, or kNil when the entry is free
+  };
+
+  static Handle<Value> New(const Arguments& args) {
+    assert(args.IsConstructCall());
+
+    HandleScope scope;
+    TimerWheel* wheel = new TimerWheel(args.This());
+    assert(wheel);
+
+    return scope.Close(args.This());
+  }
+
+  TimerWheel(Handle<Object> object)
+      : HandleWrap(object, (uv_handle_t*) &handle_) {
+    active_ = false;
+    running_ = false;
+    entries_ = NULL;
+    size_ = 0;
+    count_ = 0;
+    free_ = kNil;
+    due_ = -1;
+
+    for (int i = 0; i < kLevels * kSlots; i++) {
+      heads_[i] = tails_[i] = kNil;
+    }
+    for (int i = 0; i < kLevels; i++) {
+      occupied_[i] = 0;
+    }
+
+    uv_loop_t* loop = Isolate::GetCurrentLoop();
+    int r = uv_timer_init(loop, &handle_);
+    assert(r == 0);
+
+    handle_.data = this;
+    now_ = uv_now(loop);
+
+    // Same as TimerWrap: only hold the loop open while something is armed.
+    uv_unref(loop);
+  }
+
+  ~TimerWheel() {
+    if (!active_) uv_ref(Isolate::GetCurrentLoop());
+    free(entries_);
+  }
+
+  void StateChange() {
+    bool was_active = active_;
+    active_ = count_ > 0 && uv_is_active((uv_handle_t*) &handle_);
+
+    if (!was_active && active_) {
+      uv_ref(Isolate::GetCurrentLoop());
+    } else if (was_active && !active_) {
+      uv_unref(Isolate::GetCurrentLoop());
+    }
+  }
+
+  int Alloc() {
+    if (free_ == kNil) {
+      int size = size_ ? size_ * 2 : 64;
+      Entry* entries = static_cast<Entry*>(
+          realloc(entries_, size * sizeof(Entry)));
+      if (entries == NULL) return kNil;
+
+      for (int i = size_; i < size; i++) {
+        entries[i].slot = kNil;
+        entries[i].next = i + 1 < size ? i + 1 : kNil;
+      }
+      entries_ = entries;
+      free_ = size_;
+      size_ = size;
+    }
+
+    int id = free_;
+    free_ = entries_[id].next;
+    count_++;
+    return id;
+  }
+
+  void Release(int id) {
+    entries_[id].slot = kNil;
+    entries_[id].next = free_;
+    free_ = id;
+    count_--;
+  }
+
+  bool IsArmed(int64_t id) {
+    return id >= 0 && id < size_ && entries_[id].slot != kNil;
+  }
+
+  // Puts the entry on the slot list for its expiry and returns the tick at
+  // which the wheel next needs to look at it: the expiry itself on the
+  // bottom level, the moment its slot cascades on the ones above.
+  int64_t Link(int id) {
+    Entry* e = &entries_[id];
+    int64_t delta = e->expiry - now_;
+    int64_t key = e->expiry;
+
+    if (delta > kMaxDelta) key = now_ + kMaxDelta;
+
+    int level = 0;
+    while (level < kLevels - 1 &&
+           delta >= static_cast<int64_t>(1) << (kBits * (level + 1))) {
+      level++;
+    }
+
+    int shift = kBits * level;
+    int index = static_cast<int>(key >> shift) & kMask;
+    int slot = level * kSlots + index;
+
+    e->slot = slot;
+    e->prev = tails_[slot];
+    e->next = kNil;
+    if (tails_[slot] == kNil) {
+      heads_[slot] = id;
+    } else {
+      entries_[tails_[slot]].next = id;
+    }
+    tails_[slot] = id;
+    occupied_[level] |= static_cast<uint64_t>(1) << index;
+
+    return (key >> shift) << shift;
+  }
+
+  void Unlink(int id) {
+    Entry* e = &entries_[id];
+    int slot = e->slot;
+
+    if (e->prev == kNil) {
+      heads_[slot] = e->next;
+    } else {
+      entries_[e->prev].next = e->next;
+    }
+    if (e->next == kNil) {
+      tails_[slot] = e->prev;
+    } else {
+      entries_[e->next].prev = e->prev;
+    }
+
+    if (heads_[slot] == kNil) {
+      occupied_[slot >> kBits] &= ~(static_cast<uint64_t>(1) << (slot & kMask));
+    }
+  }
+
+  // The next tick at which an entry expires or a slot has to cascade, or -1
+  // when the wheel is empty.
+  int64_t NextEvent() {
+    int64_t next = -1;
+
+    for (int level = 0; level < kLevels; level++) {
+      if (occupied_[level] == 0) continue;
+
+      // A slot on the upper levels cascades when the ticks below it wrap
+      // around; if now_ is on such a boundary that has not been processed
+      // yet, the current slot is still pending.
+      int shift = kBits * level;
+      int64_t base = (now_ + (static_cast<int64_t>(1) << shift) - 1) >> shift;
+      int off = NextOccupied(occupied_[level], static_cast<int>(base) & kMask);
+      int64_t when = (base + off) << shift;
+
+      if (next < 0 || when < next) next = when;
+    }
+
+    return next;
+  }
+
+  // Sets the timer for `when` unless it is already set to go off earlier.
+  void Schedule(int64_t when) {
+    if (running_) return;
+    if (due_ >= 0 && due_ <= when) return;
+
+    int64_t timeout = when - uv_now(Isolate::GetCurrentLoop());
+    if (timeout < 0) timeout = 0;
+
+    uv_timer_stop(&handle_);
+    int r = uv_timer_start(&handle_, OnTimeout, timeout, 0);
+    assert(r == 0);
+    due_ = when;
+
+    StateChange();
+  }
+
+  void Arm(int id, int64_t msecs) {
+    Entry* e = &entries_[id];
+    e->expiry = uv_now(Isolate::GetCurrentLoop()) + (msecs > 0 ? msecs : 0);
+
+    // Entries armed from an ontimeout callback never land on the tick that
+    // is being processed, or a zero timeout would spin forever.
+    int64_t earliest = running_ ? now_ + 1 : now_;
+    if (e->expiry < earliest) e->expiry = earliest;
+
+    Schedule(Link(id));
+  }
+
+  void Cascade(int level) {
+    int index = static_cast<int>(now_ >> (kBits * level)) & kMask;
+    int slot = level * kSlots + index;
+    int id = heads_[slot];
+
+    heads_[slot] = tails_[slot] = kNil;
+    occupied_[level] &= ~(static_cast<uint64_t>(1) << index);
+
+    while (id != kNil) {
+      int next = entries_[id].next;
+      Link(id);
+      id = next;
+    }
+
+    if (index == 0 && level + 1 < kLevels) Cascade(level + 1);
+  }
+
+  void Expire(int index) {
+    // Entries armed from the callbacks are appended and always expire
+    // later, so stop at the first one that is not due.
+    while (heads_[index] != kNil) {
+      HandleScope scope;
+
+      int id = heads_[index];
+      if (entries_[id].expiry > now_) break;
+
+      Unlink(id);
+      Release(id);
+
+      Local<Value> argv[1] = { Integer::New(id) };
+      LoopStatsScope stats_scope(LoopStats::PHASE_TIMERS, "ontimeout");
+      MakeCallback(object_, "ontimeout", 1, argv);
+    }
+  }
+
+  void Run(int64_t target) {
+    running_ = true;
+
+    while (now_ <= target && count_ > 0) {
+      int index = static_cast<int>(now_) & kMask;
+      if (index == 0) Cascade(1);
+      Expire(index);
+      now_++;
+
+      // Skip the ticks that have nothing on them.
+      int64_t next = NextEvent();
+      if (next < 0 || next > target) next = target + 1;
+      if (next > now_) now_ = next;
+    }
+
+    running_ = false;
+  }
+
+  static void OnTimeout(uv_timer_t* handle, int status) {
+    HandleScope scope;
+
+    TimerWheel* wheel = static_cast<TimerWheel*>(handle->data);
+    assert(wheel);
+
+    wheel->due_ = -1;
+    wheel->Run(uv_now(handle->loop));
+
+    if (wheel->count_ > 0) {
+      wheel->Schedule(wheel->NextEvent());
+    } else {
+      wheel->StateChange();
+    }
+  }
+
+  static Handle<Value> Start(const Arguments& args) {
+    HandleScope scope;
+
+    UNWRAP_WHEEL
+
+    // Nothing armed means nothing to catch up on; move the clock forward.
+    // The cached loop time may be arbitrarily old here (think of a program
+    // doing synchronous work on startup), so refresh it once; while the
+    // wheel is busy the loop keeps it current.
+    if (wheel->count_ == 0 && !wheel->running_) {
+      uv_loop_t* loop = Isolate::GetCurrentLoop();
+      uv_update_time(loop);
+      wheel->now_ = uv_now(loop);
+    }
+
+    int id = wheel->Alloc();
+    if (id == kNil) {
+      uv_err_t err;
+      err.code = UV_ENOMEM;
+      SetErrno(err);
+      return scope.Close(Integer::New(-1));
+    }
+
+    wheel->Arm(id, args[0]->IntegerValue());
+
+    return scope.Close(Integer::New(id));
+  }
+
+  static Handle<Value> Again(const Arguments& args) {
+    HandleScope scope;
+
+    UNWRAP_WHEEL
+
+    int64_t id = args[0]->IntegerValue();
+    if (!wheel->IsArmed(id)) {
+      uv_err_t err;
+      err.code = UV_EINVAL;
+      SetErrno(err);
+      return scope.Close(Integer::New(-1));
+    }
+
+    wheel->Unlink(id);
+    wheel->Arm(id, args[1]->IntegerValue());
+
+    return scope.Close(Integer::New(0));
+  }
+
+  static Handle<Value> Stop(const Arguments& args) {
+    HandleScope scope;
+
+    UNWRAP_WHEEL
+
+    int64_t id = args[0]->IntegerValue();
+    if (!wheel->IsArmed(id)) {
+      uv_err_t err;
+      err.code = UV_EINVAL;
+      SetErrno(err);
+      return scope.Close(Integer::New(-1));
+    }
+
+    wheel->Unlink(id);
+    wheel->Release(id);
+
+    if (wheel->count_ == 0 && !wheel->running_) {
+      uv_timer_stop(&wheel->handle_);
+      wheel->due_ = -1;
+      wheel->StateChange();
+    }
+
+    return scope.Close(Integer::New(0));
+  }
+
+  uv_timer_t handle_;
+  bool active_;
+  bool running_;  // inside Run(), the timer is rescheduled afterwards
+
+  Entry* entries_;
+  int size_;
+  int count_;  // armed entries
+  int free_;
+
+  int heads_[kLevels * kSlots];
+  int tails_[kLevels * kSlots];
+  uint64_t occupied_[kLevels];  // one bit per non-empty slot
+
+  int64_t now_;  // the next tick to process
+  int64_t due_;  // tick the timer is set for, or -1
+};
+
+
 class TimerWrap : public HandleWrap {
  public:
   static void Initialize(Handle<Object> target) {
@@ -71,6 +500,8 @@ class TimerWrap : public HandleWrap {
     NODE_SET_PROTOTYPE_METHOD(constructor, "again", Again);
 
     target->Set(String::NewSymbol("Timer"), constructor->GetFunction());
+
+    TimerWheel::Initialize(target);
   }
 
  private:
@@ -201,6 +632,7 @@ class TimerWrap : public HandleWrap {
     wrap->StateChange();
 
     Local<Value> argv[1] = { Integer::New(status) };
+    LoopStatsScope stats_scope(LoopStats::PHASE_TIMERS, "ontimeout");
     MakeCallback(wrap->object_, "ontimeout", 1, argv);
   }
 
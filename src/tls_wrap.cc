@@ -0,0 +1,790 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include <node.h>
+#include <node_buffer.h>
+#include <node_crypto.h>
+#include <stream_wrap.h>
+#include <tls_wrap.h>
+#include <req_wrap.h>
+
+#include <stdlib.h> // malloc, free
+
+
+namespace node {
+
+// Ciphertext is read from the stream in chunks of this size; a full TLS
+// record fits in one.
+#define ENC_BUF_SIZE (16 * 1024 + 512)
+#define CLEAR_BUF_SIZE (16 * 1024)
+
+using v8::Object;
+using v8::Handle;
+using v8::Local;
+using v8::Persistent;
+using v8::Value;
+using v8::HandleScope;
+using v8::FunctionTemplate;
+using v8::String;
+using v8::Function;
+using v8::Arguments;
+using v8::Integer;
+using v8::Array;
+using v8::Exception;
+using v8::ThrowException;
+
+
+#define UNWRAP \
+  assert(!args.Holder().IsEmpty()); \
+  assert(args.Holder()->InternalFieldCount() > 0); \
+  TLSWrap* wrap = ObjectWrap::Unwrap<TLSWrap>(args.Holder()); \
+  if (!wrap->stream_) { \
+    uv_err_t err; \
+    err.code = UV_EBADF; \
+    SetErrno(err); \
+    return scope.Close(v8::Null()); \
+  }
+
+
+typedef class ReqWrap<uv_shutdown_t> ShutdownWrap;
+
+class TLSWrapStatics : public ModuleStatics {
+    v8::Persistent<v8::String> error_symbol;
+    friend class TLSWrap;
+};
+
+// A chunk of cleartext written from JavaScript. The last chunk of a write
+// carries the request object that is completed once it is on the wire.
+class PendingWrite {
+ public:
+  PendingWrite(Handle<Object> buffer, Handle<Object> req) {
+    next = NULL;
+    data = Buffer::Data(buffer);
+    length = Buffer::Length(buffer);
+    buffer_obj = Persistent<Object>::New(buffer);
+    if (!req.IsEmpty()) req_obj = Persistent<Object>::New(req);
+  }
+
+  ~PendingWrite() {
+    if (!buffer_obj.IsEmpty()) buffer_obj.Dispose();
+    if (!req_obj.IsEmpty()) req_obj.Dispose();
+  }
+
+  PendingWrite* next;
+  char* data;
+  size_t length;
+  Persistent<Object> buffer_obj;
+  Persistent<Object> req_obj;
+};
+
+
+// A write of ciphertext to the stream and the requests it completes.
+class FlushWrap : public ReqWrap<uv_write_t> {
+ public:
+  TLSWrap* wrap_;
+  uv_buf_t buf_;
+  PendingWrite* writes_;
+};
+
+
+static void FreeWrites(PendingWrite* w) {
+  while (w) {
+    PendingWrite* next = w->next;
+    delete w;
+    w = next;
+  }
+}
+
+
+void TLSWrap::Initialize(Handle<Object> target) {
+  NODE_STATICS_NEW(node_tls_wrap, TLSWrapStatics, statics);
+
+  HandleScope scope;
+
+  statics->error_symbol = NODE_PSYMBOL("error");
+
+  Local<FunctionTemplate> t = FunctionTemplate::New(New);
+  t->SetClassName(String::NewSymbol("TLSWrap"));
+
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+
+  NODE_SET_PROTOTYPE_METHOD(t, "start", Start);
+  NODE_SET_PROTOTYPE_METHOD(t, "close", Close);
+  NODE_SET_PROTOTYPE_METHOD(t, "readStart", ReadStart);
+  NODE_SET_PROTOTYPE_METHOD(t, "readStop", ReadStop);
+  NODE_SET_PROTOTYPE_METHOD(t, "write", Write);
+  NODE_SET_PROTOTYPE_METHOD(t, "writev", Writev);
+  NODE_SET_PROTOTYPE_METHOD(t, "shutdown", Shutdown);
+
+  NODE_SET_PROTOTYPE_METHOD(t, "getPeerCertificate",
+                            Connection::GetPeerCertificate);
+  NODE_SET_PROTOTYPE_METHOD(t, "getSession", Connection::GetSession);
+  NODE_SET_PROTOTYPE_METHOD(t, "setSession", Connection::SetSession);
+  NODE_SET_PROTOTYPE_METHOD(t, "isSessionReused", Connection::IsSessionReused);
+  NODE_SET_PROTOTYPE_METHOD(t, "isInitFinished", Connection::IsInitFinished);
+  NODE_SET_PROTOTYPE_METHOD(t, "verifyError", Connection::VerifyError);
+  NODE_SET_PROTOTYPE_METHOD(t, "getCurrentCipher",
+                            Connection::GetCurrentCipher);
+  NODE_SET_PROTOTYPE_METHOD(t, "receivedShutdown",
+                            Connection::ReceivedShutdown);
+
+#ifdef OPENSSL_NPN_NEGOTIATED
+  NODE_SET_PROTOTYPE_METHOD(t, "getNegotiatedProtocol",
+                            Connection::GetNegotiatedProto);
+  NODE_SET_PROTOTYPE_METHOD(t, "setNPNProtocols", Connection::SetNPNProtocols);
+#endif
+
+#ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+  NODE_SET_PROTOTYPE_METHOD(t, "getServername", Connection::GetServername);
+  NODE_SET_PROTOTYPE_METHOD(t, "setSNICallback", Connection::SetSNICallback);
+#endif
+
+  target->Set(String::NewSymbol("TLSWrap"), t->GetFunction());
+}
+
+
+TLSWrap::TLSWrap(StreamWrap* stream, Handle<Object> stream_obj)
+    : Connection() {
+  stream_ = stream;
+  stream_obj_ = Persistent<Object>::New(stream_obj);
+  enc_buf_ = NULL;
+  pending_head_ = pending_tail_ = NULL;
+  encrypted_head_ = encrypted_tail_ = NULL;
+  pending_size_ = 0;
+  shutdown_req_ = NULL;
+  established_ = false;
+  reading_ = false;
+  eof_ = false;
+}
+
+
+TLSWrap::~TLSWrap() {
+  assert(stream_ == NULL);
+  free(enc_buf_);
+}
+
+
+// new TLSWrap(handle, context, isServer, servername | requestCert,
+//             rejectUnauthorized)
+//
+// Takes over `handle`, a TCP or Pipe, which must be connected. From then
+// on the handle must not be used directly; closing the TLSWrap closes it.
+Handle<Value> TLSWrap::New(const Arguments& args) {
+  HandleScope scope;
+
+  if (args.Length() < 2 || !args[0]->IsObject() || !args[1]->IsObject()) {
+    return ThrowException(Exception::TypeError(
+          String::New("Takes a stream handle and a SecureContext")));
+  }
+
+  Local<Object> stream_obj = args[0]->ToObject();
+  if (stream_obj->InternalFieldCount() < 1) {
+    return ThrowException(Exception::TypeError(
+          String::New("First argument must be a stream handle")));
+  }
+
+  StreamWrap* stream =
+      static_cast<StreamWrap*>(stream_obj->GetPointerFromInternalField(0));
+  if (stream == NULL) {
+    return ThrowException(Exception::Error(
+          String::New("Stream handle is closed")));
+  }
+
+  TLSWrap* wrap = new TLSWrap(stream, stream_obj);
+  wrap->Wrap(args.Holder());
+  // Stay alive for as long as the stream is ours.
+  wrap->Ref();
+
+  wrap->InitSSL(args, 1);
+
+  stream->StopReading();
+  stream->SetConsumer(wrap);
+  wrap->UpdateWriteQueueSize();
+
+  return args.This();
+}
+
+
+// Starts the handshake. Clients have to call this, servers wait for the
+// client to say hello.
+Handle<Value> TLSWrap::Start(const Arguments& args) {
+  HandleScope scope;
+
+  UNWRAP
+
+  int rv = SSL_do_handshake(wrap->ssl_);
+  if (wrap->HandleSSLError("SSL_do_handshake", rv) < 0) {
+    // The error is on the object; it is reported from JavaScript.
+    return scope.Close(Integer::New(rv));
+  }
+
+  if (!wrap->Flush()) {
+    return scope.Close(Integer::New(-1));
+  }
+
+  return scope.Close(Integer::New(0));
+}
+
+
+Handle<Value> TLSWrap::ReadStart(const Arguments& args) {
+  HandleScope scope;
+
+  UNWRAP
+
+  wrap->reading_ = true;
+  int r = wrap->stream_->StartReading();
+  if (r) {
+    SetLastErrno();
+    return scope.Close(Integer::New(r));
+  }
+
+  // Hand out what was deciphered while reading was stopped.
+  if (wrap->established_ && wrap->ClearOut() == false) {
+    wrap->EmitError();
+  }
+
+  return scope.Close(Integer::New(0));
+}
+
+
+Handle<Value> TLSWrap::ReadStop(const Arguments& args) {
+  HandleScope scope;
+
+  UNWRAP
+
+  wrap->reading_ = false;
+  int r = wrap->stream_->StopReading();
+  if (r) SetLastErrno();
+
+  return scope.Close(Integer::New(r));
+}
+
+
+void TLSWrap::Queue(PendingWrite* w) {
+  if (pending_tail_) {
+    pending_tail_->next = w;
+  } else {
+    pending_head_ = w;
+  }
+  pending_tail_ = w;
+  pending_size_ += w->length;
+}
+
+
+Handle<Value> TLSWrap::Write(const Arguments& args) {
+  HandleScope scope;
+
+  UNWRAP
+
+  if (!Buffer::HasInstance(args[0])) {
+    return ThrowException(Exception::TypeError(
+          String::New("First argument must be a buffer")));
+  }
+
+  Local<Object> req = Object::New();
+  wrap->Queue(new PendingWrite(args[0]->ToObject(), req));
+
+  // Errors are not reported through callbacks from in here, JavaScript
+  // is in the middle of a write and not ready for them. The error is left
+  // on the object for the socket to pick up when it is destroyed.
+  if (wrap->established_ && wrap->EncryptPending() == false) {
+    uv_err_t err;
+    err.code = UV_EPROTO;
+    SetErrno(err);
+    return scope.Close(v8::Null());
+  }
+
+  if (!wrap->Flush()) {
+    return scope.Close(v8::Null());
+  }
+
+  wrap->UpdateWriteQueueSize();
+
+  return scope.Close(req);
+}
+
+
+Handle<Value> TLSWrap::Writev(const Arguments& args) {
+  HandleScope scope;
+
+  UNWRAP
+
+  if (!args[0]->IsArray()) {
+    return ThrowException(Exception::TypeError(
+          String::New("First argument must be an array of buffers")));
+  }
+
+  Local<Array> chunks = Local<Array>::Cast(args[0]);
+  uint32_t count = chunks->Length();
+  if (count == 0) {
+    return ThrowException(Exception::TypeError(
+          String::New("Nothing to write")));
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    if (!Buffer::HasInstance(chunks->Get(i))) {
+      return ThrowException(Exception::TypeError(
+            String::New("Array must only contain buffers")));
+    }
+  }
+
+  Local<Object> req = Object::New();
+  for (uint32_t i = 0; i < count; i++) {
+    Local<Object> buffer = chunks->Get(i)->ToObject();
+    wrap->Queue(new PendingWrite(buffer,
+                                 i + 1 == count ? req : Local<Object>()));
+  }
+
+  if (wrap->established_ && wrap->EncryptPending() == false) {
+    uv_err_t err;
+    err.code = UV_EPROTO;
+    SetErrno(err);
+    return scope.Close(v8::Null());
+  }
+
+  if (!wrap->Flush()) {
+    return scope.Close(v8::Null());
+  }
+
+  wrap->UpdateWriteQueueSize();
+
+  return scope.Close(req);
+}
+
+
+// Sends close_notify and shuts down the stream's write side, once what was
+// written before has been encrypted.
+Handle<Value> TLSWrap::Shutdown(const Arguments& args) {
+  HandleScope scope;
+
+  UNWRAP
+
+  if (wrap->shutdown_req_) {
+    uv_err_t err;
+    err.code = UV_EINVAL;
+    SetErrno(err);
+    return scope.Close(v8::Null());
+  }
+
+  ShutdownWrap* req_wrap = new ShutdownWrap();
+  req_wrap->data_ = wrap;
+  wrap->shutdown_req_ = req_wrap;
+
+  // DoShutdown() frees the request when it fails.
+  if (wrap->established_ && wrap->pending_head_ == NULL) {
+    if (!wrap->DoShutdown()) {
+      return scope.Close(v8::Null());
+    }
+  }
+
+  return scope.Close(req_wrap->object_);
+}
+
+
+Handle<Value> TLSWrap::Close(const Arguments& args) {
+  HandleScope scope;
+
+  TLSWrap* wrap = ObjectWrap::Unwrap<TLSWrap>(args.Holder());
+  if (wrap->stream_ == NULL) return v8::Null();
+
+  wrap->stream_->SetConsumer(NULL);
+  wrap->stream_ = NULL;
+
+  Local<Object> stream_obj = Local<Object>::New(wrap->stream_obj_);
+  wrap->stream_obj_.Dispose();
+  wrap->stream_obj_.Clear();
+
+  FreeWrites(wrap->pending_head_);
+  FreeWrites(wrap->encrypted_head_);
+  wrap->pending_head_ = wrap->pending_tail_ = NULL;
+  wrap->encrypted_head_ = wrap->encrypted_tail_ = NULL;
+  wrap->pending_size_ = 0;
+
+  if (wrap->shutdown_req_) {
+    wrap->shutdown_req_->Dispatched();
+    delete wrap->shutdown_req_;
+    wrap->shutdown_req_ = NULL;
+  }
+
+  // Closes the stream, which fails whatever is still on its write queue.
+  Local<Value> close = stream_obj->Get(String::NewSymbol("close"));
+  if (close->IsFunction()) {
+    Local<Function>::Cast(close)->Call(stream_obj, 0, NULL);
+  }
+
+  wrap->Unref();
+
+  return v8::Null();
+}
+
+
+uv_buf_t TLSWrap::OnAlloc(size_t suggested_size) {
+  // The ciphertext goes into bio_read_ right away, so one buffer will do.
+  if (enc_buf_ == NULL) {
+    enc_buf_ = static_cast<char*>(malloc(ENC_BUF_SIZE));
+    if (enc_buf_ == NULL) return uv_buf_init(NULL, 0);
+  }
+  return uv_buf_init(enc_buf_, ENC_BUF_SIZE);
+}
+
+
+void TLSWrap::OnRead(ssize_t nread, uv_buf_t buf) {
+  HandleScope scope;
+
+  if (nread < 0) {
+    uv_err_t err = uv_last_error(Isolate::GetCurrentLoop());
+    if (err.code == UV_EOF) {
+      // close_notify has been reported already.
+      if (!eof_) EmitEOF();
+    } else {
+      SetErrno(err);
+      MakeCallback(handle_, "onread", 0, NULL);
+    }
+    return;
+  }
+
+  if (nread == 0) return;
+
+  int written = BIO_write(bio_read_, buf.base, nread);
+  assert(written == nread);
+
+  Cycle();
+}
+
+
+// Moves everything along after ciphertext came in: the handshake, writes
+// that were waiting for it, cleartext for JavaScript and whatever OpenSSL
+// has to send in response.
+void TLSWrap::Cycle() {
+  HandleScope scope;
+
+  if (!established_) {
+    int rv = SSL_do_handshake(ssl_);
+    if (HandleSSLError("SSL_do_handshake", rv) < 0) {
+      // Let the peer know, if there's an alert.
+      Flush();
+      EmitError();
+      return;
+    }
+
+    if (!SSL_is_init_finished(ssl_)) {
+      if (!Flush()) EmitError();
+      return;
+    }
+
+    established_ = true;
+    MakeCallback(handle_, "onhandshakedone", 0, NULL);
+    if (stream_ == NULL) return;  // closed by the callback
+  }
+
+  if (!EncryptPending()) {
+    Flush();
+    EmitError();
+    return;
+  }
+
+  if (reading_ && !ClearOut()) {
+    Flush();
+    EmitError();
+    return;
+  }
+
+  if (stream_ == NULL) return;
+
+  if (!Flush()) {
+    EmitError();
+    return;
+  }
+
+  if (shutdown_req_ && pending_head_ == NULL && !DoShutdown()) {
+    EmitError();
+    return;
+  }
+
+  UpdateWriteQueueSize();
+}
+
+
+// Encrypts what was written so far, unless OpenSSL needs to hear from the
+// peer first. Returns false on errors, which are left in `error`.
+bool TLSWrap::EncryptPending() {
+  while (pending_head_) {
+    PendingWrite* w = pending_head_;
+
+    if (w->length > 0) {
+      int rv = SSL_write(ssl_, w->data, w->length);
+      if (rv <= 0) {
+        // Renegotiating; this is retried with the same arguments later.
+        return HandleSSLError("SSL_write", rv) >= 0;
+      }
+      assert(static_cast<size_t>(rv) == w->length);
+    }
+
+    pending_head_ = w->next;
+    if (pending_head_ == NULL) pending_tail_ = NULL;
+    pending_size_ -= w->length;
+
+    if (w->req_obj.IsEmpty()) {
+      delete w;
+      continue;
+    }
+
+    // Only the request has to stay around until the data is on the wire.
+    w->buffer_obj.Dispose();
+    w->buffer_obj.Clear();
+    w->next = NULL;
+    if (encrypted_tail_) {
+      encrypted_tail_->next = w;
+    } else {
+      encrypted_head_ = w;
+    }
+    encrypted_tail_ = w;
+  }
+
+  return true;
+}
+
+
+// Passes deciphered data on to JavaScript until there is none left or
+// JavaScript stops reading. Returns false on errors.
+bool TLSWrap::ClearOut() {
+  char data[CLEAR_BUF_SIZE];
+
+  while (reading_ && stream_ && !eof_) {
+    int n = SSL_read(ssl_, data, sizeof(data));
+
+    if (n > 0) {
+      HandleScope scope;
+      Buffer* b = Buffer::New(data, n);
+      Local<Value> argv[3] = {
+        Local<Object>::New(b->handle_),
+        Integer::New(0),
+        Integer::New(n)
+      };
+      MakeCallback(handle_, "onread", 3, argv);
+      continue;
+    }
+
+    if (SSL_get_error(ssl_, n) == SSL_ERROR_ZERO_RETURN) {
+      // The peer sent close_notify.
+      SetShutdownFlags();
+      EmitEOF();
+      return true;
+    }
+
+    return HandleSSLError("SSL_read", n) >= 0;
+  }
+
+  return true;
+}
+
+
+// Puts what is in bio_write_ on the stream's write queue, as one write.
+// Returns false with errno set if the stream would not take it.
+bool TLSWrap::Flush() {
+  if (stream_ == NULL) return true;
+
+  size_t size = BIO_pending(bio_write_);
+  if (size == 0 && encrypted_head_ == NULL) return true;
+
+  FlushWrap* req_wrap = new FlushWrap();
+  req_wrap->wrap_ = this;
+  req_wrap->buf_ = uv_buf_init(NULL, 0);
+  req_wrap->writes_ = encrypted_head_;
+  encrypted_head_ = encrypted_tail_ = NULL;
+
+  if (size > 0) {
+    req_wrap->buf_.base = static_cast<char*>(malloc(size));
+    if (req_wrap->buf_.base == NULL) {
+      FreeWrites(req_wrap->writes_);
+      req_wrap->Dispatched();
+      delete req_wrap;
+      uv_err_t err;
+      err.code = UV_ENOMEM;
+      SetErrno(err);
+      return false;
+    }
+    int n = BIO_read(bio_write_, req_wrap->buf_.base, size);
+    assert(static_cast<size_t>(n) == size);
+    req_wrap->buf_.len = size;
+  }
+
+  int r = uv_write(&req_wrap->req_,
+                   stream_->GetStream(),
+                   &req_wrap->buf_,
+                   1,
+                   AfterFlush);
+
+  req_wrap->Dispatched();
+
+  if (r) {
+    SetLastErrno();
+    free(req_wrap->buf_.base);
+    FreeWrites(req_wrap->writes_);
+    delete req_wrap;
+    return false;
+  }
+
+  Ref();
+  return true;
+}
+
+
+void TLSWrap::AfterFlush(uv_write_t* req, int status) {
+  FlushWrap* req_wrap = static_cast<FlushWrap*>(req->data);
+  TLSWrap* wrap = req_wrap->wrap_;
+
+  HandleScope scope;
+
+  free(req_wrap->buf_.base);
+
+  if (status) {
+    SetLastErrno();
+  }
+
+  wrap->UpdateWriteQueueSize();
+
+  PendingWrite* w = req_wrap->writes_;
+  while (w) {
+    Local<Value> argv[3] = {
+      Integer::New(status),
+      Local<Value>::New(wrap->handle_),
+      Local<Value>::New(w->req_obj)
+    };
+    MakeCallback(w->req_obj, "oncomplete", 3, argv);
+
+    PendingWrite* next = w->next;
+    delete w;
+    w = next;
+  }
+
+  delete req_wrap;
+  wrap->Unref();
+}
+
+
+bool TLSWrap::DoShutdown() {
+  ShutdownWrap* req_wrap = shutdown_req_;
+  shutdown_req_ = NULL;
+
+  int rv = SSL_shutdown(ssl_);
+  if (HandleSSLError("SSL_shutdown", rv) < 0) {
+    // The error is on the object; the stream is destroyed with it.
+    req_wrap->Dispatched();
+    delete req_wrap;
+    uv_err_t err;
+    err.code = UV_EPROTO;
+    SetErrno(err);
+    return false;
+  }
+  SetShutdownFlags();
+
+  if (!Flush()) {
+    req_wrap->Dispatched();
+    delete req_wrap;
+    return false;
+  }
+
+  int r = uv_shutdown(&req_wrap->req_, stream_->GetStream(), AfterShutdown);
+
+  req_wrap->Dispatched();
+
+  if (r) {
+    SetLastErrno();
+    delete req_wrap;
+    return false;
+  }
+
+  Ref();
+  return true;
+}
+
+
+void TLSWrap::AfterShutdown(uv_shutdown_t* req, int status) {
+  ShutdownWrap* req_wrap = static_cast<ShutdownWrap*>(req->data);
+  TLSWrap* wrap = static_cast<TLSWrap*>(req_wrap->data_);
+
+  HandleScope scope;
+
+  if (status) {
+    SetLastErrno();
+  }
+
+  Local<Value> argv[3] = {
+    Integer::New(status),
+    Local<Value>::New(wrap->handle_),
+    Local<Value>::New(req_wrap->object_)
+  };
+
+  MakeCallback(req_wrap->object_, "oncomplete", 3, argv);
+
+  delete req_wrap;
+  wrap->Unref();
+}
+
+
+void TLSWrap::EmitEOF() {
+  HandleScope scope;
+
+  eof_ = true;
+
+  uv_err_t err;
+  err.code = UV_EOF;
+  SetErrno(err);
+  MakeCallback(handle_, "onread", 0, NULL);
+}
+
+
+// Reports the error that HandleSSLError left on the object or, if there is
+// none, the last libuv error.
+void TLSWrap::EmitError() {
+  HandleScope scope;
+
+  if (stream_ == NULL) return;
+
+  TLSWrapStatics* statics = NODE_STATICS_GET(node_tls_wrap, TLSWrapStatics);
+  Local<Value> e = handle_->Get(statics->error_symbol);
+  handle_->Set(statics->error_symbol, v8::Null());
+
+  if (e->BooleanValue()) {
+    Local<Value> argv[1] = { e };
+    MakeCallback(handle_, "onerror", 1, argv);
+  } else {
+    SetLastErrno();
+    MakeCallback(handle_, "onerror", 0, NULL);
+  }
+}
+
+
+void TLSWrap::UpdateWriteQueueSize() {
+  HandleScope scope;
+
+  size_t size = pending_size_;
+  if (stream_) size += stream_->GetStream()->write_queue_size;
+
+  handle_->Set(String::NewSymbol("writeQueueSize"), Integer::New(size));
+}
+
+
+}  // namespace node
+
+NODE_MODULE(node_tls_wrap, node::TLSWrap::Initialize)
@@ -0,0 +1,98 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef TLS_WRAP_H_
+#define TLS_WRAP_H_
+
+#include <v8.h>
+#include <node.h>
+#include <node_crypto.h>
+#include <stream_wrap.h>
+#include <req_wrap.h>
+
+namespace node {
+
+class PendingWrite;
+
+// A TLS connection on top of a TCP or pipe handle. What is read from the
+// stream goes into the SSL object as it arrives and only cleartext is
+// passed up to JavaScript; what JavaScript writes is encrypted and put on
+// the stream's write queue. To net.Socket it is just another stream handle.
+class TLSWrap : public crypto::Connection, public StreamConsumer {
+ public:
+  static void Initialize(v8::Handle<v8::Object> target);
+
+  uv_buf_t OnAlloc(size_t suggested_size);
+  void OnRead(ssize_t nread, uv_buf_t buf);
+
+ protected:
+  // JavaScript functions
+  static v8::Handle<v8::Value> New(const v8::Arguments& args);
+  static v8::Handle<v8::Value> Start(const v8::Arguments& args);
+  static v8::Handle<v8::Value> ReadStart(const v8::Arguments& args);
+  static v8::Handle<v8::Value> ReadStop(const v8::Arguments& args);
+  static v8::Handle<v8::Value> Write(const v8::Arguments& args);
+  static v8::Handle<v8::Value> Writev(const v8::Arguments& args);
+  static v8::Handle<v8::Value> Shutdown(const v8::Arguments& args);
+  static v8::Handle<v8::Value> Close(const v8::Arguments& args);
+
+  TLSWrap(StreamWrap* stream, v8::Handle<v8::Object> stream_obj);
+  ~TLSWrap();
+
+ private:
+  // Callbacks for libuv
+  static void AfterFlush(uv_write_t* req, int status);
+  static void AfterShutdown(uv_shutdown_t* req, int status);
+
+  void Queue(PendingWrite* w);
+  void Cycle();
+  bool EncryptPending();
+  bool ClearOut();
+  bool Flush();
+  bool DoShutdown();
+  void EmitEOF();
+  void EmitError();
+  void UpdateWriteQueueSize();
+
+  StreamWrap* stream_;  // NULL once closed
+  v8::Persistent<v8::Object> stream_obj_;
+  char* enc_buf_;
+
+  // Cleartext that could not be encrypted yet, and writes whose data is
+  // in bio_write_ but not on the stream's write queue yet.
+  PendingWrite* pending_head_;
+  PendingWrite* pending_tail_;
+  PendingWrite* encrypted_head_;
+  PendingWrite* encrypted_tail_;
+  size_t pending_size_;
+
+  ReqWrap<uv_shutdown_t>* shutdown_req_;  // waiting for pending writes
+  bool established_;
+  bool reading_;
+  bool eof_;
+};
+
+
+}  // namespace node
+
+
+#endif  // TLS_WRAP_H_
@@ -73,6 +73,11 @@ class TTYWrap : StreamWrap {
     NODE_SET_PROTOTYPE_METHOD(t, "readStart", StreamWrap::ReadStart);
     NODE_SET_PROTOTYPE_METHOD(t, "readStop", StreamWrap::ReadStop);
     NODE_SET_PROTOTYPE_METHOD(t, "write", StreamWrap::Write);
+    NODE_SET_PROTOTYPE_METHOD(t, "writev", StreamWrap::Writev);
+    NODE_SET_PROTOTYPE_METHOD(t, "writeAsciiString",
+                              StreamWrap::WriteAsciiString);
+    NODE_SET_PROTOTYPE_METHOD(t, "writeUtf8String",
+                              StreamWrap::WriteUtf8String);
 
     NODE_SET_PROTOTYPE_METHOD(t, "getWindowSize", TTYWrap::GetWindowSize);
     NODE_SET_PROTOTYPE_METHOD(t, "setRawMode", SetRawMode);
@@ -26,6 +26,7 @@
 #include <handle_wrap.h>
 
 #include <stdlib.h>
+#include <string.h>
 
 // Temporary hack: libuv should provide uv_inet_pton and uv_inet_ntop.
 // Clean this up in tcp_wrap.cc too.
@@ -78,7 +79,10 @@ public:
   static Handle<Value> Send(const Arguments& args);
   static Handle<Value> Bind6(const Arguments& args);
   static Handle<Value> Send6(const Arguments& args);
+  static Handle<Value> SendBatch(const Arguments& args);
+  static Handle<Value> SendBatch6(const Arguments& args);
   static Handle<Value> RecvStart(const Arguments& args);
+  static Handle<Value> RecvBatchStart(const Arguments& args);
   static Handle<Value> RecvStop(const Arguments& args);
   static Handle<Value> GetSockName(const Arguments& args);
 
@@ -88,6 +92,7 @@ private:
 
   static Handle<Value> DoBind(const Arguments& args, int family);
   static Handle<Value> DoSend(const Arguments& args, int family);
+  static Handle<Value> DoSendBatch(const Arguments& args, int family);
 
   static uv_buf_t OnAlloc(uv_handle_t* handle, size_t suggested_size);
   static void OnSend(uv_udp_send_t* req, int status);
@@ -96,20 +101,45 @@ private:
                      uv_buf_t buf,
                      struct sockaddr* addr,
                      unsigned flags);
+  static void OnRecvBatch(uv_udp_t* handle, int nmsgs, uv_udp_msg_t* msgs);
 
   uv_udp_t handle_;
+
+  // Datagrams are received into memory owned by the wrap and copied out
+  // into a Buffer of the right size, so the receive buffers are allocated
+  // once rather than 64 kB per datagram.
+  char* recv_buf_;
+  // Batch mode: `nmsgs_` slots of `msg_size_` bytes each in `slab_`.
+  char* slab_;
+  uv_udp_msg_t* msgs_;
+  int nmsgs_;
+  size_t msg_size_;
 };
 
 
+static const size_t kRecvBufferSize = 64 * 1024;
+// Linux caps recvmmsg() and sendmmsg() at this many datagrams per call.
+static const int kMaxBatch = 1024;
+
+
 UDPWrap::UDPWrap(Handle<Object> object): HandleWrap(object,
                                                     (uv_handle_t*)&handle_) {
   int r = uv_udp_init(Isolate::GetCurrentLoop(), &handle_);
   assert(r == 0); // can't fail anyway
   handle_.data = reinterpret_cast<void*>(this);
+
+  recv_buf_ = NULL;
+  slab_ = NULL;
+  msgs_ = NULL;
+  nmsgs_ = 0;
+  msg_size_ = 0;
 }
 
 
 UDPWrap::~UDPWrap() {
+  delete[] recv_buf_;
+  delete[] slab_;
+  delete[] msgs_;
 }
 
 
@@ -131,7 +161,10 @@ void UDPWrap::Initialize(Handle<Object> target) {
   NODE_SET_PROTOTYPE_METHOD(t, "bind6", Bind6);
   NODE_SET_PROTOTYPE_METHOD(t, "send6", Send6);
   NODE_SET_PROTOTYPE_METHOD(t, "close", Close);
+  NODE_SET_PROTOTYPE_METHOD(t, "sendBatch", SendBatch);
+  NODE_SET_PROTOTYPE_METHOD(t, "sendBatch6", SendBatch6);
   NODE_SET_PROTOTYPE_METHOD(t, "recvStart", RecvStart);
+  NODE_SET_PROTOTYPE_METHOD(t, "recvBatchStart", RecvBatchStart);
   NODE_SET_PROTOTYPE_METHOD(t, "recvStop", RecvStop);
   NODE_SET_PROTOTYPE_METHOD(t, "getsockname", GetSockName);
 
@@ -253,6 +286,77 @@ Handle<Value> UDPWrap::Send6(const Arguments& args) {
 }
 
 
+Handle<Value> UDPWrap::DoSendBatch(const Arguments& args, int family) {
+  HandleScope scope;
+  int r;
+
+  // sendBatch(buffers, port, address)
+  assert(args.Length() == 3);
+
+  UNWRAP
+
+  assert(args[0]->IsArray());
+  Local<Array> buffers = Local<Array>::Cast(args[0]);
+
+  int count = buffers->Length();
+  assert(count > 0 && count <= kMaxBatch);
+
+  // libuv copies the array, the memory only has to last for the call.
+  uv_buf_t bufsml[16];
+  uv_buf_t* bufs = count <= 16 ? bufsml : new uv_buf_t[count];
+
+  for (int i = 0; i < count; i++) {
+    Local<Value> buffer = buffers->Get(i);
+    assert(Buffer::HasInstance(buffer));
+    bufs[i] = uv_buf_init(Buffer::Data(buffer->ToObject()),
+                          Buffer::Length(buffer->ToObject()));
+  }
+
+  SendWrap* req_wrap = new SendWrap();
+  req_wrap->object_->SetHiddenValue(buffer_sym, buffers);
+
+  const unsigned short port = args[1]->Uint32Value();
+  String::Utf8Value address(args[2]->ToString());
+
+  switch (family) {
+  case AF_INET:
+    r = uv_udp_send_batch(&req_wrap->req_, &wrap->handle_, bufs, count,
+                          uv_ip4_addr(*address, port), OnSend);
+    break;
+  case AF_INET6:
+    r = uv_udp_send_batch6(&req_wrap->req_, &wrap->handle_, bufs, count,
+                           uv_ip6_addr(*address, port), OnSend);
+    break;
+  default:
+    assert(0 && "unexpected address family");
+    abort();
+  }
+
+  if (bufs != bufsml) delete[] bufs;
+
+  req_wrap->Dispatched();
+
+  if (r) {
+    SetLastErrno();
+    delete req_wrap;
+    return Null();
+  }
+  else {
+    return scope.Close(req_wrap->object_);
+  }
+}
+
+
+Handle<Value> UDPWrap::SendBatch(const Arguments& args) {
+  return DoSendBatch(args, AF_INET);
+}
+
+
+Handle<Value> UDPWrap::SendBatch6(const Arguments& args) {
+  return DoSendBatch(args, AF_INET6);
+}
+
+
 Handle<Value> UDPWrap::RecvStart(const Arguments& args) {
   HandleScope scope;
 
@@ -269,6 +373,45 @@ Handle<Value> UDPWrap::RecvStart(const Arguments& args) {
 }
 
 
+// recvBatchStart(count, size)
+Handle<Value> UDPWrap::RecvBatchStart(const Arguments& args) {
+  HandleScope scope;
+
+  UNWRAP
+
+  int count = args[0]->Int32Value();
+  size_t size = args[1]->Uint32Value();
+  assert(count > 0 && count <= kMaxBatch);
+  assert(size > 0 && size <= kRecvBufferSize);
+
+  // The slots are reused from batch to batch and across restarts.
+  if (count != wrap->nmsgs_ || size != wrap->msg_size_) {
+    delete[] wrap->slab_;
+    delete[] wrap->msgs_;
+    wrap->slab_ = new char[count * size];
+    wrap->msgs_ = new uv_udp_msg_t[count];
+    wrap->nmsgs_ = count;
+    wrap->msg_size_ = size;
+
+    for (int i = 0; i < count; i++) {
+      wrap->msgs_[i].buf = uv_buf_init(wrap->slab_ + i * size, size);
+    }
+  }
+
+  // UV_EALREADY means that the socket is already bound but that's okay
+  int r = uv_udp_recv_batch_start(&wrap->handle_,
+                                  wrap->msgs_,
+                                  wrap->nmsgs_,
+                                  OnRecvBatch);
+  if (r && uv_last_error(Isolate::GetCurrentLoop()).code != UV_EALREADY) {
+    SetLastErrno();
+    return False();
+  }
+
+  return True();
+}
+
+
 Handle<Value> UDPWrap::RecvStop(const Arguments& args) {
   HandleScope scope;
 
@@ -332,13 +475,15 @@ void UDPWrap::OnSend(uv_udp_send_t* req, int status) {
 
 
 uv_buf_t UDPWrap::OnAlloc(uv_handle_t* handle, size_t suggested_size) {
-  // FIXME switch to slab allocation, share with stream_wrap.cc
-  return uv_buf_init(new char[suggested_size], suggested_size);
-}
+  UDPWrap* wrap = reinterpret_cast<UDPWrap*>(handle->data);
 
+  if (wrap->recv_buf_ == NULL) {
+    wrap->recv_buf_ = new char[kRecvBufferSize];
+  }
 
-static void ReleaseMemory(char* data, void* arg) {
-  delete[] data; // data == buf.base
+  return uv_buf_init(wrap->recv_buf_,
+                     suggested_size < kRecvBufferSize ? suggested_size
+                                                      : kRecvBufferSize);
 }
 
 
@@ -348,7 +493,6 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
                      struct sockaddr* addr,
                      unsigned flags) {
   if (nread == 0) {
-    ReleaseMemory(buf.base, NULL);
     return;
   }
 
@@ -369,7 +513,8 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
   else {
     Local<Object> rinfo = Object::New();
     AddressToJS(rinfo, addr, sizeof *addr);
-    argv[2] = Buffer::New(buf.base, nread, ReleaseMemory, NULL)->handle_;
+    // handle_ is weak, keep the buffer alive until onmessage has it.
+    argv[2] = Local<Object>::New(Buffer::New(buf.base, nread)->handle_);
     argv[3] = rinfo;
   }
 
@@ -377,6 +522,112 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
 }
 
 
+static bool SameAddress(const sockaddr_storage* a, const sockaddr_storage* b) {
+  if (a->ss_family != b->ss_family) return false;
+
+  switch (a->ss_family) {
+  case AF_INET:
+    return memcmp(&reinterpret_cast<const sockaddr_in*>(a)->sin_addr,
+                  &reinterpret_cast<const sockaddr_in*>(b)->sin_addr,
+                  sizeof(in_addr)) == 0;
+  case AF_INET6:
+    return memcmp(&reinterpret_cast<const sockaddr_in6*>(a)->sin6_addr,
+                  &reinterpret_cast<const sockaddr_in6*>(b)->sin6_addr,
+                  sizeof(in6_addr)) == 0;
+  default:
+    return false;
+  }
+}
+
+
+static Local<String> AddressString(const sockaddr_storage* addr) {
+  char ip[INET6_ADDRSTRLEN];
+
+  switch (addr->ss_family) {
+  case AF_INET:
+    uv_inet_ntop(AF_INET, &reinterpret_cast<const sockaddr_in*>(addr)->sin_addr,
+                 ip, sizeof ip);
+    return String::New(ip);
+  case AF_INET6:
+    uv_inet_ntop(AF_INET6,
+                 &reinterpret_cast<const sockaddr_in6*>(addr)->sin6_addr,
+                 ip, sizeof ip);
+    return String::New(ip);
+  default:
+    return String::Empty();
+  }
+}
+
+
+static int AddressPort(const sockaddr_storage* addr) {
+  switch (addr->ss_family) {
+  case AF_INET:
+    return ntohs(reinterpret_cast<const sockaddr_in*>(addr)->sin_port);
+  case AF_INET6:
+    return ntohs(reinterpret_cast<const sockaddr_in6*>(addr)->sin6_port);
+  default:
+    return 0;
+  }
+}
+
+
+// Delivers a batch as onmessages(handle, nmsgs, buffer, info) where the
+// datagrams are packed back to back in `buffer` and `info` holds four
+// entries per datagram: offset, length, address and port.
+void UDPWrap::OnRecvBatch(uv_udp_t* handle, int nmsgs, uv_udp_msg_t* msgs) {
+  HandleScope scope;
+
+  UDPWrap* wrap = reinterpret_cast<UDPWrap*>(handle->data);
+
+  Handle<Value> argv[4] = {
+    wrap->object_,
+    Integer::New(nmsgs),
+    Null(),
+    Null()
+  };
+
+  if (nmsgs == -1) {
+    SetLastErrno();
+    MakeCallback(wrap->object_, "onmessages", ARRAY_SIZE(argv), argv);
+    return;
+  }
+
+  size_t total = 0;
+  for (int i = 0; i < nmsgs; i++) {
+    total += msgs[i].nread;
+  }
+
+  Local<Object> buffer = Local<Object>::New(Buffer::New(total)->handle_);
+  char* data = Buffer::Data(buffer);
+  Local<Array> info = Array::New(nmsgs * 4);
+  Local<String> address;
+
+  size_t offset = 0;
+  for (int i = 0; i < nmsgs; i++) {
+    uv_udp_msg_t* msg = &msgs[i];
+    memcpy(data + offset, msg->buf.base, msg->nread);
+
+    // Batches tend to come from a handful of peers; only format the
+    // address when it differs from the previous datagram's.
+    if (i == 0 || !SameAddress(&msgs[i - 1].addr, &msg->addr)) {
+      address = AddressString(&msg->addr);
+    }
+
+    info->Set(i * 4 + 0, Integer::NewFromUnsigned(offset));
+    info->Set(i * 4 + 1, Integer::NewFromUnsigned(msg->nread));
+    info->Set(i * 4 + 2, address);
+    info->Set(i * 4 + 3, Integer::New(AddressPort(&msg->addr)));
+
+    offset += msg->nread;
+  }
+
+  argv[2] = buffer;
+  argv[3] = info;
+
+  MakeCallback(wrap->object_, "onmessages", ARRAY_SIZE(argv), argv);
+}
+
+
 void AddressToJS(Handle<Object> info,
                  const sockaddr* addr,
                  int addrlen) {
@@ -0,0 +1,116 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Checks the native base64, hex and UTF-8 codecs against simple JavaScript
+// implementations, at lengths around the block sizes of the vector kernels.
+
+var common = require('../common');
+var assert = require('assert');
+
+var alphabet = 'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/';
+
+function base64(b) {
+  var out = '';
+  for (var i = 0; i < b.length; i += 3) {
+    var x = b[i];
+    var y = i + 1 < b.length ? b[i + 1] : 0;
+    var z = i + 2 < b.length ? b[i + 2] : 0;
+    out += alphabet[x >> 2] + alphabet[((x & 3) << 4) | (y >> 4)];
+    out += i + 1 < b.length ? alphabet[((y & 15) << 2) | (z >> 6)] : '=';
+    out += i + 2 < b.length ? alphabet[z & 63] : '=';
+  }
+  return out;
+}
+
+function hex(b) {
+  var out = '';
+  for (var i = 0; i < b.length; i++) {
+    out += (b[i] < 16 ? '0' : '') + b[i].toString(16);
+  }
+  return out;
+}
+
+for (var n = 0; n < 100; n++) {
+  var b = new Buffer(n);
+  for (var i = 0; i < n; i++) b[i] = (i * 131 + n * 7) & 0xff;
+
+  var b64 = b.toString('base64');
+  assert.equal(b64, base64(b));
+  assert.equal(hex(new Buffer(b64, 'base64')), hex(b));
+
+  // line breaks and stray characters are skipped by the decoder
+  var wrapped = b64.replace(/(.{13})/g, '$1\r\n');
+  assert.equal(hex(new Buffer(wrapped, 'base64')), hex(b));
+  wrapped = b64.replace(/(.{5})/g, '$1*');
+  assert.equal(hex(new Buffer(wrapped, 'base64')), hex(b));
+
+  var h = b.toString('hex');
+  assert.equal(h, hex(b));
+  assert.equal(hex(new Buffer(h, 'hex')), h);
+  assert.equal(hex(new Buffer(h.toUpperCase(), 'hex')), h);
+
+  // slices that do not start at the beginning of the parent
+  if (n > 3) {
+    assert.equal(b.slice(3).toString('base64'), base64(b.slice(3)));
+    assert.equal(b.slice(3).toString('hex'), hex(b.slice(3)));
+  }
+}
+
+// invalid hex digits are reported wherever they are
+var digits = new Array(65).join('ab');
+for (var i = 0; i < digits.length; i++) {
+  ['g', ' ', 'İ', '\u0000'].forEach(function(c) {
+    var bad = digits.slice(0, i) + c + digits.slice(i + 1);
+    assert.throws(function() { new Buffer(bad, 'hex'); }, /Invalid hex/);
+  });
+}
+assert.throws(function() { new Buffer('abc', 'hex'); }, /Invalid hex/);
+
+// only the part that fits is decoded
+var small = new Buffer(4);
+assert.equal(small.write(digits, 0, 'hex'), 4);
+assert.equal(Buffer._charsWritten, 8);
+assert.equal(small.toString('hex'), 'abababab');
+
+// utf8
+var text = new Array(20).join('aé€ z');
+assert.equal(new Buffer(text).toString(), text);
+var long = new Array(40).join('x') + '世界' + new Array(40).join('y');
+assert.equal(new Buffer(long).toString(), long);
+for (var i = 0; i < long.length; i++) {
+  var s = long.slice(i);
+  assert.equal(new Buffer(s).toString(), s);
+}
+
+// Malformed input and characters outside the BMP are left to V8, which must
+// produce the same result as it does for short strings.
+function sameAsShort(bytes) {
+  var pad = new Array(65).join('a');
+  var padded = new Buffer(pad.length + bytes.length);
+  padded.write(pad, 0, 'ascii');
+  for (var i = 0; i < bytes.length; i++) padded[pad.length + i] = bytes[i];
+  assert.equal(padded.toString(), pad + new Buffer(bytes).toString());
+}
+sameAsShort([0xc3, 0xa9, 0xff, 0x41]);              // invalid byte
+sameAsShort([0xc0, 0xaf]);                          // overlong
+sameAsShort([0xed, 0xa0, 0x80]);                    // surrogate
+sameAsShort([0xe2, 0x82]);                          // truncated
+sameAsShort([0xf0, 0x9f, 0x98, 0x80, 0xc3, 0xa9]);  // 4 byte sequence
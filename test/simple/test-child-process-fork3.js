@@ -0,0 +1,64 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Push more messages through the fork() channel than fit into it at once
+// and check that they all arrive, in order, in both directions.
+
+var common = require('../common');
+var assert = require('assert');
+var fork = require('child_process').fork;
+
+var N = 2000;
+
+if (process.argv[2] == 'child') {
+  var received = 0;
+
+  process.on('message', function(m) {
+    assert.equal(m.n, received);
+    received++;
+    if (received == N) {
+      for (var i = 0; i < N; i++) process.send({ n: i });
+      process.send({ done: true });
+    }
+  });
+} else {
+  var child = fork(__filename, ['child']);
+  var received = 0;
+  var gotDone = false;
+
+  child.on('message', function(m) {
+    if (m.done) {
+      gotDone = true;
+      child.kill();
+      return;
+    }
+    assert.equal(m.n, received);
+    received++;
+  });
+
+  for (var i = 0; i < N; i++) child.send({ n: i });
+
+  process.on('exit', function() {
+    assert.equal(received, N);
+    assert.ok(gotDone);
+  });
+}
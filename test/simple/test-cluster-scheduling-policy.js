@@ -0,0 +1,157 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Checks that connections reach the workers under every scheduling policy,
+// and that round-robin spreads them evenly. Once the workers are gone, the
+// port is left listening only when the master shares the socket, which is
+// what SCHED_REUSEPORT falls back to when SO_REUSEPORT does not work.
+
+var common = require('../common');
+var assert = require('assert');
+var cluster = require('cluster');
+var net = require('net');
+
+var WORKERS = 3;
+var CONNECTIONS = 30;
+
+if (cluster.isWorker) {
+  var server = net.createServer(function(socket) {
+    socket.end(process.env.NODE_WORKER_ID);
+  });
+  server.listen(parseInt(process.env.TEST_PORT, 10), function() {
+    process.send({ cmd: 'testListening' });
+  });
+  server.on('close', function() {
+    process.send({ cmd: 'testClosed' });
+  });
+  process.on('message', function(m) {
+    if (m.cmd == 'testClose') server.close();
+  });
+  return;
+}
+
+var policies = [
+  cluster.SCHED_SHARED,
+  cluster.SCHED_RR,
+  cluster.SCHED_LEAST_LOADED,
+  cluster.SCHED_REUSEPORT
+];
+var results = {};
+var held = {};
+
+// Can this system do SO_REUSEPORT at all?
+var probe = net._createServerHandle('0.0.0.0', common.PORT + 10, 4, true);
+var canReusePort = !!probe;
+if (probe) probe.close();
+
+function run(index) {
+  // The shared listening socket stays with the master for good.
+  if (index == policies.length) process.exit();
+
+  var policy = policies[index];
+  var port = common.PORT + index;
+  var workers = [];
+  var listening = 0;
+  var closed = 0;
+  var counts = results[policy] = {};
+
+  cluster.schedulingPolicy = policy;
+  process.env.TEST_PORT = port;
+
+  for (var i = 0; i < WORKERS; i++) {
+    var worker = cluster.fork();
+    worker.on('message', function(m) {
+      if (m.cmd == 'testListening' && ++listening == WORKERS) connect(0);
+      if (m.cmd == 'testClosed' && ++closed == WORKERS) check();
+    });
+    workers.push(worker);
+  }
+
+  // With every worker's server closed, only a socket the master shares out
+  // is still listening.
+  function check() {
+    var c = net.createConnection(port);
+    c.on('connect', function() {
+      held[policy] = true;
+      c.destroy();
+      next();
+    });
+    c.on('error', function(e) {
+      assert.equal(e.code, 'ECONNREFUSED');
+      held[policy] = false;
+      next();
+    });
+  }
+
+  function next() {
+    var dead = 0;
+    cluster.on('death', function ondeath() {
+      if (++dead < WORKERS) return;
+      cluster.removeListener('death', ondeath);
+      run(index + 1);
+    });
+    workers.forEach(function(worker) { worker.kill(); });
+  }
+
+  function connect(n) {
+    if (n == CONNECTIONS) {
+      workers.forEach(function(worker) {
+        worker.send({ cmd: 'testClose' });
+      });
+      return;
+    }
+
+    var id = '';
+    var c = net.createConnection(port);
+    c.setEncoding('ascii');
+    c.on('data', function(d) { id += d; });
+    c.on('end', function() {
+      counts[id] = (counts[id] || 0) + 1;
+      connect(n + 1);
+    });
+  }
+}
+
+run(0);
+
+process.on('exit', function() {
+  policies.forEach(function(policy) {
+    var total = 0;
+    for (var id in results[policy]) total += results[policy][id];
+    assert.equal(total, CONNECTIONS, policy);
+  });
+
+  // Each connection is done before the next one is made, so round-robin
+  // has to go round in turn. The load reports race with the next
+  // connection, so least-loaded only has to use every worker.
+  var ids = Object.keys(results[cluster.SCHED_RR]);
+  assert.equal(ids.length, WORKERS);
+  ids.forEach(function(id) {
+    assert.equal(results[cluster.SCHED_RR][id], CONNECTIONS / WORKERS);
+  });
+  assert.equal(Object.keys(results[cluster.SCHED_LEAST_LOADED]).length,
+               WORKERS);
+
+  assert.strictEqual(held[cluster.SCHED_SHARED], true);
+  assert.strictEqual(held[cluster.SCHED_RR], false);
+  assert.strictEqual(held[cluster.SCHED_LEAST_LOADED], false);
+  assert.strictEqual(held[cluster.SCHED_REUSEPORT], !canReusePort);
+});
@@ -0,0 +1,84 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Where the platform has no batched datagram I/O (Windows), sendBatch()
+// sends one datagram at a time and setRecvBatch() leaves the socket emitting
+// 'message' events. Fake such a platform by failing the bindings the way
+// libuv does there.
+
+var common = require('../common');
+var assert = require('assert');
+var dgram = require('dgram');
+
+function enosys() {
+  errno = 'ENOSYS';
+  return null;
+}
+
+var N = 10;
+var buffers = [];
+var total = 0;
+for (var i = 0; i < N; i++) {
+  buffers.push(new Buffer('datagram ' + i));
+  total += buffers[i].length;
+}
+
+var received = [];
+var sent = false;
+
+var server = dgram.createSocket('udp4');
+server._handle.recvBatchStart = function() {
+  errno = 'ENOSYS';
+  return false;
+};
+server.setRecvBatch(16);
+
+server.on('messages', function() {
+  assert.fail('no batches without batch support');
+});
+
+server.on('message', function(msg) {
+  received.push(msg.toString());
+  if (received.length == N) {
+    client.close();
+    server.close();
+  }
+});
+
+server.bind(common.PORT, '127.0.0.1');
+
+var client = dgram.createSocket('udp4');
+client.bind(0, '127.0.0.1');
+client._handle.sendBatch = enosys;
+
+client.sendBatch(buffers, common.PORT, '127.0.0.1', function(err, bytes) {
+  assert.ifError(err);
+  assert.equal(bytes, total);
+  sent = true;
+});
+
+process.on('exit', function() {
+  assert.ok(sent);
+  assert.equal(received.length, N);
+  for (var i = 0; i < N; i++) {
+    assert.equal(received[i], 'datagram ' + i);
+  }
+});
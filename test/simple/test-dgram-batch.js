@@ -0,0 +1,94 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var dgram = require('dgram');
+
+var N = 100;
+var buffers = [];
+for (var i = 0; i < N; i++) {
+  buffers.push(new Buffer('datagram ' + i));
+}
+// truncated to the batch slot size
+buffers.push(new Buffer(new Array(301).join('x')));
+
+var batches = 0;
+var received = [];
+var single = 0;
+var sent = false;
+
+var server = dgram.createSocket('udp4');
+server.setRecvBatch(16, 256);
+
+server.on('messages', function(buf, info) {
+  batches++;
+  assert.equal(info.length % 4, 0);
+  assert.ok(info.length / 4 <= 16);
+
+  for (var i = 0; i < info.length; i += 4) {
+    assert.equal(info[i + 2], '127.0.0.1');
+    assert.equal(info[i + 3], client.address().port);
+    received.push(buf.toString('utf8', info[i], info[i] + info[i + 1]));
+  }
+
+  if (received.length == N + 1) {
+    client.close();
+    server.close();
+  }
+});
+
+server.on('message', function(msg, rinfo) {
+  assert.equal(msg.toString(), received[single]);
+  assert.equal(rinfo.size, msg.length);
+  assert.equal(rinfo.address, '127.0.0.1');
+  single++;
+});
+
+server.bind(common.PORT, '127.0.0.1');
+
+var client = dgram.createSocket('udp4');
+client.bind(0, '127.0.0.1');
+
+assert.throws(function() { client.sendBatch([], common.PORT, '127.0.0.1'); });
+assert.throws(function() {
+  client.sendBatch(['not a buffer'], common.PORT, '127.0.0.1');
+});
+assert.throws(function() { server.setRecvBatch(4096); });
+
+client.sendBatch(buffers, common.PORT, '127.0.0.1', function(err, bytes) {
+  assert.ifError(err);
+  var total = 0;
+  buffers.forEach(function(b) { total += b.length; });
+  assert.equal(bytes, total);
+  sent = true;
+});
+
+process.on('exit', function() {
+  assert.ok(sent);
+  assert.equal(received.length, N + 1);
+  for (var i = 0; i < N; i++) {
+    assert.equal(received[i], 'datagram ' + i);
+  }
+  assert.equal(received[N].length, 256);
+  assert.equal(single, N + 1);
+  assert.ok(batches < N);
+});
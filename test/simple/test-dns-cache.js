@@ -0,0 +1,122 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var dns = require('dns');
+
+dns.clearCache();
+dns.getCacheStats(true);
+
+assert.throws(function() {
+  dns.setCacheOptions(null);
+}, TypeError);
+assert.throws(function() {
+  dns.setCacheOptions({ lookupTtl: -1 });
+}, TypeError);
+assert.throws(function() {
+  dns.setCacheOptions({ maxEntries: 'many' });
+}, TypeError);
+
+var address;
+
+// Lookups of a name already being looked up wait for the first one.
+function coalesce() {
+  var done = 0;
+  for (var i = 0; i < 3; i++) {
+    dns.lookup('localhost', function(err, addr) {
+      if (err) throw err;
+      if (address === undefined) address = addr;
+      assert.equal(addr, address);
+      if (++done < 3) return;
+
+      var stats = dns.getCacheStats();
+      assert.equal(stats.coalesced, 2);
+      assert.equal(stats.inserts, 1);
+      assert.equal(stats.size, 1);
+      hit();
+    });
+  }
+}
+
+// Names are case insensitive.
+function hit() {
+  var sync = true;
+  dns.lookup('LOCALHOST', function(err, addr) {
+    assert.equal(sync, false);
+    assert.equal(addr, address);
+    assert.equal(dns.getCacheStats().hits, 1);
+    expire();
+  });
+  sync = false;
+}
+
+function expire() {
+  dns.setCacheOptions({ lookupTtl: 50 });
+  dns.clearCache();
+  dns.lookup('localhost', function(err) {
+    if (err) throw err;
+    setTimeout(function() {
+      dns.lookup('localhost', function(err) {
+        if (err) throw err;
+        var stats = dns.getCacheStats();
+        assert.equal(stats.expired, 1);
+        assert.equal(stats.inserts, 3);
+        evict();
+      });
+    }, 100);
+  });
+}
+
+// Lookups for different families are different entries.
+function evict() {
+  dns.setCacheOptions({ lookupTtl: 5000, maxEntries: 1 });
+  assert.equal(dns.getCacheStats().size, 1);
+  dns.lookup('localhost', 4, function(err) {
+    if (err) throw err;
+    var stats = dns.getCacheStats();
+    assert.equal(stats.evictions, 1);
+    assert.equal(stats.size, 1);
+    disable();
+  });
+}
+
+function disable() {
+  dns.setCacheOptions({ enabled: false, maxEntries: 1000 });
+  var stats = dns.getCacheStats(true);
+  assert.equal(stats.enabled, false);
+  assert.equal(stats.size, 0);
+
+  dns.lookup('localhost', function(err, addr) {
+    if (err) throw err;
+    assert.equal(addr, address);
+    assert.equal(dns.getCacheStats().misses, 0);
+    dns.setCacheOptions({ enabled: true });
+    finished = true;
+  });
+}
+
+var finished = false;
+coalesce();
+
+process.on('exit', function() {
+  assert.ok(finished);
+});
@@ -0,0 +1,88 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+
+var path = require('path'),
+    fs = require('fs');
+
+if (process.platform === 'win32') {
+  console.error('Skipping: fs.mmap is not supported on windows.');
+  process.exit(0);
+}
+
+var fn = path.join(common.tmpDir, 'mmap.bin');
+var data = new Buffer(3 * 4096 + 123);
+for (var i = 0; i < data.length; i++) data[i] = (i * 7) & 0xff;
+fs.writeFileSync(fn, data);
+
+var fd = fs.openSync(fn, 'r');
+
+// The whole file.
+var buf = fs.mmap(fd);
+assert.ok(Buffer.isBuffer(buf));
+assert.equal(buf.length, data.length);
+assert.equal(buf.toString('hex'), data.toString('hex'));
+
+// Offsets do not have to be page aligned.
+buf = fs.mmap(fd, 5000, 100, 'sequential');
+assert.equal(buf.length, 100);
+assert.equal(buf.toString('hex'), data.slice(5000, 5100).toString('hex'));
+
+buf = fs.mmap(fd, 4096, null, 'random');
+assert.equal(buf.length, data.length - 4096);
+assert.equal(buf[0], data[4096]);
+
+assert.equal(fs.mmap(fd, data.length).length, 0);
+
+// Lengths past the end of the file are cut short rather than mapping pages
+// that would fault when read.
+buf = fs.mmap(fd, 0, data.length + 100000);
+assert.equal(buf.length, data.length);
+assert.equal(buf[buf.length - 1], data[data.length - 1]);
+assert.equal(buf[data.length + 50000], undefined);
+
+buf = fs.mmap(fd, data.length - 3, 100);
+assert.equal(buf.length, 3);
+assert.equal(fs.mmap(fd, data.length + 4096, 10).length, 0);
+
+// The mapping outlives the descriptor, and writes stay private.
+buf = fs.mmap(fd, 0, 10, 'willneed');
+fs.closeSync(fd);
+assert.equal(buf[3], data[3]);
+buf[3] = buf[3] ^ 0xff;
+assert.equal(buf[3], data[3] ^ 0xff);
+assert.equal(fs.readFileSync(fn)[3], data[3]);
+
+assert.throws(function() {
+  fs.mmap(fd);
+}, function(err) {
+  return err.code === 'EBADF';
+});
+
+fd = fs.openSync(fn, 'r');
+assert.throws(function() {
+  fs.mmap(fd, 0, 10, 'bogus');
+}, TypeError);
+fs.closeSync(fd);
+
+fs.unlinkSync(fn);
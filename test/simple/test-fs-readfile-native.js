@@ -0,0 +1,114 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+
+var path = require('path'),
+    fs = require('fs');
+
+var fn = path.join(common.tmpDir, 'readfile-native.txt');
+
+// Short and long enough to be handed to V8 as external strings, ASCII only,
+// BMP text and text with surrogate pairs, which the worker leaves to V8.
+var samples = [
+  'hello world\n',
+  new Array(5000).join('hello world\n'),
+  new Array(20).join('été 中文 '),
+  new Array(5000).join('été 中文 '),
+  new Array(5000).join('😀 mixed é ')
+];
+
+var pending = 0;
+
+samples.forEach(function(text, i) {
+  var file = fn + '.' + i;
+  var bytes = new Buffer(text, 'utf8');
+  fs.writeFileSync(file, text, 'utf8');
+
+  assert.equal(fs.readFileSync(file, 'utf8'), text);
+  var buf = fs.readFileSync(file);
+  assert.ok(Buffer.isBuffer(buf));
+  assert.equal(buf.length, bytes.length);
+  assert.equal(buf.toString('hex'), bytes.toString('hex'));
+  assert.equal(fs.readFileSync(file, 'base64'), bytes.toString('base64'));
+
+  pending += 3;
+  fs.readFile(file, 'utf8', function(err, data) {
+    if (err) throw err;
+    assert.equal(data, text);
+    pending--;
+  });
+  fs.readFile(file, 'ascii', function(err, data) {
+    if (err) throw err;
+    assert.equal(data, bytes.toString('ascii'));
+    pending--;
+  });
+  fs.readFile(file, function(err, data) {
+    if (err) throw err;
+    assert.ok(Buffer.isBuffer(data));
+    assert.equal(data.toString('hex'), bytes.toString('hex'));
+    pending--;
+  });
+});
+
+// Files that report a size of zero are read until EOF.
+if (process.platform === 'linux') {
+  var status = fs.readFileSync('/proc/self/status', 'utf8');
+  assert.ok(/^Name:/.test(status));
+  pending++;
+  fs.readFile('/proc/self/status', function(err, data) {
+    if (err) throw err;
+    assert.ok(data.length > 0);
+    pending--;
+  });
+}
+
+var missing = path.join(common.tmpDir, 'does-not-exist.txt');
+
+assert.throws(function() {
+  fs.readFileSync(missing);
+}, function(err) {
+  return err.code === 'ENOENT' && err.path === missing;
+});
+
+pending++;
+fs.readFile(missing, 'utf8', function(err, data) {
+  assert.ok(err);
+  assert.equal(err.code, 'ENOENT');
+  assert.equal(err.path, missing);
+  assert.equal(err.syscall, 'open');
+  assert.equal(data, undefined);
+  pending--;
+});
+
+pending++;
+fs.readFile(fn + '.0', 'bogus', function(err, data) {
+  assert.ok(err instanceof Error);
+  pending--;
+});
+
+process.on('exit', function() {
+  assert.equal(pending, 0);
+  samples.forEach(function(text, i) {
+    fs.unlinkSync(fn + '.' + i);
+  });
+});
@@ -0,0 +1,132 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var http = require('http');
+
+var name = 'localhost:' + common.PORT;
+var server = http.createServer(function(req, res) {
+  res.end('hello');
+});
+
+var agent = new http.Agent({ keepAlive: true,
+                             maxFreeSockets: 1,
+                             idleTimeout: 200 });
+
+function get(cb) {
+  return http.get({
+    host: 'localhost',
+    port: common.PORT,
+    path: '/',
+    agent: agent
+  }, function(res) {
+    res.on('end', cb);
+  });
+}
+
+// Sequential requests reuse the one socket.
+function sequential() {
+  var parser;
+  var req = get(function() {
+    parser = req.parser;
+    assert.ok(parser);
+    process.nextTick(function() {
+      assert.equal(agent.freeSockets[name].length, 1);
+      var first = agent.freeSockets[name][0];
+
+      // The idle socket keeps nothing of the request it served.
+      assert.strictEqual(first._httpMessage, null);
+      assert.strictEqual(first.ondata, null);
+      assert.strictEqual(first.onend, null);
+      assert.strictEqual(req.parser, null);
+      assert.notEqual(http.parsers.list.indexOf(parser), -1);
+      assert.strictEqual(parser.socket, null);
+
+      get(function() {
+        process.nextTick(function() {
+          assert.strictEqual(agent.freeSockets[name][0], first);
+          var stats = agent.getPoolStats();
+          assert.equal(stats.creates, 1);
+          assert.equal(stats.hits, 1);
+          assert.equal(stats.idle, 1);
+          assert.strictEqual(first._httpMessage, null);
+          concurrent();
+        });
+      });
+    });
+  });
+}
+
+// Two sockets become free but only one may stay.
+function concurrent() {
+  var done = 0;
+  function cb() {
+    if (++done < 2) return;
+    process.nextTick(function() {
+      var stats = agent.getPoolStats();
+      assert.equal(stats.creates, 2);
+      assert.equal(stats.hits, 2);
+      assert.equal(stats.evictions, 1);
+      assert.equal(stats.idle, 1);
+      idle();
+    });
+  }
+  get(cb);
+  get(cb);
+}
+
+// The remaining socket is closed once it has been idle for idleTimeout.
+function idle() {
+  setTimeout(function() {
+    var stats = agent.getPoolStats();
+    assert.equal(stats.evictions, 2);
+    assert.equal(stats.idle, 0);
+    assert.equal(agent.freeSockets[name], undefined);
+    stale();
+  }, 400);
+}
+
+// A free socket that is dead by the time it is needed is skipped.
+function stale() {
+  get(function() {
+    process.nextTick(function() {
+      var socket = agent.freeSockets[name][0];
+      // Looks like the server went away while the socket sat in the pool.
+      socket.writable = false;
+      get(function() {
+        var stats = agent.getPoolStats();
+        assert.equal(stats.stale, 1);
+        assert.equal(stats.creates, 4);
+        process.nextTick(function() {
+          agent.destroy();
+          server.close();
+        });
+      });
+    });
+  });
+}
+
+server.listen(common.PORT, sequential);
+
+process.on('exit', function() {
+  assert.equal(agent.getPoolStats().idle, 0);
+});
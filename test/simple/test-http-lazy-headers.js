@@ -0,0 +1,121 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// With server.lazyHeaders the request headers are handed over as raw bytes
+// and only turned into strings when looked at. Check getHeader() before
+// and after request.headers has been created, for a head that arrives in
+// one piece and one that is split over several packets.
+
+var common = require('../common');
+var assert = require('assert');
+var http = require('http');
+var net = require('net');
+
+var requests = 0;
+
+var srv = http.createServer(function(req, res) {
+  requests++;
+
+  assert.equal(req.url, '/lazy?' + requests);
+  assert.equal(req.getHeader('X-BAR'), 'banjo, bango');
+  assert.deepEqual(req.getHeader('set-cookie'), ['a=1', 'b=2']);
+  assert.equal(req.getHeader('Host'), 'foo');
+  assert.equal(req.getHeader('x-missing'), undefined);
+  assert.equal(req.getHeader('empty'), '');
+
+  // The header bytes are a copy of their own, not a view of the read
+  // buffer they came in.
+  assert.equal(req._rawHeaders.length, headerBytes);
+
+  req.on('end', function() {
+    // Created after the message is complete; must not end up in trailers.
+    assert.equal(req.headers.accept, 'abc, def');
+    assert.equal(req.headers.host, 'foo');
+    assert.equal(req.headers['x-bar'], 'banjo, bango');
+    assert.deepEqual(req.headers['set-cookie'], ['a=1', 'b=2']);
+    assert.deepEqual(req.trailers, {});
+    assert.equal(req.getHeader('ACCEPT'), 'abc, def');
+
+    req.headers = { replaced: 'yes' };
+    assert.equal(req.getHeader('replaced'), 'yes');
+
+    res.writeHead(200, {'Content-Type': 'text/plain', 'Content-Length': 2});
+    res.end('ok');
+  });
+});
+srv.lazyHeaders = true;
+
+var head =
+    'Host: foo\r\n' +
+    'accept: abc\r\n' +
+    'Accept: def\r\n' +
+    'hOst: bar\r\n' +
+    'x-bar: banjo\r\n' +
+    'X-Bar: bango\r\n' +
+    'Set-Cookie: a=1\r\n' +
+    'set-cookie: b=2\r\n' +
+    'empty: \r\n' +
+    'Connection: close\r\n' +
+    '\r\n';
+var headerBytes = head.replace(/: ?|\r\n/g, '').length;
+
+var responses = 0;
+
+function request(n, split) {
+  var data = 'GET /lazy?' + n + ' HTTP/1.1\r\n' + head;
+  var c = net.createConnection(common.PORT);
+  var response = '';
+
+  c.setEncoding('ascii');
+  c.on('data', function(d) { response += d; });
+  c.on('end', function() {
+    assert.ok(/^HTTP\/1\.1 200 OK/.test(response));
+    assert.ok(/ok$/.test(response));
+    if (++responses == 2) srv.close();
+  });
+
+  c.on('connect', function() {
+    if (!split) {
+      c.write(data);
+      return;
+    }
+    // Make the parser collect the pieces itself.
+    var i = 0;
+    (function next() {
+      c.write(data.slice(i, i + 5));
+      i += 5;
+      if (i < data.length) setTimeout(next, 1);
+    })();
+  });
+}
+
+srv.listen(common.PORT, function() {
+  request(1, false);
+});
+
+srv.on('request', function(req) {
+  if (requests == 1) request(2, true);
+});
+
+process.on('exit', function() {
+  assert.equal(requests, 2);
+  assert.equal(responses, 2);
+});
@@ -555,3 +555,42 @@ function expectBody(expected) {
   parser.onHeadersComplete = onHeadersComplete2;
   parser.execute(req2, 0, req2.length);
 })();
+
+
+//
+// Test headers and URL split over several buffers that are reused between
+// calls to execute(), and common header names in different spellings.
+//
+(function() {
+  var request =
+    'GET /some/long/path?with=a&query=string HTTP/1.1' + CRLF +
+    'Host: example.com' + CRLF +
+    'user-agent: curl/7.21' + CRLF +
+    'CONTENT-TYPE: text/plain' + CRLF +
+    'X-A-Rather-Long-Header-Name: ' + Array(200).join('x') + CRLF +
+    'Content-Length: 0' + CRLF +
+    CRLF;
+
+  var parser = newParser(REQUEST);
+
+  parser.onHeadersComplete = mustCall(function(info) {
+    assert.equal(info.method, 'GET');
+    assert.equal(info.url || parser.url,
+                 '/some/long/path?with=a&query=string');
+    assert.deepEqual(info.headers || parser.headers,
+      ['Host', 'example.com',
+       'user-agent', 'curl/7.21',
+       'CONTENT-TYPE', 'text/plain',
+       'X-A-Rather-Long-Header-Name', Array(200).join('x'),
+       'Content-Length', '0']);
+  });
+
+  // Feed it in chunks of 7 bytes through the same buffer and clobber the
+  // buffer after every call; the parser must not keep pointers into it.
+  var chunk = new Buffer(7);
+  for (var i = 0; i < request.length; i += chunk.length) {
+    var n = chunk.write(request.slice(i, i + chunk.length), 0, 'ascii');
+    parser.execute(chunk, 0, n);
+    chunk.fill(0x40);
+  }
+})();
@@ -0,0 +1,102 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var http = require('http');
+var fs = require('fs');
+var path = require('path');
+
+var fn = path.join(common.tmpDir, 'http-sendfile.txt');
+var text = new Array(20000).join('0123456789abcdef');
+fs.writeFileSync(fn, text);
+var fd = fs.openSync(fn, 'r');
+
+var callbacks = 0;
+
+var server = http.createServer(function(req, res) {
+  switch (req.url) {
+    case '/':
+      res.sendFile(fd, 0, text.length, function(err) {
+        assert.ok(!err);
+        callbacks++;
+      });
+      break;
+
+    case '/range':
+      res.writeHead(206, {'Content-Length': 100});
+      res.sendFile(fd, 16, 100);
+      break;
+
+    case '/chunked':
+      res.writeHead(200, {});
+      res.write('first;');
+      res.sendFile(fd, 0, 1000);
+      break;
+  }
+});
+
+function get(path, cb) {
+  http.get({ port: common.PORT, path: path }, function(res) {
+    var body = '';
+    res.setEncoding('ascii');
+    res.on('data', function(chunk) { body += chunk; });
+    res.on('end', function() { cb(res, body); });
+  });
+}
+
+var pending = 0;
+function done() {
+  if (--pending == 0) server.close();
+}
+
+server.listen(common.PORT, function() {
+  // More requests than the agent has sockets, so that some responses are
+  // sent on connections that are kept alive.
+  for (var i = 0; i < 8; i++) {
+    pending++;
+    get('/', function(res, body) {
+      assert.equal(res.headers['content-length'], text.length);
+      assert.equal(body, text);
+      done();
+    });
+  }
+
+  pending++;
+  get('/range', function(res, body) {
+    assert.equal(res.statusCode, 206);
+    assert.equal(body, text.slice(16, 116));
+    done();
+  });
+
+  pending++;
+  get('/chunked', function(res, body) {
+    assert.equal(res.headers['transfer-encoding'], 'chunked');
+    assert.equal(body, 'first;' + text.slice(0, 1000));
+    done();
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(callbacks, 8);
+  fs.closeSync(fd);
+  fs.unlinkSync(fn);
+});
@@ -51,6 +51,7 @@ var expected = [
   'NativeModule util',
   'NativeModule path',
   'NativeModule module',
+  'Binding resolver',
   'NativeModule fs',
   'Binding fs',
   'Binding constants',
@@ -79,8 +80,7 @@ switch (process.stdout._type) {
       'NativeModule tty',
       'NativeModule net',
       'NativeModule timers',
-      'Binding timer_wrap',
-      'NativeModule _linklist'
+      'Binding timer_wrap'
     ]);
     break;
 
@@ -91,7 +91,6 @@ switch (process.stdout._type) {
       'NativeModule net',
       'NativeModule timers',
       'Binding timer_wrap',
-      'NativeModule _linklist',
       'Binding pipe_wrap'
     ]);
     break;
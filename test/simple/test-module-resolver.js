@@ -0,0 +1,144 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var path = require('path');
+var spawn = require('child_process').spawn;
+
+var dir = path.join(common.tmpDir, 'module-resolver');
+var manifest = path.join(common.tmpDir, 'module-resolver.manifest');
+
+function rmrf(p) {
+  try {
+    if (fs.statSync(p).isDirectory()) {
+      fs.readdirSync(p).forEach(function(name) {
+        rmrf(path.join(p, name));
+      });
+      fs.rmdirSync(p);
+    } else {
+      fs.unlinkSync(p);
+    }
+  } catch (e) {
+  }
+}
+
+rmrf(dir);
+rmrf(manifest);
+fs.mkdirSync(dir, 0777);
+fs.mkdirSync(path.join(dir, 'node_modules'), 0777);
+
+var resolver = process.binding('resolver');
+resolver.beginLookup();
+assert.equal(resolver.type(dir), resolver.DIRECTORY);
+assert.equal(resolver.type(path.join(dir, 'nope.js')), resolver.MISSING);
+
+// Files that show up after a directory was listed are found.
+assert.throws(function() {
+  require(path.join(dir, 'a'));
+});
+fs.writeFileSync(path.join(dir, 'a.js'), 'exports.a = 1;');
+assert.equal(require(path.join(dir, 'a')).a, 1);
+
+// Names listed under another case are left to the file system.
+resolver.beginLookup();
+assert.equal(resolver.type(path.join(dir, 'A.js')),
+             path.existsSync(path.join(dir, 'A.js')) ? resolver.FILE :
+                                                        resolver.MISSING);
+
+fs.mkdirSync(path.join(dir, 'node_modules', 'pkg'), 0777);
+fs.writeFileSync(path.join(dir, 'node_modules', 'pkg', 'package.json'),
+                 JSON.stringify({ main: 'lib/main' }));
+fs.mkdirSync(path.join(dir, 'node_modules', 'pkg', 'lib'), 0777);
+fs.writeFileSync(path.join(dir, 'node_modules', 'pkg', 'lib', 'main.js'),
+                 'exports.pkg = 1;');
+fs.writeFileSync(path.join(dir, 'b.js'),
+                 'exports.pkg = require("pkg").pkg;');
+assert.equal(require(path.join(dir, 'b')).pkg, 1);
+
+// The manifest one run writes is used by the next.
+function run(cb, file, expected) {
+  file = file || path.join(dir, 'b');
+  var child = spawn(process.execPath,
+                    ['--resolution-manifest=' + manifest,
+                     '-e', 'console.log(require(' +
+                           JSON.stringify(file) + ').pkg)']);
+  var out = '';
+  child.stdout.setEncoding('utf8');
+  child.stdout.on('data', function(s) { out += s; });
+  child.on('exit', function(code) {
+    assert.equal(code, 0);
+    assert.equal(out, (expected || 1) + '\n');
+    cb();
+  });
+}
+
+var runs = 0;
+
+run(function() {
+  runs++;
+  var saved = fs.readFileSync(manifest, 'utf8');
+  assert.ok(saved.indexOf(path.join(dir, 'b.js')) >= 0);
+  assert.ok(saved.indexOf(path.join(dir, 'node_modules', 'pkg', 'lib',
+                                    'main.js')) >= 0);
+
+  // Stale entries are resolved again.
+  fs.unlinkSync(path.join(dir, 'node_modules', 'pkg', 'lib', 'main.js'));
+  fs.writeFileSync(path.join(dir, 'node_modules', 'pkg', 'lib', 'main.json'),
+                   '{ "pkg": 1 }');
+
+  run(function() {
+    runs++;
+    var saved = fs.readFileSync(manifest, 'utf8');
+    assert.ok(saved.indexOf(path.join(dir, 'node_modules', 'pkg', 'lib',
+                                      'main.json')) >= 0);
+
+    // A copy installed closer to the requiring module wins over the one
+    // in the manifest.
+    var sub = path.join(dir, 'sub');
+    fs.mkdirSync(sub, 0777);
+    fs.writeFileSync(path.join(sub, 'c.js'),
+                     'exports.pkg = require("pkg").pkg;');
+    run(function() {
+      runs++;
+      fs.mkdirSync(path.join(sub, 'node_modules'), 0777);
+      fs.writeFileSync(path.join(sub, 'node_modules', 'pkg.js'),
+                       'exports.pkg = 2;');
+
+      run(function() {
+        runs++;
+
+        // A damaged manifest is ignored.
+        fs.writeFileSync(manifest, 'garbage');
+        run(function() {
+          runs++;
+          rmrf(dir);
+          rmrf(manifest);
+        });
+      }, path.join(sub, 'c'), 2);
+    }, path.join(sub, 'c'), 1);
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(runs, 5);
+});
@@ -0,0 +1,73 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+var common = require('../common');
+var assert = require('assert');
+var net = require('net');
+
+// More chunks than a single writev() takes.
+var N = 3000;
+
+var expected = '';
+var received = '';
+var callbacks = 0;
+
+var server = net.createServer(function(socket) {
+  socket.setEncoding('ascii');
+  socket.on('data', function(d) {
+    received += d;
+  });
+  socket.on('end', function() {
+    server.close();
+  });
+});
+
+server.listen(common.PORT, function() {
+  var client = net.createConnection(common.PORT);
+
+  client.on('connect', function() {
+    client.cork();
+    for (var i = 0; i < N; i++) {
+      var chunk = 'chunk ' + i + '\n';
+      expected += chunk;
+      client.write(new Buffer(chunk), function() {
+        callbacks++;
+      });
+    }
+    assert.ok(client.bufferSize >= expected.length);
+    client.uncork();
+
+    // Corked writes that are never uncorked explicitly go out on the next
+    // tick.
+    client.cork();
+    client.write('tail\n');
+    expected += 'tail\n';
+    process.nextTick(function() {
+      client.end();
+    });
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(callbacks, N);
+  assert.equal(received, expected);
+});
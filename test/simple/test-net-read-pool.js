@@ -0,0 +1,134 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Flags: --expose_gc
+
+// Lots of small reads and a bulk transfer on the same connection. The data
+// must arrive intact while the read size adapts, and the pool that reads
+// are carved out of must show up in process.memoryUsage(). Once the data is
+// collected its slabs are pooled, and a second transfer reuses them.
+
+var common = require('../common');
+var assert = require('assert');
+var net = require('net');
+
+var N = 200;
+var BULK = 4 * 1024 * 1024;
+
+var expected = '';
+for (var i = 0; i < N; i++) expected += 'ping ' + i + '\n';
+var bulk = new Buffer(BULK);
+for (var i = 0; i < BULK; i++) bulk[i] = i % 251;
+
+// Every slab size, largest first.
+var SLABS = 1024 * 1024 + 256 * 1024 + 64 * 1024;
+
+var received = [];
+var transfers = 0;
+var firstPool;
+
+var server = net.createServer(function(socket) {
+  socket.on('data', function(d) {
+    received.push(d);
+  });
+  socket.on('end', function() {
+    transfers++;
+    if (transfers == 1) {
+      firstPool = check();
+      again();
+    } else {
+      server.close();
+    }
+  });
+});
+
+server.listen(common.PORT, send);
+
+function send() {
+  var client = net.createConnection(common.PORT);
+  var i = 0;
+
+  client.setNoDelay();
+
+  function ping() {
+    if (i == N) {
+      client.end(bulk);
+      return;
+    }
+    client.write('ping ' + i++ + '\n');
+    setTimeout(ping, 1);
+  }
+
+  client.on('connect', ping);
+}
+
+function check() {
+  var all = concat(received);
+  assert.equal(all.length, Buffer.byteLength(expected) + BULK);
+  assert.equal(all.toString('ascii', 0, Buffer.byteLength(expected)),
+               expected);
+  var offset = Buffer.byteLength(expected);
+  for (var i = 0; i < BULK; i++) {
+    if (all[offset + i] !== i % 251) {
+      assert.fail(all[offset + i], i % 251, 'byte ' + i + ' differs');
+    }
+  }
+
+
+  // All of it is still referenced, so only the slabs currently being
+  // carved up are not pinned.
+  var pool = process.memoryUsage().readPool;
+  assert.ok(pool.misses > 0);
+  assert.ok(pool.pinned >= all.length - SLABS);
+  assert.equal(pool.pinned % (64 * 1024), 0);
+  return pool;
+}
+
+// Lets go of the data and sends it again.
+function again() {
+  received = [];
+  setTimeout(function() {
+    gc();
+    var pool = process.memoryUsage().readPool;
+    assert.ok(pool.pinned < firstPool.pinned);
+    assert.ok(pool.pooled > 0);
+    send();
+  }, 10);
+}
+
+process.on('exit', function() {
+  assert.equal(transfers, 2);
+  var pool = check();
+  assert.ok(pool.hits > firstPool.hits);
+});
+
+function concat(list) {
+  var length = 0;
+  for (var i = 0; i < list.length; i++) length += list[i].length;
+  var b = new Buffer(length);
+  var pos = 0;
+  for (var i = 0; i < list.length; i++) {
+    list[i].copy(b, pos);
+    pos += list[i].length;
+  }
+  return b;
+}
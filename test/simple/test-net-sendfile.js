@@ -0,0 +1,104 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var net = require('net');
+var fs = require('fs');
+var path = require('path');
+
+var fn = path.join(common.tmpDir, 'net-sendfile.bin');
+var data = new Buffer(1024 * 1024 + 17);
+for (var i = 0; i < data.length; i++) data[i] = (i * 31) & 0xff;
+fs.writeFileSync(fn, data);
+var fd = fs.openSync(fn, 'r');
+
+var sent = 0;
+var failed = 0;
+
+var server = net.createServer(function(socket) {
+  socket.once('data', function(what) {
+    if (what.toString() == 'bad') {
+      // The file ends before the range does.
+      socket.on('error', function(err) {
+        assert.equal(err.code, 'EINVAL');
+        failed++;
+      });
+      socket.sendFile(fd, data.length - 10, 100, function(err) {
+        assert.ok(err);
+      });
+      return;
+    }
+
+    // Ordered with the writes around it, corked ones included.
+    socket.write('head;');
+    socket.cork();
+    socket.write('corked;');
+    socket.sendFile(fd, 1, data.length - 1, function(err) {
+      assert.ok(!err);
+      sent++;
+    });
+    socket.end(';tail');
+  });
+});
+
+server.listen(common.PORT, function() {
+  var client = net.connect(common.PORT);
+  var chunks = [];
+  var length = 0;
+
+  client.write('good');
+  client.on('data', function(chunk) {
+    chunks.push(chunk);
+    length += chunk.length;
+  });
+  client.on('end', function() {
+    var all = new Buffer(length);
+    var offset = 0;
+    chunks.forEach(function(chunk) {
+      chunk.copy(all, offset);
+      offset += chunk.length;
+    });
+
+    var head = 'head;corked;';
+    assert.equal(length, head.length + data.length - 1 + ';tail'.length);
+    assert.equal(all.toString('ascii', 0, head.length), head);
+    assert.equal(all.toString('ascii', length - 5), ';tail');
+    var body = all.slice(head.length, length - 5);
+    for (var i = 0; i < body.length; i++) {
+      if (body[i] !== data[i + 1]) assert.fail(body[i], data[i + 1]);
+    }
+
+    var bad = net.connect(common.PORT);
+    bad.write('bad');
+    bad.on('error', function() {});
+    bad.on('close', function() {
+      server.close();
+    });
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(sent, 1);
+  assert.equal(failed, 1);
+  fs.closeSync(fd);
+  fs.unlinkSync(fn);
+});
@@ -0,0 +1,108 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Strings written to a socket are encoded without an intermediate Buffer.
+// Check small and large strings in both encodings that take that path.
+
+var common = require('../common');
+var assert = require('assert');
+var net = require('net');
+
+function repeat(s, n) {
+  var r = '';
+  while (n-- > 0) r += s;
+  return r;
+}
+
+var strings = [
+  ['hello ascii\n', 'ascii'],
+  ['héllo wörld ☃\n', 'utf8'],
+  ['', 'utf8'],
+  [repeat('€', 3000), 'utf8'],        // larger than the shared block
+  [repeat('x', 100 * 1024), 'ascii'],
+  [repeat('😀', 10), undefined]  // surrogate pairs, default utf8
+];
+// Plenty of small writes in flight at the same time.
+for (var i = 0; i < 2000; i++) {
+  strings.push(['line ' + i + ' æ\n', i % 2 ? 'utf8' : 'utf-8']);
+}
+
+var expected = [];
+var expectedLength = 0;
+strings.forEach(function(s) {
+  var b = new Buffer(s[0], s[1]);
+  expected.push(b);
+  expectedLength += b.length;
+});
+
+var received = [];
+var receivedLength = 0;
+var callbacks = 0;
+var bytesWritten;
+
+var server = net.createServer(function(socket) {
+  socket.on('data', function(d) {
+    received.push(d);
+    receivedLength += d.length;
+  });
+  socket.on('end', function() {
+    server.close();
+  });
+});
+
+server.listen(common.PORT, function() {
+  var client = net.createConnection(common.PORT, function() {
+    strings.forEach(function(s) {
+      var cb = function() {
+        callbacks++;
+      };
+      if (s[1]) {
+        client.write(s[0], s[1], cb);
+      } else {
+        client.write(s[0], cb);
+      }
+    });
+    bytesWritten = client.bytesWritten;
+    client.end();
+  });
+});
+
+function concat(list, length) {
+  var b = new Buffer(length);
+  var pos = 0;
+  list.forEach(function(c) {
+    c.copy(b, pos);
+    pos += c.length;
+  });
+  return b;
+}
+
+process.on('exit', function() {
+  assert.equal(callbacks, strings.length);
+  assert.equal(bytesWritten, expectedLength);
+  assert.equal(receivedLength, expectedLength);
+  var a = concat(received, receivedLength);
+  var b = concat(expected, expectedLength);
+  for (var i = 0; i < a.length; i++) {
+    if (a[i] !== b[i]) assert.fail(a[i], b[i], 'byte ' + i + ' differs');
+  }
+});
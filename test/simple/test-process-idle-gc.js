@@ -0,0 +1,93 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+
+assert.throws(function() {
+  process.setIdleGC({ mode: 'eager' });
+}, TypeError);
+assert.throws(function() {
+  process.setIdleGC({ minIdle: -1 });
+}, TypeError);
+assert.throws(function() {
+  process.setIdleGC();
+}, TypeError);
+
+process.setIdleGC({ mode: 'batch', minIdle: 5 });
+var stats = process.idleGCStats(true);
+assert.equal(stats.mode, 'batch');
+assert.equal(stats.minIdle, 5);
+
+// V8 starts another round of idle cleanup after this many collections.
+var kGCsBeforeRearm = 4;
+var overLimitChecked = false;
+
+function churn() {
+  var junk = [];
+  for (var i = 0; i < 100000; i++) junk.push({ i: i });
+  return junk.length;
+}
+
+// Collections forced by allocation happen on the critical path.
+for (var i = 0; i < 20; i++) churn();
+stats = process.idleGCStats();
+assert.ok(stats.critical.scavenges + stats.critical.markSweeps > 0);
+assert.equal(stats.steps, 0);
+
+// Once the loop sits idle, V8 gets to clean up until it is done.
+setTimeout(function() {
+  var stats = process.idleGCStats(true);
+  assert.ok(stats.steps > 0);
+  assert.ok(stats.idle.scavenges + stats.idle.markSweeps > 0);
+  assert.ok(stats.idle.time > 0);
+  assert.ok(stats.done);
+
+  // Reset cleared the counters.
+  stats = process.idleGCStats();
+  assert.equal(stats.steps, 0);
+  assert.equal(stats.idle.time, 0);
+
+  overLimit();
+}, 1000);
+
+// A quiet isolate above the heap limit stops stepping once V8 is done too,
+// instead of keeping the loop from ever blocking.
+function overLimit() {
+  process.setIdleGC({ heapLimit: 1 });
+  churn();
+
+  setTimeout(function() {
+    var before = process.idleGCStats();
+    assert.ok(before.done);
+
+    setTimeout(function() {
+      var after = process.idleGCStats();
+      assert.ok(after.steps - before.steps <= kGCsBeforeRearm);
+      assert.ok(after.idle.markSweeps - before.idle.markSweeps <= 1);
+      overLimitChecked = true;
+    }, 1000);
+  }, 500);
+}
+
+process.on('exit', function() {
+  assert.ok(overLimitChecked);
+});
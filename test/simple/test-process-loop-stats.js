@@ -0,0 +1,86 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+
+var phases = ['poll', 'io', 'tick', 'timers', 'eio'];
+
+function checkHistogram(h) {
+  var count = 0;
+  h.buckets.forEach(function(bucket) {
+    count += bucket[1];
+  });
+  assert.equal(count, h.count);
+  if (h.count == 0) return;
+
+  assert.ok(h.min <= h.p50);
+  assert.ok(h.p50 <= h.p90);
+  assert.ok(h.p90 <= h.p99);
+  assert.ok(h.p99 <= h.p999);
+  assert.ok(h.p999 <= h.max);
+  assert.ok(h.total >= h.max);
+}
+
+// Start from a clean slate.
+process.loopStats(true);
+
+var stats = process.loopStats();
+phases.forEach(function(phase) {
+  assert.equal(stats.phases[phase].count, 0);
+});
+assert.equal(stats.longest, null);
+
+setTimeout(function() {
+  // Block the loop for 50ms in a timer.
+  var start = Date.now();
+  while (Date.now() - start < 50);
+
+  fs.stat(__filename, function(err) {
+    assert.ifError(err);
+
+    setTimeout(function() {
+      var stats = process.loopStats(true);
+
+      phases.forEach(function(phase) {
+        checkHistogram(stats.phases[phase]);
+      });
+      checkHistogram(stats.eventsPerIteration);
+
+      assert.ok(stats.iterations > 0);
+      assert.ok(stats.phases.poll.count > 0);
+      assert.ok(stats.phases.timers.count >= 1);
+      assert.ok(stats.phases.eio.count >= 1);
+
+      assert.equal(stats.longest.phase, 'timers');
+      assert.equal(stats.longest.callback, 'ontimeout');
+      assert.ok(stats.longest.duration >= 45000);
+      assert.ok(stats.phases.timers.max >= 45000);
+
+      // Reading with reset cleared everything.
+      var after = process.loopStats();
+      assert.equal(after.phases.timers.count, 0);
+      assert.equal(after.phases.eio.count, 0);
+      assert.equal(after.longest, null);
+    }, 1);
+  });
+}, 1);
@@ -0,0 +1,142 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var path = require('path');
+var spawn = require('child_process').spawn;
+
+var cacheDir = path.join(common.tmpDir, 'code-cache');
+var script = path.join(common.tmpDir, 'code-cache-module.js');
+
+// Big enough for V8 to preparse it.
+var source = 'exports.sum = 0;\n';
+for (var i = 0; i < 100; i++) {
+  source += 'function f' + i + '(a) { return a + ' + i + '; }\n' +
+            'exports.sum += f' + i + '(1);\n';
+}
+fs.writeFileSync(script, source);
+
+// As long as the first one, so that only the source tells them apart.
+var other = path.join(common.tmpDir, 'code-cache-other.js');
+var otherSource = source.replace('exports.sum = 0;', 'exports.sum = 1;');
+fs.writeFileSync(other, otherSource);
+
+function clear() {
+  try {
+    fs.readdirSync(cacheDir).forEach(function(name) {
+      fs.unlinkSync(path.join(cacheDir, name));
+    });
+    fs.rmdirSync(cacheDir);
+  } catch (e) {
+  }
+}
+
+function entries() {
+  return fs.readdirSync(cacheDir).filter(function(name) {
+    return /^[0-9a-f]{16}$/.test(name);
+  });
+}
+
+// The entry of a module's source, which it ends with.
+function entryOf(source) {
+  source = require('module').wrap(source);
+  var tail = new Buffer(source, 'ucs2');
+  var found = entries().filter(function(name) {
+    var buf = fs.readFileSync(path.join(cacheDir, name));
+    return buf.length > tail.length &&
+           buf.slice(buf.length - tail.length).toString('ucs2') === source;
+  });
+  assert.equal(found.length, 1);
+  return found[0];
+}
+
+function run(cb, file, expected) {
+  file = file || script;
+  var env = {};
+  for (var key in process.env) env[key] = process.env[key];
+  env.NODE_CODE_CACHE_DIR = cacheDir;
+
+  var child = spawn(process.execPath,
+                    ['-e', 'console.log(require(' + JSON.stringify(file) +
+                           ').sum)'],
+                    { env: env });
+  var out = '';
+  child.stdout.setEncoding('utf8');
+  child.stdout.on('data', function(s) { out += s; });
+  child.on('exit', function(code) {
+    assert.equal(code, 0);
+    assert.equal(out, (expected || 5050) + '\n');
+    cb();
+  });
+}
+
+var runs = 0;
+clear();
+
+// The first run fills the cache, the second one uses it.
+run(function() {
+  runs++;
+  var before = entries();
+  assert.ok(before.length > 0);
+
+  run(function() {
+    runs++;
+    assert.deepEqual(entries(), before);
+
+    // Damaged entries are ignored and replaced.
+    before.forEach(function(name) {
+      var file = path.join(cacheDir, name);
+      var buf = fs.readFileSync(file);
+      for (var i = 32; i < buf.length; i++) buf[i] = 0xff - buf[i];
+      fs.writeFileSync(file, buf);
+    });
+
+    run(function() {
+      runs++;
+      assert.deepEqual(entries(), before);
+
+      // An entry whose header matches but whose source does not, as after
+      // a hash collision, is not used.
+      run(function() {
+        runs++;
+        var name = entryOf(source);
+        var file = path.join(cacheDir, name);
+        var good = fs.readFileSync(file);
+        var bad = fs.readFileSync(path.join(cacheDir, entryOf(otherSource)));
+        good.copy(bad, 16, 16, 24);  // source_hash
+        fs.writeFileSync(file, bad);
+
+        run(function() {
+          runs++;
+          assert.equal(fs.readFileSync(file).toString('base64'),
+                       good.toString('base64'));
+          clear();
+        });
+      }, other, 5051);
+    });
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(runs, 5);
+});
@@ -0,0 +1,95 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var timers = require('timers');
+
+// Idle timeouts with many distinct values all share one timing wheel.
+// Check that they fire in order, never early, and that re-arming and
+// cancelling work, including from inside a timeout callback.
+
+var start = Date.now();
+var fired = [];
+var items = [];
+
+function makeItem(msecs) {
+  var item = {
+    msecs: msecs,
+    _onTimeout: function() {
+      var elapsed = Date.now() - start;
+      assert.ok(elapsed >= msecs - 1,
+                msecs + ' ms timeout fired after ' + elapsed + ' ms');
+      fired.push(msecs);
+    }
+  };
+  timers.enroll(item, msecs);
+  timers.active(item);
+  return item;
+}
+
+// Spread over the first two levels of the wheel (64 ms and 4096 ms).
+for (var i = 1; i <= 150; i++) {
+  items.push(makeItem(i * 3));
+}
+
+// Cancelled before expiring.
+var cancelled = makeItem(100);
+timers.unenroll(cancelled);
+
+// Re-armed further out, it must only fire once and late.
+var rearmed = { _onTimeout: function() { rearmedAt.push(Date.now() - start); } };
+var rearmedAt = [];
+timers.enroll(rearmed, 50);
+timers.active(rearmed);
+setTimeout(function() {
+  timers.active(rearmed);
+}, 30);
+
+// A timeout callback that arms another item and cancels a pending one.
+var victim = makeItem(400);
+var chained = {
+  _onTimeout: function() {
+    timers.unenroll(victim);
+    timers.enroll(chained2, 0);
+    timers.active(chained2);
+  }
+};
+var chained2 = {
+  _onTimeout: function() { chained2.fired = true; }
+};
+timers.enroll(chained, 200);
+timers.active(chained);
+
+process.on('exit', function() {
+  var expected = [];
+  for (var i = 1; i <= 150; i++) {
+    if (i * 3 !== 400) expected.push(i * 3);
+  }
+  var sorted = fired.slice().sort(function(a, b) { return a - b; });
+  assert.deepEqual(fired.filter(function(m) { return m !== 400; }),
+                   sorted.filter(function(m) { return m !== 400; }));
+  assert.equal(fired.indexOf(400), -1);
+  assert.equal(fired.length, expected.length);
+  assert.equal(rearmedAt.length, 1);
+  assert.ok(rearmedAt[0] >= 79, 're-armed timeout fired at ' + rearmedAt[0]);
+  assert.ok(chained2.fired);
+});
@@ -0,0 +1,134 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Servers that share the session cache but trust different CAs must not
+// resume each other's sessions; a resumed session skips the verification of
+// the client certificate.
+
+if (!process.versions.openssl) {
+  console.error('Skipping because node compiled without OpenSSL.');
+  process.exit(0);
+}
+
+var common = require('../common');
+var assert = require('assert');
+var tls = require('tls');
+var fs = require('fs');
+var path = require('path');
+
+var SSL_OP_NO_TICKET = 0x00004000;
+
+function loadPEM(n) {
+  return fs.readFileSync(path.join(common.fixturesDir, 'keys', n + '.pem'));
+}
+
+var key = loadPEM('agent1-key');
+var cert = loadPEM('agent1-cert');
+
+var accepted = {};
+
+function createServer(port, ca, secureOptions, cb) {
+  var server = tls.createServer({
+    key: key,
+    cert: cert,
+    ca: [loadPEM(ca)],
+    requestCert: true,
+    rejectUnauthorized: true,
+    sharedSessionCache: true,
+    sharedTicketKeys: true,
+    secureOptions: secureOptions
+  }, function(cleartext) {
+    assert(cleartext.authorized);
+    accepted[port] = (accepted[port] || 0) + 1;
+    cleartext.end();
+  });
+  server.listen(port, cb);
+  return server;
+}
+
+// Connects with the client certificate signed by ca1 and calls back with
+// the session and whether it was reused.
+function connect(port, session, cb) {
+  var reused = false;
+  var next = null;
+  var c = tls.connect(port, {
+    key: key,
+    cert: cert,
+    session: session
+  }, function() {
+    reused = c.isSessionReused();
+    next = c.getSession();
+  });
+  c.on('error', function() {});
+  c.on('close', function() {
+    cb(next, reused);
+  });
+}
+
+var steps = 0;
+
+function test(port, secureOptions, cb) {
+  var trusting = createServer(port, 'ca1', secureOptions, function() {
+    var other = createServer(port + 1, 'ca2', secureOptions, function() {
+      connect(port, null, function(session, reused) {
+        assert(session);
+        assert(!reused);
+
+        connect(port, session, function(_, reused) {
+          assert(reused);
+          assert.equal(accepted[port], 2);
+
+          connect(port + 1, session, function(_, reused) {
+            assert(!reused);
+            assert.equal(accepted[port + 1], undefined);
+
+            trusting.close();
+            other.close();
+            steps++;
+            cb();
+          });
+        });
+      });
+    });
+  });
+}
+
+test(common.PORT, SSL_OP_NO_TICKET, function() {
+  test(common.PORT + 2, 0, function() {
+    // Servers that do not ask for it keep their sessions to themselves.
+    var stored = tls.getSessionCacheStats().stored;
+    var server = tls.createServer({ key: key, cert: cert }, function(c) {
+      c.end();
+    });
+    server.listen(common.PORT + 4, function() {
+      connect(common.PORT + 4, null, function() {
+        assert.equal(tls.getSessionCacheStats().stored, stored);
+        server.close();
+        steps++;
+      });
+    });
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(steps, 3);
+});
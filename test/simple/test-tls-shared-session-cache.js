@@ -0,0 +1,144 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+if (!process.versions.openssl) {
+  console.error('Skipping because node compiled without OpenSSL.');
+  process.exit(0);
+}
+
+var common = require('../common');
+var assert = require('assert');
+var tls = require('tls');
+var fs = require('fs');
+var path = require('path');
+
+var SSL_OP_NO_TICKET = 0x00004000;
+
+var key = fs.readFileSync(path.join(common.fixturesDir, 'agent.key'));
+var cert = fs.readFileSync(path.join(common.fixturesDir, 'agent.crt'));
+
+function createServer(port, secureOptions, cb) {
+  var server = tls.createServer({
+    key: key,
+    cert: cert,
+    sessionIdContext: 'test-tls-shared-session-cache',
+    secureOptions: secureOptions,
+    sharedSessionCache: true,
+    sharedTicketKeys: true
+  }, function(cleartext) {
+    cleartext.end();
+  });
+  server.listen(port, cb);
+  return server;
+}
+
+// Connects and calls back with the session and whether it was reused.
+function connect(port, session, cb) {
+  var c = tls.connect(port, { session: session }, function() {
+    var reused = c.isSessionReused();
+    var next = c.getSession();
+    c.on('close', function() {
+      cb(next, reused);
+    });
+  });
+}
+
+var stats = tls.getSessionCacheStats();
+assert.equal(stats.entries, 0);
+
+var steps = 0;
+var servers = [];
+
+// Two servers without tickets resume each other's sessions through the
+// session id cache they share.
+servers.push(createServer(common.PORT, SSL_OP_NO_TICKET, function() {
+  servers.push(createServer(common.PORT + 1, SSL_OP_NO_TICKET, function() {
+    connect(common.PORT, null, function(session, reused) {
+      assert(!reused);
+      assert.equal(tls.getSessionCacheStats().stored, 1);
+
+      connect(common.PORT + 1, session, function(session, reused) {
+        assert(reused);
+        var stats = tls.getSessionCacheStats();
+        assert.equal(stats.hits, 1);
+        assert.equal(stats.entries, 1);
+
+        tls.flushSessionCache();
+        assert.equal(tls.getSessionCacheStats().entries, 0);
+
+        connect(common.PORT, session, function(session, reused) {
+          assert(!reused);
+          assert.equal(tls.getSessionCacheStats().misses, 1);
+          steps++;
+          testTickets();
+        });
+      });
+    });
+  }));
+}));
+
+// A server with tickets keeps accepting tickets issued under the previous
+// key after one rotation, but not after two.
+function testTickets() {
+  if (!tls.rotateTicketKeys) return done();
+
+  servers.push(createServer(common.PORT + 2, 0, function() {
+    connect(common.PORT + 2, null, function(session, reused) {
+      assert(!reused);
+
+      tls.rotateTicketKeys();
+      connect(common.PORT + 2, session, function(_, reused) {
+        assert(reused);
+        assert.equal(tls.getSessionCacheStats().ticketHits, 1);
+
+        tls.rotateTicketKeys(new Buffer(48));
+        connect(common.PORT + 2, session, function(_, reused) {
+          assert(!reused);
+          var stats = tls.getSessionCacheStats();
+          assert.equal(stats.ticketMisses, 1);
+          assert.equal(stats.ticketKeyRotations, 2);
+
+          assert.throws(function() {
+            tls.rotateTicketKeys(new Buffer(16));
+          }, TypeError);
+          steps++;
+          done();
+        });
+      });
+    });
+  }));
+}
+
+function done() {
+  tls.setSessionCacheOptions({ size: 1 });
+  var stats = tls.getSessionCacheStats();
+  assert.equal(stats.size, 1);
+  assert.equal(stats.timeout, 300);
+  assert(stats.entries <= 1);
+
+  servers.forEach(function(server) {
+    server.close();
+  });
+}
+
+process.on('exit', function() {
+  assert.equal(steps, 2);
+});
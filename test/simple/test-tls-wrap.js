@@ -0,0 +1,101 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Connections run on the native TLSWrap handle: data that is written
+// before the handshake is done, large writes and close_notify all make
+// it through, and the cleartext sockets are net.Sockets on that handle.
+
+if (!process.versions.openssl) {
+  console.error('Skipping because node compiled without OpenSSL.');
+  process.exit(0);
+}
+
+var common = require('../common');
+var assert = require('assert');
+var net = require('net');
+var tls = require('tls');
+var fs = require('fs');
+
+var TLSWrap = process.binding('tls_wrap').TLSWrap;
+
+var options = {
+  key: fs.readFileSync(common.fixturesDir + '/keys/agent2-key.pem'),
+  cert: fs.readFileSync(common.fixturesDir + '/keys/agent2-cert.pem')
+};
+
+var big = new Buffer(1024 * 1024);
+for (var i = 0; i < big.length; i++) big[i] = i % 251;
+
+var serverGot = 0;
+var clientGot = [];
+var secureConnections = 0;
+var clientEnded = false;
+
+var server = tls.Server(options, function(cleartext) {
+  secureConnections++;
+  assert.ok(cleartext instanceof net.Socket);
+  assert.ok(cleartext._handle instanceof TLSWrap);
+  assert.ok(cleartext.getCipher());
+
+  cleartext.on('data', function(d) {
+    serverGot += d.length;
+    if (serverGot == 5) {
+      cleartext.write(big);
+      cleartext.end('bye');
+    }
+  });
+});
+
+server.listen(common.PORT, function() {
+  var client = tls.connect(common.PORT, function() {
+    assert.ok(client._handle instanceof TLSWrap);
+  });
+
+  // Queued until the connection and the handshake are done.
+  client.write('hello');
+
+  client.on('data', function(d) {
+    clientGot.push(d);
+  });
+
+  client.on('end', function() {
+    clientEnded = true;
+    server.close();
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(secureConnections, 1);
+  assert.equal(serverGot, 5);
+  assert.ok(clientEnded);
+
+  var got = new Buffer(big.length + 3);
+  var offset = 0;
+  clientGot.forEach(function(d) {
+    assert.ok(offset + d.length <= got.length);
+    d.copy(got, offset);
+    offset += d.length;
+  });
+  assert.equal(offset, got.length);
+  for (var i = 0; i < big.length; i++) assert.equal(got[i], i % 251);
+  assert.equal(got.slice(big.length).toString(), 'bye');
+});
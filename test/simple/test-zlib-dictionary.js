@@ -0,0 +1,113 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Preset dictionaries, and reuse of deflate states between streams.
+
+var common = require('../common');
+var assert = require('assert');
+var zlib = require('zlib');
+
+var dictionary = new Buffer(JSON.stringify({
+  status: 'ok', items: [], total: 0, page: 1, next: null, previous: null,
+  'content-type': 'application/json', created: '', updated: ''
+}));
+
+function response(i) {
+  return JSON.stringify({
+    status: 'ok', items: [i, i + 1], total: 2, page: 1,
+    next: null, previous: null, created: '2012-01-01'
+  });
+}
+
+function compress(Ctor, opts, input, cb) {
+  var out = [];
+  var z = new Ctor(opts);
+  z.on('data', function(c) { out.push(c); });
+  z.on('end', function() { cb(join(out)); });
+  z.end(input);
+}
+
+function join(buffers) {
+  var length = 0;
+  buffers.forEach(function(b) { length += b.length; });
+  var result = new Buffer(length);
+  var off = 0;
+  buffers.forEach(function(b) { b.copy(result, off); off += b.length; });
+  return result;
+}
+
+var roundTrips = 0;
+
+[[zlib.Deflate, zlib.Inflate],
+ [zlib.DeflateRaw, zlib.InflateRaw],
+ [zlib.Deflate, zlib.Unzip]].forEach(function(pair, n) {
+  var input = response(n);
+
+  compress(pair[0], {}, input, function(plain) {
+    compress(pair[0], { dictionary: dictionary }, input, function(packed) {
+      assert.ok(packed.length < plain.length,
+                'dictionary should help: ' + packed.length + ' vs ' +
+                plain.length);
+
+      compress(pair[1], { dictionary: dictionary }, packed, function(out) {
+        assert.equal(out.toString(), input);
+        roundTrips++;
+      });
+    });
+  });
+});
+
+assert.throws(function() {
+  zlib.createGzip({ dictionary: dictionary });
+}, /dictionary/);
+
+assert.throws(function() {
+  zlib.createDeflate({ dictionary: 'not a buffer' });
+}, /dictionary/);
+
+// Streams that have ended hand their deflate state over to the next one.
+var binding = process.binding('zlib');
+var before = binding.deflatePoolStats();
+var sequential = 0;
+
+(function next() {
+  if (sequential === 20) {
+    var after = binding.deflatePoolStats();
+    assert.ok(after.hits - before.hits >= 19,
+              'pool hits: ' + (after.hits - before.hits));
+    assert.ok(after.pooled >= 1);
+    return;
+  }
+  var input = response(sequential);
+  compress(zlib.Gzip, { level: 6 }, input, function(packed) {
+    zlib.gunzip(packed, function(err, out) {
+      assert.ifError(err);
+      assert.equal(out.toString(), input);
+      sequential++;
+      next();
+    });
+  });
+})();
+
+process.on('exit', function() {
+  assert.equal(roundTrips, 3);
+  assert.equal(sequential, 20);
+});
@@ -0,0 +1,216 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Pipelined mode: the input is queued in the binding and drained in
+// batches. Round-trip a few MB written in uneven pieces, with a flush, a
+// pause and backpressure along the way, and check that errors come out.
+
+var common = require('../common');
+var assert = require('assert');
+var zlib = require('zlib');
+
+var input = new Buffer(3 * 1024 * 1024 + 77);
+var seed = 1;
+for (var i = 0; i < input.length; i++) {
+  // compressible but not trivially so
+  seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+  input[i] = 97 + (seed >> 16) % 8;
+}
+
+var pipelines = 0;
+
+function pipeline(Ctor, Dtor, opts) {
+  var deflate = new Ctor({ pipeline: true, chunkSize: 4096 });
+  var inflate = new Dtor({ pipeline: true, highWaterMark: 64 * 1024 });
+  var output = [];
+  var length = 0;
+  var callbacks = 0;
+  var writes = 0;
+  var drains = 0;
+  var sawFalse = false;
+  var flushed = false;
+
+  deflate.on('data', function(chunk) {
+    assert.ok(Buffer.isBuffer(chunk));
+    if (!inflate.write(chunk)) {
+      deflate.pause();
+      inflate.once('drain', function() { deflate.resume(); });
+    }
+  });
+  deflate.on('end', function() {
+    inflate.end();
+  });
+  deflate.on('drain', function() {
+    drains++;
+    write();
+  });
+
+  inflate.on('data', function(chunk) {
+    output.push(chunk);
+    length += chunk.length;
+  });
+  inflate.on('end', function() {
+    var result = new Buffer(length);
+    var off = 0;
+    output.forEach(function(b) {
+      b.copy(result, off);
+      off += b.length;
+    });
+    assert.equal(result.length, input.length);
+    for (var i = 0; i < input.length; i++) {
+      if (result[i] !== input[i]) assert.fail('differs at ' + i);
+    }
+    assert.equal(callbacks, writes);
+    assert.ok(flushed);
+    if (sawFalse) assert.ok(drains > 0);
+    pipelines++;
+  });
+
+  var pos = 0;
+  function write() {
+    while (pos < input.length) {
+      var n = Math.min(input.length - pos, 1000 + (pos % 7919));
+      writes++;
+      var ret = deflate.write(input.slice(pos, pos + n), function() {
+        callbacks++;
+      });
+      pos += n;
+      if (pos > input.length / 2 && !flushed) {
+        deflate.flush(function() { flushed = true; });
+      }
+      if (!ret) {
+        sawFalse = true;
+        return;
+      }
+    }
+    deflate.end();
+  }
+  write();
+}
+
+pipeline(zlib.Deflate, zlib.Inflate);
+pipeline(zlib.Gzip, zlib.Gunzip);
+pipeline(zlib.DeflateRaw, zlib.InflateRaw);
+pipeline(zlib.Gzip, zlib.Unzip);
+
+// Corrupt input is reported once, as an error. The stream is done with
+// after that: it does not end, and writing to it is an error rather than a
+// crash in the released binding.
+var errors = 0;
+var ended = false;
+var bad = new zlib.Inflate({ pipeline: true });
+bad.on('error', function(err) {
+  errors++;
+  assert.ok(err.errno);
+  assert.ok(/header|invalid/.test(err.message), err.message);
+  assert.equal(bad.writable, false);
+
+  bad.removeAllListeners('error');
+  bad.on('error', function(err) {
+    assert.ok(/after end/.test(err.message), err.message);
+    errors++;
+  });
+  bad.write(new Buffer('more'));
+});
+bad.on('end', function() {
+  ended = true;
+});
+bad.write(new Buffer('this is not deflate data'));
+bad.end();
+
+// Input that stops short of the end of the stream is an error too, not a
+// clean 'end' with half of the data.
+var truncated = 0;
+var gzipped = [];
+var gzip = new zlib.Gzip();
+gzip.on('data', function(chunk) {
+  gzipped.push(chunk);
+});
+gzip.on('end', function() {
+  var all = new Buffer(gzipped.reduce(function(n, b) {
+    return n + b.length;
+  }, 0));
+  var off = 0;
+  gzipped.forEach(function(b) {
+    b.copy(all, off);
+    off += b.length;
+  });
+
+  var gunzip = new zlib.Gunzip({ pipeline: true });
+  gunzip.on('error', function(err) {
+    assert.ok(/unexpected end of file/.test(err.message), err.message);
+    truncated++;
+  });
+  gunzip.on('end', function() {
+    assert.fail('truncated input ended cleanly');
+  });
+  gunzip.end(all.slice(0, all.length >> 1));
+});
+gzip.end(input.slice(0, 64 * 1024));
+
+// A batch carries several chunks of output. None of them may come out
+// while the stream is paused, whether the pause came before or during the
+// batch.
+var pausedData = 0;
+var resumed = false;
+var unpaused = new zlib.Deflate({ chunkSize: 1024 });
+var compressed = [];
+unpaused.on('data', function(chunk) {
+  compressed.push(chunk);
+});
+unpaused.on('end', function() {
+  var inflate = new zlib.Inflate({ pipeline: true, chunkSize: 1024 });
+  var paused = false;
+  var length = 0;
+  inflate.on('data', function(chunk) {
+    assert.ok(!paused, 'data while paused');
+    length += chunk.length;
+    if (length === chunk.length) {
+      paused = true;
+      inflate.pause();
+      setTimeout(function() {
+        paused = false;
+        resumed = true;
+        inflate.resume();
+      }, 50);
+    }
+  });
+  inflate.on('end', function() {
+    assert.equal(length, 256 * 1024);
+    pausedData++;
+  });
+  compressed.forEach(function(b) {
+    inflate.write(b);
+  });
+  inflate.end();
+});
+var zeroes = new Buffer(256 * 1024);
+zeroes.fill(0);
+unpaused.end(zeroes);
+
+process.on('exit', function() {
+  assert.equal(pipelines, 4);
+  assert.equal(errors, 2);
+  assert.ok(!ended);
+  assert.equal(truncated, 1);
+  assert.equal(pausedData, 1);
+  assert.ok(resumed);
+});